@@ -0,0 +1,128 @@
+// Pure-compute benchmark cases, shared by the device build (src/main.cpp,
+// in cycles) and the host build (tools/micro_bench, in ns)
+//
+// Each case runs the library code the sketches call on their hot paths with
+// inputs that change from call to call, so nothing is folded at compile
+// time. Names are the keys tools/bench_compare matches on: rename a case
+// and its baseline entry goes missing.
+
+#pragma once
+
+#include <string.h>
+#include <MicroBench.h>
+#include <FixedString.h>
+#include <SpanRaster.h>
+#include <SeriesCodec.h>
+#include <SensorFilter.h>
+#include <AdcDsp.h>
+#include <DhtDecode.h>
+#include <TelemetryCodec.h>
+#include <ButtonLogic.h>
+
+namespace bench {
+
+// The pulse train a DHT11 sends for `bytes`, as the RMT receiver captures it
+inline size_t dhtPulses(const uint8_t bytes[5], DhtPulse *out) {
+  size_t n = 0;
+  out[n++] = {1, 30};   // line released by the host
+  out[n++] = {0, 80};   // handshake
+  out[n++] = {1, 80};
+  for (uint8_t i = 0; i < 40; i++) {
+    out[n++] = {0, 50};
+    out[n++] = {1, (uint16_t)((bytes[i / 8] >> (7 - i % 8)) & 1 ? 70 : 27)};
+  }
+  out[n++] = {0, 50};
+  return n;
+}
+
+static const char *const LABELS[] = {"All Off", "Alternate Blink", "All On", "PWM Fade"};
+
+template <typename Out>
+void runComputeCases(Out &out, const BenchClock &clock) {
+  uint32_t i = 0;
+  uint32_t sink = 0;
+
+  // ---- Text ----
+  char num[FIXED_MAX_CHARS];
+  benchRun(out, clock, "formatFixed 23.47", 100, [&] { sink += formatFixed(num, 2347 + (int32_t)(i++ & 7), 2); });
+  benchRun(out, clock, "FixedString label", 100, [&] {
+    FixedString<24> s("Mode: ");
+    s += label(LABELS, i++ & 3);
+    sink += s.length();
+  });
+  benchRun(out, clock, "FixedString printf line", 10, [&] {
+    FixedString<PRINTF_CHARS> s;
+    s.printf("LDR 15min: min %d mean %d max %d (%lu samples)\n", (int)(i & 255), 220, 240, (unsigned long)i);
+    i++;
+    sink += s.length();
+  });
+
+  // ---- Frame buffer (what clearDisplay / fillCircle cost without the GFX layer) ----
+  static uint8_t frame[128 * 64 / 8];
+  SpanRaster raster;
+  raster.begin(frame);
+  benchRun(out, clock, "SpanRaster fillScreen", 10, [&] { raster.fillScreen(0); });
+  benchRun(out, clock, "SpanRaster fillCircle r20", 10, [&] { raster.fillCircle(64, 32, 20, 1 + (i++ & 1)); });
+  benchKeep(frame);
+
+  // ---- Sample log ----
+  static uint8_t block[252];
+  SeriesCodec::Encoder enc(3);
+  enc.begin(block, sizeof(block));
+  benchRun(out, clock, "SeriesCodec add 3ch", 10, [&] {
+    int16_t v[3] = {(int16_t)(2000 + (i & 7)), 225, (int16_t)(450 + (i >> 6 & 1))};
+    if (!enc.add(500 * i, v)) {
+      enc.begin(block, sizeof(block));
+      enc.add(500 * i, v);
+    }
+    i++;
+  });
+  benchKeep(block);
+
+  // ---- Filters ----
+  FilterChain<Median<5>, Ema<q15(0.1)>> ldr;
+  FilterChain<Kalman<q16(0.5), q16(8.0)>> dht;
+  benchRun(out, clock, "Median<5>+Ema push", 100, [&] { sink += ldr.push(2000 + (int32_t)(i++ * 7 & 15)); });
+  benchRun(out, clock, "Kalman push", 100, [&] { sink += dht.push(220 + (int32_t)(i++ & 1) * 10); });
+
+  // ---- ADC ----
+  Decimator<6> dec;
+  AdcCalLut lut;
+  lut.setLinear(3300);
+  benchRun(out, clock, "Decimator<6> push", 100, [&] {
+    uint16_t o;
+    if (dec.push((uint16_t)(2048 + (i++ & 31)), o)) sink += o;
+  });
+  benchRun(out, clock, "AdcCalLut toMv", 100, [&] { sink += lut.toMv((uint16_t)(i++ & 4095)); });
+
+  // ---- DHT decode ----
+  static DhtPulse pulses[90];
+  const uint8_t bytes[5] = {50, 0, 22, 0, 72};
+  size_t np = dhtPulses(bytes, pulses);
+  benchRun(out, clock, "dhtDecode + convert", 10, [&] {
+    uint8_t b[5];
+    int16_t t;
+    uint16_t h;
+    if (dhtDecode(pulses, np, b) == DHT_OK) {
+      dhtConvert(DHT11, b, t, h);
+      sink += t + h;
+    }
+  });
+
+  // ---- Telemetry frame ----
+  static uint8_t payload[64], cobs[70];
+  for (uint8_t k = 0; k < sizeof(payload); k++) payload[k] = (uint8_t)(k * 37);
+  benchRun(out, clock, "crc16 + cobs 64B", 10, [&] {
+    payload[0] = (uint8_t)i++;
+    sink += TelemetryCodec::crc16(payload, sizeof(payload));
+    sink += (uint32_t)TelemetryCodec::cobsEncode(payload, sizeof(payload), cobs);
+  });
+
+  // ---- Buttons ----
+  VerticalDebounce deb;
+  benchRun(out, clock, "VerticalDebounce update", 100, [&] { sink += deb.update((i++ >> 3 & 1) << 25); });
+
+  benchKeep(sink);
+}
+
+}  // namespace bench
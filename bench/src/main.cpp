@@ -0,0 +1,145 @@
+// Micro-benchmarks: the primitives the sketches spend their time in, timed
+// with the CPU cycle counter and printed as "bench,..." lines (MicroBench)
+//
+// Board as in week 6: OLED on I2C (21, 22), LDR on 34, DHT11 on 14, LED on
+// 17, buzzer on 27. A missing part only affects its own case (no OLED: the
+// display cases time a panel that doesn't answer; no DHT: the DHT case is
+// left out, which bench_compare reports as MISSING).
+//
+// Send 'b' over serial to run everything again.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+#include <OledDiff.h>
+#include <DhtRmt.h>
+#include <FastPin.h>
+#include <MicroBench.h>
+
+// 0: leave out the cases the simulator charges no time for, which would all
+// read 0 cycles there: computation, frame-buffer drawing and LEDC writes
+#ifndef BENCH_COMPUTE
+#define BENCH_COMPUTE 1
+#endif
+
+#if BENCH_COMPUTE
+#include "ComputeCases.h"
+#endif
+
+#define SDA_PIN 21
+#define SCL_PIN 22
+#define LDR_PIN 34
+#define DHT_PIN 14
+#define LED_PIN 17
+#define OUT_PIN 18       // digitalWrite / FastPin target (LED_PIN is on LEDC)
+#define BUZZER_PIN 27
+
+const uint8_t PWM_LED = 0;
+const uint8_t PWM_BUZ = 3;
+const uint8_t DHT_READS = 5;            // one every 2 s
+const uint32_t DHT_TIMEOUT_MS = 15000;
+
+Adafruit_SSD1306 display(128, 64, &Wire, -1);
+OledDiff oled(display);
+DhtRmt dht(DHT_PIN, DHT11, 2000);
+
+static uint32_t cycles() { return ESP.getCycleCount(); }
+
+void benchDisplay(const BenchClock &clock) {
+  uint32_t i = 0;
+#if BENCH_COMPUTE
+  benchRun(Serial, clock, "clearDisplay", 10, [&] { display.clearDisplay(); });
+  benchRun(Serial, clock, "drawChar", 10, [&] {
+    display.drawChar((int16_t)(6 * (i & 15)), 0, (unsigned char)('A' + (i & 15)), SSD1306_WHITE, SSD1306_BLACK, 1);
+    i++;
+  });
+  benchRun(Serial, clock, "print 14 chars", 10, [&] {
+    display.setCursor(0, 16);
+    display.print("Mode: PWM Fade");
+  });
+  benchRun(Serial, clock, "fillCircle r20", 10, [&] { display.fillCircle(64, 32, 20, SSD1306_INVERSE); });
+#endif
+  benchRun(Serial, clock, "display() full frame", 1, [&] { display.display(); });
+  // The sketches' usual redraw: one character changed, only its page sent
+  benchRun(Serial, clock, "OledDiff flush 1 char", 1, [&] {
+    display.drawChar(0, 48, (unsigned char)('0' + (i++ & 7)), SSD1306_WHITE, SSD1306_BLACK, 1);
+    oled.flush();
+  });
+}
+
+void benchPins(const BenchClock &clock) {
+  uint32_t i = 0;
+#if BENCH_COMPUTE
+  benchRun(Serial, clock, "ledcWrite", 10, [&] { ledcWrite(PWM_LED, i++ & 255); });
+  benchRun(Serial, clock, "ledcWriteTone", 1, [&] { ledcWriteTone(PWM_BUZ, 440 + (i++ & 1) * 100); });
+  ledcWriteTone(PWM_BUZ, 0);
+#endif
+  benchRun(Serial, clock, "digitalWrite", 10, [&] { digitalWrite(OUT_PIN, i++ & 1); });
+  benchRun(Serial, clock, "FastPin write", 10, [&] { Pin<OUT_PIN>::write(i++ & 1); });
+  uint32_t sum = 0;
+  benchRun(Serial, clock, "analogRead", 1, [&] { sum += analogRead(LDR_PIN); });
+  benchKeep(sum);
+}
+
+// A DHT read is spread over many poll() calls: add up the cycles spent in
+// them from one good reading to the next
+void benchDht(const BenchClock &clock) {
+  BenchSamples s;
+  uint32_t seq = dht.latest().seq;
+  uint32_t spent = 0;
+  uint32_t start = millis();
+  while (s.count() < DHT_READS && millis() - start < DHT_TIMEOUT_MS) {
+    uint32_t t0 = clock.read();
+    dht.poll();
+    uint32_t d = clock.read() - t0;
+    spent += d > clock.overhead ? d - clock.overhead : 0;
+    if (dht.latest().seq != seq) {
+      if (seq) s.add(spent);   // the first one may have started before us
+      seq = dht.latest().seq;
+      spent = 0;
+    }
+    delay(1);
+  }
+  if (s.count()) s.print(Serial, "DhtRmt read (CPU)", clock.unit);
+  else printfTo(Serial, "# DHT: no reading in %lu ms (%s)\n", (unsigned long)DHT_TIMEOUT_MS,
+                dhtStatusName(dht.lastStatus()));
+}
+
+void runAll() {
+  BenchClock clock = benchClock(cycles, "cycles");
+  printfTo(Serial, "# bench: %u MHz, counter overhead %lu cycles\n", ESP.getCpuFreqMHz(),
+           (unsigned long)clock.overhead);
+  benchDisplay(clock);
+  benchPins(clock);
+  benchDht(clock);
+#if BENCH_COMPUTE
+  bench::runComputeCases(Serial, clock);
+#endif
+  Serial.println("# bench: done");
+}
+
+void setup() {
+  Serial.begin(115200);
+  Wire.begin(SDA_PIN, SCL_PIN);
+  if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) Serial.println("# OLED not found");
+  oled.begin();
+  display.setTextColor(SSD1306_WHITE);
+  display.setTextSize(1);
+
+  ledcSetup(PWM_LED, 5000, 8);
+  ledcAttachPin(LED_PIN, PWM_LED);
+  ledcSetup(PWM_BUZ, 2000, 8);
+  ledcAttachPin(BUZZER_PIN, PWM_BUZ);
+  pinMode(OUT_PIN, OUTPUT);
+  dht.begin();
+
+  runAll();
+}
+
+void loop() {
+  dht.poll();
+  while (Serial.available())
+    if (Serial.read() == 'b') runAll();
+  delay(10);
+}
@@ -0,0 +1,69 @@
+// AdcDsp: integer decimation and calibration for 12-bit ADC samples
+//
+// Pure code (no Arduino / IDF headers) so the math can be checked on the host.
+
+#pragma once
+
+#include <stdint.h>
+
+// Boxcar decimator: averages 2^SHIFT input samples into one output sample.
+// Uses only an add per input and a shift per output.
+template <uint8_t SHIFT>
+class Decimator {
+public:
+  static const uint16_t FACTOR = 1u << SHIFT;
+
+  // Returns true when `out` holds a new averaged sample
+  bool push(uint16_t sample, uint16_t &out) {
+    _sum += sample;
+    if (++_n < FACTOR) return false;
+    out = (uint16_t)((_sum + FACTOR / 2) >> SHIFT);   // rounded mean
+    _sum = 0;
+    _n = 0;
+    return true;
+  }
+
+private:
+  uint32_t _sum = 0;
+  uint16_t _n = 0;
+};
+
+// Piecewise-linear raw -> millivolt table for a 12-bit ADC.
+// Breakpoints every 128 codes (33 entries incl. 4096), interpolated with
+// integer math only.
+class AdcCalLut {
+public:
+  static const uint8_t STEP_SHIFT = 7;
+  static const uint8_t POINTS = (4096 >> STEP_SHIFT) + 1;
+
+  // Ideal straight line 0..fullScaleMv (what (raw / 4095.0) * 3.3 did).
+  // The last breakpoint is code 4096, one past full scale.
+  void setLinear(uint16_t fullScaleMv) {
+    for (uint8_t i = 0; i < POINTS; i++) {
+      uint32_t raw = (uint32_t)i << STEP_SHIFT;
+      _mv[i] = (uint16_t)((raw * fullScaleMv + 2047) / 4095);
+    }
+  }
+
+  // Fill from any raw -> mV function (e.g. esp_adc_cal_raw_to_voltage).
+  // The function is only asked for codes up to 4095; the point at 4096 is
+  // extended from the last segment so that toMv(4095) == rawToMv(4095).
+  template <typename F>
+  void build(F rawToMv) {
+    for (uint8_t i = 0; i < POINTS - 1; i++) _mv[i] = (uint16_t)rawToMv((uint32_t)i << STEP_SHIFT);
+    const int32_t STEP = 1 << STEP_SHIFT;
+    int32_t a = _mv[POINTS - 2], top = (int32_t)rawToMv(4095);
+    _mv[POINTS - 1] = (uint16_t)(a + ((top - a) * STEP + (STEP - 1) / 2) / (STEP - 1));
+  }
+
+  uint16_t toMv(uint16_t raw) const {
+    if (raw > 4095) raw = 4095;
+    uint8_t i = raw >> STEP_SHIFT;
+    int32_t frac = raw & ((1u << STEP_SHIFT) - 1);
+    int32_t a = _mv[i], b = _mv[i + 1];
+    return (uint16_t)(a + (((b - a) * frac + (1 << (STEP_SHIFT - 1))) >> STEP_SHIFT));
+  }
+
+private:
+  uint16_t _mv[POINTS] = {};
+};
@@ -0,0 +1,52 @@
+#include "AdcStream.h"
+
+static const i2s_port_t PORT = I2S_NUM_0;
+static const int DMA_BUF_LEN = 256;       // samples per DMA buffer
+static const int DMA_BUF_COUNT = 4;
+
+AdcStream::AdcStream(uint8_t pin, uint32_t sampleRate) : _pin(pin), _rate(sampleRate) {}
+
+bool AdcStream::begin() {
+  int8_t ch = digitalPinToAnalogChannel(_pin);
+  if (ch < 0 || ch >= ADC1_CHANNEL_MAX) return false;   // ADC2 pins can't be streamed
+  _channel = (adc1_channel_t)ch;
+
+  i2s_config_t cfg = {};
+  cfg.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+  cfg.sample_rate = _rate;
+  cfg.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  cfg.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+  cfg.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+  cfg.dma_buf_count = DMA_BUF_COUNT;
+  cfg.dma_buf_len = DMA_BUF_LEN;
+  if (i2s_driver_install(PORT, &cfg, 0, nullptr) != ESP_OK) return false;
+  if (i2s_set_adc_mode(ADC_UNIT_1, _channel) != ESP_OK) return false;
+  adc1_config_channel_atten(_channel, ADC_ATTEN_DB_11);
+
+  // Per-chip calibration (eFuse Vref / two-point when burned), sampled once
+  // into the lookup table so poll() never calls into esp_adc_cal.
+  esp_adc_cal_characteristics_t chars;
+  esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &chars);
+  _cal.build([&chars](uint32_t raw) { return esp_adc_cal_raw_to_voltage(raw, &chars); });
+
+  return i2s_adc_enable(PORT) == ESP_OK;
+}
+
+void AdcStream::poll() {
+  uint16_t buf[DMA_BUF_LEN];
+  size_t bytes = 0;
+  // Timeout 0: take only what the DMA has already finished
+  while (i2s_read(PORT, buf, sizeof(buf), &bytes, 0) == ESP_OK && bytes > 0) {
+    size_t n = bytes / sizeof(uint16_t);
+    _samples += n;
+    for (size_t i = 0; i < n; i++) {
+      uint16_t out;
+      // Top 4 bits carry the channel number, low 12 bits the conversion
+      if (_decimator.push(buf[i] & 0x0FFF, out)) {
+        _raw = out;
+        _mv = _cal.toMv(out);
+        _outputs++;
+      }
+    }
+  }
+}
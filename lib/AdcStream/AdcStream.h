@@ -0,0 +1,45 @@
+// AdcStream: continuous ADC1 sampling of one pin through I2S DMA
+//
+// The I2S peripheral clocks the built-in ADC at a fixed rate and DMA fills
+// a ring of buffers in the background. poll() drains whatever is ready
+// without waiting, averages every 2^OVERSAMPLE_SHIFT samples and converts
+// the result to millivolts through a calibration table.
+//
+// Only one I2S-ADC stream can exist (it owns I2S0 and ADC1), and analogRead()
+// on other ADC1 pins does not work while it runs.
+
+#pragma once
+
+#include <Arduino.h>
+#include <driver/i2s.h>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include "AdcDsp.h"
+
+class AdcStream {
+public:
+  static const uint8_t OVERSAMPLE_SHIFT = 6;   // 64 samples per output
+
+  explicit AdcStream(uint8_t pin, uint32_t sampleRate = 16000);
+
+  bool begin();
+  void poll();                  // call often from loop(); never blocks
+
+  uint16_t raw() const { return _raw; }       // latest averaged 12-bit value
+  uint16_t millivolts() const { return _mv; }
+  uint32_t outputs() const { return _outputs; }   // averaged samples produced
+  uint32_t samples() const { return _samples; }   // raw samples consumed
+
+private:
+  uint8_t _pin;
+  uint32_t _rate;
+  adc1_channel_t _channel = ADC1_CHANNEL_MAX;
+
+  Decimator<OVERSAMPLE_SHIFT> _decimator;
+  AdcCalLut _cal;
+
+  uint16_t _raw = 0;
+  uint16_t _mv = 0;
+  uint32_t _outputs = 0;
+  uint32_t _samples = 0;
+};
@@ -0,0 +1,127 @@
+// ButtonLogic: debounce and press classification for up to 32 inputs
+//
+// Pure code (no Arduino / IDF headers): feed it sampled pin words and a time
+// base and it produces events, so bounce traces can be replayed on the host.
+// Bit n of every mask is GPIO n; a set bit means "pressed".
+
+#pragma once
+
+#include <stdint.h>
+
+enum ButtonEventType : uint8_t {
+  BTN_PRESS = 0,   // debounced press edge
+  BTN_RELEASE,     // debounced release edge (heldMs = how long it was down)
+  BTN_SHORT,       // released before the long-press time
+  BTN_LONG,        // still held when the long-press time ran out
+  BTN_DOUBLE,      // second short press within the double-press gap
+};
+// A long second press on a double-press pin gives BTN_SHORT for the first
+// press, then BTN_LONG.
+
+
+struct ButtonEvent {
+  uint8_t type;      // ButtonEventType
+  uint8_t pin;       // GPIO number
+  uint32_t heldMs;   // BTN_RELEASE / BTN_SHORT / BTN_DOUBLE only
+  uint32_t timeMs;   // scan time the event was detected at
+};
+
+// 2-bit vertical counter: every lane changes state only after its raw input
+// has disagreed with the debounced state for 4 consecutive samples. All 32
+// lanes are updated with a handful of word-wide logic operations.
+class VerticalDebounce {
+public:
+  // Returns the lanes whose debounced state toggled on this sample
+  uint32_t update(uint32_t raw) {
+    uint32_t delta = raw ^ _state;
+    _ct0 = ~(_ct0 & delta);
+    _ct1 = _ct0 ^ (_ct1 & delta);
+    uint32_t toggled = delta & _ct0 & _ct1;
+    _state ^= toggled;
+    return toggled;
+  }
+  uint32_t state() const { return _state; }
+
+private:
+  uint32_t _state = 0;
+  uint32_t _ct0 = 0xFFFFFFFF;
+  uint32_t _ct1 = 0xFFFFFFFF;
+};
+
+// Turns debounced edges into short / long / double presses.
+// `Sink` is anything with `void operator()(const ButtonEvent &)`.
+class PressClassifier {
+public:
+  uint16_t longMs = 1000;
+  uint16_t doubleGapMs = 300;
+  uint32_t doubleMask = 0;   // pins that wait for a possible second press
+
+  template <typename Sink>
+  void update(uint32_t state, uint32_t toggled, uint32_t now, Sink &emit) {
+    for (uint32_t m = toggled; m; m &= m - 1) {
+      uint8_t pin = __builtin_ctz(m);
+      if (state & (1u << pin)) pressed(pin, now, emit);
+      else released(pin, now, emit);
+    }
+    // Timeouts only matter for buttons that are down or waiting for a 2nd press
+    for (uint32_t m = _active; m; m &= m - 1) {
+      uint8_t pin = __builtin_ctz(m);
+      Track &t = _track[pin];
+      if ((t.phase == DOWN || t.phase == DOWN2) && !t.longSent && now - t.downAt >= longMs) {
+        t.longSent = true;
+        // The first press was short after all: report it before this one
+        if (t.phase == DOWN2) emit(ButtonEvent{BTN_SHORT, pin, t.firstHeld, now});
+        emit(ButtonEvent{BTN_LONG, pin, 0, now});
+      } else if (t.phase == GAP && now - t.upAt >= doubleGapMs) {
+        emit(ButtonEvent{BTN_SHORT, pin, t.firstHeld, now});
+        idle(pin);
+      }
+    }
+  }
+
+private:
+  enum Phase : uint8_t { IDLE = 0, DOWN, GAP, DOWN2 };
+  struct Track {
+    uint32_t downAt;      // start of the current press
+    uint32_t upAt;        // end of the first press (GAP / DOWN2)
+    uint32_t firstHeld;   // how long the first press was down (GAP / DOWN2)
+    Phase phase;
+    bool longSent;
+  };
+
+  template <typename Sink>
+  void pressed(uint8_t pin, uint32_t now, Sink &emit) {
+    Track &t = _track[pin];
+    emit(ButtonEvent{BTN_PRESS, pin, 0, now});
+    t.phase = t.phase == GAP ? DOWN2 : DOWN;
+    t.downAt = now;
+    t.longSent = false;
+    _active |= 1u << pin;
+  }
+
+  template <typename Sink>
+  void released(uint8_t pin, uint32_t now, Sink &emit) {
+    Track &t = _track[pin];
+    uint32_t held = now - t.downAt;
+    emit(ButtonEvent{BTN_RELEASE, pin, held, now});
+    if (t.phase == DOWN && !t.longSent && (doubleMask & (1u << pin))) {
+      t.phase = GAP;
+      t.upAt = now;
+      t.firstHeld = held;
+      return;
+    }
+    if (!t.longSent) {
+      if (t.phase == DOWN2) emit(ButtonEvent{BTN_DOUBLE, pin, held, now});
+      else if (t.phase == DOWN) emit(ButtonEvent{BTN_SHORT, pin, held, now});
+    }
+    idle(pin);
+  }
+
+  void idle(uint8_t pin) {
+    _track[pin].phase = IDLE;
+    _active &= ~(1u << pin);
+  }
+
+  Track _track[32] = {};
+  uint32_t _active = 0;
+};
@@ -0,0 +1,38 @@
+#include "ButtonScan.h"
+#include <soc/gpio_reg.h>
+
+ButtonScan *ButtonScan::_instance = nullptr;
+
+ButtonScan::ButtonScan(uint8_t timerNum, uint8_t periodMs) : _timerNum(timerNum), _periodMs(periodMs) {}
+
+bool ButtonScan::add(uint8_t pin, bool detectDouble) {
+  if (pin >= 32) return false;
+  _mask |= 1u << pin;
+  if (detectDouble) _classifier.doubleMask |= 1u << pin;
+  return true;
+}
+
+bool ButtonScan::begin() {
+  if (_instance) return false;   // the timer ISR has no argument: one scanner only
+  _instance = this;
+  for (uint8_t pin = 0; pin < 32; pin++)
+    if (_mask & (1u << pin)) pinMode(pin, INPUT_PULLUP);
+
+  _timer = timerBegin(_timerNum, 80, true);   // 1 us tick
+  timerAttachInterrupt(_timer, &ButtonScan::onTimer, true);
+  timerAlarmWrite(_timer, (uint64_t)_periodMs * 1000, true);
+  timerAlarmEnable(_timer);
+  return true;
+}
+
+void IRAM_ATTR ButtonScan::onTimer() {
+  _instance->scan();
+}
+
+void IRAM_ATTR ButtonScan::scan() {
+  _now += _periodMs;
+  uint32_t pressed = ~REG_READ(GPIO_IN_REG) & _mask;   // active low
+  uint32_t toggled = _debounce.update(pressed);
+  Pusher sink = {this};
+  _classifier.update(_debounce.state(), toggled, _now, sink);
+}
@@ -0,0 +1,59 @@
+// ButtonScan: all buttons on one periodic timer interrupt
+//
+// Every `periodMs` the timer ISR reads GPIO_IN_REG once (all pins 0-31),
+// debounces every configured button at the same time with a vertical
+// counter and classifies presses (see ButtonLogic.h). Events are queued for
+// loop(), which reads them with next(). One hardware timer is used no
+// matter how many buttons there are, and no GPIO interrupts at all.
+//
+// Buttons are active low with the internal pull-up. Only GPIO 0-31 can be
+// scanned (the ones covered by the single input register read).
+
+#pragma once
+
+#include <Arduino.h>
+#include <EventQueue.h>
+#include "ButtonLogic.h"
+
+class ButtonScan {
+public:
+  static const uint8_t QUEUE_LEN = 16;
+
+  explicit ButtonScan(uint8_t timerNum = 0, uint8_t periodMs = 10);
+
+  // Configure before begin(). Returns false for pins the scanner can't read.
+  bool add(uint8_t pin, bool detectDouble = false);
+  void setLongPressMs(uint16_t ms) { _classifier.longMs = ms; }
+  void setDoubleGapMs(uint16_t ms) { _classifier.doubleGapMs = ms; }
+
+  bool begin();
+
+  // Oldest pending event; false when there is none
+  bool next(ButtonEvent &e) { return _queue.pop(e); }
+
+  bool isDown(uint8_t pin) const { return (_debounce.state() >> pin) & 1; }
+  uint32_t overflows() const { return _queue.overflows(); }
+
+private:
+  static void IRAM_ATTR onTimer();
+  void IRAM_ATTR scan();
+
+  struct Pusher {
+    ButtonScan *self;
+    void operator()(const ButtonEvent &e) { self->_queue.push(e); }
+  };
+
+  static ButtonScan *_instance;
+
+  uint8_t _timerNum;
+  uint8_t _periodMs;
+  hw_timer_t *_timer = nullptr;
+  uint32_t _mask = 0;
+  uint32_t _now = 0;
+
+  VerticalDebounce _debounce;
+  PressClassifier _classifier;
+
+  // Producer: the scan ISR, consumer: loop()
+  SpscQueue<ButtonEvent, QUEUE_LEN> _queue;
+};
@@ -0,0 +1,186 @@
+#include "CoopSched.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+
+static uint32_t arduinoNowUs() { return micros(); }
+
+// Waking through the esp_timer task takes about this long: shorter sleeps
+// are spun, longer ones wake this much early and spin the rest
+static const uint32_t WAKE_US = 20;
+
+static TaskHandle_t sleeper = nullptr;
+static esp_timer_handle_t wakeTimer = nullptr;
+
+static void onWake(void *) { xTaskNotifyGive(sleeper); }
+
+// Blocked, not spinning: an esp_timer one-shot notifies the sleeping task
+// just before the deadline, so the CPU is free (and idle) for the whole
+// wait instead of being rounded to the 1 ms FreeRTOS tick.
+static void arduinoSleepUs(uint32_t us) {
+  uint32_t end = micros() + us;
+  if (us > WAKE_US) {
+    if (!wakeTimer) {
+      esp_timer_create_args_t args = {};
+      args.callback = &onWake;
+      args.name = "coopsched";
+      esp_timer_create(&args, &wakeTimer);
+    }
+    sleeper = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);   // drop a notification left from before
+    esp_timer_start_once(wakeTimer, us - WAKE_US);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+  int32_t left = (int32_t)(end - micros());
+  if (left > 0) delayMicroseconds(left);
+}
+
+SchedClock SchedClock::arduino() { return SchedClock{&arduinoNowUs, &arduinoSleepUs}; }
+#endif
+
+uint32_t VirtualClock::now = 0;
+
+CoopSched::CoopSched(const SchedClock &clock) : _clock(clock) {
+  for (uint8_t i = 0; i < MAX_TASKS; i++) _pos[i] = -1;
+}
+
+int8_t CoopSched::every(uint32_t periodUs, TaskFn fn, const char *name, bool enabled) {
+  return add(periodUs, 0, fn, name, enabled);
+}
+
+int8_t CoopSched::after(uint32_t delayUs, TaskFn fn, const char *name) {
+  return add(0, delayUs, fn, name, true);
+}
+
+int8_t CoopSched::add(uint32_t periodUs, uint32_t firstUs, TaskFn fn, const char *name, bool enabled) {
+  if (_count == 0 && _statsSince == 0) _statsSince = _clock.nowUs();
+  for (int8_t id = 0; id < MAX_TASKS; id++) {
+    Task &t = _tasks[id];
+    if (t.fn) continue;
+    t = Task();
+    t.fn = fn;
+    t.name = name;
+    t.periodUs = periodUs;
+    t.deadline = _clock.nowUs() + firstUs;
+    if (enabled) heapPush(id);
+    return id;
+  }
+  return -1;
+}
+
+void CoopSched::enable(int8_t id, bool on) {
+  if (id < 0 || !_tasks[id].fn || on == enabled(id)) return;
+  if (on) {
+    _tasks[id].deadline = _clock.nowUs();
+    heapPush(id);
+  } else {
+    heapRemove(id);
+  }
+}
+
+void CoopSched::again(uint32_t delayUs) {
+  if (_running < 0) return;
+  if (enabled(_running)) heapRemove(_running);
+  _tasks[_running].deadline = _runDeadline + delayUs;
+  heapPush(_running);
+}
+
+uint32_t CoopSched::runDue() {
+  while (_count) {
+    int8_t id = _heap[0];
+    Task &t = _tasks[id];
+    uint32_t start = _clock.nowUs();
+    int32_t early = (int32_t)(t.deadline - start);
+    if (early > 0) return (uint32_t)early;
+
+    // Take it off the heap before running so the task may re-enable,
+    // disable or retime itself (and others) freely.
+    heapRemove(id);
+    uint32_t deadline = t.deadline;
+    bool periodic = t.periodUs != 0;
+    if (periodic) {
+      t.deadline = deadline + t.periodUs;
+      // Fell more than a period behind: skip the missed slots, keep the phase
+      if ((int32_t)(t.deadline - start) < 0)
+        t.deadline += ((start - t.deadline) / t.periodUs + 1) * t.periodUs;
+      heapPush(id);
+    }
+
+    _running = id;
+    _runDeadline = deadline;
+    t.fn();
+    _running = -1;
+
+    uint32_t end = _clock.nowUs();
+    TaskStats &s = t.stats;
+    uint32_t late = start - deadline;
+    uint32_t ran = end - start;
+    s.runs++;
+    s.totalLateUs += late;
+    if (late > s.maxLateUs) s.maxLateUs = late;
+    if (ran > s.maxRunUs) s.maxRunUs = ran;
+    s.busyUs += ran;
+
+    if (!periodic && !enabled(id)) _tasks[id].fn = nullptr;   // one-shot done
+  }
+  return UINT32_MAX;
+}
+
+void CoopSched::run() {
+  uint32_t wait = runDue();
+  if (wait == UINT32_MAX) wait = 1000;   // nothing queued: idle a millisecond
+  if (wait) _clock.sleepUs(wait);
+}
+
+uint16_t CoopSched::cpuPermille(int8_t id) const {
+  uint32_t span = _clock.nowUs() - _statsSince;
+  if (!span) return 0;
+  uint64_t p = _tasks[id].stats.busyUs * 1000 / span;
+  return p > 1000 ? 1000 : (uint16_t)p;
+}
+
+void CoopSched::resetStats() {
+  for (uint8_t i = 0; i < MAX_TASKS; i++) _tasks[i].stats = TaskStats();
+  _statsSince = _clock.nowUs();
+}
+
+// ---- binary min-heap on deadline, with positions tracked for removal ----
+
+void CoopSched::heapPush(int8_t id) {
+  place(_count, id);
+  siftUp(_count++);
+}
+
+void CoopSched::heapRemove(int8_t id) {
+  uint8_t i = _pos[id];
+  _pos[id] = -1;
+  if (--_count == i) return;
+  place(i, _heap[_count]);
+  siftDown(i);
+  siftUp(i);
+}
+
+void CoopSched::siftUp(uint8_t i) {
+  while (i > 0) {
+    uint8_t parent = (i - 1) / 2;
+    if (!before(_heap[i], _heap[parent])) break;
+    int8_t a = _heap[i], b = _heap[parent];
+    place(i, b);
+    place(parent, a);
+    i = parent;
+  }
+}
+
+void CoopSched::siftDown(uint8_t i) {
+  for (;;) {
+    uint8_t l = 2 * i + 1, r = l + 1, m = i;
+    if (l < _count && before(_heap[l], _heap[m])) m = l;
+    if (r < _count && before(_heap[r], _heap[m])) m = r;
+    if (m == i) break;
+    int8_t a = _heap[i], b = _heap[m];
+    place(i, b);
+    place(m, a);
+    i = m;
+  }
+}
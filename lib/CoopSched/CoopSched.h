@@ -0,0 +1,120 @@
+// CoopSched: deadline-driven cooperative scheduler
+//
+// Tasks are plain functions run either periodically or once after a delay.
+// Pending deadlines sit in a binary min-heap, so finding the next task is
+// O(1) and (re)scheduling one is O(log n). run() executes whatever is due
+// and then sleeps until exactly the next deadline, instead of the fixed
+// delay() steps the sketches used to pace themselves with.
+//
+// Time comes from a SchedClock (micros()/esp_timer on the board, a VirtualClock
+// on the host), so the same scheduling can be replayed and measured off
+// target. All times are 32-bit microseconds compared wrap-safely, so no
+// deadline may be more than ~35 minutes away.
+
+#pragma once
+
+#include <stdint.h>
+#include <FixedString.h>
+
+typedef void (*TaskFn)();
+
+struct SchedClock {
+  uint32_t (*nowUs)();
+  void (*sleepUs)(uint32_t us);
+
+#ifdef ARDUINO
+  static SchedClock arduino();   // micros() + esp_timer wake-up, blocked in ulTaskNotifyTake()
+#endif
+};
+
+// Host clock: sleeping just moves time forward
+struct VirtualClock {
+  static uint32_t now;
+  static uint32_t nowUs() { return now; }
+  static void sleepUs(uint32_t us) { now += us; }
+  static SchedClock clock() { return SchedClock{&nowUs, &sleepUs}; }
+};
+
+struct TaskStats {
+  uint32_t runs = 0;
+  uint32_t maxLateUs = 0;     // worst start time past the deadline
+  uint64_t totalLateUs = 0;
+  uint32_t maxRunUs = 0;      // longest single run
+  uint64_t busyUs = 0;        // total time spent inside the task
+};
+
+class CoopSched {
+public:
+  static const uint8_t MAX_TASKS = 16;
+
+  explicit CoopSched(const SchedClock &clock);
+
+  // Returns a task id, or -1 when all slots are taken.
+  // Periodic tasks keep their phase (next = deadline + period).
+  int8_t every(uint32_t periodUs, TaskFn fn, const char *name, bool enabled = true);
+  // One-shot: runs once and frees its slot
+  int8_t after(uint32_t delayUs, TaskFn fn, const char *name);
+
+  // A disabled task keeps its slot and stats but never runs.
+  // Enabling it makes it due immediately.
+  void enable(int8_t id, bool on);
+  bool enabled(int8_t id) const { return id >= 0 && _pos[id] >= 0; }
+  void setPeriod(int8_t id, uint32_t periodUs) { if (id >= 0) _tasks[id].periodUs = periodUs; }
+
+  // From inside a running task: run it again `delayUs` after the deadline it
+  // was released at (not after "now", so chained steps don't drift).
+  // Lets a one-shot task walk through a sequence of different delays.
+  void again(uint32_t delayUs);
+
+  // Run every task that is due, then return the us until the next deadline
+  // (0 if something is already due again, UINT32_MAX if nothing is queued).
+  uint32_t runDue();
+  // runDue() then sleep until the next deadline: call this as the whole loop()
+  void run();
+
+  const TaskStats &stats(int8_t id) const { return _tasks[id].stats; }
+  const char *name(int8_t id) const { return _tasks[id].name; }
+  // Share of the time since start (or the last resetStats()) spent in a task, in 0.1 %
+  uint16_t cpuPermille(int8_t id) const;
+  void resetStats();
+
+  // Print one line per task: runs, late max/avg, run max, CPU share
+  template <typename Out>
+  void report(Out &out) const {
+    for (int8_t i = 0; i < MAX_TASKS; i++) {
+      const Task &t = _tasks[i];
+      if (!t.fn) continue;
+      const TaskStats &s = t.stats;
+      printfTo(out, "%-8s runs %6lu  late max %6lu us avg %5lu us  run max %6lu us  cpu %3u.%u%%\n",
+                    t.name, (unsigned long)s.runs, (unsigned long)s.maxLateUs,
+                    (unsigned long)(s.runs ? s.totalLateUs / s.runs : 0), (unsigned long)s.maxRunUs,
+                    cpuPermille(i) / 10, cpuPermille(i) % 10);
+    }
+  }
+
+private:
+  struct Task {
+    TaskFn fn = nullptr;
+    const char *name = "";
+    uint32_t periodUs = 0;     // 0 = one-shot
+    uint32_t deadline = 0;
+    TaskStats stats;
+  };
+
+  int8_t add(uint32_t periodUs, uint32_t firstUs, TaskFn fn, const char *name, bool enabled);
+  bool before(int8_t a, int8_t b) const { return (int32_t)(_tasks[a].deadline - _tasks[b].deadline) < 0; }
+  void heapPush(int8_t id);
+  void heapRemove(int8_t id);
+  void siftUp(uint8_t i);
+  void siftDown(uint8_t i);
+  void place(uint8_t i, int8_t id) { _heap[i] = id; _pos[id] = i; }
+
+  SchedClock _clock;
+  Task _tasks[MAX_TASKS];
+  int8_t _heap[MAX_TASKS];
+  int8_t _pos[MAX_TASKS];      // index in _heap, -1 = not queued
+  uint8_t _count = 0;
+  uint32_t _statsSince = 0;
+  int8_t _running = -1;
+  uint32_t _runDeadline = 0;
+};
@@ -0,0 +1,53 @@
+#include "CoreLoad.h"
+#include <FixedString.h>
+
+static TaskLoad *g_tasks = nullptr;   // in registration order
+static TaskLoad **g_tail = &g_tasks;
+static uint32_t g_lastReportUs = 0;
+
+TaskLoad::TaskLoad(const char *name) : _name(name), _next(nullptr) {
+  *g_tail = this;
+  g_tail = &_next;
+}
+
+namespace CoreLoad {
+
+static const uint8_t MAX_LISTED = 8;
+
+// Percent with two decimals: a quiet core is well under 1 %
+static void printPercent(Print &out, uint32_t busyUs, uint32_t windowUs) {
+  uint32_t bp = windowUs ? (uint32_t)((uint64_t)busyUs * 10000 / windowUs) : 0;
+  printfTo(out, "%3lu.%02lu %%", (unsigned long)(bp / 100), (unsigned long)(bp % 100));
+}
+
+void report(Print &out) {
+  uint32_t now = micros();
+  uint32_t window = now - g_lastReportUs;
+  g_lastReportUs = now;
+
+  // Take every task's busy time once, so the per-core sums and the per-task
+  // lines describe the same window
+  uint32_t busy[MAX_LISTED] = {};
+  uint32_t perCore[2] = {0, 0};
+  uint8_t n = 0;
+  for (TaskLoad *t = g_tasks; t && n < MAX_LISTED; t = t->next(), n++) {
+    busy[n] = t->takeBusyUs();
+    if (t->core() == 0 || t->core() == 1) perCore[t->core()] += busy[n];
+  }
+
+  for (uint8_t c = 0; c < 2; c++) {
+    printfTo(out, "core%u ", c);
+    printPercent(out, perCore[c], window);
+    out.print("  ");
+  }
+  printfTo(out, "(%lu ms)\n", (unsigned long)(window / 1000));
+
+  n = 0;
+  for (TaskLoad *t = g_tasks; t && n < MAX_LISTED; t = t->next(), n++) {
+    printfTo(out, "  %-6s core%d ", t->name(), t->core());
+    printPercent(out, busy[n], window);
+    out.println();
+  }
+}
+
+}  // namespace CoreLoad
@@ -0,0 +1,69 @@
+// CoreLoad: CPU use per task and per core from explicit busy spans
+//
+//   TaskLoad acqLoad("acq");           // file scope, one per task
+//   void acqTask(void *) {
+//     for (;;) {
+//       { LoadScope busy(acqLoad); ...work... }
+//       vTaskDelayUntil(...);          // waiting is not counted
+//     }
+//   }
+//   CoreLoad::report(Serial);          // % busy per core since the last report
+//
+// Each TaskLoad is written only by its own task (it remembers which core it
+// ran on) and read by report(), so no locks are needed: the counters are
+// 32-bit microsecond totals, compared wrap-safely between reports. Reports
+// must therefore come at least every ~71 minutes. Time a task spends blocked
+// inside a span (an I2C transfer waiting on the bus) counts as busy. report()
+// lists the first eight TaskLoads.
+
+#pragma once
+
+#include <Arduino.h>
+
+class TaskLoad {
+public:
+  explicit TaskLoad(const char *name);
+
+  void begin() { _t0 = micros(); }
+  void end() {
+    _busyUs += micros() - _t0;
+    _core = (int8_t)xPortGetCoreID();
+  }
+
+  const char *name() const { return _name; }
+  int8_t core() const { return _core; }
+  uint32_t busyUs() const { return _busyUs; }
+  TaskLoad *next() const { return _next; }
+
+  // Busy time since the previous call (used by CoreLoad::report())
+  uint32_t takeBusyUs() {
+    uint32_t busy = _busyUs;
+    uint32_t d = busy - _reportedUs;
+    _reportedUs = busy;
+    return d;
+  }
+
+private:
+  const char *_name;
+  volatile uint32_t _busyUs = 0;
+  volatile int8_t _core = -1;      // -1 until the first span ends
+  uint32_t _t0 = 0;
+  uint32_t _reportedUs = 0;        // _busyUs at the previous report
+  TaskLoad *_next;
+};
+
+class LoadScope {
+public:
+  explicit LoadScope(TaskLoad &t) : _t(t) { _t.begin(); }
+  ~LoadScope() { _t.end(); }
+
+private:
+  TaskLoad &_t;
+};
+
+namespace CoreLoad {
+// One line per core, then one per task:
+//   core0  12.50 %  core1   3.10 %  (10000 ms)
+//     acq    core0  12.50 %
+void report(Print &out);
+}
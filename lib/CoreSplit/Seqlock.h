@@ -0,0 +1,51 @@
+// Seqlock: latest-value snapshot shared between tasks on different cores
+//
+// One writer publishes a whole struct, any number of readers copy it out.
+// The writer never waits: it makes the sequence odd, copies the value in and
+// makes it even again. A reader copies the value between two reads of the
+// sequence and keeps the copy only if both were the same even number, so it
+// never sees half of one publish and half of the next. Readers retry only
+// when they raced a publish, which for a few bytes every few hundred
+// milliseconds practically never happens.
+//
+// Unlike a queue nothing ever backs up: a slow reader skips straight to the
+// newest value. T must be trivially copyable.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+template <typename T>
+class Seqlock {
+public:
+  // Writer side (one task only)
+  void publish(const T &v) {
+    uint32_t s = _seq.load(std::memory_order_relaxed);
+    _seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&_value, &v, sizeof(T));
+    _seq.store(s + 2, std::memory_order_release);
+  }
+
+  // Reader side. Returns the publish count the copy belongs to, 0 while
+  // nothing has been published yet (out is left untouched then).
+  uint32_t read(T &out) const {
+    for (;;) {
+      uint32_t s1 = _seq.load(std::memory_order_acquire);
+      if (s1 == 0) return 0;
+      if (s1 & 1) continue;   // publish in progress on the other core
+      memcpy(&out, &_value, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) == s1) return s1 / 2;
+    }
+  }
+
+  // Publish count without copying, to check for something new cheaply
+  uint32_t version() const { return _seq.load(std::memory_order_acquire) / 2; }
+
+private:
+  T _value;
+  std::atomic<uint32_t> _seq{0};
+};
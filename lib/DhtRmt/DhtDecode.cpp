@@ -0,0 +1,62 @@
+#include "DhtDecode.h"
+
+// Datasheet timings with generous margins (sensors and wiring vary)
+static const uint16_t ACK_MIN_US = 40, ACK_MAX_US = 120;   // 80 us low, 80 us high
+static const uint16_t GAP_MIN_US = 30, GAP_MAX_US = 90;    // 50 us low before each bit
+static const uint16_t BIT_MIN_US = 10, BIT_MAX_US = 100;   // 26-28 us = 0, 70 us = 1
+static const uint16_t ONE_US = 48;                         // threshold between 0 and 1
+
+static bool inRange(uint16_t v, uint16_t lo, uint16_t hi) { return v >= lo && v <= hi; }
+
+const char *dhtStatusName(DhtStatus s) {
+  switch (s) {
+    case DHT_OK: return "ok";
+    case DHT_NO_RESPONSE: return "no response";
+    case DHT_TRUNCATED: return "truncated";
+    case DHT_BAD_TIMING: return "bad timing";
+    case DHT_CHECKSUM: return "checksum";
+    case DHT_TIMEOUT: return "timeout";
+    default: return "?";
+  }
+}
+
+DhtStatus dhtDecode(const DhtPulse *pulses, size_t n, uint8_t out[5]) {
+  if (n == 0) return DHT_TIMEOUT;
+
+  // Handshake: sensor pulls low ~80 us, then high ~80 us
+  size_t i = 0;
+  while (i + 1 < n && !(pulses[i].level == 0 && inRange(pulses[i].us, ACK_MIN_US, ACK_MAX_US) &&
+                        pulses[i + 1].level == 1 && inRange(pulses[i + 1].us, ACK_MIN_US, ACK_MAX_US)))
+    i++;
+  if (i + 1 >= n) return DHT_NO_RESPONSE;
+  i += 2;
+
+  // 40 bits, each a ~50 us low followed by a high whose length is the bit
+  for (uint8_t k = 0; k < 5; k++) out[k] = 0;
+  for (uint8_t bit = 0; bit < 40; bit++, i += 2) {
+    if (i + 1 >= n) return DHT_TRUNCATED;
+    const DhtPulse &gap = pulses[i];
+    const DhtPulse &cell = pulses[i + 1];
+    if (gap.level != 0 || cell.level != 1) return DHT_BAD_TIMING;
+    if (!inRange(gap.us, GAP_MIN_US, GAP_MAX_US) || !inRange(cell.us, BIT_MIN_US, BIT_MAX_US))
+      return DHT_BAD_TIMING;
+    out[bit >> 3] = (out[bit >> 3] << 1) | (cell.us > ONE_US ? 1 : 0);
+  }
+
+  uint8_t sum = out[0] + out[1] + out[2] + out[3];
+  return sum == out[4] ? DHT_OK : DHT_CHECKSUM;
+}
+
+void dhtConvert(uint8_t type, const uint8_t b[5], int16_t &tempTenths, uint16_t &humTenths) {
+  if (type == DHT11) {
+    // Integer byte + decimal byte; bit 7 of the temperature decimal is the sign
+    humTenths = b[0] * 10 + b[1];
+    tempTenths = b[2] * 10 + (b[3] & 0x0F);
+    if (b[3] & 0x80) tempTenths = -tempTenths;
+  } else {
+    // DHT21/22: 16-bit values in tenths, sign-magnitude temperature
+    humTenths = ((uint16_t)b[0] << 8) | b[1];
+    tempTenths = (int16_t)((((uint16_t)b[2] & 0x7F) << 8) | b[3]);
+    if (b[2] & 0x80) tempTenths = -tempTenths;
+  }
+}
@@ -0,0 +1,40 @@
+// DhtDecode: turn a captured DHT11/DHT22 pulse train into a reading
+//
+// Pure code (no Arduino / IDF headers) so it can be fed recorded waveforms
+// on the host. A capture is the list of line levels and how long each one
+// lasted, as produced by the RMT receiver at 1 us resolution.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef DHT11
+#define DHT11 11
+#endif
+#ifndef DHT22
+#define DHT22 22
+#endif
+
+struct DhtPulse {
+  uint8_t level;   // 0 = line low, 1 = line high
+  uint16_t us;     // duration
+};
+
+enum DhtStatus : uint8_t {
+  DHT_OK = 0,
+  DHT_NO_RESPONSE,   // no 80 us low / 80 us high handshake found
+  DHT_TRUNCATED,     // handshake seen but fewer than 40 bits followed
+  DHT_BAD_TIMING,    // a bit cell outside the datasheet tolerances
+  DHT_CHECKSUM,      // 40 bits decoded, parity byte does not match
+  DHT_TIMEOUT,       // nothing captured at all
+};
+
+const char *dhtStatusName(DhtStatus s);
+
+// Decode the 5 data bytes. Leading pulses before the handshake (e.g. the
+// line floating high after the host releases it) are skipped.
+DhtStatus dhtDecode(const DhtPulse *pulses, size_t n, uint8_t out[5]);
+
+// Convert decoded bytes to tenths of a degree C and tenths of a %RH.
+void dhtConvert(uint8_t type, const uint8_t b[5], int16_t &tempTenths, uint16_t &humTenths);
@@ -0,0 +1,102 @@
+#include "DhtRmt.h"
+
+static const uint32_t CAPTURE_TIMEOUT_MS = 50;  // a whole frame takes ~5 ms
+static const uint16_t IDLE_US = 200;            // line idle this long = end of frame
+static const size_t MAX_PULSES = 128;           // 64 RMT items, one memory block
+
+DhtRmt::DhtRmt(uint8_t pin, uint8_t type, uint32_t periodMs, rmt_channel_t channel)
+    : _pin(pin), _type(type), _periodMs(periodMs), _channel(channel) {}
+
+bool DhtRmt::begin() {
+  rmt_config_t cfg = RMT_DEFAULT_CONFIG_RX((gpio_num_t)_pin, _channel);
+  cfg.clk_div = 80;                        // 1 us per tick
+  cfg.rx_config.idle_threshold = IDLE_US;
+  cfg.rx_config.filter_en = true;
+  cfg.rx_config.filter_ticks_thresh = 100; // ignore glitches < ~1.25 us
+  if (rmt_config(&cfg) != ESP_OK) return false;
+  if (rmt_driver_install(_channel, 512, 0) != ESP_OK) return false;
+  if (rmt_get_ringbuf_handle(_channel, &_rb) != ESP_OK) return false;
+
+  // Open drain with pull-up: level 0 drives the line, level 1 releases it
+  // to the sensor. The RMT keeps reading the pad through the GPIO matrix.
+  gpio_set_direction((gpio_num_t)_pin, GPIO_MODE_INPUT_OUTPUT_OD);
+  gpio_set_pull_mode((gpio_num_t)_pin, GPIO_PULLUP_ONLY);
+  gpio_set_level((gpio_num_t)_pin, 1);
+
+  esp_timer_create_args_t args = {};
+  args.callback = &DhtRmt::onStartDone;
+  args.arg = this;
+  args.name = "dht";
+  if (esp_timer_create(&args, &_timer) != ESP_OK) return false;
+
+  _nextMs = millis();
+  return true;
+}
+
+// esp_timer task: host start pulse is over, hand the line to the sensor
+void DhtRmt::onStartDone(void *arg) {
+  DhtRmt *self = static_cast<DhtRmt *>(arg);
+  rmt_rx_start(self->_channel, true);
+  gpio_set_level((gpio_num_t)self->_pin, 1);
+  self->_state = CAPTURE;
+}
+
+void DhtRmt::poll() {
+  uint32_t now = millis();
+
+  if (_state == IDLE) {
+    if ((int32_t)(now - _nextMs) < 0) return;
+    // Start signal: >= 18 ms low for DHT11, ~1 ms for DHT22
+    gpio_set_level((gpio_num_t)_pin, 0);
+    _startMs = now;
+    _state = START;
+    esp_timer_start_once(_timer, _type == DHT11 ? 20000 : 1100);
+    return;
+  }
+
+  if (_state != CAPTURE) return;
+
+  size_t len = 0;
+  rmt_item32_t *items = (rmt_item32_t *)xRingbufferReceive(_rb, &len, 0);
+  if (!items) {
+    if (now - _startMs > CAPTURE_TIMEOUT_MS) finish(DHT_TIMEOUT, nullptr);
+    return;
+  }
+
+  // Flatten RMT items into level/duration pairs; a zero duration ends the frame
+  DhtPulse pulses[MAX_PULSES];
+  size_t n = 0;
+  for (size_t k = 0; k < len / sizeof(rmt_item32_t) && n + 2 <= MAX_PULSES; k++) {
+    if (!items[k].duration0) break;
+    pulses[n++] = {(uint8_t)items[k].level0, (uint16_t)items[k].duration0};
+    if (!items[k].duration1) break;
+    pulses[n++] = {(uint8_t)items[k].level1, (uint16_t)items[k].duration1};
+  }
+  vRingbufferReturnItem(_rb, items);
+
+  uint8_t bytes[5];
+  DhtStatus status = dhtDecode(pulses, n, bytes);
+  finish(status, status == DHT_OK ? bytes : nullptr);
+}
+
+void DhtRmt::finish(DhtStatus status, const uint8_t *bytes) {
+  rmt_rx_stop(_channel);
+  _lastStatus = status;
+
+  uint32_t wait = _periodMs;
+  if (bytes) {
+    dhtConvert(_type, bytes, _reading.tempTenths, _reading.humTenths);
+    _reading.timestampMs = _startMs;
+    _reading.seq++;
+    _reading.valid = true;
+    _streak = 0;
+  } else {
+    _failures++;
+    if (_streak < 16) _streak++;
+    // 2x, 4x, 8x ... the normal period, capped
+    wait = _periodMs << (_streak < 5 ? _streak : 5);
+    if (wait > MAX_BACKOFF_MS) wait = MAX_BACKOFF_MS;
+  }
+  _nextMs = _startMs + wait;
+  _state = IDLE;
+}
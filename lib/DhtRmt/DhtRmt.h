@@ -0,0 +1,68 @@
+// DhtRmt: non-blocking DHT11/DHT22 acquisition using the ESP32 RMT receiver
+//
+// One bus transaction per sampling period:
+//   poll() pulls the data line low and arms an esp_timer one-shot
+//   -> the timer releases the line and starts an RMT capture
+//   -> a later poll() picks the pulse train up from the RMT ring buffer
+//      and decodes it with dhtDecode().
+// Interrupts are never disabled and poll() never waits, so button ISRs and
+// the rest of loop() keep running during a read.
+//
+// The newest good reading stays cached (with its timestamp) until the next
+// one arrives. After a failed read the next attempt is pushed back
+// exponentially, up to MAX_BACKOFF_MS.
+
+#pragma once
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include <esp_timer.h>
+#include "DhtDecode.h"
+
+struct DhtReading {
+  int16_t tempTenths = 0;    // 0.1 degC
+  uint16_t humTenths = 0;    // 0.1 %RH
+  uint32_t timestampMs = 0;  // millis() when the frame was captured
+  uint32_t seq = 0;          // increments with every good reading
+  bool valid = false;
+
+  float temperature() const { return tempTenths / 10.0f; }
+  float humidity() const { return humTenths / 10.0f; }
+};
+
+class DhtRmt {
+public:
+  static const uint32_t MAX_BACKOFF_MS = 60000;
+
+  DhtRmt(uint8_t pin, uint8_t type, uint32_t periodMs = 2000, rmt_channel_t channel = RMT_CHANNEL_0);
+
+  bool begin();
+  void poll();               // call often from loop(); never blocks
+
+  const DhtReading &latest() const { return _reading; }
+  DhtStatus lastStatus() const { return _lastStatus; }
+  uint32_t failures() const { return _failures; }          // total failed reads
+  uint8_t consecutiveFailures() const { return _streak; }
+
+private:
+  enum State : uint8_t { IDLE, START, CAPTURE };
+
+  static void onStartDone(void *arg);
+  void finish(DhtStatus status, const uint8_t *bytes);
+
+  uint8_t _pin;
+  uint8_t _type;
+  uint32_t _periodMs;
+  rmt_channel_t _channel;
+  RingbufHandle_t _rb = nullptr;
+  esp_timer_handle_t _timer = nullptr;
+
+  volatile State _state = IDLE;
+  uint32_t _startMs = 0;
+  uint32_t _nextMs = 0;
+
+  DhtReading _reading;
+  DhtStatus _lastStatus = DHT_TIMEOUT;
+  uint32_t _failures = 0;
+  uint8_t _streak = 0;
+};
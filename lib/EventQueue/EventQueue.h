@@ -0,0 +1,109 @@
+// EventQueue: bounded, wait-free queues for passing events out of ISRs
+//
+// SpscQueue<T, N>     one producer (e.g. one ISR), one consumer (loop()).
+// MpscQueue<T, N, P>  P producers, each with its own SPSC lane, one consumer
+//                     that always takes the oldest head (by timeUs).
+//
+// push() and pop() never block or retry: a full queue rejects the push and
+// counts it in overflows(). Only 32-bit atomic loads and stores are used,
+// which are lock-free on the ESP32 and safe from IRAM_ATTR context.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// What the ISRs in this repo report
+struct Event {
+  uint8_t type;      // sketch-defined
+  uint8_t source;    // sketch-defined (button, timer, ...)
+  uint16_t arg;      // optional payload
+  uint32_t timeUs;   // micros() when the event happened
+};
+
+template <typename T, uint16_t N>
+class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "queue length must be a power of two");
+
+public:
+  // Producer side
+  bool IRAM_ATTR push(const T &v) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) == N) {
+      // Only the producer writes this counter, so no read-modify-write needed
+      _overflows.store(_overflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    _buf[head & (N - 1)] = v;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T &v) {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+    v = _buf[tail & (N - 1)];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  const T *peek() const {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return nullptr;
+    return &_buf[tail & (N - 1)];
+  }
+
+  bool empty() const { return peek() == nullptr; }
+  uint16_t size() const {
+    return (uint16_t)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+  }
+  uint32_t overflows() const { return _overflows.load(std::memory_order_relaxed); }
+
+private:
+  T _buf[N];
+  std::atomic<uint32_t> _head{0};
+  std::atomic<uint32_t> _tail{0};
+  std::atomic<uint32_t> _overflows{0};
+};
+
+// T must have a uint32_t `timeUs` member; lanes are merged oldest-first
+// (wrap-safe comparison, so events must be less than ~35 min apart).
+template <typename T, uint16_t N, uint8_t P>
+class MpscQueue {
+public:
+  // `lane` identifies the producer: each ISR must use its own lane
+  bool IRAM_ATTR push(uint8_t lane, const T &v) { return _lanes[lane].push(v); }
+
+  bool pop(T &v) {
+    int8_t best = -1;
+    uint32_t bestTime = 0;
+    for (uint8_t i = 0; i < P; i++) {
+      const T *head = _lanes[i].peek();
+      if (head && (best < 0 || (int32_t)(head->timeUs - bestTime) < 0)) {
+        best = i;
+        bestTime = head->timeUs;
+      }
+    }
+    return best >= 0 && _lanes[best].pop(v);
+  }
+
+  bool empty() const {
+    for (uint8_t i = 0; i < P; i++)
+      if (!_lanes[i].empty()) return false;
+    return true;
+  }
+  uint32_t overflows() const {
+    uint32_t n = 0;
+    for (uint8_t i = 0; i < P; i++) n += _lanes[i].overflows();
+    return n;
+  }
+
+private:
+  SpscQueue<T, N> _lanes[P];
+};
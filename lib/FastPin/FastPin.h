@@ -0,0 +1,146 @@
+// FastPin: GPIO pins and pin groups fixed at compile time
+//
+// A pin number is a template argument, so its register bit is a constant
+// and an update is one store to GPIO_OUT_W1TS_REG (set) or
+// GPIO_OUT_W1TC_REG (clear): no pin lookup, no read-modify-write, and all
+// pins of a group change on the same APB write instead of one
+// digitalWrite() after the other.
+//
+//   typedef PinGroup<17, 18, 19> Leds;     // replaces #define LED_1 17 ...
+//   typedef Pin<14> Buzzer;
+//   static_assert(pinsDisjoint<Leds, Buzzer>(), "LED and buzzer pins overlap");
+//
+//   Leds::begin();                         // pinMode(OUTPUT), all low
+//   Leds::write(on);                       // all three, one store
+//   Leds::pattern(0b010);                  // middle one on: one store per direction
+//
+// Checked at compile time: every pin is an existing, output-capable GPIO
+// (not 6-11, wired to the flash, nor the input-only 34-39) and no pin is
+// listed twice; pinsDisjoint() checks groups against each other. Groups
+// within GPIO 0-31 take one store per update, pins 32 and 33 live in the
+// second output register and add a store there.
+//
+// Cost: a group update is a constant and a store, a few CPU cycles;
+// digitalWrite() goes through the pin table and the HAL once per pin. Build
+// HomeTask 2-Part B with -DFASTPIN_BENCH=1 to count both in cycles.
+
+#pragma once
+
+#include <Arduino.h>
+#include <soc/gpio_reg.h>
+
+// Always inlined, so the stores end up in the caller: an IRAM_ATTR ISR
+// stays in IRAM
+#define FASTPIN_INLINE static inline __attribute__((always_inline))
+
+namespace fastpin {
+
+constexpr bool outputCapable(uint8_t p) {
+  return p <= 33 && !(p >= 6 && p <= 11) && p != 20 && p != 24 && !(p >= 28 && p <= 31);
+}
+
+// Register bits of a pin list: lo = GPIO 0-31, hi = GPIO 32-33
+template <uint8_t... P>
+struct Bits;
+
+template <>
+struct Bits<> {
+  static constexpr uint32_t lo = 0;
+  static constexpr uint32_t hi = 0;
+  static constexpr bool valid = true;
+  static constexpr bool unique = true;
+};
+
+template <uint8_t P, uint8_t... R>
+struct Bits<P, R...> {
+  static constexpr uint32_t bit = 1u << (P & 31);
+  static constexpr uint32_t lo = (P < 32 ? bit : 0) | Bits<R...>::lo;
+  static constexpr uint32_t hi = (P < 32 ? 0 : bit) | Bits<R...>::hi;
+  static constexpr bool valid = outputCapable(P) && Bits<R...>::valid;
+  static constexpr bool unique = !((P < 32 ? Bits<R...>::lo : Bits<R...>::hi) & bit) && Bits<R...>::unique;
+};
+
+// Register bits for "bit i of `bits` set" over the pin list, unrolled at compile time
+template <bool High, uint8_t... P>
+struct Select;
+
+template <bool High>
+struct Select<High> {
+  FASTPIN_INLINE uint32_t mask(uint32_t) { return 0; }
+};
+
+template <bool High, uint8_t P, uint8_t... R>
+struct Select<High, P, R...> {
+  FASTPIN_INLINE uint32_t mask(uint32_t bits) {
+    return ((P >= 32) == High && (bits & 1) ? Bits<P>::bit : 0) | Select<High, R...>::mask(bits >> 1);
+  }
+};
+
+}  // namespace fastpin
+
+template <uint8_t... P>
+class PinGroup {
+  typedef fastpin::Bits<P...> B;
+  static_assert(sizeof...(P) > 0, "PinGroup needs at least one pin");
+  static_assert(B::valid, "PinGroup: not an output GPIO (6-11 are the flash, 34-39 are input only)");
+  static_assert(B::unique, "PinGroup: a pin is listed twice");
+
+public:
+  static constexpr uint8_t SIZE = sizeof...(P);
+  static constexpr uint32_t MASK = B::lo;     // GPIO_OUT bits
+  static constexpr uint32_t MASK1 = B::hi;    // GPIO_OUT1 bits (GPIO 32, 33)
+
+  // Outputs, all low
+  static void begin() {
+    clear();
+    const uint8_t pins[] = {P...};
+    for (uint8_t i = 0; i < SIZE; i++) pinMode(pins[i], OUTPUT);
+  }
+
+  FASTPIN_INLINE void set() {
+    if (MASK) REG_WRITE(GPIO_OUT_W1TS_REG, MASK);
+    if (MASK1) REG_WRITE(GPIO_OUT1_W1TS_REG, MASK1);
+  }
+  FASTPIN_INLINE void clear() {
+    if (MASK) REG_WRITE(GPIO_OUT_W1TC_REG, MASK);
+    if (MASK1) REG_WRITE(GPIO_OUT1_W1TC_REG, MASK1);
+  }
+  FASTPIN_INLINE void write(bool high) {
+    if (high) set();
+    else clear();
+  }
+
+  // Bit i drives the i-th pin of the list (first pin = bit 0). The pins
+  // going high are set by one store, those going low cleared by the next.
+  FASTPIN_INLINE void pattern(uint32_t bits) {
+    uint32_t on = fastpin::Select<false, P...>::mask(bits);
+    if (MASK) {
+      REG_WRITE(GPIO_OUT_W1TS_REG, on);
+      REG_WRITE(GPIO_OUT_W1TC_REG, MASK & ~on);
+    }
+    if (MASK1) {
+      uint32_t on1 = fastpin::Select<true, P...>::mask(bits);
+      REG_WRITE(GPIO_OUT1_W1TS_REG, on1);
+      REG_WRITE(GPIO_OUT1_W1TC_REG, MASK1 & ~on1);
+    }
+  }
+
+  // True if any pin of the group is latched high
+  FASTPIN_INLINE bool isSet() {
+    return (MASK && (REG_READ(GPIO_OUT_REG) & MASK)) || (MASK1 && (REG_READ(GPIO_OUT1_REG) & MASK1));
+  }
+  FASTPIN_INLINE void toggle() { write(!isSet()); }
+};
+
+template <uint8_t N>
+using Pin = PinGroup<N>;
+
+// True if no pin is in more than one of the groups
+template <typename A>
+constexpr bool pinsDisjoint() {
+  return true;
+}
+template <typename A, typename B, typename... R>
+constexpr bool pinsDisjoint() {
+  return !(A::MASK & B::MASK) && !(A::MASK1 & B::MASK1) && pinsDisjoint<A, R...>() && pinsDisjoint<B, R...>();
+}
@@ -0,0 +1,30 @@
+// FixedFormat: integer / fixed-point numbers to text without heap or floats
+//
+// Pure code (no Arduino headers). formatFixed(buf, 2350, 2) writes "23.50",
+// the same text Print::print(23.5f) produces, from the integer the sensor
+// code already keeps (0.01 units here). Negative values get a leading '-'.
+
+#pragma once
+
+#include <stdint.h>
+
+static const uint8_t FIXED_MAX_CHARS = 13;   // '-', 10 digits, '.', NUL
+
+// Writes value / 10^decimals with exactly `decimals` digits after the point
+// (decimals <= 9) and returns the length. `out` needs FIXED_MAX_CHARS bytes.
+inline uint8_t formatFixed(char *out, int32_t value, uint8_t decimals = 0) {
+  char rev[FIXED_MAX_CHARS];
+  uint8_t n = 0;
+  uint32_t mag = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+  if (decimals > 9) decimals = 9;
+  do {
+    if (n == decimals && decimals) rev[n++] = '.';
+    rev[n++] = (char)('0' + mag % 10);
+    mag /= 10;
+  } while (mag || n <= decimals);
+  uint8_t len = 0;
+  if (value < 0) out[len++] = '-';
+  while (n) out[len++] = rev[--n];
+  out[len] = '\0';
+  return len;
+}
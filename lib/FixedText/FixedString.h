@@ -0,0 +1,127 @@
+// FixedString: text built in a fixed-size buffer instead of on the heap
+//
+// Arduino `String` allocates on every concatenation and frees the
+// temporaries again, so a label redrawn a few times a second churns the
+// heap for as long as the device runs. FixedString<N> keeps up to N chars
+// inline (on the stack when it is a local) and truncates anything longer:
+//
+//   FixedString<24> s("Mode: ");
+//   s += label(MODE_LABELS, mode);          // "Mode: PWM Fade"
+//   s.appendFixed(tempTenths, 1);           // "23.5", via formatFixed()
+//   display.print(s.c_str());
+//
+//   printfTo(Serial, "%lu samples\n", n);   // Serial.printf() without the heap
+//
+// Labels live in `constexpr const char *const NAMES[]` tables; label()
+// bounds-checks the index and labelCount() lets a static_assert tie the
+// table to the enum it names.
+//
+// printf() / printfTo() format with vsnprintf into the fixed buffer. The
+// ESP32 core's Print::printf() does the same but mallocs a bigger buffer
+// when the text is over 63 chars; printfTo() truncates at PRINTF_CHARS
+// instead. Integer conversions don't allocate; newlib's %f does (dtoa), so
+// fixed-point values should go through appendFixed().
+//
+// Pure code (no Arduino headers): printfTo() takes anything with
+// write(const uint8_t *, size_t), and tools/text_bench builds it on the host.
+
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "FixedFormat.h"
+
+template <uint16_t N>
+class FixedString {
+public:
+  static const uint16_t CAPACITY = N;
+
+  FixedString() { _buf[0] = '\0'; }
+  explicit FixedString(const char *s) : FixedString() { append(s); }
+
+  const char *c_str() const { return _buf; }
+  uint16_t length() const { return _len; }
+  bool truncated() const { return _truncated; }   // something didn't fit
+  void clear() {
+    _len = 0;
+    _buf[0] = '\0';
+    _truncated = false;
+  }
+
+  FixedString &append(const char *s, size_t n) {
+    if (n > (size_t)(N - _len)) {
+      n = N - _len;
+      _truncated = true;
+    }
+    memcpy(_buf + _len, s, n);
+    _len += (uint16_t)n;
+    _buf[_len] = '\0';
+    return *this;
+  }
+  FixedString &append(const char *s) { return s ? append(s, strlen(s)) : *this; }
+  FixedString &append(char c) { return append(&c, 1); }
+  // value / 10^decimals, see formatFixed()
+  FixedString &appendFixed(int32_t value, uint8_t decimals = 0) {
+    char num[FIXED_MAX_CHARS];
+    return append(num, formatFixed(num, value, decimals));
+  }
+
+  FixedString &operator+=(const char *s) { return append(s); }
+
+  // Appends; returns the chars written
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+  }
+  size_t vprintf(const char *fmt, va_list ap) {
+    int n = vsnprintf(_buf + _len, N + 1 - _len, fmt, ap);
+    if (n < 0) {
+      _buf[_len] = '\0';
+      return 0;
+    }
+    if (n > N - _len) {
+      n = N - _len;
+      _truncated = true;
+    }
+    _len += (uint16_t)n;
+    return (size_t)n;
+  }
+
+private:
+  char _buf[N + 1];
+  uint16_t _len = 0;
+  bool _truncated = false;
+};
+
+// Longest printfTo() output; the buffer is on the caller's stack
+static const uint16_t PRINTF_CHARS = 127;
+
+template <typename Out>
+size_t printfTo(Out &out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+template <typename Out>
+size_t printfTo(Out &out, const char *fmt, ...) {
+  FixedString<PRINTF_CHARS> s;
+  va_list ap;
+  va_start(ap, fmt);
+  s.vprintf(fmt, ap);
+  va_end(ap);
+  return out.write((const uint8_t *)s.c_str(), s.length());
+}
+
+template <size_t N>
+constexpr size_t labelCount(const char *const (&)[N]) {
+  return N;
+}
+
+// table[i], or "?" when i is out of range
+template <size_t N>
+constexpr const char *label(const char *const (&table)[N], size_t i) {
+  return i < N ? table[i] : "?";
+}
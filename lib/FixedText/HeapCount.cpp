@@ -0,0 +1,71 @@
+#include "HeapCount.h"
+
+#if HEAPCOUNT
+
+#include <stdlib.h>
+#include <new>
+#include "FixedString.h"
+
+// Tasks on both cores allocate: the count is one atomic add
+static volatile uint32_t g_count = 0;
+static uint32_t g_mark = 0;
+static bool g_marked = false;
+
+static inline void counted() { __atomic_fetch_add(&g_count, 1, __ATOMIC_RELAXED); }
+
+extern "C" {
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t n);
+
+void *__wrap_malloc(size_t n) {
+  counted();
+  return __real_malloc(n);
+}
+void *__wrap_calloc(size_t n, size_t size) {
+  counted();
+  return __real_calloc(n, size);
+}
+void *__wrap_realloc(void *p, size_t n) {
+  if (n) counted();
+  return __real_realloc(p, n);
+}
+}
+
+// The C++ runtime may have its own path to the allocator (a shared
+// libstdc++ on the host does), so send operator new through malloc
+void *operator new(size_t n) {
+  void *p = malloc(n ? n : 1);
+  if (!p) abort();
+  return p;
+}
+void *operator new[](size_t n) { return operator new(n); }
+void *operator new(size_t n, const std::nothrow_t &) noexcept { return malloc(n ? n : 1); }
+void *operator new[](size_t n, const std::nothrow_t &) noexcept { return malloc(n ? n : 1); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+namespace HeapCount {
+
+uint32_t allocations() { return g_count; }
+
+void mark() {
+  g_mark = g_count;
+  g_marked = true;
+}
+
+uint32_t sinceMark() { return g_count - g_mark; }
+
+void report(Print &out) {
+  if (g_marked)
+    printfTo(out, "heap: %lu allocations since setup (%lu before)\n", (unsigned long)sinceMark(),
+             (unsigned long)g_mark);
+  else
+    printfTo(out, "heap: %lu allocations (HEAP_MARK() not reached)\n", (unsigned long)g_count);
+}
+
+}  // namespace HeapCount
+
+#endif
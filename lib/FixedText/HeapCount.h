@@ -0,0 +1,45 @@
+// HeapCount: counts heap allocations, to show none happen after setup()
+//
+// Debug builds only. Build with -DHEAPCOUNT=1 and have the linker route the
+// C allocator through the counter:
+//
+//   build_flags = -DHEAPCOUNT=1 -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+//
+// Otherwise every HEAP_* macro expands to nothing (HEAP_REPORT prints that
+// counting is off). Forgetting the -Wl flags gives undefined __real_malloc
+// at link time rather than a silent zero.
+//
+//   HEAP_MARK();            // end of setup(): later allocations are counted
+//   HEAP_REPORT(Serial);    // "heap: 0 allocations since setup (41 before)"
+//
+// Every malloc / calloc / realloc call counts (a realloc that only shrinks
+// too), and operator new is routed to malloc so C++ allocations count as
+// well. That covers Arduino String, which grows with realloc. The FreeRTOS
+// heap (task stacks, queues) is separate and not counted.
+
+#pragma once
+
+#ifndef HEAPCOUNT
+#define HEAPCOUNT 0
+#endif
+
+#if HEAPCOUNT
+
+#include <Arduino.h>
+
+namespace HeapCount {
+uint32_t allocations();   // since boot
+void mark();
+uint32_t sinceMark();
+void report(Print &out);
+}  // namespace HeapCount
+
+#define HEAP_MARK() HeapCount::mark()
+#define HEAP_REPORT(out) HeapCount::report(out)
+
+#else
+
+#define HEAP_MARK() ((void)0)
+#define HEAP_REPORT(out) (out).println("heap counting is off (build with -DHEAPCOUNT=1, see HeapCount.h)")
+
+#endif
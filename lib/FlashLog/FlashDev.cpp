@@ -0,0 +1,91 @@
+#include "FlashDev.h"
+
+#if defined(ESP32)
+
+bool PartitionFlash::begin() {
+  _part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, _label);
+  if (!_part) return false;
+  const void *p = nullptr;
+  if (esp_partition_mmap(_part, 0, _part->size, SPI_FLASH_MMAP_DATA, &p, &_handle) != ESP_OK) {
+    _part = nullptr;
+    return false;
+  }
+  _map = (const uint8_t *)p;
+  return true;
+}
+
+// The flash driver invalidates the cache over the written range, so the
+// mapped view shows new data right after these return
+bool PartitionFlash::erase(uint32_t offset, uint32_t len) {
+  return _part && esp_partition_erase_range(_part, offset, len) == ESP_OK;
+}
+
+bool PartitionFlash::write(uint32_t offset, const void *src, uint32_t len) {
+  return _part && esp_partition_write(_part, offset, src, len) == ESP_OK;
+}
+
+#endif
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+FileFlash::~FileFlash() { close(); }
+
+bool FileFlash::open(const char *path, uint32_t size) {
+  close();
+  if (size == 0 || size % SECTOR_BYTES) return false;
+  int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) return false;
+  struct stat st;
+  bool fresh = fstat(fd, &st) == 0 && st.st_size == 0;
+  if (ftruncate(fd, size) != 0) {
+    ::close(fd);
+    return false;
+  }
+  void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) return false;
+  _map = (uint8_t *)p;
+  _size = size;
+  if (fresh) memset(_map, 0xFF, size);
+  return true;
+}
+
+void FileFlash::close() {
+  if (_map) munmap(_map, _size);
+  _map = nullptr;
+  _size = 0;
+}
+
+// How much of an operation of `len` bytes gets done before the power goes
+uint32_t FileFlash::allowance(uint32_t len) {
+  if (!_cut) return len;
+  uint32_t n = len < _budget ? len : _budget;
+  _budget -= n;
+  return n;
+}
+
+bool FileFlash::erase(uint32_t offset, uint32_t len) {
+  if (!_map || offset % SECTOR_BYTES || len % SECTOR_BYTES || offset > _size || len > _size - offset)
+    return false;
+  uint32_t n = allowance(len);
+  memset(_map + offset, 0xFF, n);
+  _erased += n / SECTOR_BYTES;
+  return n == len;
+}
+
+bool FileFlash::write(uint32_t offset, const void *src, uint32_t len) {
+  if (!_map || offset > _size || len > _size - offset) return false;
+  uint32_t n = allowance(len);
+  const uint8_t *s = (const uint8_t *)src;
+  for (uint32_t i = 0; i < n; i++) _map[offset + i] &= s[i];
+  _written += n;
+  return n == len;
+}
+
+#endif
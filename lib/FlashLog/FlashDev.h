@@ -0,0 +1,94 @@
+// FlashDev: the storage under FlashLog, as NOR flash behaves
+//
+// erase() sets whole 4 KB sectors to 0xFF; write() can only clear bits, so
+// every byte is written at most once between erases. map() is a read-only
+// pointer to the whole region: reads never copy.
+//
+// PartitionFlash   an ESP32 data partition, memory-mapped through the flash
+//                  cache (esp_partition_mmap)
+// FileFlash        a file on Linux, mmap()ed, with the same NOR rules plus
+//                  an injectable power cut, for recovery and throughput
+//                  tests on the host
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class FlashDev {
+public:
+  static const uint32_t SECTOR_BYTES = 4096;   // erase unit
+  static const uint16_t PAGE_BYTES = 256;      // program unit
+
+  virtual ~FlashDev() {}
+
+  virtual uint32_t size() const = 0;
+  virtual const uint8_t *map() const = 0;
+  // Offsets and lengths in erase() are whole sectors
+  virtual bool erase(uint32_t offset, uint32_t len) = 0;
+  virtual bool write(uint32_t offset, const void *src, uint32_t len) = 0;
+};
+
+#if defined(ESP32)
+
+#include <esp_partition.h>
+
+class PartitionFlash : public FlashDev {
+public:
+  // Data partition by label, as named in the project's partitions CSV
+  explicit PartitionFlash(const char *label) : _label(label) {}
+
+  bool begin();
+
+  uint32_t size() const override { return _part ? _part->size : 0; }
+  const uint8_t *map() const override { return _map; }
+  bool erase(uint32_t offset, uint32_t len) override;
+  bool write(uint32_t offset, const void *src, uint32_t len) override;
+
+private:
+  const char *_label;
+  const esp_partition_t *_part = nullptr;
+  const uint8_t *_map = nullptr;
+  spi_flash_mmap_handle_t _handle = 0;
+};
+
+#endif
+
+#if defined(__linux__)
+
+class FileFlash : public FlashDev {
+public:
+  FileFlash() {}
+  ~FileFlash() override;
+
+  // Opens (or creates, erased) a file of `size` bytes, a multiple of 4 KB
+  bool open(const char *path, uint32_t size);
+  void close();
+
+  // Power cut: after `bytes` more bytes have been programmed or erased, the
+  // operation in progress stops halfway and every later one fails, until
+  // restorePower(). Reopening the file is the "reboot".
+  void cutPowerAfter(uint32_t bytes) { _budget = bytes; _cut = true; }
+  void restorePower() { _cut = false; }
+  bool powered() const { return !_cut || _budget > 0; }
+
+  uint32_t size() const override { return _size; }
+  const uint8_t *map() const override { return _map; }
+  bool erase(uint32_t offset, uint32_t len) override;
+  bool write(uint32_t offset, const void *src, uint32_t len) override;
+
+  uint32_t bytesWritten() const { return _written; }
+  uint32_t sectorsErased() const { return _erased; }
+
+private:
+  uint32_t allowance(uint32_t len);
+
+  uint8_t *_map = nullptr;
+  uint32_t _size = 0;
+  bool _cut = false;
+  uint32_t _budget = 0;
+  uint32_t _written = 0;
+  uint32_t _erased = 0;
+};
+
+#endif
@@ -0,0 +1,384 @@
+#include "FlashLog.h"
+#include <TelemetryCodec.h>
+#include <string.h>
+
+using TelemetryCodec::crc16;
+
+static const uint32_t OPEN_MAGIC = 0x474F4C46;   // "FLOG"
+static const uint32_t SEAL_MAGIC = 0x4C414553;   // "SEAL"
+static const uint8_t FORMAT_SERIES = 2;           // pages hold SeriesCodec blocks
+static const uint16_t BLOCK_BYTES = FlashLog::PAGE_BYTES - 4;
+
+FlashLog::FlashLog(FlashDev &dev, uint8_t channels)
+    : _dev(dev), _channels(channels > MAX_CHANNELS ? MAX_CHANNELS : channels), _enc(_channels) {
+  // Most samples a block can hold: the first in full, then one bit per field
+  _maxPerPage = (uint16_t)((BLOCK_BYTES * 8 - 32 - 16 * _channels) / (1 + _channels) + 1);
+  resetPage();
+}
+
+void FlashLog::resetPage() {
+  memset(_page, 0xFF, sizeof(PageHeader));
+  _enc.begin(_page + sizeof(PageHeader), BLOCK_BYTES);
+}
+
+const FlashLog::SegOpen *FlashLog::header(uint16_t slot) const {
+  const SegOpen *h = (const SegOpen *)segment(slot);
+  if (h->magic != OPEN_MAGIC || h->channels != _channels || h->format != FORMAT_SERIES) return nullptr;
+  if (crc16((const uint8_t *)h, offsetof(SegOpen, crc)) != h->crc) return nullptr;
+  return h;
+}
+
+const FlashLog::SegSeal *FlashLog::seal(uint16_t slot) const {
+  const SegSeal *s = (const SegSeal *)(segment(slot) + SEAL_OFFSET);
+  if (s->magic != SEAL_MAGIC) return nullptr;
+  if (crc16((const uint8_t *)s, offsetof(SegSeal, crc)) != s->crc) return nullptr;
+  return s;
+}
+
+uint16_t FlashLog::pageCrc(uint32_t seq, const uint8_t *block, uint16_t count) const {
+  uint8_t pre[6] = {(uint8_t)seq, (uint8_t)(seq >> 8), (uint8_t)(seq >> 16), (uint8_t)(seq >> 24),
+                    (uint8_t)count, (uint8_t)(count >> 8)};
+  return crc16(block, BLOCK_BYTES, crc16(pre, sizeof(pre)));
+}
+
+FlashLog::PageState FlashLog::page(uint16_t slot, uint8_t p, uint32_t seq) const {
+  const uint8_t *base = segment(slot) + (uint32_t)p * PAGE_BYTES;
+  const PageHeader *h = (const PageHeader *)base;
+  if (h->count == 0xFFFF && h->crc == 0xFFFF) {
+    // A write cut short after the header would leave the rest half done,
+    // so only a page that is 0xFF throughout can still be written
+    for (uint16_t i = sizeof(PageHeader); i < PAGE_BYTES; i++)
+      if (base[i] != 0xFF) return PAGE_TORN;
+    return PAGE_FREE;
+  }
+  if (h->count == 0 || h->count > _maxPerPage) return PAGE_TORN;
+  return pageCrc(seq, base + sizeof(PageHeader), h->count) == h->crc ? PAGE_OK : PAGE_TORN;
+}
+
+uint16_t FlashLog::pageRecords(uint16_t slot, uint8_t p, uint32_t seq, const SegSeal *sl) const {
+  const PageHeader *h = (const PageHeader *)(segment(slot) + (uint32_t)p * PAGE_BYTES);
+  if (sl) return p <= sl->pages && !(sl->badPages >> p & 1) ? h->count : 0;
+  return page(slot, p, seq) == PAGE_OK ? h->count : 0;
+}
+
+uint16_t FlashLog::nextValid(uint16_t slot) const {
+  for (uint16_t k = 1; k < _slots; k++) {
+    uint16_t s = (slot + k) % _slots;
+    if (header(s)) return s;
+  }
+  return slot;
+}
+
+bool FlashLog::begin(uint64_t uptimeMs) {
+  _slots = _dev.map() ? _dev.size() / SEGMENT_BYTES : 0;
+  if (_slots < 2) return false;
+
+  // Newest segment = highest sequence number; everything else follows from it
+  _head = -1;
+  _segments = 0;
+  for (uint16_t s = 0; s < _slots; s++) {
+    const SegOpen *h = header(s);
+    if (!h) continue;
+    _segments++;
+    if (h->wear > _maxWear) _maxWear = h->wear;
+    if (_head < 0 || h->seq > _seq) {
+      _head = s;
+      _seq = h->seq;
+    }
+  }
+  _records = 0;
+  _open = false;
+  if (_head < 0) {
+    _base = 0;
+    return true;
+  }
+
+  _oldest = nextValid((uint16_t)_head);
+  _oldestT = header(_oldest)->t0;
+
+  // Records in the sealed segments, then the head decoded page by page
+  for (uint16_t s = _oldest; s != (uint16_t)_head; s = nextValid(s)) {
+    const SegSeal *sl = seal(s);
+    if (sl) {
+      _records += sl->records;
+      continue;
+    }
+    for (uint8_t p = 1; p < PAGES; p++) _records += pageRecords(s, p, header(s)->seq, nullptr);
+  }
+
+  const SegOpen *h = header((uint16_t)_head);
+  _t0 = h->t0;
+  _newestT = _t0;
+  const SegSeal *sl = seal((uint16_t)_head);
+  if (sl) {
+    _records += sl->records;
+    _newestT = _t0 + sl->lastDt;
+  } else {
+    // Unsealed: rebuild its running statistics and find the first free page
+    memset(&_stats, 0, sizeof(_stats));
+    for (uint8_t c = 0; c < _channels; c++) {
+      _stats.ch[c].min = INT16_MAX;
+      _stats.ch[c].max = INT16_MIN;
+    }
+    uint8_t last = 0;
+    for (uint8_t p = 1; p < PAGES; p++) {
+      PageState st = page((uint16_t)_head, p, _seq);
+      if (st == PAGE_FREE) continue;
+      last = p;
+      if (st == PAGE_TORN) {
+        _torn++;
+        _stats.badPages |= 1 << p;
+        continue;
+      }
+      const uint8_t *base = segment((uint16_t)_head) + (uint32_t)p * PAGE_BYTES;
+      uint32_t n = 0;
+      decodeBlock(base + sizeof(PageHeader), ((const PageHeader *)base)->count, 0, 0, UINT64_MAX, addToSeal, this, n);
+      _stats.records += n;
+    }
+    _records += _stats.records;
+    if (_stats.records) _newestT = _t0 + _stats.lastDt;
+    _stats.pages = last;
+    _nextPage = last + 1;
+    _open = _nextPage < PAGES;
+  }
+
+  // Carry on from just after the newest record
+  uint64_t resume = _newestT + 1;
+  _base = resume > uptimeMs ? resume - uptimeMs : 0;
+  return true;
+}
+
+bool FlashLog::openSegment(uint64_t t) {
+  uint16_t slot = _head < 0 ? 0 : (uint16_t)((_head + 1) % _slots);
+
+  // Reusing the oldest segment: its records go
+  const SegOpen *old = header(slot);
+  uint32_t wear = old ? old->wear : 0;
+  if (old && _segments) {
+    const SegSeal *sl = seal(slot);
+    uint32_t n = 0;
+    if (sl) n = sl->records;
+    else
+      for (uint8_t p = 1; p < PAGES; p++) n += pageRecords(slot, p, old->seq, nullptr);
+    _records -= n < _records ? n : _records;
+    _segments--;
+    if (slot == _oldest) {
+      _oldest = nextValid(slot);
+      if (_oldest != slot) _oldestT = header(_oldest)->t0;
+    }
+  }
+
+  _erases++;
+  if (!_dev.erase((uint32_t)slot * SEGMENT_BYTES, SEGMENT_BYTES)) {
+    _errors++;
+    return false;
+  }
+
+  SegOpen h;
+  memset(&h, 0xFF, sizeof(h));
+  h.magic = OPEN_MAGIC;
+  h.seq = _head < 0 ? 1 : _seq + 1;
+  h.t0 = t;
+  h.wear = wear + 1;
+  h.channels = _channels;
+  h.format = FORMAT_SERIES;
+  h.crc = crc16((const uint8_t *)&h, offsetof(SegOpen, crc));
+  if (!_dev.write((uint32_t)slot * SEGMENT_BYTES, &h, sizeof(h))) {
+    _errors++;
+    return false;
+  }
+  if (h.wear > _maxWear) _maxWear = h.wear;
+
+  if (_head < 0 || _segments == 0) {
+    _oldest = slot;
+    _oldestT = t;
+  }
+  _head = slot;
+  _seq = h.seq;
+  _segments++;
+  _t0 = t;
+  _nextPage = 1;
+  _open = true;
+  memset(&_stats, 0, sizeof(_stats));
+  for (uint8_t c = 0; c < _channels; c++) {
+    _stats.ch[c].min = INT16_MAX;
+    _stats.ch[c].max = INT16_MIN;
+  }
+  return true;
+}
+
+bool FlashLog::writePage() {
+  PageHeader *ph = (PageHeader *)_page;
+  ph->count = _enc.count();
+  ph->crc = pageCrc(_seq, _page + sizeof(PageHeader), ph->count);
+  bool ok = _dev.write((uint32_t)_head * SEGMENT_BYTES + (uint32_t)_nextPage * PAGE_BYTES, _page, PAGE_BYTES);
+  if (!ok) {
+    _errors++;
+    _stats.badPages |= 1 << _nextPage;
+  }
+  _pagesWritten++;
+  _stats.pages = _nextPage;
+  _nextPage++;
+  resetPage();
+  if (_nextPage >= PAGES) return sealSegment() && ok;
+  return ok;
+}
+
+bool FlashLog::sealSegment() {
+  _open = false;
+  _stats.magic = SEAL_MAGIC;
+  _stats.crc = crc16((const uint8_t *)&_stats, offsetof(SegSeal, crc));
+  if (_dev.write((uint32_t)_head * SEGMENT_BYTES + SEAL_OFFSET, &_stats, sizeof(_stats))) return true;
+  _errors++;
+  return false;
+}
+
+bool FlashLog::append(uint64_t t, const int16_t *v) {
+  if (!_slots) return false;
+  if (_records && t < _newestT) {
+    _late++;
+    return false;
+  }
+  // Past what a u32 offset can hold: start a new segment
+  if (_open && t - _t0 > UINT32_MAX) {
+    if (_enc.count() && !writePage()) return false;
+    if (_open && !sealSegment()) return false;
+  }
+  if (!_open && !openSegment(t)) return false;
+
+  // Page full: write it out (which may seal the segment) and start the next
+  bool ok = true;
+  if (!_enc.add((uint32_t)(t - _t0), v)) {
+    ok = writePage();
+    if (!_open && !openSegment(t)) return false;
+    _enc.add((uint32_t)(t - _t0), v);   // always fits an empty block
+  }
+  addToSeal(this, t - _t0, v);
+  _stats.records++;
+  if (!_records) _oldestT = t;
+  _records++;
+  _newestT = t;
+  return ok;
+}
+
+bool FlashLog::flush() {
+  return _enc.count() ? writePage() : true;
+}
+
+void FlashLog::addToSeal(void *ctx, uint64_t dt, const int16_t *v) {
+  FlashLog *log = static_cast<FlashLog *>(ctx);
+  for (uint8_t c = 0; c < log->_channels; c++) {
+    ChanStats &cs = log->_stats.ch[c];
+    if (v[c] < cs.min) cs.min = v[c];
+    if (v[c] > cs.max) cs.max = v[c];
+    cs.sum += v[c];
+  }
+  log->_stats.lastDt = (uint32_t)dt;
+}
+
+bool FlashLog::decodeBlock(const uint8_t *block, uint16_t count, uint64_t t0, uint64_t from, uint64_t to,
+                           RecordFn fn, void *ctx, uint32_t &n) const {
+  SeriesCodec::Decoder dec(_channels);
+  dec.begin(block, BLOCK_BYTES, count);
+  uint32_t dt;
+  int16_t v[MAX_CHANNELS];
+  while (dec.next(dt, v)) {
+    uint64_t t = t0 + dt;
+    if (t > to) return false;
+    if (t < from) continue;
+    fn(ctx, t, v);
+    n++;
+  }
+  return true;
+}
+
+bool FlashLog::decode(uint16_t slot, uint64_t from, uint64_t to, RecordFn fn, void *ctx, uint32_t &n) const {
+  const SegOpen *h = header(slot);
+  const SegSeal *sl = seal(slot);
+  bool head = (int32_t)slot == _head;
+  uint8_t pages = head && _open ? _nextPage : PAGES;
+  for (uint8_t p = 1; p < pages; p++) {
+    uint16_t count = pageRecords(slot, p, h->seq, sl);
+    if (!count) continue;
+    const uint8_t *base = segment(slot) + (uint32_t)p * PAGE_BYTES;
+    if (!decodeBlock(base + sizeof(PageHeader), count, h->t0, from, to, fn, ctx, n)) return false;
+  }
+  if (!head || !_open) return true;
+  // Still in RAM
+  return decodeBlock(_page + sizeof(PageHeader), _enc.count(), _t0, from, to, fn, ctx, n);
+}
+
+uint16_t FlashLog::seek(uint64_t t, uint16_t &before) const {
+  // Segments from the oldest to the head are in time order: binary search
+  uint16_t span = (uint16_t)((_head - _oldest + _slots) % _slots) + 1;
+  uint16_t lo = 0, hi = span - 1;
+  while (lo < hi) {
+    uint16_t mid = (uint16_t)((lo + hi + 1) / 2);
+    const SegOpen *h = header((_oldest + mid) % _slots);
+    if (h && h->t0 <= t) lo = mid;
+    else hi = mid - 1;
+  }
+  before = lo;
+  return (_oldest + lo) % _slots;
+}
+
+uint32_t FlashLog::query(uint64_t from, uint64_t to, RecordFn fn, void *ctx) const {
+  uint32_t n = 0;
+  _skipped = 0;
+  if (_head < 0 || to < from) return 0;
+  for (uint16_t s = seek(from, _skipped);; s = nextValid(s)) {
+    const SegOpen *h = header(s);
+    const SegSeal *sl = seal(s);
+    if (h->t0 > to) break;
+    if (sl && h->t0 + sl->lastDt < from) {
+      _skipped++;
+    } else if (!decode(s, from, to, fn, ctx, n)) {
+      break;
+    }
+    if (s == (uint16_t)_head) break;
+  }
+  return n;
+}
+
+namespace {
+struct ChannelRollup {
+  Rollup r;
+  uint8_t ch;
+};
+}
+
+static void addToRollup(void *ctx, uint64_t, const int16_t *v) {
+  ChannelRollup *c = static_cast<ChannelRollup *>(ctx);
+  int16_t x;
+  memcpy(&x, v + c->ch, 2);
+  c->r.add(x);
+}
+
+Rollup FlashLog::summary(uint64_t from, uint64_t to, uint8_t ch) const {
+  ChannelRollup acc;
+  acc.ch = ch;
+  _skipped = 0;
+  if (_head < 0 || to < from || ch >= _channels) return acc.r;
+  uint32_t n = 0;
+  for (uint16_t s = seek(from, _skipped);; s = nextValid(s)) {
+    const SegOpen *h = header(s);
+    const SegSeal *sl = seal(s);
+    if (h->t0 > to) break;
+    if (sl && (h->t0 + sl->lastDt < from || (h->t0 >= from && h->t0 + sl->lastDt <= to))) {
+      // Outside the range, or wholly inside: the header says all there is
+      if (h->t0 >= from && sl->records) {
+        Rollup seg;
+        seg.min = sl->ch[ch].min;
+        seg.max = sl->ch[ch].max;
+        seg.sum = sl->ch[ch].sum;
+        seg.count = sl->records;
+        acc.r.merge(seg);
+      }
+      _skipped++;
+    } else if (!decode(s, from, to, addToRollup, &acc, n)) {
+      break;
+    }
+    if (s == (uint16_t)_head) break;
+  }
+  return acc.r;
+}
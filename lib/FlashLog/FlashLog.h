@@ -0,0 +1,180 @@
+// FlashLog: append-only sample log on NOR flash, readable in place
+//
+// The flash region is a ring of 4 KB segments (one erase sector each):
+//
+//   page 0       segment header: SegOpen, written when the segment starts
+//                (sequence number, first timestamp, erase count), and
+//                SegSeal, written when it is full (record count, last
+//                timestamp, min / max / sum per channel)
+//   pages 1-15   data pages: count + CRC16, then one SeriesCodec block
+//                (timestamps as ms since the segment's first one)
+//
+// Samples collect in a one-page RAM buffer and go to flash a whole page at a
+// time, so every page is programmed once with one write. When the ring is
+// full the oldest segment is erased and reused, which spreads erases evenly
+// over the partition (each header carries its sector's erase count).
+//
+// A page is compressed as it fills: timestamps are delta-of-delta coded and
+// values delta coded, so a sample that changes slowly at a steady rate takes
+// a few bits instead of 4 + 2 per channel bytes. The encoder stops at the
+// first sample that doesn't fit and the page goes to flash as it is.
+//
+// Queries decode pages straight out of the memory-mapped flash, nothing is
+// copied first. A sealed segment outside the asked-for time range is skipped by
+// its header alone, and summary() merges the header statistics of segments
+// that lie entirely inside the range without touching their pages.
+//
+// Power loss: a page whose CRC doesn't match was torn and is skipped; a
+// segment without a valid SegSeal is decoded page by page. Sealed segments
+// list their bad pages in the seal, so reading them needs no CRC at all.
+// begin() finds the newest segment and appends after its last written page.
+// At most the RAM page is lost (how many samples that is depends on how well
+// they compress), nothing if flush() is called first.
+//
+// Timestamps are "log time": milliseconds of logged uptime, continuing from
+// the newest record after a reset (there is no RTC). logTime() converts.
+//
+// Pure code on top of FlashDev, so it runs unchanged on the host with a
+// FileFlash.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FlashDev.h"
+#include <Rollup.h>
+#include <SeriesCodec.h>
+
+class FlashLog {
+public:
+  static const uint8_t MAX_CHANNELS = 4;
+  static const uint32_t SEGMENT_BYTES = FlashDev::SECTOR_BYTES;
+  static const uint16_t PAGE_BYTES = FlashDev::PAGE_BYTES;
+  static const uint8_t PAGES = SEGMENT_BYTES / PAGE_BYTES;   // header page + 15 data pages
+
+  typedef void (*RecordFn)(void *ctx, uint64_t t, const int16_t *v);
+
+  FlashLog(FlashDev &dev, uint8_t channels);
+
+  // Scans the segment headers and recovers the write position. `uptimeMs`
+  // is the clock logTime() will be given (millis64()).
+  bool begin(uint64_t uptimeMs);
+  uint64_t logTime(uint64_t uptimeMs) const { return _base + uptimeMs; }
+
+  // Timestamps must not go backwards (older ones are rejected, see late())
+  bool append(uint64_t t, const int16_t *v);
+  // Writes the partly filled page now; the rest of that page stays unused
+  bool flush();
+
+  // Calls fn for every record with from <= t <= to, oldest first, including
+  // those still in the RAM page. `v` is only valid during the call.
+  uint32_t query(uint64_t from, uint64_t to, RecordFn fn, void *ctx) const;
+  template <typename F>
+  uint32_t forEach(uint64_t from, uint64_t to, F fn) const {
+    return query(from, to, [](void *c, uint64_t t, const int16_t *v) { (*static_cast<F *>(c))(t, v); }, &fn);
+  }
+  // One channel over [from, to]
+  Rollup summary(uint64_t from, uint64_t to, uint8_t ch) const;
+
+  bool empty() const { return _records == 0; }
+  uint64_t oldest() const { return _oldestT; }
+  uint64_t newest() const { return _newestT; }
+  uint32_t records() const { return _records; }
+  uint16_t segments() const { return _segments; }
+  uint16_t capacity() const { return _slots; }      // segments in the ring
+
+  uint32_t pagesWritten() const { return _pagesWritten; }
+  uint32_t erases() const { return _erases; }
+  uint32_t maxWear() const { return _maxWear; }     // highest sector erase count
+  uint32_t tornPages() const { return _torn; }      // found by begin()
+  uint32_t late() const { return _late; }
+  uint32_t errors() const { return _errors; }       // failed flash writes / erases
+  // Segments the last query() / summary() skipped or summarised by header only
+  uint16_t lastSkipped() const { return _skipped; }
+
+private:
+  struct SegOpen {
+    uint32_t magic;
+    uint32_t seq;
+    uint64_t t0;
+    uint32_t wear;
+    uint8_t channels;
+    uint8_t format;
+    uint16_t crc;
+  };
+  struct ChanStats {
+    int16_t min;
+    int16_t max;
+    int32_t sum;           // one segment only: 65535 records * INT16_MAX still fits
+  };
+  struct SegSeal {
+    uint32_t magic;
+    uint16_t records;
+    uint16_t pages;        // data pages used, torn ones included
+    uint32_t lastDt;       // ms from t0 to the last record
+    ChanStats ch[MAX_CHANNELS];
+    uint16_t badPages;     // bit p: data page p was torn or failed to write
+    uint16_t crc;          // last, so a seal cut short anywhere fails it
+  };
+  struct PageHeader {
+    uint16_t count;
+    uint16_t crc;
+  };
+  static const uint16_t SEAL_OFFSET = 32;
+
+  enum PageState : uint8_t { PAGE_FREE, PAGE_OK, PAGE_TORN };
+
+  const uint8_t *segment(uint16_t slot) const { return _dev.map() + (uint32_t)slot * SEGMENT_BYTES; }
+  const SegOpen *header(uint16_t slot) const;
+  const SegSeal *seal(uint16_t slot) const;
+  PageState page(uint16_t slot, uint8_t p, uint32_t seq) const;
+  // Records on data page p (0 = skip it), trusting the seal when there is one
+  uint16_t pageRecords(uint16_t slot, uint8_t p, uint32_t seq, const SegSeal *sl) const;
+  // Newest segment whose first record is <= t (the oldest if none)
+  uint16_t seek(uint64_t t, uint16_t &before) const;
+  uint16_t pageCrc(uint32_t seq, const uint8_t *block, uint16_t count) const;
+  uint16_t nextValid(uint16_t slot) const;   // next valid slot after `slot`, towards the head
+
+  // Decodes one segment's records in [from, to] (and the RAM page for the
+  // open one); returns false once a record past `to` is seen
+  bool decode(uint16_t slot, uint64_t from, uint64_t to, RecordFn fn, void *ctx, uint32_t &n) const;
+  bool decodeBlock(const uint8_t *block, uint16_t count, uint64_t t0, uint64_t from, uint64_t to, RecordFn fn,
+                   void *ctx, uint32_t &n) const;
+  // Adds one sample (dt from the segment start) to the head's running SegSeal
+  static void addToSeal(void *ctx, uint64_t dt, const int16_t *v);
+
+  bool openSegment(uint64_t t);
+  bool writePage();
+  bool sealSegment();
+  void resetPage();
+
+  FlashDev &_dev;
+  uint8_t _channels;
+  uint16_t _maxPerPage;
+  uint16_t _slots = 0;
+
+  int32_t _head = -1;          // newest segment, -1 while the log is empty
+  uint16_t _oldest = 0;
+  uint32_t _seq = 0;           // of the head segment
+  uint16_t _segments = 0;
+  bool _open = false;          // head accepts more pages
+  uint64_t _t0 = 0;            // of the head segment
+  uint8_t _nextPage = 1;
+  SegSeal _stats;              // head segment so far
+
+  uint8_t _page[PAGE_BYTES];
+  SeriesCodec::Encoder _enc;
+
+  uint32_t _records = 0;
+  uint64_t _oldestT = 0;
+  uint64_t _newestT = 0;
+  uint64_t _base = 0;
+
+  uint32_t _pagesWritten = 0;
+  uint32_t _erases = 0;
+  uint32_t _maxWear = 0;
+  uint32_t _torn = 0;
+  uint32_t _late = 0;
+  uint32_t _errors = 0;
+  mutable uint16_t _skipped = 0;
+};
@@ -0,0 +1,53 @@
+#include "InputTrace.h"
+#include <FixedString.h>
+
+InputRecorder *InputRecorder::_instance = nullptr;
+
+bool InputRecorder::add(uint8_t pin) {
+  if (_pinCount == MAX_PINS) return false;
+  _pins[_pinCount++] = pin;
+  return true;
+}
+
+bool InputRecorder::begin() {
+  if (_instance) return false;
+  _instance = this;
+  static void (*const isrs[MAX_PINS])() = {&onEdge<0>, &onEdge<1>, &onEdge<2>, &onEdge<3>};
+  for (uint8_t i = 0; i < _pinCount; i++) {
+    pinMode(_pins[i], INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(_pins[i]), isrs[i], CHANGE);
+  }
+  return true;
+}
+
+void InputRecorder::clear() {
+  portENTER_CRITICAL(&_lock);
+  _count = 0;
+  _dropped = 0;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void IRAM_ATTR InputRecorder::record(uint8_t pin) {
+  uint32_t now = micros();
+  uint8_t level = digitalRead(pin);
+  portENTER_CRITICAL_ISR(&_lock);
+  if (_count < LEN) _edges[_count++] = {now, pin, level};
+  else _dropped++;
+  portEXIT_CRITICAL_ISR(&_lock);
+}
+
+void InputRecorder::dump(Print &out) {
+  // Edges already stored never change, so only the count needs the lock
+  portENTER_CRITICAL(&_lock);
+  uint16_t n = _count;
+  uint32_t dropped = _dropped;
+  portEXIT_CRITICAL(&_lock);
+
+  for (uint16_t i = 0; i < n; i++) {
+    const Edge &e = _edges[i];
+    unsigned long ms = e.us / 1000, frac = e.us % 1000;
+    if (e.level) printfTo(out, "%lu.%03lu release %u\n", ms, frac, e.pin);
+    else printfTo(out, "%lu.%03lu pin %u 0\n", ms, frac, e.pin);
+  }
+  printfTo(out, "# InputRecorder: %u edges, %lu dropped\n", n, (unsigned long)dropped);
+}
@@ -0,0 +1,54 @@
+// InputTrace: record button edges as a replayable simulator script
+//
+// Each added pin gets a CHANGE interrupt that stores micros() and the new
+// level in a fixed ring. dump() prints the edges in the sim's input script
+// format ("<ms> pin N 0" / "<ms> release N", times from reset, us
+// resolution), so a bounce seen on the bench can be run again under
+// sim/ArduinoSim with expect lines added (see sim/README, "Replay").
+//
+// Recording stops when the ring is full (the start of a session is what a
+// replay needs); the rest is counted in dropped(). Buttons are active low
+// with the internal pull-up. Only one recorder: the ISRs have no argument.
+
+#pragma once
+
+#include <Arduino.h>
+
+class InputRecorder {
+public:
+  static const uint8_t MAX_PINS = 4;
+  static const uint16_t LEN = 512;
+
+  // Configure before begin(). Returns false when all slots are taken.
+  bool add(uint8_t pin);
+  bool begin();
+
+  void clear();
+  // Script lines for every edge so far, then a summary comment
+  void dump(Print &out);
+
+  uint16_t count() const { return _count; }
+  uint32_t dropped() const { return _dropped; }
+
+private:
+  struct Edge {
+    uint32_t us;
+    uint8_t pin;
+    uint8_t level;
+  };
+
+  template <uint8_t SLOT>
+  static void IRAM_ATTR onEdge() { _instance->record(_instance->_pins[SLOT]); }
+  void IRAM_ATTR record(uint8_t pin);
+
+  static InputRecorder *_instance;
+
+  uint8_t _pins[MAX_PINS];
+  uint8_t _pinCount = 0;
+
+  // Written by the ISRs, read by dump()
+  Edge _edges[LEN];
+  volatile uint16_t _count = 0;
+  volatile uint32_t _dropped = 0;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+};
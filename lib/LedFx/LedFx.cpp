@@ -0,0 +1,101 @@
+#include "LedFx.h"
+
+static const ledc_mode_t MODE = LEDC_LOW_SPEED_MODE;
+
+LedFx::LedFx(ledc_timer_t timer, ledc_channel_t firstChannel, uint32_t freqHz)
+    : _ledcTimer(timer), _firstChannel(firstChannel), _freq(freqHz) {}
+
+bool LedFx::add(uint8_t pin) {
+  if (_count >= LEDFX_MAX_LEDS || _firstChannel + _count >= LEDC_CHANNEL_MAX) return false;
+  _pins[_count++] = pin;
+  return true;
+}
+
+bool LedFx::begin() {
+  ledc_timer_config_t tc = {};
+  tc.speed_mode = MODE;
+  tc.duty_resolution = (ledc_timer_bit_t)LEDFX_BITS;
+  tc.timer_num = _ledcTimer;
+  tc.freq_hz = _freq;
+  tc.clk_cfg = LEDC_USE_APB_CLK;
+  if (ledc_timer_config(&tc) != ESP_OK) return false;
+
+  for (uint8_t i = 0; i < _count; i++) {
+    ledc_channel_config_t cc = {};
+    cc.gpio_num = _pins[i];
+    cc.speed_mode = MODE;
+    cc.channel = (ledc_channel_t)(_firstChannel + i);
+    cc.timer_sel = _ledcTimer;
+    cc.duty = 0;
+    if (ledc_channel_config(&cc) != ESP_OK) return false;
+  }
+
+  // Fade-end interrupt; already installed is fine
+  ledc_fade_func_install(0);
+
+  esp_timer_create_args_t args = {};
+  args.callback = &LedFx::onTimer;
+  args.arg = this;
+  args.name = "ledfx";
+  return esp_timer_create(&args, &_timer) == ESP_OK;
+}
+
+void LedFx::play(const Effect &fx) {
+  portENTER_CRITICAL(&_lock);
+  _pending = &fx;
+  bool idle = !_busy;
+  _busy = true;
+  portEXIT_CRITICAL(&_lock);
+  // Otherwise the running segment's timer picks it up
+  if (idle) esp_timer_start_once(_timer, 0);
+}
+
+void LedFx::set(uint8_t level, uint16_t rampMs) {
+  portENTER_CRITICAL(&_lock);
+  _still.rampMs = rampMs;
+  for (uint8_t i = 0; i < LEDFX_MAX_LEDS; i++) _still.level[i] = level;
+  portEXIT_CRITICAL(&_lock);
+  play(_stillFx);
+}
+
+// esp_timer task: the current segment is over
+void LedFx::onTimer(void *arg) {
+  static_cast<LedFx *>(arg)->step();
+}
+
+void LedFx::step() {
+  for (;;) {
+    DutySegment s;
+    portENTER_CRITICAL(&_lock);
+    if (_pending) {
+      _expander.start(*_pending);
+      _pending = nullptr;
+    }
+    bool more = _expander.next(s);
+    if (!more) _busy = false;
+    portEXIT_CRITICAL(&_lock);
+    if (!more) return;
+
+    apply(s);
+    _segments++;
+    if (s.ms) {
+      esp_timer_start_once(_timer, (uint64_t)s.ms * 1000);
+      return;
+    }
+    // Instant change with no hold: go straight on to the next keyframe
+  }
+}
+
+void LedFx::apply(const DutySegment &s) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (s.duty[i] == _duty[i]) continue;
+    ledc_channel_t ch = (ledc_channel_t)(_firstChannel + i);
+    if (s.ramp) {
+      ledc_set_fade_with_time(MODE, ch, s.duty[i], s.ms);
+      ledc_fade_start(MODE, ch, LEDC_FADE_NO_WAIT);
+    } else {
+      ledc_set_duty_and_update(MODE, ch, s.duty[i], 0);
+    }
+    _duty[i] = s.duty[i];
+  }
+}
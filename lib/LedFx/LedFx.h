@@ -0,0 +1,63 @@
+// LedFx: LED effects faded by the LEDC hardware
+//
+// Up to LEDFX_MAX_LEDS LEDs on the low-speed LEDC group at 13-bit
+// resolution. play() takes an Effect (see LedKeyframes.h); an esp_timer
+// wakes up only at segment boundaries to start the next hardware fade on
+// every LED, so nothing runs in loop() and the CPU is idle while the
+// brightness changes. Long holds wake it every LEDFX_SEGMENT_MS without
+// touching the LEDC (apply() skips unchanged duties).
+//
+// A new effect takes over when the running segment ends (at most
+// LEDFX_SEGMENT_MS later) and ramps from the current brightness, so
+// switching effects never jumps.
+//
+// Uses the low-speed LEDC channels/timer given to the constructor; they
+// must not be used through ledcSetup()/ledcWrite() (Arduino channels 8-15).
+
+#pragma once
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include <esp_timer.h>
+#include "LedKeyframes.h"
+
+class LedFx {
+public:
+  explicit LedFx(ledc_timer_t timer = LEDC_TIMER_0, ledc_channel_t firstChannel = LEDC_CHANNEL_0,
+                 uint32_t freqHz = 5000);
+
+  // LED index = order of add(). Configure before begin().
+  bool add(uint8_t pin);
+  bool begin();
+
+  // `fx` (and its keyframes) must stay valid while it plays
+  void play(const Effect &fx);
+  // All LEDs to one brightness (through the same path as play())
+  void set(uint8_t level, uint16_t rampMs = 0);
+
+  bool busy() const { return _busy; }      // an effect is still running
+  uint32_t segments() const { return _segments; }
+
+private:
+  static void onTimer(void *arg);
+  void step();
+  void apply(const DutySegment &s);
+
+  ledc_timer_t _ledcTimer;
+  ledc_channel_t _firstChannel;
+  uint32_t _freq;
+  uint8_t _pins[LEDFX_MAX_LEDS];
+  uint8_t _count = 0;
+  esp_timer_handle_t _timer = nullptr;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  KeyframeExpander _expander;
+  const Effect *_pending = nullptr;
+  volatile bool _busy = false;
+  uint16_t _duty[LEDFX_MAX_LEDS] = {};
+  uint32_t _segments = 0;
+
+  // Backing store for set()
+  Keyframe _still = {0, 0, {0}};
+  Effect _stillFx = {&_still, 1, false};
+};
@@ -0,0 +1,172 @@
+// LedKeyframes: LED effects as keyframes, expanded to PWM duty segments
+//
+// Pure code (no Arduino / IDF headers) so an effect can be expanded and
+// checked on the host.
+//
+// An effect is a `constexpr Keyframe[]`: for every LED a perceived
+// brightness (0-255) to reach in `rampMs`, then keep for `holdMs`. The
+// expander turns that into DutySegments (13-bit duties through the gamma
+// table), which LedFx hands to the LEDC fade hardware one at a time.
+//
+// The hardware fades duty linearly, so a ramp is split into segments of at
+// most LEDFX_SEGMENT_MS with gamma-corrected end points: the brightness
+// follows the gamma curve piecewise-linearly. Holds are split the same way,
+// so no segment is ever longer than LEDFX_SEGMENT_MS.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t LEDFX_BITS = 13;
+static const uint16_t LEDFX_MAX_DUTY = (1u << LEDFX_BITS) - 1;
+static const uint8_t LEDFX_MAX_LEDS = 4;
+// Longest segment (hardware fade or hold). Also how long a new effect may
+// wait for the running segment to end.
+static const uint16_t LEDFX_SEGMENT_MS = 64;
+
+// round(8191 * (i / 255)^2.2)
+static constexpr uint16_t LEDFX_GAMMA[256] = {
+     0,    0,    0,    0,    1,    1,    2,    3,    4,    5,    7,    8,
+    10,   12,   14,   16,   19,   21,   24,   27,   30,   34,   37,   41,
+    45,   49,   54,   59,   63,   69,   74,   79,   85,   91,   97,  104,
+   110,  117,  124,  132,  139,  147,  155,  163,  172,  180,  189,  198,
+   208,  217,  227,  237,  248,  258,  269,  280,  292,  303,  315,  327,
+   340,  352,  365,  378,  391,  405,  419,  433,  447,  462,  477,  492,
+   507,  523,  539,  555,  571,  588,  605,  622,  639,  657,  675,  693,
+   712,  731,  750,  769,  789,  808,  828,  849,  870,  890,  912,  933,
+   955,  977,  999, 1022, 1045, 1068, 1091, 1115, 1139, 1163, 1187, 1212,
+  1237, 1263, 1288, 1314, 1340, 1367, 1394, 1421, 1448, 1476, 1503, 1532,
+  1560, 1589, 1618, 1647, 1677, 1707, 1737, 1767, 1798, 1829, 1860, 1892,
+  1924, 1956, 1989, 2022, 2055, 2088, 2122, 2156, 2190, 2224, 2259, 2294,
+  2330, 2366, 2402, 2438, 2475, 2512, 2549, 2586, 2624, 2662, 2701, 2740,
+  2779, 2818, 2858, 2897, 2938, 2978, 3019, 3060, 3102, 3143, 3186, 3228,
+  3271, 3314, 3357, 3400, 3444, 3489, 3533, 3578, 3623, 3669, 3714, 3760,
+  3807, 3853, 3900, 3948, 3995, 4043, 4091, 4140, 4189, 4238, 4288, 4337,
+  4387, 4438, 4489, 4540, 4591, 4643, 4695, 4747, 4800, 4853, 4906, 4960,
+  5013, 5068, 5122, 5177, 5232, 5288, 5344, 5400, 5456, 5513, 5570, 5627,
+  5685, 5743, 5802, 5860, 5919, 5979, 6038, 6098, 6159, 6219, 6280, 6342,
+  6403, 6465, 6528, 6590, 6653, 6716, 6780, 6844, 6908, 6973, 7037, 7103,
+  7168, 7234, 7300, 7367, 7434, 7501, 7568, 7636, 7704, 7773, 7842, 7911,
+  7980, 8050, 8120, 8191,
+};
+static_assert(LEDFX_GAMMA[255] == LEDFX_MAX_DUTY, "gamma table must end at full duty");
+
+constexpr uint16_t ledGamma(uint8_t level) { return LEDFX_GAMMA[level]; }
+
+struct Keyframe {
+  uint16_t rampMs;                 // time to get here from the previous keyframe
+  uint16_t holdMs;                 // then stay for this long
+  uint8_t level[LEDFX_MAX_LEDS];   // perceived brightness per LED
+};
+
+struct Effect {
+  const Keyframe *frames;
+  uint8_t count;
+  bool loop;                       // after the last keyframe start over
+};
+
+template <size_t N>
+constexpr Effect makeEffect(const Keyframe (&frames)[N], bool loop) {
+  static_assert(N > 0 && N < 256, "an effect needs 1-255 keyframes");
+  return Effect{frames, (uint8_t)N, loop};
+}
+
+// What the hardware does next: for every LED go to `duty`, linearly over
+// `ms` (ramp) or at once and then wait `ms` (!ramp).
+struct DutySegment {
+  uint16_t duty[LEDFX_MAX_LEDS];
+  uint16_t ms;
+  bool ramp;
+};
+
+class KeyframeExpander {
+public:
+  // Start `fx` from the current levels (the first ramp begins where the
+  // previous effect left off).
+  void start(const Effect &fx) {
+    _fx = fx;
+    _frame = 0;
+    _sub = 0;
+    _inHold = false;
+    _holdLeft = 0;
+    _done = fx.count == 0;
+
+    // A looping effect with no time in it would never yield
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < fx.count; i++) total += fx.frames[i].rampMs + fx.frames[i].holdMs;
+    if (total == 0) _fx.loop = false;
+  }
+
+  bool done() const { return _done; }
+  uint8_t level(uint8_t led) const { return _cur[led]; }
+
+  // Next segment; false once a non-looping effect has finished
+  bool next(DutySegment &s) {
+    if (_done) return false;
+    const Keyframe &k = _fx.frames[_frame];
+
+    if (_inHold) {
+      nextHold(s);
+      return true;
+    }
+
+    if (k.rampMs == 0) {
+      for (uint8_t i = 0; i < LEDFX_MAX_LEDS; i++) _cur[i] = k.level[i];
+      _holdLeft = k.holdMs;
+      nextHold(s);
+      return true;
+    }
+
+    if (_sub == 0) {
+      for (uint8_t i = 0; i < LEDFX_MAX_LEDS; i++) _from[i] = _cur[i];
+      _subs = (k.rampMs + LEDFX_SEGMENT_MS - 1) / LEDFX_SEGMENT_MS;
+    }
+    _sub++;
+    for (uint8_t i = 0; i < LEDFX_MAX_LEDS; i++) {
+      int16_t d = (int16_t)k.level[i] - _from[i];
+      _cur[i] = (uint8_t)(_from[i] + d * _sub / _subs);
+    }
+    setDuty(s, _cur);
+    // Exact split of rampMs, no rounding drift across the segments
+    s.ms = (uint16_t)((uint32_t)k.rampMs * _sub / _subs - (uint32_t)k.rampMs * (_sub - 1) / _subs);
+    s.ramp = true;
+    if (_sub == _subs) {
+      _sub = 0;
+      _holdLeft = k.holdMs;
+      _inHold = _holdLeft > 0;
+      if (!_inHold) nextFrame();
+    }
+    return true;
+  }
+
+private:
+  // The next LEDFX_SEGMENT_MS (at most) of the current keyframe's hold
+  void nextHold(DutySegment &s) {
+    setDuty(s, _cur);
+    s.ms = _holdLeft < LEDFX_SEGMENT_MS ? _holdLeft : LEDFX_SEGMENT_MS;
+    s.ramp = false;
+    _holdLeft -= s.ms;
+    _inHold = _holdLeft > 0;
+    if (!_inHold) nextFrame();
+  }
+
+  static void setDuty(DutySegment &s, const uint8_t *level) {
+    for (uint8_t i = 0; i < LEDFX_MAX_LEDS; i++) s.duty[i] = ledGamma(level[i]);
+  }
+
+  void nextFrame() {
+    if (++_frame < _fx.count) return;
+    _frame = 0;
+    if (!_fx.loop) _done = true;
+  }
+
+  Effect _fx = {nullptr, 0, false};
+  uint8_t _frame = 0;
+  uint16_t _sub = 0, _subs = 0;
+  uint16_t _holdLeft = 0;
+  bool _inHold = false;
+  bool _done = true;
+  uint8_t _from[LEDFX_MAX_LEDS] = {};
+  uint8_t _cur[LEDFX_MAX_LEDS] = {};
+};
@@ -0,0 +1,105 @@
+#include "LoopProfiler.h"
+#include <FixedString.h>
+
+#if LOOPPROF
+
+static ProfSection *g_sections = nullptr;   // in registration order
+static ProfSection **g_tail = &g_sections;
+static uint32_t g_bias = 0;
+static uint32_t g_probe = 0;
+
+ProfSection::ProfSection(const char *name, bool listed) : _name(name), _next(nullptr) {
+  if (!listed) return;
+  *g_tail = this;
+  g_tail = &_next;
+}
+
+void ProfSection::record(uint32_t cycles) { _hist.add(cycles > g_bias ? cycles - g_bias : 0); }
+
+void ProfSection::mark() {
+  uint32_t now = ESP.getCycleCount();
+  if (_marked) _hist.add(now - _lastMark);
+  _lastMark = now;
+  _marked = true;
+}
+
+void ProfSection::reset() {
+  _hist.reset();
+  _marked = false;
+}
+
+namespace LoopProfiler {
+
+uint32_t biasCycles() { return g_bias; }
+uint32_t probeCycles() { return g_probe; }
+
+// Minimum over a few runs: interrupts can only make a run longer.
+// An empty scope records the gap between its two counter reads (the bias);
+// the probe cost also includes the record() call after the second read.
+void calibrate() {
+  static const uint8_t RUNS = 32;
+  ProfSection scratch("calibrate", false);
+  uint32_t bias = UINT32_MAX, probe = UINT32_MAX;
+  for (uint8_t i = 0; i < RUNS; i++) {
+    uint32_t t0 = ESP.getCycleCount();
+    uint32_t t1 = ESP.getCycleCount();
+    if (t1 - t0 < bias) bias = t1 - t0;
+
+    t0 = ESP.getCycleCount();
+    {
+      ProfScope s(scratch);
+    }
+    t1 = ESP.getCycleCount();
+    if (t1 - t0 < probe) probe = t1 - t0;
+  }
+  g_bias = bias;
+  g_probe = probe;
+}
+
+void reset() {
+  for (ProfSection *s = g_sections; s; s = s->next()) s->reset();
+}
+
+// Cycles as microseconds with two decimals, without floats. The whole part
+// is at most 10 digits (cycles / MHz), so the field is clamped to what the
+// buffer holds next to ".dd" and the terminator.
+static void printUs(Print &out, uint32_t cycles, uint8_t width) {
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  uint64_t centi = (uint64_t)cycles * 100 / (mhz ? mhz : 240);
+  char buf[16];
+  int field = width > 3 ? width - 3 : 1;
+  if (field > (int)sizeof(buf) - 4) field = sizeof(buf) - 4;
+  snprintf(buf, sizeof(buf), "%*u.%02u", field, (unsigned)(centi / 100), (unsigned)(centi % 100));
+  out.print(buf);
+}
+
+void dump(Print &out) {
+  printfTo(out, "prof: us at %lu MHz, probe %lu cycles (bias %lu subtracted)\n",
+                (unsigned long)ESP.getCpuFreqMHz(), (unsigned long)g_probe, (unsigned long)g_bias);
+  out.println("section       count      p50      p99      max     mean");
+  for (ProfSection *s = g_sections; s; s = s->next()) {
+    const ProfHistogram &h = s->hist();
+    printfTo(out, "%-10s %8lu ", s->name(), (unsigned long)h.count());
+    printUs(out, h.percentile(500), 8);
+    out.print(' ');
+    printUs(out, h.percentile(990), 8);
+    out.print(' ');
+    printUs(out, h.max(), 8);
+    out.print(' ');
+    printUs(out, h.mean(), 8);
+    out.println();
+    if (!h.count()) continue;
+    // Non-empty buckets as <lower edge us>:<count>
+    for (uint8_t i = 0; i < ProfHistogram::BUCKETS; i++) {
+      if (!h.bucket(i)) continue;
+      out.print(' ');
+      printUs(out, ProfHistogram::lowerBound(i), 0);
+      printfTo(out, ":%lu", (unsigned long)h.bucket(i));
+    }
+    out.println();
+  }
+}
+
+}  // namespace LoopProfiler
+
+#endif
@@ -0,0 +1,91 @@
+// LoopProfiler: per-section timing histograms from the CPU cycle counter
+//
+// Build with -DLOOPPROF=1 to enable; otherwise every PROF_* macro expands to
+// nothing and no code or RAM is used.
+//
+//   PROF_SECTION(secDraw, "draw");     // file scope: one named histogram
+//   void draw() {
+//     PROF_SCOPE(secDraw);             // times the rest of this block
+//     ...
+//   }
+//   PROF_INTERVAL(secTick);            // time since the previous mark (jitter)
+//   PROF_BEGIN();                      // in setup(): measure the probe cost
+//   PROF_DUMP(Serial);                 // on demand: p50 / p99 / max per section
+//
+// A probe is two ESP.getCycleCount() reads plus ProfHistogram::add():
+// constant time, no locks. PROF_BEGIN() measures the bias one probe adds to
+// its own sample (subtracted from every sample) and its total cost, which
+// the dump prints. Each section must only be recorded from one core/context.
+// The cycle counter wraps every ~17.9 s at 240 MHz, so longer spans are not
+// measurable.
+
+#pragma once
+
+#ifndef LOOPPROF
+#define LOOPPROF 0
+#endif
+
+#include <stdint.h>
+#include "ProfHistogram.h"
+
+#if LOOPPROF
+
+#include <Arduino.h>
+
+class ProfSection {
+public:
+  explicit ProfSection(const char *name, bool listed = true);
+
+  void record(uint32_t cycles);
+  void mark();                       // record the cycles since the last mark()
+  void reset();
+
+  const char *name() const { return _name; }
+  const ProfHistogram &hist() const { return _hist; }
+  ProfSection *next() const { return _next; }
+
+private:
+  const char *_name;
+  ProfHistogram _hist;
+  uint32_t _lastMark = 0;
+  bool _marked = false;
+  ProfSection *_next;
+};
+
+class ProfScope {
+public:
+  explicit ProfScope(ProfSection &s) : _s(s), _t0(ESP.getCycleCount()) {}
+  ~ProfScope() { _s.record(ESP.getCycleCount() - _t0); }
+
+private:
+  ProfSection &_s;
+  uint32_t _t0;
+};
+
+namespace LoopProfiler {
+void calibrate();
+void dump(Print &out);
+void reset();
+uint32_t biasCycles();       // subtracted from every scope sample
+uint32_t probeCycles();      // what one probe costs the surrounding code
+}  // namespace LoopProfiler
+
+#define PROF_CAT2(a, b) a##b
+#define PROF_CAT(a, b) PROF_CAT2(a, b)
+#define PROF_SECTION(var, label) static ProfSection var(label)
+#define PROF_SCOPE(var) ProfScope PROF_CAT(_profScope, __LINE__)(var)
+#define PROF_INTERVAL(var) (var).mark()
+#define PROF_BEGIN() LoopProfiler::calibrate()
+#define PROF_DUMP(out) LoopProfiler::dump(out)
+#define PROF_RESET() LoopProfiler::reset()
+
+#else
+
+#define PROF_SECTION(var, label) struct PROF_unused_##var
+#define PROF_SCOPE(var) ((void)0)
+#define PROF_INTERVAL(var) ((void)0)
+#define PROF_BEGIN() ((void)0)
+#define PROF_DUMP(out) (out).println("profiling is off (build with -DLOOPPROF=1)")
+#define PROF_RESET() ((void)0)
+
+#endif
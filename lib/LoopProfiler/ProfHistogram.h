@@ -0,0 +1,66 @@
+// ProfHistogram: fixed-bucket log-scale histogram of cycle counts
+//
+// Pure code (no Arduino / IDF headers) so recorded samples can be checked on
+// the host. Every power of two is split into 8 buckets (values 0-7 get one
+// each), which covers the whole 32-bit range in 240 counters (~1 KB) with at
+// most 12.5 % relative bucket width. add() is a count-leading-zeros, a shift and
+// three increments: constant time, no loops, no allocation.
+
+#pragma once
+
+#include <stdint.h>
+
+class ProfHistogram {
+public:
+  static const uint8_t BUCKETS = 240;
+
+  static uint8_t index(uint32_t v) {
+    if (v < 8) return (uint8_t)v;
+    uint8_t msb = 31 - __builtin_clz(v);
+    return (uint8_t)((msb - 2) * 8 + ((v >> (msb - 3)) & 7));
+  }
+  // Smallest value that falls into bucket i
+  static uint32_t lowerBound(uint8_t i) {
+    if (i < 8) return i;
+    uint8_t msb = i / 8 + 2;
+    return (uint32_t)(8 + i % 8) << (msb - 3);
+  }
+  static uint32_t upperBound(uint8_t i) { return i + 1 < BUCKETS ? lowerBound(i + 1) - 1 : UINT32_MAX; }
+
+  void add(uint32_t v) {
+    _counts[index(v)]++;
+    _n++;
+    _sum += v;
+    if (v > _max) _max = v;
+  }
+
+  void reset() { *this = ProfHistogram(); }
+
+  uint32_t count() const { return _n; }
+  uint32_t max() const { return _max; }
+  uint32_t mean() const { return _n ? (uint32_t)(_sum / _n) : 0; }
+  uint32_t bucket(uint8_t i) const { return _counts[i]; }
+
+  // Value at or below which `permille` of the samples fall: the upper edge
+  // of the bucket holding that rank, capped at the observed max.
+  uint32_t percentile(uint16_t permille) const {
+    if (!_n) return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)_n * permille + 999) / 1000);
+    if (rank == 0) rank = 1;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKETS; i++) {
+      seen += _counts[i];
+      if (seen >= rank) {
+        uint32_t hi = upperBound(i);
+        return hi < _max ? hi : _max;
+      }
+    }
+    return _max;
+  }
+
+private:
+  uint32_t _counts[BUCKETS] = {};
+  uint32_t _n = 0;
+  uint32_t _max = 0;
+  uint64_t _sum = 0;
+};
@@ -0,0 +1,111 @@
+// MelodyCore: note tables and the sequencing state machine
+//
+// Pure code (no Arduino / IDF headers) so a melody can be stepped against a
+// virtual clock on the host and the emitted tones compared with the table.
+//
+// A melody is a `constexpr Note[]`: frequency, length and trailing rest in
+// sixteenths of a beat. The LEDC clock divider for every note is worked out
+// by the compiler, so playing a note is a couple of register writes with no
+// float math at run time.
+
+#pragma once
+
+#include <stdint.h>
+
+// Buzzer PWM: 10-bit duty (50 % = square wave) from the 80 MHz APB clock
+static const uint8_t MELODY_DUTY_BITS = 10;
+static const uint32_t MELODY_APB_HZ = 80000000UL;
+
+// LEDC divider for `hz` in the timer's fixed-point format (8 fractional
+// bits). 0 means silence. Valid range at 10 bits is about 77 Hz .. 78 kHz.
+constexpr uint32_t melodyDivider(uint16_t hz) {
+  return hz ? (uint32_t)(((uint64_t)MELODY_APB_HZ << 8) / ((uint64_t)hz << MELODY_DUTY_BITS)) : 0;
+}
+
+struct Note {
+  uint32_t div;     // precomputed LEDC divider, 0 = rest
+  uint16_t hz;
+  uint8_t len;      // sounding time, sixteenths of a beat
+  uint8_t gap;      // silence after the note, sixteenths of a beat
+
+  constexpr Note(uint16_t hz, uint8_t len, uint8_t gap = 0)
+      : div(melodyDivider(hz)), hz(hz), len(len), gap(gap) {}
+};
+
+// Equal-tempered pitches used by the sketches (Hz, rounded)
+enum : uint16_t {
+  NOTE_REST = 0,
+  NOTE_C4 = 262, NOTE_D4 = 294, NOTE_E4 = 330, NOTE_F4 = 349, NOTE_G4 = 392,
+  NOTE_GS4 = 415, NOTE_A4 = 440, NOTE_B4 = 494,
+  NOTE_C5 = 523, NOTE_D5 = 587, NOTE_E5 = 659, NOTE_F5 = 698, NOTE_FS5 = 740,
+  NOTE_G5 = 784, NOTE_GS5 = 830, NOTE_A5 = 880,
+};
+
+class MelodyCore {
+public:
+  static const uint16_t DEFAULT_BPM = 120;
+
+  MelodyCore() { setTempo(DEFAULT_BPM); }
+
+  void start(const Note *notes, uint16_t count, bool loop) {
+    _notes = notes;
+    _count = count;
+    _loop = loop;
+    _index = 0;
+    _inGap = false;
+    _playing = count > 0;
+  }
+  void stop() { _playing = false; }
+  bool playing() const { return _playing; }
+  uint16_t index() const { return _index; }
+
+  // Applies from the next note or rest on
+  void setTempo(uint16_t bpm) {
+    if (bpm == 0) bpm = 1;
+    _bpm = bpm;
+    _unitUs = 60000000UL / 4 / bpm;
+  }
+  uint16_t tempo() const { return _bpm; }
+  uint32_t unitUs() const { return _unitUs; }
+
+  // Perform the step that is due now: calls sink.tone(note) or sink.silence()
+  // and returns the time until the next step in microseconds (0 when the
+  // melody has ended and the output is silent).
+  template <typename Sink>
+  uint32_t step(Sink &sink) {
+    if (!_playing) {
+      sink.silence();
+      return 0;
+    }
+    const Note &n = _notes[_index];
+    uint32_t wait;
+    if (!_inGap) {
+      if (n.div) sink.tone(n);
+      else sink.silence();
+      if (n.gap) {
+        _inGap = true;
+        return n.len * _unitUs;     // same note again, now for its rest
+      }
+      wait = n.len * _unitUs;
+    } else {
+      sink.silence();
+      _inGap = false;
+      wait = n.gap * _unitUs;
+    }
+    if (++_index >= _count) {
+      _index = 0;
+      if (!_loop) _playing = false;   // next step silences the last note
+    }
+    return wait;
+  }
+
+private:
+  const Note *_notes = nullptr;
+  uint16_t _count = 0;
+  uint16_t _index = 0;
+  bool _loop = false;
+  bool _inGap = false;
+  bool _playing = false;
+  uint16_t _bpm = DEFAULT_BPM;
+  uint32_t _unitUs = 0;
+};
@@ -0,0 +1,140 @@
+#include "MelodySeq.h"
+
+static const ledc_mode_t MODE = LEDC_HIGH_SPEED_MODE;
+
+MelodySeq::MelodySeq(uint8_t pin, ledc_channel_t channel, ledc_timer_t timer)
+    : _pin(pin), _channel(channel), _ledcTimer(timer) {}
+
+bool MelodySeq::begin() {
+  ledc_timer_config_t tc = {};
+  tc.speed_mode = MODE;
+  tc.duty_resolution = (ledc_timer_bit_t)MELODY_DUTY_BITS;
+  tc.timer_num = _ledcTimer;
+  tc.freq_hz = 1000;                       // replaced by the first note
+  tc.clk_cfg = LEDC_USE_APB_CLK;
+  if (ledc_timer_config(&tc) != ESP_OK) return false;
+
+  ledc_channel_config_t cc = {};
+  cc.gpio_num = _pin;
+  cc.speed_mode = MODE;
+  cc.channel = _channel;
+  cc.timer_sel = _ledcTimer;
+  cc.duty = 0;                             // silent until play()
+  if (ledc_channel_config(&cc) != ESP_OK) return false;
+
+  esp_timer_create_args_t args = {};
+  args.callback = &MelodySeq::onTimer;
+  args.arg = this;
+  args.name = "melody";
+  return esp_timer_create(&args, &_timer) == ESP_OK;
+}
+
+void MelodySeq::play(const Note *notes, uint16_t count, bool loop) {
+  portENTER_CRITICAL(&_lock);
+  _core.start(notes, count, loop);
+  _dueUs = esp_timer_get_time();
+  stepLocked();                            // first note starts right away
+  portEXIT_CRITICAL(&_lock);
+  apply();
+}
+
+void MelodySeq::stop() {
+  portENTER_CRITICAL(&_lock);
+  _core.stop();
+  _playing = false;
+  publishLocked(0, NO_DEADLINE);
+  portEXIT_CRITICAL(&_lock);
+  apply();
+}
+
+void MelodySeq::setTempo(uint16_t bpm) {
+  portENTER_CRITICAL(&_lock);
+  _core.setTempo(bpm);
+  portEXIT_CRITICAL(&_lock);
+}
+
+// esp_timer task: a note boundary is due
+void MelodySeq::onTimer(void *arg) {
+  static_cast<MelodySeq *>(arg)->advance();
+}
+
+void MelodySeq::advance() {
+  portENTER_CRITICAL(&_lock);
+  int64_t now = esp_timer_get_time();
+  // A callback that was already dispatched when play() restarted the
+  // melody sees a deadline in the future and must not step it; apply()
+  // has armed the timer for that deadline.
+  if (now < _dueUs) {
+    portEXIT_CRITICAL(&_lock);
+    return;
+  }
+  uint32_t late = (uint32_t)(now - _dueUs);
+  if (late > _maxLateUs) _maxLateUs = late;
+  stepLocked();
+  portEXIT_CRITICAL(&_lock);
+  apply();
+}
+
+// Steps the melody and publishes the result; _dueUs is the step's deadline
+void MelodySeq::stepLocked() {
+  NextTone next;
+  uint32_t wait = _core.step(next);
+  _playing = wait != 0;
+  // Absolute deadlines: the next boundary is measured from when this one
+  // was due, not from when the callback got to run.
+  if (wait) _dueUs += wait;
+  publishLocked(next.div, wait ? _dueUs : NO_DEADLINE);
+}
+
+void MelodySeq::publishLocked(uint32_t div, int64_t dueUs) {
+  _wantDiv = div;
+  _wantDueUs = dueUs;
+  _wantSeq++;
+}
+
+// Writes the newest published output to the LEDC and the timer. If another
+// context is already writing, it picks this output up when it is done.
+void MelodySeq::apply() {
+  for (;;) {
+    portENTER_CRITICAL(&_lock);
+    if (_applying || _doneSeq == _wantSeq) {
+      portEXIT_CRITICAL(&_lock);
+      return;
+    }
+    _applying = true;
+    uint32_t seq = _wantSeq, div = _wantDiv;
+    int64_t due = _wantDueUs;
+    portEXIT_CRITICAL(&_lock);
+
+    drive(div);
+    esp_timer_stop(_timer);
+    if (due != NO_DEADLINE) {
+      int64_t left = due - esp_timer_get_time();
+      esp_timer_start_once(_timer, left > 0 ? left : 0);
+    }
+
+    portENTER_CRITICAL(&_lock);
+    _doneSeq = seq;
+    _applying = false;
+    portEXIT_CRITICAL(&_lock);
+  }
+}
+
+void MelodySeq::drive(uint32_t div) {
+  if (!div) {
+    if (!_sounding) return;
+    ledc_set_duty(MODE, _channel, 0);
+    ledc_update_duty(MODE, _channel);
+    _sounding = false;
+    return;
+  }
+  if (div != _div) {
+    ledc_timer_set(MODE, _ledcTimer, div, MELODY_DUTY_BITS, LEDC_APB_CLK);
+    _div = div;
+  }
+  if (!_sounding) {
+    ledc_set_duty(MODE, _channel, 1u << (MELODY_DUTY_BITS - 1));   // 50 %
+    ledc_update_duty(MODE, _channel);
+    _sounding = true;
+  }
+}
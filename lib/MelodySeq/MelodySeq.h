@@ -0,0 +1,79 @@
+// MelodySeq: plays a melody in the background on a buzzer
+//
+// An esp_timer one-shot fires at every note boundary and reprograms the LEDC
+// timer with the note's precomputed divider (see MelodyCore.h). Nothing runs
+// in loop(): play() and stop() return immediately, and stop() silences the
+// buzzer before it returns (if a note boundary is being written on the
+// other core at that moment, that writer silences it right after).
+//
+// The spinlock only guards MelodyCore and the wanted output (divider and
+// next deadline, with a sequence number). LEDC and esp_timer calls are made
+// after it is released, by one context at a time, which keeps applying
+// until it has written the newest output.
+//
+// Deadlines are absolute, so callback latency does not add up over a long
+// melody. The LEDC channel/timer pair is configured here directly; don't use
+// ledcWriteTone() / ledcAttachPin() on the same channel.
+
+#pragma once
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include <esp_timer.h>
+#include "MelodyCore.h"
+
+class MelodySeq {
+public:
+  MelodySeq(uint8_t pin, ledc_channel_t channel = LEDC_CHANNEL_0, ledc_timer_t timer = LEDC_TIMER_0);
+
+  bool begin();
+
+  void play(const Note *notes, uint16_t count, bool loop = true);
+  template <uint16_t N>
+  void play(const Note (&notes)[N], bool loop = true) { play(notes, N, loop); }
+
+  void stop();
+  void setTempo(uint16_t bpm);
+
+  bool playing() const { return _playing; }
+  uint16_t tempo() const { return _core.tempo(); }
+  uint32_t maxLateUs() const { return _maxLateUs; }   // worst note-boundary delay
+
+private:
+  static void onTimer(void *arg);
+  void advance();
+  void stepLocked();
+  void publishLocked(uint32_t div, int64_t dueUs);
+  void apply();
+  void drive(uint32_t div);
+
+  // Output side of MelodyCore::step(): what the buzzer should do next
+  struct NextTone {
+    uint32_t div = 0;   // 0 = silent
+    void tone(const Note &n) { div = n.div; }
+    void silence() { div = 0; }
+  };
+
+  static const int64_t NO_DEADLINE = -1;
+
+  uint8_t _pin;
+  ledc_channel_t _channel;
+  ledc_timer_t _ledcTimer;
+  esp_timer_handle_t _timer = nullptr;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  // Under _lock
+  MelodyCore _core;
+  volatile bool _playing = false;
+  int64_t _dueUs = 0;
+  uint32_t _maxLateUs = 0;
+  uint32_t _wantDiv = 0;
+  int64_t _wantDueUs = NO_DEADLINE;
+  uint32_t _wantSeq = 0;
+  uint32_t _doneSeq = 0;
+  bool _applying = false;
+
+  // Only touched by the context that set _applying
+  bool _sounding = false;
+  uint32_t _div = 0;
+};
@@ -0,0 +1,104 @@
+// MicroBench: timing harness for short, hot operations
+//
+// A case is a callable run in batches; each batch is timed with the
+// caller's counter (ESP.getCycleCount() on the device, a nanosecond clock
+// on the host), the cost of reading the counter is subtracted, and the
+// per-call min / median / max over the batches is printed:
+//
+//   BenchClock clock = benchClock(cycles, "cycles");   // measures its own overhead
+//   benchRun(Serial, clock, "formatFixed", 100, [&] { n += formatFixed(buf, v++, 2); });
+//   benchKeep(n);
+//
+// Operations that can't be repeated back to back (a DHT transaction) go
+// through BenchSamples directly: add() one measurement per run, print()
+// them.
+//
+// One line per case, grep-able out of a serial log and compared against a
+// stored baseline by tools/bench_compare:
+//
+//   bench,<name>,<unit>,<min>,<p50>,<max>,<calls per batch>
+//
+// Per-call values have one decimal. Batches take the median, not the mean,
+// so an interrupt landing in one batch moves max but not p50.
+//
+// Pure code (no Arduino headers): output goes through printfTo().
+
+#pragma once
+
+#include <stdint.h>
+#include <FixedString.h>
+
+typedef uint32_t (*BenchCounter)();
+
+struct BenchClock {
+  BenchCounter read;
+  const char *unit;      // "cycles", "ns", "us"
+  uint32_t overhead;     // counter units of an empty batch, subtracted
+};
+
+// Keeps a result alive so the compiler can't drop the work behind it
+template <typename T>
+inline void benchKeep(const T &v) {
+  asm volatile("" : : "r"(&v) : "memory");
+}
+
+// Per-call times of up to MAX runs, in tenths of a counter unit
+class BenchSamples {
+public:
+  static const uint8_t MAX = 31;
+
+  void add(uint32_t units, uint16_t calls = 1) {
+    if (_n < MAX) _v[_n++] = (uint32_t)(((uint64_t)units * 10 + calls / 2) / calls);
+  }
+  uint8_t count() const { return _n; }
+
+  template <typename Out>
+  void print(Out &out, const char *name, const char *unit, uint16_t calls = 1) {
+    if (!_n) return;
+    sort();
+    char lo[FIXED_MAX_CHARS], mid[FIXED_MAX_CHARS], hi[FIXED_MAX_CHARS];
+    formatFixed(lo, (int32_t)_v[0], 1);
+    formatFixed(mid, (int32_t)_v[_n / 2], 1);
+    formatFixed(hi, (int32_t)_v[_n - 1], 1);
+    printfTo(out, "bench,%s,%s,%s,%s,%s,%u\n", name, unit, lo, mid, hi, calls);
+  }
+
+private:
+  void sort() {
+    for (uint8_t i = 1; i < _n; i++)
+      for (uint8_t j = i; j > 0 && _v[j - 1] > _v[j]; j--) {
+        uint32_t t = _v[j];
+        _v[j] = _v[j - 1];
+        _v[j - 1] = t;
+      }
+  }
+
+  uint32_t _v[MAX];
+  uint8_t _n = 0;
+};
+
+// A clock whose overhead is the cheapest of 31 back-to-back reads
+inline BenchClock benchClock(BenchCounter read, const char *unit) {
+  BenchClock c = {read, unit, UINT32_MAX};
+  for (uint8_t i = 0; i < BenchSamples::MAX; i++) {
+    uint32_t t0 = read();
+    uint32_t d = read() - t0;
+    if (d < c.overhead) c.overhead = d;
+  }
+  return c;
+}
+
+// Times `calls` calls of fn per batch over `batches` batches (<= 31)
+template <typename Out, typename F>
+void benchRun(Out &out, const BenchClock &clock, const char *name, uint16_t calls, F fn,
+              uint8_t batches = BenchSamples::MAX) {
+  BenchSamples s;
+  fn();   // warm caches and lazy init outside the timing
+  for (uint8_t b = 0; b < batches; b++) {
+    uint32_t t0 = clock.read();
+    for (uint16_t i = 0; i < calls; i++) fn();
+    uint32_t d = clock.read() - t0;
+    s.add(d > clock.overhead ? d - clock.overhead : 0, calls);
+  }
+  s.print(out, name, clock.unit, calls);
+}
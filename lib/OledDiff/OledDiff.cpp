@@ -0,0 +1,123 @@
+#include "OledDiff.h"
+
+// Bytes per data transaction after the 0x40 control byte (same limit the
+// Adafruit driver uses, so one chunk always fits in the Wire buffer).
+#ifdef I2C_BUFFER_LENGTH
+static const uint16_t CHUNK = (I2C_BUFFER_LENGTH > 256 ? 256 : I2C_BUFFER_LENGTH) - 1;
+#else
+static const uint16_t CHUNK = 31;
+#endif
+
+// Bus bytes for one rectangle: 0x00 + 6 address command bytes, then the
+// data with one 0x40 control byte per chunk.
+static uint16_t rectCost(uint8_t pages, uint8_t cols) {
+  uint16_t n = (uint16_t)pages * cols;
+  return 7 + n + (n + CHUNK - 1) / CHUNK;
+}
+
+OledDiff::OledDiff(Adafruit_SSD1306 &display, TwoWire &wire, uint8_t addr,
+                   uint32_t clkDuring, uint32_t clkAfter)
+    : _display(display), _wire(wire), _addr(addr),
+      _clkDuring(clkDuring), _clkAfter(clkAfter) {}
+
+bool OledDiff::begin() {
+  _valid = false;
+  return _display.width() == WIDTH && _display.height() == PAGES * 8;
+}
+
+uint16_t OledDiff::flush() {
+  return flush(_display.getBuffer());
+}
+
+uint16_t OledDiff::flush(const uint8_t *frame) {
+  // Changed column range per page (first > last means clean)
+  uint8_t first[PAGES], last[PAGES];
+  for (uint8_t p = 0; p < PAGES; p++) {
+    const uint8_t *row = frame + p * WIDTH;
+    const uint8_t *old = _shadow + p * WIDTH;
+    if (!_valid) {
+      first[p] = 0;
+      last[p] = WIDTH - 1;
+      continue;
+    }
+    int16_t a = 0, b = WIDTH - 1;
+    while (a < WIDTH && row[a] == old[a]) a++;
+    while (b > a && row[b] == old[b]) b--;
+    first[p] = (a < WIDTH) ? a : 1;
+    last[p] = (a < WIDTH) ? b : 0;
+  }
+
+  if (_clkDuring) _wire.setClock(_clkDuring);
+
+  _busOk = true;
+  uint16_t bytes = 0;
+  uint8_t rects = 0;
+  uint8_t p = 0;
+  while (p < PAGES) {
+    if (first[p] > last[p]) { p++; continue; }
+
+    // Grow the rectangle downwards while one merged transfer is cheaper
+    // than addressing the next dirty page on its own.
+    uint8_t p1 = p, c0 = first[p], c1 = last[p];
+    while (p1 + 1 < PAGES && first[p1 + 1] <= last[p1 + 1]) {
+      uint8_t n0 = min(c0, first[p1 + 1]), n1 = max(c1, last[p1 + 1]);
+      uint16_t merged = rectCost(p1 - p + 2, n1 - n0 + 1);
+      uint16_t split = rectCost(p1 - p + 1, c1 - c0 + 1) +
+                       rectCost(1, last[p1 + 1] - first[p1 + 1] + 1);
+      if (merged > split) break;
+      c0 = n0;
+      c1 = n1;
+      p1++;
+    }
+    bytes += sendRect(frame, p, p1, c0, c1);
+    rects++;
+    p = p1 + 1;
+  }
+
+  if (_clkAfter) _wire.setClock(_clkAfter);
+
+  // A failed transfer leaves GDDRAM unknown: resend everything next time.
+  _valid = _busOk;
+
+  _lastBytes = bytes;
+  _lastRects = rects;
+  _totalBytes += bytes;
+  _frames++;
+  return bytes;
+}
+
+uint16_t OledDiff::sendRect(const uint8_t *frame, uint8_t p0, uint8_t p1, uint8_t c0, uint8_t c1) {
+  const uint8_t cmds[] = {SSD1306_COLUMNADDR, c0, c1, SSD1306_PAGEADDR, p0, p1};
+  uint16_t bytes = sendCommands(cmds, sizeof(cmds));
+
+  // Horizontal addressing mode: the controller wraps from c1 back to c0 on
+  // the next page, so rows are streamed page by page.
+  uint16_t inChunk = 0;
+  for (uint8_t p = p0; p <= p1; p++) {
+    const uint8_t *row = frame + p * WIDTH;
+    for (uint8_t c = c0; c <= c1; c++) {
+      if (inChunk == 0) {
+        _wire.beginTransmission(_addr);
+        _wire.write((uint8_t)0x40);
+        bytes++;
+      }
+      _wire.write(row[c]);
+      bytes++;
+      if (++inChunk == CHUNK) {
+        if (_wire.endTransmission() != 0) _busOk = false;
+        inChunk = 0;
+      }
+    }
+    memcpy(_shadow + p * WIDTH + c0, row + c0, c1 - c0 + 1);
+  }
+  if (inChunk && _wire.endTransmission() != 0) _busOk = false;
+  return bytes;
+}
+
+uint16_t OledDiff::sendCommands(const uint8_t *cmds, uint8_t n) {
+  _wire.beginTransmission(_addr);
+  _wire.write((uint8_t)0x00);
+  _wire.write(cmds, n);
+  if (_wire.endTransmission() != 0) _busOk = false;
+  return n + 1;
+}
@@ -0,0 +1,61 @@
+// OledDiff: differential flush for a 128x64 SSD1306 on I2C
+//
+// Keeps a shadow copy of what is already in the controller's GDDRAM and, on
+// flush(), only sends the pages / column ranges that changed, using the
+// SSD1306 column (0x21) and page (0x22) address commands.
+//
+// Drawing still goes through Adafruit_SSD1306 as before; only the call to
+// display.display() is replaced by oled.flush().
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+
+class OledDiff {
+public:
+  static const uint8_t WIDTH = 128;
+  static const uint8_t PAGES = 8;                  // 64 rows / 8
+  static const uint16_t FRAME_BYTES = WIDTH * PAGES;
+
+  OledDiff(Adafruit_SSD1306 &display, TwoWire &wire = Wire, uint8_t addr = 0x3C,
+           uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+
+  // Call after display.begin(). Returns false for panels that are not 128x64.
+  bool begin();
+
+  // Push the Adafruit buffer (or any 1 KB frame in SSD1306 page layout).
+  // Returns the number of bytes written to the bus for this frame.
+  uint16_t flush();
+  uint16_t flush(const uint8_t *frame);
+
+  // Forget the shadow so the next flush resends the whole frame.
+  void invalidate() { _valid = false; }
+
+  // Send raw commands in a single I2C transaction (counted in the stats).
+  uint16_t sendCommands(const uint8_t *cmds, uint8_t n);
+
+  uint16_t lastFrameBytes() const { return _lastBytes; }
+  uint8_t lastFrameRects() const { return _lastRects; }
+  uint32_t totalBytes() const { return _totalBytes; }
+  uint32_t frames() const { return _frames; }
+
+private:
+  uint16_t sendRect(const uint8_t *frame, uint8_t p0, uint8_t p1, uint8_t c0, uint8_t c1);
+
+  Adafruit_SSD1306 &_display;
+  TwoWire &_wire;
+  uint8_t _addr;
+  uint32_t _clkDuring;
+  uint32_t _clkAfter;
+
+  uint8_t _shadow[FRAME_BYTES];
+  bool _valid = false;
+  bool _busOk = true;
+
+  uint16_t _lastBytes = 0;
+  uint8_t _lastRects = 0;
+  uint32_t _totalBytes = 0;
+  uint32_t _frames = 0;
+};
@@ -0,0 +1,112 @@
+#include "OledFx.h"
+
+void OledFx::send(Effect e, const uint8_t *cmds, uint8_t n) {
+  _stats[e].commands++;
+  _stats[e].bytes += _oled.sendCommands(cmds, n);
+}
+
+void OledFx::scroll(Direction dir, uint8_t startPage, uint8_t endPage, Speed speed, uint8_t vOffset) {
+  // Parameters may only change while scrolling is off, so every setup
+  // starts with a deactivate
+  if (dir == RIGHT || dir == LEFT) {
+    const uint8_t cmds[] = {SSD1306_DEACTIVATE_SCROLL,
+                            (uint8_t)(dir == RIGHT ? SSD1306_RIGHT_HORIZONTAL_SCROLL : SSD1306_LEFT_HORIZONTAL_SCROLL),
+                            0x00, (uint8_t)(startPage & 7), speed, (uint8_t)(endPage & 7), 0x00, 0xFF,
+                            SSD1306_ACTIVATE_SCROLL};
+    send(SCROLL, cmds, sizeof(cmds));
+  } else {
+    const uint8_t cmds[] = {SSD1306_DEACTIVATE_SCROLL, SSD1306_SET_VERTICAL_SCROLL_AREA, 0, OledDiff::PAGES * 8,
+                            (uint8_t)(dir == DIAG_RIGHT ? SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL
+                                                        : SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL),
+                            0x00, (uint8_t)(startPage & 7), speed, (uint8_t)(endPage & 7),
+                            (uint8_t)(vOffset & 0x3F), SSD1306_ACTIVATE_SCROLL};
+    send(SCROLL, cmds, sizeof(cmds));
+  }
+  _scrolling = true;
+}
+
+void OledFx::stopScroll() {
+  if (!_scrolling) return;
+  const uint8_t cmd = SSD1306_DEACTIVATE_SCROLL;
+  send(SCROLL, &cmd, 1);
+  _scrolling = false;
+  _oled.invalidate();   // GDDRAM holds the scrolled picture now
+}
+
+void OledFx::invert(bool on) {
+  const uint8_t cmd = on ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY;
+  send(BLINK, &cmd, 1);
+  _inverted = on;
+}
+
+void OledFx::blink(uint16_t periodMs, uint16_t count) {
+  _blinkMs = periodMs ? periodMs : 1;
+  _blinkLeft = count ? 2UL * count : UINT32_MAX;
+  _blinkNext = millis();
+}
+
+void OledFx::stopBlink() {
+  _blinkLeft = 0;
+  if (_inverted) invert(false);
+}
+
+void OledFx::contrast(uint8_t value) {
+  const uint8_t cmds[] = {SSD1306_SETCONTRAST, value};
+  send(FADE, cmds, sizeof(cmds));
+  _contrast = value;
+}
+
+void OledFx::fade(uint8_t from, uint8_t to, uint16_t durationMs) {
+  _fadeFrom = from;
+  _fadeTo = to;
+  _fadeMs = durationMs;
+  _fadeStart = _fadeNext = millis();
+  _fading = true;
+  contrast(from);
+}
+
+void OledFx::roll(int8_t rows, uint16_t stepMs) {
+  _rollStep = rows;
+  _rollMs = stepMs ? stepMs : 1;
+  _rollNext = millis() + _rollMs;
+}
+
+void OledFx::stopRoll() {
+  _rollStep = 0;
+  if (!_startLine) return;
+  const uint8_t cmd = SSD1306_SETSTARTLINE;
+  send(ROLL, &cmd, 1);
+  _startLine = 0;
+}
+
+void OledFx::poll() {
+  uint32_t now = millis();
+
+  if (_blinkLeft && (int32_t)(now - _blinkNext) >= 0) {
+    invert(!_inverted);
+    if (_blinkLeft != UINT32_MAX) _blinkLeft--;
+    _blinkNext += _blinkMs;
+    if ((int32_t)(now - _blinkNext) >= 0) _blinkNext = now + _blinkMs;   // fell behind: don't burst
+  }
+
+  if (_fading && (int32_t)(now - _fadeNext) >= 0) {
+    uint32_t t = now - _fadeStart;
+    uint8_t value = _fadeTo;
+    if (t < _fadeMs) value = _fadeFrom + (int32_t)(_fadeTo - _fadeFrom) * (int32_t)t / _fadeMs;
+    else _fading = false;
+    if (value != _contrast) contrast(value);
+    _fadeNext = now + FADE_STEP_MS;
+  }
+
+  if (_rollStep && (int32_t)(now - _rollNext) >= 0) {
+    _startLine = (_startLine + _rollStep) & 0x3F;
+    const uint8_t cmd = SSD1306_SETSTARTLINE | _startLine;
+    send(ROLL, &cmd, 1);
+    _rollNext += _rollMs;
+    if ((int32_t)(now - _rollNext) >= 0) _rollNext = now + _rollMs;
+  }
+}
+
+void OledFx::resetStats() {
+  for (uint8_t i = 0; i < EFFECT_COUNT; i++) _stats[i] = Stats();
+}
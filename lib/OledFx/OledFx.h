@@ -0,0 +1,94 @@
+// OledFx: SSD1306 animations done by the controller itself
+//
+// Hardware scroll, invert, contrast and the display start line are a few
+// command bytes each, instead of pushing a new 1 KB frame. Effects start
+// with one call and are advanced by poll() from loop(), which never waits.
+// Commands go through OledDiff::sendCommands(), so they share its bus
+// settings and show up in its byte counts.
+//
+//   OledFx fx(oled);                          // OledDiff of the same panel
+//   fx.blink(150);                            // invert every 150 ms
+//   fx.fade(0xCF, 0x00, 1000);                // contrast ramp over 1 s
+//   fx.roll(1, 30);                           // scroll up a row every 30 ms
+//   fx.scroll(OledFx::LEFT, 0, 7, OledFx::FRAMES_5);
+//   loop(): fx.poll();
+//
+// stats(effect) has the command and byte count of each effect. For
+// comparison, a full frame through OledDiff is 1040 bytes.
+//
+// Hardware scrolling moves the picture inside GDDRAM, and new data must
+// not be written while it runs: stopScroll() ends it and makes the next
+// OledDiff flush resend the whole frame. The start-line roll leaves GDDRAM
+// alone; flushes during a roll just appear shifted.
+
+#pragma once
+
+#include <Arduino.h>
+#include <OledDiff.h>
+
+class OledFx {
+public:
+  enum Effect : uint8_t { SCROLL, BLINK, FADE, ROLL, EFFECT_COUNT };
+  enum Direction : uint8_t { RIGHT, LEFT, DIAG_RIGHT, DIAG_LEFT };
+  // Frames between horizontal scroll steps, as the controller encodes them
+  enum Speed : uint8_t {
+    FRAMES_2 = 7, FRAMES_3 = 4, FRAMES_4 = 5, FRAMES_5 = 0,
+    FRAMES_25 = 6, FRAMES_64 = 1, FRAMES_128 = 2, FRAMES_256 = 3
+  };
+
+  struct Stats {
+    uint32_t commands = 0;   // I2C transactions
+    uint32_t bytes = 0;      // bus bytes after the address
+  };
+
+  explicit OledFx(OledDiff &oled) : _oled(oled) {}
+
+  // Hardware scroll of pages startPage..endPage. Diagonal scrolls also
+  // move the picture up by vOffset rows (1-63) per horizontal step.
+  void scroll(Direction dir, uint8_t startPage, uint8_t endPage, Speed speed = FRAMES_5, uint8_t vOffset = 1);
+  void stopScroll();
+
+  // Toggle invert every periodMs; count = number of flashes, 0 = until stopBlink()
+  void blink(uint16_t periodMs, uint16_t count = 0);
+  void stopBlink();
+  void invert(bool on);
+
+  // Contrast from -> to over durationMs, at most one step per FADE_STEP_MS
+  void fade(uint8_t from, uint8_t to, uint16_t durationMs);
+  void contrast(uint8_t value);
+
+  // Move the display start line by `rows` (negative = down) every stepMs;
+  // stopRoll() puts the picture back at line 0
+  void roll(int8_t rows, uint16_t stepMs);
+  void stopRoll();
+
+  void poll();
+
+  bool busy() const { return _blinkLeft || _fading || _rollStep || _scrolling; }
+  const Stats &stats(Effect e) const { return _stats[e]; }
+  void resetStats();
+
+  static const uint8_t FADE_STEP_MS = 16;   // about one panel refresh
+
+private:
+  void send(Effect e, const uint8_t *cmds, uint8_t n);
+
+  OledDiff &_oled;
+  Stats _stats[EFFECT_COUNT];
+  bool _scrolling = false;
+
+  bool _inverted = false;
+  uint32_t _blinkLeft = 0;     // toggles still to do, UINT32_MAX = forever
+  uint16_t _blinkMs = 0;
+  uint32_t _blinkNext = 0;
+
+  bool _fading = false;
+  uint8_t _fadeFrom = 0, _fadeTo = 0, _contrast = 0;
+  uint16_t _fadeMs = 0;
+  uint32_t _fadeStart = 0, _fadeNext = 0;
+
+  int8_t _rollStep = 0;
+  uint8_t _startLine = 0;
+  uint16_t _rollMs = 0;
+  uint32_t _rollNext = 0;
+};
@@ -0,0 +1,49 @@
+#include "OledService.h"
+
+OledService::OledService(Adafruit_SSD1306 &display, OledDiff &oled)
+    : _display(display), _oled(oled) {}
+
+bool OledService::begin(UBaseType_t priority, BaseType_t core, uint32_t stackBytes) {
+  return xTaskCreatePinnedToCore(taskEntry, "oled", stackBytes, this, priority, &_task, core) == pdPASS;
+}
+
+void OledService::submit() {
+  if (!_task) {           // not started: behave like a plain flush
+    _oled.flush();
+    return;
+  }
+  portENTER_CRITICAL(&_lock);
+  memcpy(_pending, _display.getBuffer(), OledDiff::FRAME_BYTES);
+  if (_hasPending) _dropped++;
+  _hasPending = true;
+  _submitted++;
+  portEXIT_CRITICAL(&_lock);
+  xTaskNotifyGive(_task);
+}
+
+void OledService::taskEntry(void *arg) {
+  static_cast<OledService *>(arg)->run();
+}
+
+void OledService::run() {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    bool have = false;
+    portENTER_CRITICAL(&_lock);
+    if (_hasPending) {
+      uint8_t *t = _front;
+      _front = _pending;
+      _pending = t;
+      _hasPending = false;
+      have = true;
+    }
+    portEXIT_CRITICAL(&_lock);
+    if (!have) continue;
+
+    uint32_t t0 = micros();
+    _oled.flush(_front);
+    _lastFlushUs = micros() - t0;
+    _flushed++;
+  }
+}
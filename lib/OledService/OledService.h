@@ -0,0 +1,50 @@
+// OledService: flush the SSD1306 from a background FreeRTOS task
+//
+// loop() keeps drawing into the Adafruit buffer as usual and calls submit()
+// instead of display.display(). submit() copies the finished frame into a
+// pending slot and wakes the flush task, which swaps it with its own front
+// buffer and sends it with OledDiff. Only the newest frame is kept: a frame
+// submitted while another is still pending replaces it (counted as dropped).
+// Both copies happen under a spinlock, so the task never sees a frame that
+// is only half drawn.
+
+#pragma once
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include <OledDiff.h>
+
+class OledService {
+public:
+  OledService(Adafruit_SSD1306 &display, OledDiff &oled);
+
+  // Start the flush task. After this only the task may touch the I2C bus.
+  bool begin(UBaseType_t priority = 1, BaseType_t core = 0, uint32_t stackBytes = 3072);
+
+  // Hand the current Adafruit buffer to the flush task (never blocks on I2C).
+  void submit();
+
+  uint32_t submitted() const { return _submitted; }
+  uint32_t flushed() const { return _flushed; }
+  uint32_t dropped() const { return _dropped; }
+  uint32_t lastFlushUs() const { return _lastFlushUs; }
+
+private:
+  static void taskEntry(void *arg);
+  void run();
+
+  Adafruit_SSD1306 &_display;
+  OledDiff &_oled;
+
+  uint8_t _frames[2][OledDiff::FRAME_BYTES];
+  uint8_t *_pending = _frames[0];
+  uint8_t *_front = _frames[1];
+  bool _hasPending = false;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+  TaskHandle_t _task = nullptr;
+
+  volatile uint32_t _submitted = 0;
+  volatile uint32_t _flushed = 0;
+  volatile uint32_t _dropped = 0;
+  volatile uint32_t _lastFlushUs = 0;
+};
@@ -0,0 +1,63 @@
+#include "OledText.h"
+
+namespace {
+
+// GFX target that records one 6x8 cell as page-layout column bytes
+class GlyphCapture : public Adafruit_GFX {
+public:
+  GlyphCapture() : Adafruit_GFX(OledText::CELL, 8) {}
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x >= 0 && x < 5 && y >= 0 && y < 8 && color) cols[x] |= 1 << y;
+  }
+  uint8_t cols[5];
+};
+
+}  // namespace
+
+void OledText::begin() {
+  GlyphCapture cap;
+  for (uint8_t c = FIRST; c <= LAST; c++) {
+    memset(cap.cols, 0, sizeof(cap.cols));
+    cap.drawChar(0, 0, c, 1, 1, 1);
+    memcpy(_glyphs[c - FIRST], cap.cols, 5);
+  }
+}
+
+int16_t OledText::print(int16_t x, uint8_t page, const char *s) {
+  if (page >= _display.height() / 8) return x;
+  const int16_t w = _display.width();
+  uint8_t *row = _display.getBuffer() + page * w;
+  for (; *s; s++, x += CELL) {
+    uint8_t c = (uint8_t)*s;
+    if (c < FIRST || c > LAST || x >= w || x <= -5) continue;
+    const uint8_t *g = _glyphs[c - FIRST];
+    if (x >= 0 && x + 5 <= w) {
+      uint8_t *p = row + x;
+      p[0] |= g[0];
+      p[1] |= g[1];
+      p[2] |= g[2];
+      p[3] |= g[3];
+      p[4] |= g[4];
+    } else {
+      for (int16_t i = 0; i < 5; i++)
+        if (x + i >= 0 && x + i < w) row[x + i] |= g[i];
+    }
+  }
+  return x;
+}
+
+int16_t OledText::print(int16_t x, uint8_t page, int32_t value, uint8_t decimals) {
+  char buf[FIXED_MAX_CHARS];
+  formatFixed(buf, value, decimals);
+  return print(x, page, buf);
+}
+
+void OledText::clear(int16_t x, uint8_t page, int16_t w) {
+  if (page >= _display.height() / 8) return;
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (x + w > _display.width()) w = _display.width() - x;
+  if (w > 0) memset(_display.getBuffer() + page * _display.width() + x, 0, w);
+}
@@ -0,0 +1,43 @@
+// OledText: page-aligned text straight into the SSD1306 frame buffer
+//
+// Adafruit_GFX draws a character as up to 40 drawPixel() calls. In the
+// SSD1306 buffer a 5x8 glyph column is exactly one byte of one page, so
+// for text whose top edge sits on a page boundary (y = 0, 8, 16, ...) a
+// character is five byte ORs instead. begin() renders the printable ASCII
+// glyphs once through GFX's own drawChar() (475 bytes of RAM), so the
+// output is pixel for pixel what display.print() gives with a transparent
+// background at text size 1.
+//
+//   text.print(0, 2, "Temp: ");                     // column 0, rows 16-23
+//   x = text.print(36, 2, reading.tempTenths * 10, 2);   // "23.50"
+//
+// Numbers go through formatFixed() (lib/FixedText): no float, no heap.
+// Characters outside 0x20-0x7E are skipped (the cell is left blank).
+
+#pragma once
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include <FixedFormat.h>
+
+class OledText {
+public:
+  static const uint8_t FIRST = 0x20, LAST = 0x7E;
+  static const uint8_t CELL = 6;                    // 5 glyph columns + 1 space
+
+  explicit OledText(Adafruit_SSD1306 &display) : _display(display) {}
+
+  void begin();
+
+  // Draw at column x on page `page` (rows 8*page .. 8*page+7), clipped to
+  // the screen. Returns the column after the text.
+  int16_t print(int16_t x, uint8_t page, const char *s);
+  int16_t print(int16_t x, uint8_t page, int32_t value, uint8_t decimals = 0);
+
+  // Clear columns [x, x + w) of a page, e.g. before redrawing a value
+  void clear(int16_t x, uint8_t page, int16_t w);
+
+private:
+  Adafruit_SSD1306 &_display;
+  uint8_t _glyphs[LAST - FIRST + 1][5];
+};
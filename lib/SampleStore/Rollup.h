@@ -0,0 +1,31 @@
+// Rollup: min / max / mean of one channel over some span of samples
+//
+// Pure code, shared by SampleStore's in-RAM tiers and FlashLog's segment
+// summaries. The sum is 64-bit: a week of 1 s samples near full scale is
+// already past 2^31, and summaries merge whole logs.
+
+#pragma once
+
+#include <stdint.h>
+
+struct Rollup {
+  int64_t sum = 0;          // first, so the struct packs into 16 bytes
+  uint32_t count = 0;
+  int16_t min = INT16_MAX;
+  int16_t max = INT16_MIN;
+
+  void add(int16_t v) {
+    if (v < min) min = v;
+    if (v > max) max = v;
+    sum += v;
+    count++;
+  }
+  void merge(const Rollup &o) {
+    if (!o.count) return;
+    if (o.min < min) min = o.min;
+    if (o.max > max) max = o.max;
+    sum += o.sum;
+    count += o.count;
+  }
+  int16_t mean() const { return count ? (int16_t)(sum / (int64_t)count) : 0; }
+};
@@ -0,0 +1,10 @@
+#include "SampleStore.h"
+
+uint64_t millis64() {
+  static uint32_t high = 0;
+  static uint32_t last = 0;
+  uint32_t now = millis();
+  if (now < last) high++;   // millis() wrapped since the previous call
+  last = now;
+  return ((uint64_t)high << 32) | now;
+}
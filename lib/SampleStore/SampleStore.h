@@ -0,0 +1,132 @@
+// SampleStore: fixed-size in-RAM history for a few sensor channels
+//
+// Keeps the last RAW raw samples plus min/max/mean rollups at three
+// resolutions (1 min, 15 min, 1 h). Everything is a plain array sized by the
+// template arguments, so sizeof(SampleStore<...>) is the whole RAM cost and
+// is known at compile time. Nothing is allocated at runtime.
+//
+// Timestamps are 64-bit milliseconds (see millis64()), so they do not wrap
+// after 49 days like millis(). Values are int16_t in whatever fixed-point
+// unit the channel uses (raw ADC counts, 0.1 degC, 0.1 %RH, ...).
+
+#pragma once
+
+#include <Arduino.h>
+#include "Rollup.h"
+
+// millis() extended to 64 bits. Must be called at least once every 49 days.
+uint64_t millis64();
+
+enum StoreTier : uint8_t { TIER_1MIN = 0, TIER_15MIN, TIER_1H, TIER_COUNT };
+
+template <uint8_t CH, uint16_t RAW, uint16_t N1MIN = 60, uint16_t N15MIN = 96, uint16_t N1H = 168>
+class SampleStore {
+public:
+  struct Sample {
+    uint64_t t;
+    int16_t v[CH];
+  };
+
+  struct Bucket {
+    uint32_t index;     // t / period of the bucket
+    Rollup ch[CH];
+  };
+
+  // Add one sample. Samples older than the newest rollup bucket still go
+  // into the raw ring but are left out of the rollups (counted in late()).
+  void add(uint64_t t, const int16_t (&v)[CH]) {
+    Sample &s = _raw[_rawHead];
+    s.t = t;
+    memcpy(s.v, v, sizeof(s.v));
+    _rawHead = (_rawHead + 1) % RAW;
+    if (_rawCount < RAW) _rawCount++;
+
+    bool late = false;
+    late |= !addToTier(_t1, N1MIN, _h1, _started[TIER_1MIN], PERIOD_MS[TIER_1MIN], t, v);
+    late |= !addToTier(_t15, N15MIN, _h15, _started[TIER_15MIN], PERIOD_MS[TIER_15MIN], t, v);
+    late |= !addToTier(_t60, N1H, _h60, _started[TIER_1H], PERIOD_MS[TIER_1H], t, v);
+    if (late) _late++;
+  }
+
+  // Raw samples, 0 = newest
+  uint16_t rawCount() const { return _rawCount; }
+  const Sample &raw(uint16_t ago) const { return _raw[(_rawHead + RAW - 1 - ago) % RAW]; }
+
+  // Rollup of one channel over the last `span` ms at the given resolution:
+  // the current (partial) bucket plus as many older ones as the span covers.
+  // Costs one merge per bucket.
+  Rollup last(StoreTier tier, uint8_t ch, uint32_t spanMs) const {
+    Rollup r;
+    uint16_t n = (spanMs + PERIOD_MS[tier] - 1) / PERIOD_MS[tier];
+    uint16_t depth = tierDepth(tier);
+    if (n > depth) n = depth;
+    for (uint16_t ago = 0; ago < n; ago++) {
+      const Bucket *b = bucket(tier, ago);
+      if (b) r.merge(b->ch[ch]);
+    }
+    return r;
+  }
+
+  // One bucket, 0 = current; nullptr if that slot has never been filled
+  const Bucket *bucket(StoreTier tier, uint16_t ago) const {
+    uint16_t depth = tierDepth(tier);
+    if (ago >= depth || !_started[tier]) return nullptr;
+    const Bucket *ring = tier == TIER_1MIN ? _t1 : tier == TIER_15MIN ? _t15 : _t60;
+    uint16_t head = tier == TIER_1MIN ? _h1 : tier == TIER_15MIN ? _h15 : _h60;
+    const Bucket &b = ring[(head + depth - ago) % depth];
+    // Older than the ring holds (never written since start): treat as empty
+    if (b.index + ago != ring[head].index) return nullptr;
+    return &b;
+  }
+
+  uint32_t late() const { return _late; }
+
+  static uint16_t tierDepth(StoreTier tier) {
+    return tier == TIER_1MIN ? N1MIN : tier == TIER_15MIN ? N15MIN : N1H;
+  }
+
+  static const uint32_t PERIOD_MS[TIER_COUNT];
+
+private:
+  // Returns false if t falls before the current bucket of this tier
+  static bool addToTier(Bucket *ring, uint16_t depth, uint16_t &head, bool &started,
+                        uint32_t period, uint64_t t, const int16_t (&v)[CH]) {
+    uint32_t idx = (uint32_t)(t / period);
+    if (!started) {
+      started = true;
+      head = 0;
+      clear(ring[0], idx);
+    } else if (idx != ring[head].index) {
+      if (idx < ring[head].index) return false;
+      uint32_t steps = idx - ring[head].index;
+      if (steps > depth) steps = depth;   // gap longer than the ring: start over
+      // Open a bucket for every period we skipped, so gaps show up as empty
+      for (uint32_t k = steps; k > 0; k--) {
+        head = (head + 1) % depth;
+        clear(ring[head], idx - k + 1);
+      }
+    }
+    for (uint8_t c = 0; c < CH; c++) ring[head].ch[c].add(v[c]);
+    return true;
+  }
+
+  static void clear(Bucket &b, uint32_t idx) {
+    b.index = idx;
+    for (uint8_t c = 0; c < CH; c++) b.ch[c] = Rollup();
+  }
+
+  Sample _raw[RAW];
+  uint16_t _rawHead = 0;
+  uint16_t _rawCount = 0;
+
+  Bucket _t1[N1MIN];
+  Bucket _t15[N15MIN];
+  Bucket _t60[N1H];
+  uint16_t _h1 = 0, _h15 = 0, _h60 = 0;
+  bool _started[TIER_COUNT] = {false, false, false};
+
+  uint32_t _late = 0;
+};
+
+template <uint8_t CH, uint16_t RAW, uint16_t N1MIN, uint16_t N15MIN, uint16_t N1H>
+const uint32_t SampleStore<CH, RAW, N1MIN, N15MIN, N1H>::PERIOD_MS[TIER_COUNT] = {60000UL, 900000UL, 3600000UL};
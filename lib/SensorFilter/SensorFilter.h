@@ -0,0 +1,187 @@
+// SensorFilter: per-channel fixed-point filters chained at compile time
+//
+// Each stage takes and returns a Q16.16 value in the channel's own unit
+// (ADC counts, mV, 0.1 degC, ...): the integer part is the sample, the
+// low 16 bits carry the fraction the smoothing produces. A chain is a type,
+// its stages are plain members, and nothing is allocated:
+//
+//   FilterChain<Median<5>, Ema<q15(0.1)>> ldrFilter;        // spikes out, then smooth
+//   FilterChain<Kalman<q16(0.5), q16(8.0)>> tempFilter;     // in (0.1 degC)^2
+//
+//   int32_t y = ldrFilter.push(ldr.raw());   // Q16.16
+//   uint16_t counts = fromQ16(y);            // rounded to the unit
+//   text.appendFixed(fromQ16(t, 1), 2);      // tenths in Q16 -> "23.47"
+//
+// Stages:
+//   Median<N>      median of the last N samples (N odd, <= 15); rejects
+//                  spikes shorter than N/2 samples, delays steps by N/2
+//   Ema<ALPHA>     y += alpha (x - y), alpha in Q15 (q15(0.1) = 3277)
+//   Kalman<Q, R>   1-D random-walk Kalman filter, process noise Q and
+//                  measurement noise R as variances in Q16 (unit^2). Starts
+//                  with a gain near 1/2 and settles to a fixed gain, so it
+//                  follows the first readings faster than an EMA of the same
+//                  steady-state smoothing
+//
+// The first sample initialises every stage, so a chain starts at the first
+// reading instead of ramping up from 0. Samples must stay within +-16383
+// units so that differences of Q16 values fit in 32 bits (12-bit ADC counts,
+// mV and 0.1-unit DHT readings all do). Multiplies are 32x32->64 (two
+// instructions on the ESP32); the Kalman gain takes one 32-bit divide.
+//
+// Pure code (no Arduino headers); tools/filter_bench checks every stage
+// against a double-precision reference and measures samples per second.
+
+#pragma once
+
+#include <stdint.h>
+
+// Q15 coefficient / Q16.16 value from a constant, e.g. as a template argument
+constexpr int32_t q15(double v) { return (int32_t)(v * 32768.0 + (v < 0 ? -0.5 : 0.5)); }
+constexpr int32_t q16(double v) { return (int32_t)(v * 65536.0 + (v < 0 ? -0.5 : 0.5)); }
+
+inline int32_t toQ16(int32_t units) { return units * 65536; }
+
+constexpr int32_t filterPow10(uint8_t n) { return n ? 10 * filterPow10(n - 1) : 1; }
+
+// Q16.16 -> integer in 10^-decimals units, rounded (decimals <= 4); feed
+// the result to formatFixed() / FixedString::appendFixed()
+inline int32_t fromQ16(int32_t q, uint8_t decimals = 0) {
+  if (decimals > 4) decimals = 4;
+  return (int32_t)(((int64_t)q * filterPow10(decimals) + 32768) >> 16);
+}
+
+template <uint8_t N>
+class Median {
+  static_assert(N % 2 == 1 && N <= 15, "Median: N must be odd and at most 15");
+
+public:
+  int32_t step(int32_t x) {
+    if (_n < N) {
+      // Filling: insert into the sorted copy, median of what is there
+      uint8_t i = _n;
+      while (i > 0 && _sorted[i - 1] > x) {
+        _sorted[i] = _sorted[i - 1];
+        i--;
+      }
+      _sorted[i] = x;
+      _ring[_n++] = x;
+      return _sorted[(_n - 1) / 2];
+    }
+    // Replace the oldest sample in the sorted copy and slide x into place
+    int32_t old = _ring[_head];
+    _ring[_head] = x;
+    if (++_head == N) _head = 0;
+    uint8_t i = 0;
+    while (_sorted[i] != old) i++;
+    if (x > old) {
+      while (i + 1 < N && _sorted[i + 1] < x) {
+        _sorted[i] = _sorted[i + 1];
+        i++;
+      }
+    } else {
+      while (i > 0 && _sorted[i - 1] > x) {
+        _sorted[i] = _sorted[i - 1];
+        i--;
+      }
+    }
+    _sorted[i] = x;
+    return _sorted[N / 2];
+  }
+
+  void reset() { _n = _head = 0; }
+
+private:
+  int32_t _ring[N];     // arrival order, _head = oldest once full
+  int32_t _sorted[N];
+  uint8_t _n = 0;
+  uint8_t _head = 0;
+};
+
+template <int32_t ALPHA>
+class Ema {
+  static_assert(ALPHA > 0 && ALPHA <= 32768, "Ema: alpha must be in (0, 1] (Q15)");
+
+public:
+  int32_t step(int32_t x) {
+    if (!_started) {
+      _started = true;
+      return _y = x;
+    }
+    _y += (int32_t)(((int64_t)(x - _y) * ALPHA + (1 << 14)) >> 15);
+    return _y;
+  }
+
+  void reset() { _started = false; }
+
+private:
+  int32_t _y = 0;
+  bool _started = false;
+};
+
+template <int32_t Q, int32_t R>
+class Kalman {
+  static_assert(Q >= 0 && R > 0, "Kalman: variances must be >= 0 (Q) and > 0 (R)");
+
+public:
+  int32_t step(int32_t z) {
+    if (!_started) {
+      _started = true;
+      _p = R;
+      return _x = z;
+    }
+    uint32_t p = _p + Q;   // predict: the value may have wandered by Q
+    // K = p / (p + R) in Q15; both scaled below 2^16 so p << 15 fits
+    uint32_t num = p, den = p + R;
+    if (den >> 16) {
+      uint8_t sh = 16 - __builtin_clz(den);
+      num >>= sh;
+      den >>= sh;
+    }
+    _k = (int32_t)((num << 15) / den);
+    _x += (int32_t)(((int64_t)(z - _x) * _k + (1 << 14)) >> 15);
+    _p = (uint32_t)(((uint64_t)p * (uint32_t)(32768 - _k)) >> 15);
+    return _x;
+  }
+
+  void reset() { _started = false; }
+  int32_t gain() const { return _k; }        // last K, Q15
+  uint32_t variance() const { return _p; }   // estimate variance, Q16 unit^2
+
+private:
+  int32_t _x = 0;
+  uint32_t _p = 0;
+  int32_t _k = 0;
+  bool _started = false;
+};
+
+template <typename... S>
+class FilterChain;
+
+template <>
+class FilterChain<> {
+public:
+  int32_t step(int32_t x) { return x; }
+  void reset() {}
+};
+
+template <typename S, typename... Rest>
+class FilterChain<S, Rest...> {
+public:
+  // One raw sample in, the chain's Q16.16 output out
+  int32_t push(int32_t units) { return _out = step(toQ16(units)); }
+  int32_t value() const { return _out; }   // last push(), Q16.16
+
+  int32_t step(int32_t x) { return _rest.step(_head.step(x)); }
+  void reset() {
+    _head.reset();
+    _rest.reset();
+    _out = 0;
+  }
+
+  S &head() { return _head; }
+
+private:
+  S _head;
+  FilterChain<Rest...> _rest;
+  int32_t _out = 0;
+};
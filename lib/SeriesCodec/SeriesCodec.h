@@ -0,0 +1,235 @@
+// SeriesCodec: bit-packed blocks of timestamped fixed-point samples
+//
+// Gorilla-style: a block starts with one sample stored in full, then every
+// further sample costs a few bits:
+//
+//   timestamp  delta-of-delta D of the u32 ms timestamps
+//                '0'                   D == 0 (steady sampling period)
+//                '10'   +  7 bits      -64 .. 63
+//                '110'  +  9 bits      -256 .. 255
+//                '1110' + 12 bits      -2048 .. 2047
+//                '1111' + 32 bits      anything
+//   each value delta d from the same channel's previous value
+//                '0'                   d == 0
+//                '10'   +  4 bits      -8 .. 7
+//                '110'  +  7 bits      -64 .. 63
+//                '1110' + 11 bits      -1024 .. 1023
+//                '1111' + 17 bits      anything an int16_t can do
+//
+// The values are already fixed point (0.1 C, 0.1 %RH, ADC counts), so a
+// plain integer delta takes the place of Gorilla's XOR of float bit
+// patterns: a DHT reading that did not move is one bit, an LDR jitter of a
+// few counts is six or nine.
+//
+// Block layout: u32 t0 (little endian), i16 first value per channel, then
+// the bit stream, most significant bit first. The sample count is kept by
+// whoever stores the block (FlashLog's page header), so a block can be
+// decoded on its own, without any other block: decode any one block by
+// picking it out of the container.
+//
+// Encoder RAM is the caller's block buffer plus ~30 bytes of state. Pure
+// code (no Arduino / IDF headers), shared by lib/FlashLog and
+// tools/series_bench.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+namespace SeriesCodec {
+
+static const uint8_t MAX_CHANNELS = 8;
+
+inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// Codes 0-4 stand for the prefixes '0', '10', '110', '1110', '1111'; each
+// is followed by a zigzag payload of the width the tables give
+static const uint8_t TIME_BITS[5] = {0, 7, 9, 12, 32};
+static const uint8_t VALUE_BITS[5] = {0, 4, 7, 11, 17};
+
+inline uint8_t timeCode(int32_t d) {
+  if (d == 0) return 0;
+  if (d >= -64 && d < 64) return 1;
+  if (d >= -256 && d < 256) return 2;
+  if (d >= -2048 && d < 2048) return 3;
+  return 4;
+}
+
+inline uint8_t valueCode(int32_t d) {
+  if (d == 0) return 0;
+  if (d >= -8 && d < 8) return 1;
+  if (d >= -64 && d < 64) return 2;
+  if (d >= -1024 && d < 1024) return 3;
+  return 4;
+}
+
+inline uint8_t prefixBits(uint8_t code) { return code < 4 ? code + 1 : 4; }
+
+class Encoder {
+public:
+  explicit Encoder(uint8_t channels) : _ch(channels > MAX_CHANNELS ? MAX_CHANNELS : channels) {}
+
+  // Start a new block in `buf` (cleared here)
+  void begin(uint8_t *buf, uint16_t capBytes) {
+    _buf = buf;
+    _capBits = (uint32_t)capBytes * 8;
+    _pos = 0;
+    _count = 0;
+    memset(buf, 0, capBytes);
+  }
+
+  // Appends one sample; false (block untouched) when it doesn't fit.
+  // Timestamps must not decrease.
+  bool add(uint32_t t, const int16_t *v) {
+    if (_count == 0) {
+      uint32_t need = 32 + 16 * _ch;
+      if (need > _capBits) return false;
+      put(t, 32);
+      for (uint8_t c = 0; c < _ch; c++) put((uint16_t)v[c], 16);
+      _prevT = t;
+      _prevDelta = 0;
+      memcpy(_prev, v, 2 * _ch);
+      _count = 1;
+      return true;
+    }
+
+    int32_t delta = (int32_t)(t - _prevT);
+    int32_t dod = (int32_t)((uint32_t)delta - (uint32_t)_prevDelta);
+    uint8_t tc = timeCode(dod);
+    uint32_t need = prefixBits(tc) + TIME_BITS[tc];
+    uint8_t vc[MAX_CHANNELS];
+    for (uint8_t c = 0; c < _ch; c++) {
+      vc[c] = valueCode((int32_t)v[c] - _prev[c]);
+      need += prefixBits(vc[c]) + VALUE_BITS[vc[c]];
+    }
+    if (_pos + need > _capBits) return false;
+
+    putCode(tc, TIME_BITS[tc], zigzag(dod));
+    for (uint8_t c = 0; c < _ch; c++) putCode(vc[c], VALUE_BITS[vc[c]], zigzag((int32_t)v[c] - _prev[c]));
+    _prevT = t;
+    _prevDelta = delta;
+    memcpy(_prev, v, 2 * _ch);
+    _count++;
+    return true;
+  }
+
+  uint16_t count() const { return _count; }
+  uint16_t bytes() const { return (uint16_t)((_pos + 7) / 8); }
+  uint8_t channels() const { return _ch; }
+
+private:
+  void put(uint32_t v, uint8_t n) {
+    // MSB first; the buffer was cleared, so only 1 bits need writing
+    while (n) {
+      uint8_t room = 8 - (_pos & 7);
+      uint8_t take = n < room ? n : room;
+      uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+      _buf[_pos >> 3] |= (uint8_t)(chunk << (room - take));
+      _pos += take;
+      n -= take;
+    }
+  }
+  void putCode(uint8_t code, uint8_t bits, uint32_t payload) {
+    // `code` ones, then a zero unless all four are ones
+    put(code < 4 ? (1u << (code + 1)) - 2 : 0xF, prefixBits(code));
+    if (bits) put(payload, bits);
+  }
+
+  uint8_t _ch;
+  uint8_t *_buf = nullptr;
+  uint32_t _capBits = 0;
+  uint32_t _pos = 0;
+  uint16_t _count = 0;
+  uint32_t _prevT = 0;
+  int32_t _prevDelta = 0;
+  int16_t _prev[MAX_CHANNELS];
+};
+
+class Decoder {
+public:
+  explicit Decoder(uint8_t channels) : _ch(channels > MAX_CHANNELS ? MAX_CHANNELS : channels) {}
+
+  // `bytes` bounds the reads: a corrupt block ends early instead of
+  // running off the buffer
+  void begin(const uint8_t *block, uint16_t bytes, uint16_t count) {
+    _buf = block;
+    _endBits = (uint32_t)bytes * 8;
+    _pos = 0;
+    _left = count;
+    _first = true;
+  }
+
+  bool next(uint32_t &t, int16_t *v) {
+    if (!_left) return false;
+    if (_first) {
+      if (_endBits < 32u + 16u * _ch) return stop();
+      _prevT = get(32);
+      for (uint8_t c = 0; c < _ch; c++) _prev[c] = (int16_t)get(16);
+      _prevDelta = 0;
+      _first = false;
+    } else {
+      uint8_t code = prefix();
+      if (code) _prevDelta = (int32_t)((uint32_t)_prevDelta + (uint32_t)unzigzag(get(TIME_BITS[code])));
+      _prevT += (uint32_t)_prevDelta;
+      for (uint8_t c = 0; c < _ch; c++) {
+        code = prefix();
+        if (code) _prev[c] = (int16_t)(_prev[c] + unzigzag(get(VALUE_BITS[code])));
+      }
+      if (_pos > _endBits) return stop();
+    }
+    t = _prevT;
+    memcpy(v, _prev, 2 * _ch);
+    _left--;
+    return true;
+  }
+
+private:
+  bool stop() {
+    _left = 0;
+    return false;
+  }
+  // Number of leading ones, at most four: the code
+  uint8_t prefix() {
+    uint8_t n = 0;
+    while (n < 4 && bit()) n++;
+    return n;
+  }
+  uint32_t bit() {
+    if (_pos >= _endBits) {
+      _pos++;
+      return 0;
+    }
+    uint32_t b = (_buf[_pos >> 3] >> (7 - (_pos & 7))) & 1;
+    _pos++;
+    return b;
+  }
+  uint32_t get(uint8_t n) {
+    uint32_t v = 0;
+    while (n) {
+      if (_pos >= _endBits) {
+        _pos += n;
+        return n < 32 ? v << n : 0;
+      }
+      uint8_t room = 8 - (_pos & 7);
+      uint8_t take = n < room ? n : room;
+      uint8_t byte = _buf[_pos >> 3];
+      v = (v << take) | ((byte >> (room - take)) & ((1u << take) - 1));
+      _pos += take;
+      n -= take;
+    }
+    return v;
+  }
+
+  uint8_t _ch;
+  const uint8_t *_buf = nullptr;
+  uint32_t _endBits = 0;
+  uint32_t _pos = 0;
+  uint16_t _left = 0;
+  bool _first = true;
+  uint32_t _prevT = 0;
+  int32_t _prevDelta = 0;
+  int16_t _prev[MAX_CHANNELS];
+};
+
+}  // namespace SeriesCodec
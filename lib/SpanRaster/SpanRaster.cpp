@@ -0,0 +1,311 @@
+#include "SpanRaster.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+typedef uint32_t __attribute__((__may_alias__)) Word;
+
+// One colour = one operation on buffer bytes / words, picked once per call
+struct OrOp {
+  static void byte(uint8_t &d, uint8_t m) { d |= m; }
+  static void word(Word &d, uint32_t m) { d |= m; }
+};
+struct ClearOp {
+  static void byte(uint8_t &d, uint8_t m) { d &= (uint8_t)~m; }
+  static void word(Word &d, uint32_t m) { d &= ~m; }
+};
+struct XorOp {
+  static void byte(uint8_t &d, uint8_t m) { d ^= m; }
+  static void word(Word &d, uint32_t m) { d ^= m; }
+};
+
+template <class Op>
+void span(uint8_t *p, int16_t n, uint8_t mask) {
+  while (n && ((uintptr_t)p & 3)) {
+    Op::byte(*p++, mask);
+    n--;
+  }
+  uint32_t m4 = mask * 0x01010101u;
+  for (; n >= 4; n -= 4, p += 4) Op::word(*(Word *)p, m4);
+  while (n--) Op::byte(*p++, mask);
+}
+
+// Rows lo..hi (0-7) of one page
+inline uint8_t rowMask(int16_t lo, int16_t hi) { return (uint8_t)((0xFF << lo) & (0xFF >> (7 - hi))); }
+
+// Bresenham exactly as Adafruit_GFX::writeLine(), after its swaps: major
+// axis x0..x0+dx, minor axis starting at y0, err starting at dx / 2. The
+// minor coordinate after k steps has a closed form, so the loop starts at
+// the first visible step and stops after the last one.
+struct Line {
+  int32_t dx, dy, e0;
+
+  // Minor-axis steps taken before pixel k
+  int32_t steps(int32_t k) const { return k * dy > e0 ? (k * dy - e0 + dx - 1) / dx : 0; }
+  // First pixel k that has taken at least m minor steps
+  int32_t firstWith(int32_t m) const { return m <= 0 ? 0 : ((m - 1) * dx + e0) / dy + 1; }
+};
+
+template <class Op>
+void drawLineOp(uint8_t *buf, int16_t w, int16_t h, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    int32_t t = x0; x0 = y0; y0 = t;
+    t = x1; x1 = y1; y1 = t;
+  }
+  if (x0 > x1) {
+    int32_t t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+  Line l = {x1 - x0, abs(y1 - y0), (x1 - x0) / 2};
+  int32_t ystep = y0 < y1 ? 1 : -1;
+  int32_t majorEnd = steep ? h : w, minorEnd = steep ? w : h;
+
+  // Visible range of k: major axis on screen, then minor axis on screen
+  int32_t kLo = x0 < 0 ? -x0 : 0;
+  int32_t kHi = (x1 < majorEnd ? x1 : majorEnd - 1) - x0;
+  int32_t mLo = ystep > 0 ? -y0 : y0 - minorEnd + 1;
+  int32_t mHi = ystep > 0 ? minorEnd - 1 - y0 : y0;
+  if (mHi < 0) return;
+  int32_t k = l.firstWith(mLo);
+  if (k > kLo) kLo = k;
+  k = l.firstWith(mHi + 1) - 1;
+  if (k < kHi) kHi = k;
+  if (kLo > kHi) return;
+
+  int32_t m = l.steps(kLo);
+  int32_t y = y0 + ystep * m;
+  int32_t err = l.e0 - kLo * l.dy + m * l.dx;
+  int32_t x = x0 + kLo, xEnd = x0 + kHi;
+
+  if (!steep) {
+    // Pixel (x, y): one bit per column
+    for (; x <= xEnd; x++) {
+      Op::byte(buf[(y >> 3) * w + x], 1 << (y & 7));
+      err -= l.dy;
+      if (err < 0) {
+        y += ystep;
+        err += l.dx;
+      }
+    }
+    return;
+  }
+  // Pixel (y, x): screen row x advances every step, collect the bits of
+  // one column within one page and store them together
+  uint8_t bits = 0;
+  for (; x <= xEnd; x++) {
+    bits |= 1 << (x & 7);
+    err -= l.dy;
+    bool moved = err < 0;
+    if (moved || (x & 7) == 7 || x == xEnd) {
+      Op::byte(buf[(x >> 3) * w + y], bits);
+      bits = 0;
+    }
+    if (moved) {
+      y += ystep;
+      err += l.dx;
+    }
+  }
+}
+
+template <class Op, bool CLIP>
+void drawCircleOp(uint8_t *buf, int16_t w, int16_t h, int16_t x0, int16_t y0, int16_t r) {
+  auto plot = [=](int16_t x, int16_t y) {
+    if (CLIP && (x < 0 || x >= w || y < 0 || y >= h)) return;
+    Op::byte(buf[(y >> 3) * w + x], 1 << (y & 7));
+  };
+  int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+  plot(x0, y0 + r);
+  plot(x0, y0 - r);
+  plot(x0 + r, y0);
+  plot(x0 - r, y0);
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    plot(x0 + x, y0 + y);
+    plot(x0 - x, y0 + y);
+    plot(x0 + x, y0 - y);
+    plot(x0 - x, y0 - y);
+    plot(x0 + y, y0 + x);
+    plot(x0 - y, y0 + x);
+    plot(x0 + y, y0 - x);
+    plot(x0 - y, y0 - x);
+  }
+}
+
+// Disc from fillCircle()'s table, page by page: the columns covering
+// every row of the page are one word-wide span, only the ragged columns
+// outside it need a mask of their own. Each pixel is written once, so
+// XorOp gives INVERSE.
+template <class Op>
+void fillDisc(uint8_t *buf, int16_t w, int16_t h, int16_t x0, int16_t y0, int16_t r, const int8_t *half) {
+  int16_t top = y0 - r < 0 ? 0 : y0 - r, bottom = y0 + r >= h ? h - 1 : y0 + r;
+  for (int16_t page = top >> 3; page <= bottom >> 3; page++) {
+    int16_t lo = page * 8 < top ? top : page * 8;
+    int16_t hi = page * 8 + 7 > bottom ? bottom : page * 8 + 7;
+    int16_t far = abs(lo - y0) > abs(hi - y0) ? abs(lo - y0) : abs(hi - y0);
+    int16_t near = lo > y0 ? lo - y0 : hi < y0 ? y0 - hi : 0;
+    int16_t inner = half[far], outer = half[near];   // the disc is its own transpose
+    uint8_t *row = buf + page * w;
+
+    int16_t a = x0 - inner < 0 ? 0 : x0 - inner, b = x0 + inner >= w ? w - 1 : x0 + inner;
+    if (a <= b) span<Op>(row + a, b - a + 1, rowMask(lo & 7, hi & 7));
+    for (int16_t dx = inner + 1; dx <= outer; dx++) {
+      int16_t rl = y0 - half[dx] > lo ? y0 - half[dx] : lo;
+      int16_t rh = y0 + half[dx] < hi ? y0 + half[dx] : hi;
+      uint8_t mask = rowMask(rl & 7, rh & 7);
+      if (x0 + dx >= 0 && x0 + dx < w) Op::byte(row[x0 + dx], mask);
+      if (x0 - dx >= 0 && x0 - dx < w) Op::byte(row[x0 - dx], mask);
+    }
+  }
+}
+
+}  // namespace
+
+void SpanRaster::begin(uint8_t *buffer, int16_t width, int16_t height) {
+  _buf = buffer;
+  _w = width;
+  _h = height;
+}
+
+void SpanRaster::pageSpan(uint8_t page, int16_t x0, int16_t x1, uint8_t mask, uint8_t color) {
+  uint8_t *p = _buf + page * _w + x0;
+  int16_t n = x1 - x0 + 1;
+  switch (color) {
+    case SET: span<OrOp>(p, n, mask); break;
+    case CLEAR: span<ClearOp>(p, n, mask); break;
+    case FLIP: span<XorOp>(p, n, mask); break;
+  }
+}
+
+// Column x, rows y0..y1, all on screen
+void SpanRaster::columnSpan(int16_t x, int16_t y0, int16_t y1, uint8_t color) {
+  uint8_t *p = _buf + (y0 >> 3) * _w + x;
+  for (int16_t page = y0 >> 3; page <= y1 >> 3; page++, p += _w) {
+    uint8_t mask = rowMask(page == y0 >> 3 ? y0 & 7 : 0, page == y1 >> 3 ? y1 & 7 : 7);
+    switch (color) {
+      case SET: *p |= mask; break;
+      case CLEAR: *p &= ~mask; break;
+      case FLIP: *p ^= mask; break;
+    }
+  }
+}
+
+void SpanRaster::drawPixel(int16_t x, int16_t y, uint8_t color) {
+  if (x < 0 || x >= _w || y < 0 || y >= _h) return;
+  columnSpan(x, y, y, color);
+}
+
+void SpanRaster::drawFastHLine(int16_t x, int16_t y, int16_t w, uint8_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void SpanRaster::drawFastVLine(int16_t x, int16_t y, int16_t h, uint8_t color) {
+  if (x < 0 || x >= _w || h <= 0) return;
+  int16_t y1 = y + h - 1;
+  if (y < 0) y = 0;
+  if (y1 >= _h) y1 = _h - 1;
+  if (y <= y1) columnSpan(x, y, y1, color);
+}
+
+void SpanRaster::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t color) {
+  if (w <= 0 || h <= 0) return;
+  int16_t x1 = x + w - 1, y1 = y + h - 1;
+  if (x < 0) x = 0;
+  if (y < 0) y = 0;
+  if (x1 >= _w) x1 = _w - 1;
+  if (y1 >= _h) y1 = _h - 1;
+  if (x > x1 || y > y1) return;
+  for (int16_t page = y >> 3; page <= y1 >> 3; page++)
+    pageSpan(page, x, x1, rowMask(page == y >> 3 ? y & 7 : 0, page == y1 >> 3 ? y1 & 7 : 7), color);
+}
+
+void SpanRaster::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color) {
+  // Same split as Adafruit_GFX::drawLine()
+  if (x0 == x1) {
+    if (y0 > y1) drawFastVLine(x0, y1, y0 - y1 + 1, color);
+    else drawFastVLine(x0, y0, y1 - y0 + 1, color);
+    return;
+  }
+  if (y0 == y1) {
+    if (x0 > x1) drawFastHLine(x1, y0, x0 - x1 + 1, color);
+    else drawFastHLine(x0, y0, x1 - x0 + 1, color);
+    return;
+  }
+  switch (color) {
+    case SET: drawLineOp<OrOp>(_buf, _w, _h, x0, y0, x1, y1); break;
+    case CLEAR: drawLineOp<ClearOp>(_buf, _w, _h, x0, y0, x1, y1); break;
+    case FLIP: drawLineOp<XorOp>(_buf, _w, _h, x0, y0, x1, y1); break;
+  }
+}
+
+void SpanRaster::drawCircle(int16_t x0, int16_t y0, int16_t r, uint8_t color) {
+  bool inside = r >= 0 && x0 - r >= 0 && x0 + r < _w && y0 - r >= 0 && y0 + r < _h;
+  switch (color) {
+    case SET:
+      inside ? drawCircleOp<OrOp, false>(_buf, _w, _h, x0, y0, r) : drawCircleOp<OrOp, true>(_buf, _w, _h, x0, y0, r);
+      break;
+    case CLEAR:
+      inside ? drawCircleOp<ClearOp, false>(_buf, _w, _h, x0, y0, r)
+             : drawCircleOp<ClearOp, true>(_buf, _w, _h, x0, y0, r);
+      break;
+    case FLIP:
+      inside ? drawCircleOp<XorOp, false>(_buf, _w, _h, x0, y0, r) : drawCircleOp<XorOp, true>(_buf, _w, _h, x0, y0, r);
+      break;
+  }
+}
+
+void SpanRaster::fillCircle(int16_t x0, int16_t y0, int16_t r, uint8_t color) {
+  // Adafruit_GFX::fillCircle() is a centre column plus the column pairs
+  // its midpoint loop emits, all centred on y0: column x0 +- dx is covered
+  // y0-half[dx] .. y0+half[dx]. Up to MAX_FILL_RADIUS the loop emits every
+  // column 0..r exactly once, and the covered set is symmetric about the
+  // diagonal, so half[dy] is also the half width of row y0 +- dy (both
+  // checked for every such r). One emission per column also means INVERSE
+  // flips exactly the disc. Huge radii go column by column, as GFX does.
+  if (r < 0) return;
+  int8_t half[MAX_FILL_RADIUS + 1];
+  bool byColumn = r > MAX_FILL_RADIUS;
+  auto emit = [&](int16_t dx, int16_t hh) {
+    if (!byColumn) {
+      half[dx] = (int8_t)hh;
+      return;
+    }
+    drawFastVLine(x0 + dx, y0 - hh, 2 * hh + 1, color);
+    if (dx) drawFastVLine(x0 - dx, y0 - hh, 2 * hh + 1, color);
+  };
+
+  emit(0, r);
+  int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r, px = x, py = y;
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (x < y + 1) emit(x, y);
+    if (y != py) {
+      emit(py, px);
+      py = y;
+    }
+    px = x;
+  }
+  if (byColumn) return;
+
+  switch (color) {
+    case SET: fillDisc<OrOp>(_buf, _w, _h, x0, y0, r, half); break;
+    case CLEAR: fillDisc<ClearOp>(_buf, _w, _h, x0, y0, r, half); break;
+    case FLIP: fillDisc<XorOp>(_buf, _w, _h, x0, y0, r, half); break;
+  }
+}
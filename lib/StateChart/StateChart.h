@@ -0,0 +1,262 @@
+// StateChart: hierarchical state machines from constexpr tables
+//
+// A chart is two constexpr arrays: the states (parent, initial child,
+// entry / exit action) and the transitions (source state, event, target,
+// action). A transition on a parent state applies to all its descendants
+// unless one of them handles the event itself.
+//
+//   static constexpr SmState STATES[] = {
+//     {SM_NONE, S_IDLE, nullptr, nullptr},      // 0 = the root
+//     {S_ROOT, SM_NONE, enterIdle, nullptr},    // S_IDLE
+//     {S_ROOT, SM_NONE, enterBusy, leaveBusy},  // S_BUSY
+//   };
+//   static constexpr SmTransition TRANSITIONS[] = {
+//     {S_IDLE, EV_GO, S_BUSY, nullptr},
+//     {S_BUSY, EV_GO, SM_INTERNAL, again},      // action only, no exit / entry
+//     {S_ROOT, EV_STOP, S_IDLE, nullptr},       // from any state
+//   };
+//   static constexpr StateChart CHART = makeChart(STATES, TRANSITIONS, EV_COUNT);
+//   static_assert(smWellFormed(CHART) && smComplete(CHART) && smReachable(CHART), "chart");
+//   StateMachine<CHART> machine;               // machine.begin(), machine.dispatch(EV_GO)
+//
+// Checked at compile time, each by its own constexpr function:
+//   smWellFormed  parents come before their children (state 0 is the root),
+//                 every state with children names one of them as initial,
+//                 indices are in range, no state handles an event twice
+//   smComplete    every leaf state handles every event, itself or through
+//                 an ancestor (SM_IGNORE marks an event as deliberately
+//                 dropped)
+//   smReachable   every leaf can be reached from the initial state
+//
+// Dispatch looks the transition up in a [leaf][event] table the compiler
+// builds from the chart, so finding the handler is one load whatever the
+// depth; only the exit / entry actions along the way walk the hierarchy.
+// Nothing runs between events.
+//
+// UML order for an external transition: exit actions from the current leaf
+// up to (not including) the common ancestor of source and target, the
+// transition action, then entry actions down to the target and on through
+// initial children to a leaf. in() already reports a state inside its own
+// entry action and still reports it inside its exit action.
+//
+// Pure code (no Arduino headers); at most 32 states and 255 transitions.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t SM_NONE = 0xFF;       // no parent / no initial child / not handled
+static const uint8_t SM_INTERNAL = 0xFE;   // target: run the action, stay in the state
+static const uint8_t SM_IGNORE = 0xFD;     // target: event handled by doing nothing
+static const uint8_t SM_MAX_STATES = 32;
+
+typedef void (*SmAction)();
+
+struct SmState {
+  uint8_t parent;
+  uint8_t initial;     // child entered with this state, SM_NONE for a leaf
+  SmAction entry;
+  SmAction exit;
+};
+
+struct SmTransition {
+  uint8_t from;
+  uint8_t event;
+  uint8_t to;          // a state, SM_INTERNAL or SM_IGNORE
+  SmAction action;
+};
+
+struct StateChart {
+  const SmState *states;
+  uint8_t stateCount;
+  const SmTransition *transitions;
+  uint8_t transitionCount;
+  uint8_t eventCount;
+};
+
+template <size_t NS, size_t NT>
+constexpr StateChart makeChart(const SmState (&states)[NS], const SmTransition (&transitions)[NT],
+                               uint8_t eventCount) {
+  static_assert(NS <= SM_MAX_STATES, "StateChart: at most 32 states");
+  static_assert(NT < SM_IGNORE, "StateChart: too many transitions");
+  return StateChart{states, (uint8_t)NS, transitions, (uint8_t)NT, eventCount};
+}
+
+// ---- Compile-time helpers (C++11 constexpr: recursion instead of loops) ----
+
+constexpr bool smIsLeaf(const StateChart &c, uint8_t s) { return c.states[s].initial == SM_NONE; }
+
+// s is a, or a descendant of a
+constexpr bool smIsUnder(const StateChart &c, uint8_t s, uint8_t a) {
+  return s == a ? true : s == SM_NONE ? false : smIsUnder(c, c.states[s].parent, a);
+}
+
+// The leaf entered when s is the target: s, then initial children
+constexpr uint8_t smLeaf(const StateChart &c, uint8_t s) {
+  return smIsLeaf(c, s) ? s : smLeaf(c, c.states[s].initial);
+}
+
+constexpr uint8_t smFind(const StateChart &c, uint8_t s, uint8_t e, uint8_t i = 0) {
+  return i >= c.transitionCount ? SM_NONE
+         : c.transitions[i].from == s && c.transitions[i].event == e ? i
+                                                                      : smFind(c, s, e, i + 1);
+}
+
+// Transition that handles event e in state s: its own, else the nearest ancestor's
+constexpr uint8_t smResolve(const StateChart &c, uint8_t s, uint8_t e) {
+  return s == SM_NONE ? SM_NONE
+         : smFind(c, s, e) != SM_NONE ? smFind(c, s, e)
+                                      : smResolve(c, c.states[s].parent, e);
+}
+
+constexpr bool smHasChild(const StateChart &c, uint8_t s, uint8_t i = 0) {
+  return i >= c.stateCount ? false : c.states[i].parent == s ? true : smHasChild(c, s, i + 1);
+}
+
+constexpr bool smStateOk(const StateChart &c, uint8_t i) {
+  return (i == 0 ? c.states[0].parent == SM_NONE : c.states[i].parent < i) &&
+         (c.states[i].initial == SM_NONE
+              ? !smHasChild(c, i)
+              : c.states[i].initial < c.stateCount && c.states[c.states[i].initial].parent == i);
+}
+
+constexpr bool smTransitionOk(const StateChart &c, uint8_t i) {
+  return c.transitions[i].from < c.stateCount && c.transitions[i].event < c.eventCount &&
+         (c.transitions[i].to < c.stateCount || c.transitions[i].to == SM_INTERNAL ||
+          c.transitions[i].to == SM_IGNORE) &&
+         smFind(c, c.transitions[i].from, c.transitions[i].event) == i;   // no earlier duplicate
+}
+
+constexpr bool smStatesOk(const StateChart &c, uint8_t i = 0) {
+  return i >= c.stateCount ? true : smStateOk(c, i) && smStatesOk(c, i + 1);
+}
+
+constexpr bool smTransitionsOk(const StateChart &c, uint8_t i = 0) {
+  return i >= c.transitionCount ? true : smTransitionOk(c, i) && smTransitionsOk(c, i + 1);
+}
+
+constexpr bool smWellFormed(const StateChart &c) {
+  return c.stateCount > 0 && c.eventCount > 0 && smStatesOk(c) && smTransitionsOk(c);
+}
+
+constexpr bool smCellHandled(const StateChart &c, uint16_t cell) {
+  return !smIsLeaf(c, (uint8_t)(cell / c.eventCount)) ||
+         smResolve(c, (uint8_t)(cell / c.eventCount), (uint8_t)(cell % c.eventCount)) != SM_NONE;
+}
+
+constexpr bool smComplete(const StateChart &c, uint16_t cell = 0) {
+  return cell >= (uint16_t)c.stateCount * c.eventCount ? true
+                                                        : smCellHandled(c, cell) && smComplete(c, cell + 1);
+}
+
+// Reachability over leaves as a bit mask: a transition whose source has a
+// reachable leaf under it makes its target's leaf reachable. Iterated once
+// per state, which is enough for the longest path.
+constexpr bool smAnyUnder(const StateChart &c, uint32_t mask, uint8_t a, uint8_t i = 0) {
+  return i >= c.stateCount ? false : ((mask >> i) & 1 && smIsUnder(c, i, a)) || smAnyUnder(c, mask, a, i + 1);
+}
+
+constexpr uint32_t smStep(const StateChart &c, uint32_t mask, uint8_t i = 0) {
+  return i >= c.transitionCount ? mask
+         : smStep(c,
+                  c.transitions[i].to < c.stateCount && smAnyUnder(c, mask, c.transitions[i].from)
+                      ? mask | 1u << smLeaf(c, c.transitions[i].to)
+                      : mask,
+                  i + 1);
+}
+
+constexpr uint32_t smReachMask(const StateChart &c, uint32_t mask, uint8_t rounds) {
+  return rounds == 0 ? mask : smReachMask(c, smStep(c, mask), rounds - 1);
+}
+
+constexpr bool smLeavesIn(const StateChart &c, uint32_t mask, uint8_t i = 0) {
+  return i >= c.stateCount ? true : (!smIsLeaf(c, i) || (mask >> i) & 1) && smLeavesIn(c, mask, i + 1);
+}
+
+constexpr bool smReachable(const StateChart &c) {
+  return smLeavesIn(c, smReachMask(c, 1u << smLeaf(c, 0), c.stateCount));
+}
+
+// ---- [leaf][event] -> transition table, built by the compiler ----
+
+template <uint16_t... I>
+struct SmSeq {};
+template <uint16_t N, uint16_t... I>
+struct SmMakeSeq : SmMakeSeq<N - 1, N - 1, I...> {};
+template <uint16_t... I>
+struct SmMakeSeq<0, I...> {
+  typedef SmSeq<I...> type;
+};
+
+template <const StateChart &C, typename Seq>
+struct SmLookup;
+
+template <const StateChart &C, uint16_t... I>
+struct SmLookup<C, SmSeq<I...>> {
+  static constexpr uint8_t cell[sizeof...(I)] = {
+      smResolve(C, (uint8_t)(I / C.eventCount), (uint8_t)(I % C.eventCount))...};
+};
+
+template <const StateChart &C, uint16_t... I>
+constexpr uint8_t SmLookup<C, SmSeq<I...>>::cell[sizeof...(I)];
+
+template <const StateChart &C>
+class StateMachine {
+  typedef SmLookup<C, typename SmMakeSeq<(uint16_t)C.stateCount * C.eventCount>::type> Lookup;
+
+public:
+  // Enters the root and its initial children, running their entry actions
+  void begin() { enter(0); }
+
+  // Returns false if no state handles the event (never for a chart that
+  // passes smComplete()). Must not be called from inside an action.
+  bool dispatch(uint8_t event) {
+    if (event >= C.eventCount || _state == SM_NONE) return false;
+    uint8_t i = Lookup::cell[_state * C.eventCount + event];
+    if (i == SM_NONE) return false;
+    const SmTransition &t = C.transitions[i];
+    if (t.to == SM_IGNORE) return true;
+    if (t.to == SM_INTERNAL) {
+      if (t.action) t.action();
+      return true;
+    }
+    // Leave up to the common ancestor; a transition to the source itself
+    // or to one of its ancestors leaves that state too
+    uint8_t top = t.from;
+    while (!smIsUnder(C, t.to, top) || top == t.to) top = C.states[top].parent;
+    while (_state != top) {
+      if (C.states[_state].exit) C.states[_state].exit();
+      _state = C.states[_state].parent;
+    }
+    if (t.action) t.action();
+    enterBelow(top, t.to);
+    return true;
+  }
+
+  uint8_t state() const { return _state; }   // current leaf
+  bool in(uint8_t s) const { return _state != SM_NONE && smIsUnder(C, _state, s); }
+
+private:
+  void enterState(uint8_t s) {
+    _state = s;
+    if (C.states[s].entry) C.states[s].entry();
+  }
+  // Enter the states from below `top` down to s, then s's initial children
+  void enterBelow(uint8_t top, uint8_t s) {
+    enterPath(top, s);
+    enter(SM_NONE);
+  }
+  void enterPath(uint8_t top, uint8_t s) {
+    if (s == top) return;
+    enterPath(top, C.states[s].parent);
+    enterState(s);
+  }
+  // s = SM_NONE: continue from the current state into its initial children
+  void enter(uint8_t s) {
+    if (s != SM_NONE) enterPath(SM_NONE, s);
+    while (C.states[_state].initial != SM_NONE) enterState(C.states[_state].initial);
+  }
+
+  uint8_t _state = SM_NONE;
+};
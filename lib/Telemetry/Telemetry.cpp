@@ -0,0 +1,82 @@
+#include "Telemetry.h"
+
+using namespace TelemetryCodec;
+
+bool Telemetry::channel(uint8_t id, const char *name, uint8_t decimals) {
+  if (_nChannels >= MAX_CHANNELS) return false;
+  _channels[_nChannels++] = {id, decimals, name};
+  return true;
+}
+
+void Telemetry::begin() {
+  sendChannels();
+}
+
+void Telemetry::add(uint8_t id, int32_t value, uint32_t ms) {
+  // Out of room, or time went backwards (deltas are unsigned): start over
+  if (_len && (_len + MAX_RECORD > MAX_PAYLOAD || (int32_t)(ms - _tLast) < 0)) flush();
+  if (!_len) {
+    _buf[0] = FRAME_DATA;
+    _buf[1] = _seq;
+    for (uint8_t i = 0; i < 4; i++) _buf[2 + i] = (uint8_t)(ms >> (8 * i));
+    _len = DATA_HEADER;
+    _t0 = _tLast = ms;
+  }
+  _buf[_len++] = id;
+  _len += putVarint(_buf + _len, ms - _tLast);
+  _len += putVarint(_buf + _len, zigzag(value));
+  _tLast = ms;
+  _pending++;
+}
+
+void Telemetry::poll() {
+  uint32_t now = millis();
+  if (_len && now - _t0 >= _flushMs) flush();
+  if (now - _lastChannelsMs >= CHANNELS_EVERY_MS) sendChannels();
+}
+
+void Telemetry::flush() {
+  if (!_len) return;
+  send(_buf, _len);
+  _records += _pending;
+  _seq++;
+  _len = 0;
+  _pending = 0;
+}
+
+void Telemetry::sendChannels() {
+  uint8_t p[MAX_PAYLOAD];
+  uint8_t n = 2, count = 0;
+  p[0] = FRAME_CHANNELS;
+  for (uint8_t i = 0; i < _nChannels; i++) {
+    uint8_t len = (uint8_t)strnlen(_channels[i].name, 32);
+    if (n + 3 + len > MAX_PAYLOAD) break;
+    p[n++] = _channels[i].id;
+    p[n++] = _channels[i].decimals;
+    p[n++] = len;
+    memcpy(p + n, _channels[i].name, len);
+    n += len;
+    count++;
+  }
+  p[1] = count;
+  send(p, n);
+  _lastChannelsMs = millis();
+}
+
+void Telemetry::send(const uint8_t *payload, uint8_t n) {
+  uint8_t raw[MAX_PAYLOAD + CRC_BYTES];
+  memcpy(raw, payload, n);
+  uint16_t crc = crc16(payload, n);
+  raw[n] = (uint8_t)crc;
+  raw[n + 1] = (uint8_t)(crc >> 8);
+
+  // Leading delimiter too: anything printed since the last frame ends there
+  uint8_t wire[1 + MAX_PAYLOAD + CRC_BYTES + 2];
+  static_assert(sizeof(wire) <= 128, "a frame should fit the UART FIFO");
+  wire[0] = 0;
+  size_t len = 1 + cobsEncode(raw, n + CRC_BYTES, wire + 1);
+  wire[len++] = 0;
+  _out.write(wire, len);
+  _frames++;
+  _bytes += len;
+}
@@ -0,0 +1,76 @@
+// Telemetry: batched binary sensor records over a serial link
+//
+// Replaces "Temperature: 23.50 °C ..." text lines with fixed-point records
+// packed into COBS frames (format in TelemetryCodec.h). Records are
+// collected in a buffer and sent as one frame when it is full or
+// flushMs after its first record, so the framing cost is shared by the
+// whole batch. No floats, no printf, no heap.
+//
+//   Telemetry tm(Serial);
+//   tm.channel(CH_TEMP, "temp_c", 1);      // values in 0.1 degC
+//   tm.begin();                            // sends the channel table
+//   tm.add(CH_TEMP, reading.tempTenths);   // in loop(), whenever
+//   tm.poll();                             // sends a due frame
+//
+// Text logging on the same port still works between frames; the host
+// decoder (tools/telemetry_decode) passes those lines through to stderr.
+// A frame is kept under the 128-byte UART FIFO, so a write of one frame to
+// an idle port does not block.
+//
+// Cost: a full frame carries 26 small-valued records in 115 bytes, 4.4 bytes
+// per value, vs. ~46 bytes for the old two-value text line. At 8N1 that is
+// ~2600 values/s at 115200 baud and ~20800 values/s at 921600.
+
+#pragma once
+
+#include <Arduino.h>
+#include "TelemetryCodec.h"
+
+class Telemetry {
+public:
+  static const uint8_t MAX_CHANNELS = 8;
+  static const uint8_t MAX_PAYLOAD = 120;            // before CRC and COBS
+  static const uint32_t CHANNELS_EVERY_MS = 30000;   // resend the table for late listeners
+
+  explicit Telemetry(Print &out, uint16_t flushMs = 1000) : _out(out), _flushMs(flushMs) {}
+
+  // Declare a channel before begin(); `decimals` is the fixed-point scale
+  bool channel(uint8_t id, const char *name, uint8_t decimals);
+  void begin();
+
+  void add(uint8_t id, int32_t value) { add(id, value, millis()); }
+  void add(uint8_t id, int32_t value, uint32_t ms);
+  void poll();
+  void flush();
+
+  uint32_t framesSent() const { return _frames; }
+  uint32_t bytesSent() const { return _bytes; }      // on the wire, delimiters included
+  uint32_t recordsSent() const { return _records; }
+
+private:
+  struct Channel {
+    uint8_t id;
+    uint8_t decimals;
+    const char *name;
+  };
+
+  void sendChannels();
+  void send(const uint8_t *payload, uint8_t n);
+
+  Print &_out;
+  uint16_t _flushMs;
+  Channel _channels[MAX_CHANNELS];
+  uint8_t _nChannels = 0;
+  uint32_t _lastChannelsMs = 0;
+
+  uint8_t _buf[MAX_PAYLOAD];
+  uint8_t _len = 0;          // 0 = no frame open
+  uint8_t _pending = 0;      // records in the open frame
+  uint8_t _seq = 0;
+  uint32_t _t0 = 0;
+  uint32_t _tLast = 0;
+
+  uint32_t _frames = 0;
+  uint32_t _bytes = 0;
+  uint32_t _records = 0;
+};
@@ -0,0 +1,99 @@
+// TelemetryCodec: byte-level pieces of the binary telemetry format
+//
+// Pure code (no Arduino / IDF headers), shared by the device side
+// (Telemetry.h) and the host decoder in tools/telemetry_decode.
+//
+// On the wire every frame is  0x00  COBS(payload + CRC16)  0x00.
+// COBS removes all zero bytes from the frame, so 0x00 only ever appears as
+// a delimiter: a decoder can start anywhere, and plain-text log lines
+// printed between frames end up as chunks of their own that fail the CRC.
+//
+// Payload (multi-byte fields little endian):
+//   FRAME_DATA      type, seq, t0 (u32 ms), then records until the CRC:
+//                     channel (u8), dt (varint ms since the previous record,
+//                     the first one since t0), value (zigzag varint)
+//   FRAME_CHANNELS  type, count, then per channel:
+//                     id (u8), decimals (u8), name length (u8), name
+// Values are fixed point: the real value is value / 10^decimals.
+// The CRC is CRC-16/CCITT-FALSE over the payload.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace TelemetryCodec {
+
+enum FrameType : uint8_t { FRAME_DATA = 1, FRAME_CHANNELS = 2 };
+
+static const uint8_t DATA_HEADER = 6;     // type, seq, t0
+static const uint8_t CRC_BYTES = 2;
+static const uint8_t MAX_RECORD = 1 + 5 + 5;   // channel + two 32-bit varints
+
+inline uint16_t crc16(const uint8_t *p, size_t n, uint16_t crc = 0xFFFF) {
+  while (n--) {
+    crc ^= (uint16_t)*p++ << 8;
+    for (uint8_t b = 0; b < 8; b++) crc = crc & 0x8000 ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// 7 bits per byte, low group first, high bit set on all but the last byte
+inline uint8_t putVarint(uint8_t *p, uint32_t v) {
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+// Returns the bytes used, 0 if the varint runs past `end` or over 5 bytes
+inline uint8_t getVarint(const uint8_t *p, const uint8_t *end, uint32_t &v) {
+  v = 0;
+  for (uint8_t n = 0; n < 5 && p + n < end; n++) {
+    v |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+    if (!(p[n] & 0x80)) return n + 1;
+  }
+  return 0;
+}
+
+// Worst-case COBS output for n input bytes (no delimiter)
+inline size_t cobsMaxEncoded(size_t n) { return n + n / 254 + 1; }
+
+inline size_t cobsEncode(const uint8_t *in, size_t n, uint8_t *out) {
+  size_t code = 0, o = 1;
+  uint8_t run = 1;
+  for (size_t i = 0; i < n; i++) {
+    if (in[i]) {
+      out[o++] = in[i];
+      run++;
+    }
+    if (!in[i] || run == 0xFF) {
+      out[code] = run;
+      code = o++;
+      run = 1;
+    }
+  }
+  out[code] = run;
+  return o;
+}
+
+// Decodes one frame (delimiters already stripped). Returns the decoded
+// length, 0 for malformed input. `out` needs n bytes.
+inline size_t cobsDecode(const uint8_t *in, size_t n, uint8_t *out) {
+  size_t i = 0, o = 0;
+  while (i < n) {
+    uint8_t code = in[i++];
+    if (!code || i + code - 1 > n) return 0;
+    for (uint8_t k = 1; k < code; k++) out[o++] = in[i++];
+    if (code != 0xFF && i < n) out[o++] = 0;
+  }
+  return o;
+}
+
+}  // namespace TelemetryCodec
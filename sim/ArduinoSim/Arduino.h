@@ -0,0 +1,128 @@
+// ArduinoSim: the Arduino-ESP32 API on a simulated board for host builds
+//
+// Same names and signatures as the ESP32 Arduino core 2.x, backed by the
+// virtual clock in SimCore.h. Outputs are recorded (see sim::stats() and
+// SIM_TRACE), inputs come from the input script or sim::driveInput().
+//
+// Time: millis()/micros() read the virtual clock (each read costs 100 ns of
+// CPU time so busy-wait loops terminate), delay() lets it run.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "WString.h"
+#include "Print.h"
+#include "SimCore.h"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define ARDUINO_ISR_ATTR
+#define PROGMEM
+#define F(s) (s)
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+#define OPEN_DRAIN 0x10
+#define OUTPUT_OPEN_DRAIN 0x13
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define ONLOW 0x04
+#define ONHIGH 0x05
+
+#define NOT_AN_INTERRUPT -1
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef unsigned int word;
+
+// ---- Time ----
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// ---- GPIO ----
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+int8_t digitalPinToAnalogChannel(uint8_t pin);
+
+#define digitalPinToInterrupt(p) ((p) < 40 ? (p) : -1)
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+// ---- LEDC (channels 0-7 high speed, 8-15 low speed) ----
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+void ledcWrite(uint8_t channel, uint32_t duty);
+uint32_t ledcRead(uint8_t channel);
+uint32_t ledcWriteTone(uint8_t channel, uint32_t freq);
+uint32_t ledcReadFreq(uint8_t channel);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+// ---- Hardware timers (80 MHz APB clock / divider) ----
+struct hw_timer_s;
+typedef struct hw_timer_s hw_timer_t;
+hw_timer_t *timerBegin(uint8_t num, uint16_t divider, bool countUp);
+void timerEnd(hw_timer_t *timer);
+void timerStart(hw_timer_t *timer);
+void timerStop(hw_timer_t *timer);
+void timerAttachInterrupt(hw_timer_t *timer, void (*fn)(void), bool edge);
+void timerDetachInterrupt(hw_timer_t *timer);
+void timerAlarmWrite(hw_timer_t *timer, uint64_t alarmValue, bool autoreload);
+void timerAlarmEnable(hw_timer_t *timer);
+void timerAlarmDisable(hw_timer_t *timer);
+bool timerAlarmEnabled(hw_timer_t *timer);
+void timerWrite(hw_timer_t *timer, uint64_t value);
+uint64_t timerRead(hw_timer_t *timer);
+
+// ---- Misc ----
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+class EspClass {
+public:
+  uint32_t getCycleCount();     // 240 MHz CPU clock on the virtual timeline
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint32_t getFreeHeap() { return 300000; }
+  uint32_t getHeapSize() { return 327680; }
+  void restart();
+};
+extern EspClass ESP;
+
+#include "HardwareSerial.h"
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Print.h"
+
+// Host build: Serial writes to stdout (unless SIM_QUIET=1); nothing is ever received
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long baud, uint32_t config = 0, int8_t rx = -1, int8_t tx = -1) {
+    (void)config; (void)rx; (void)tx;
+    _baud = baud;
+  }
+  void end() {}
+  int available() { return 0; }
+  int read() { return -1; }
+  int peek() { return -1; }
+  void flush();
+  unsigned long baudRate() const { return _baud; }
+  operator bool() const { return true; }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t n) override;
+  using Print::write;
+
+private:
+  unsigned long _baud = 115200;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,523 @@
+// The simulated board: GPIO pads, ADC inputs, hardware timers, time
+// functions, Serial, and the Arduino String / Print implementations.
+
+#include "Arduino.h"
+#include "SimBoard.h"
+#include "soc/gpio_reg.h"
+
+#include <stdarg.h>
+
+namespace {
+
+struct Pad {
+  bool output = false;
+  bool openDrain = false;
+  bool pullup = false;
+  bool pulldown = false;
+  bool out = false;          // output latch
+  bool driven = false;       // something outside the chip drives the pad
+  bool drivenLevel = false;
+  void (*isr)() = nullptr;
+  int isrMode = 0;
+};
+
+Pad g_pads[sim::PIN_COUNT];
+uint16_t g_analog[sim::PIN_COUNT];
+
+bool padLevel(const Pad &p) {
+  if (p.output && !p.openDrain) return p.out;
+  if (p.output && p.openDrain && !p.out) return false;
+  if (p.driven) return p.drivenLevel;
+  return p.pullup;           // floating pads read low
+}
+
+// Call after anything that may change a pad's level
+void levelChanged(uint8_t pin, bool before) {
+  Pad &p = g_pads[pin];
+  bool now = padLevel(p);
+  if (now == before || !p.isr) return;
+  bool fire = false;
+  switch (p.isrMode) {
+    case RISING: fire = now; break;
+    case FALLING: fire = !now; break;
+    case CHANGE: fire = true; break;
+    case ONLOW: fire = !now; break;
+    case ONHIGH: fire = now; break;
+  }
+  if (fire) p.isr();
+}
+
+// Cost of reading the clock; keeps `while (millis() < t)` loops finite
+const uint64_t CLOCK_READ_NS = 100;
+
+}  // namespace
+
+namespace sim {
+
+void gpioDirection(uint8_t pin, bool output, bool openDrain) {
+  if (pin >= PIN_COUNT) return;
+  Pad &p = g_pads[pin];
+  bool before = padLevel(p);
+  p.output = output;
+  p.openDrain = openDrain;
+  levelChanged(pin, before);
+}
+
+void gpioPull(uint8_t pin, bool up, bool down) {
+  if (pin >= PIN_COUNT) return;
+  Pad &p = g_pads[pin];
+  bool before = padLevel(p);
+  p.pullup = up;
+  p.pulldown = down;
+  levelChanged(pin, before);
+}
+
+void gpioSet(uint8_t pin, bool level) {
+  if (pin >= PIN_COUNT) return;
+  Pad &p = g_pads[pin];
+  if (p.out == level) return;
+  bool before = padLevel(p);
+  p.out = level;
+  stats().gpioWrites++;
+  activity();
+  outputChanged(pin);
+  trace("gpio %u -> %d", pin, level);
+  levelChanged(pin, before);
+}
+
+bool gpioLevel(uint8_t pin) { return pin < PIN_COUNT && padLevel(g_pads[pin]); }
+
+uint16_t analogValue(uint8_t pin) { return pin < PIN_COUNT ? g_analog[pin] : 0; }
+
+void driveInput(uint8_t pin, bool level) {
+  if (pin >= PIN_COUNT) return;
+  Pad &p = g_pads[pin];
+  bool before = padLevel(p);
+  p.driven = true;
+  p.drivenLevel = level;
+  levelChanged(pin, before);
+}
+
+void releaseInput(uint8_t pin) {
+  if (pin >= PIN_COUNT) return;
+  Pad &p = g_pads[pin];
+  bool before = padLevel(p);
+  p.driven = false;
+  levelChanged(pin, before);
+}
+
+void setAnalog(uint8_t pin, uint16_t raw) {
+  if (pin < PIN_COUNT) g_analog[pin] = raw > 4095 ? 4095 : raw;
+}
+
+}  // namespace sim
+
+// ---- Time ----
+
+unsigned long millis() {
+  sim::busyNs(CLOCK_READ_NS);
+  return (unsigned long)(uint32_t)(sim::nowNs() / 1000000);
+}
+
+unsigned long micros() {
+  sim::busyNs(CLOCK_READ_NS);
+  return (unsigned long)(uint32_t)(sim::nowNs() / 1000);
+}
+
+void delay(uint32_t ms) { sim::sleepNs((uint64_t)ms * 1000000); }
+void delayMicroseconds(uint32_t us) { sim::spinNs((uint64_t)us * 1000); }
+void yield() {}
+
+// ---- GPIO ----
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  sim::gpioPull(pin, mode & PULLUP, mode & PULLDOWN);
+  sim::gpioDirection(pin, (mode & OUTPUT) == OUTPUT, mode & OPEN_DRAIN);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  sim::busyNs(50);
+  sim::gpioSet(pin, val != LOW);
+}
+
+int digitalRead(uint8_t pin) {
+  sim::busyNs(50);
+  return sim::gpioLevel(pin) ? HIGH : LOW;
+}
+
+uint32_t simRegRead(uint32_t reg) {
+  uint32_t v = 0;
+  if (reg == GPIO_IN_REG) {
+    for (uint8_t i = 0; i < 32; i++)
+      if (sim::gpioLevel(i)) v |= 1u << i;
+  } else if (reg == GPIO_IN1_REG) {
+    for (uint8_t i = 32; i < sim::PIN_COUNT; i++)
+      if (sim::gpioLevel(i)) v |= 1u << (i - 32);
+  } else if (reg == GPIO_OUT_REG) {
+    for (uint8_t i = 0; i < 32; i++)
+      if (g_pads[i].out) v |= 1u << i;
+  } else if (reg == GPIO_OUT1_REG) {
+    for (uint8_t i = 32; i < sim::PIN_COUNT; i++)
+      if (g_pads[i].out) v |= 1u << (i - 32);
+  }
+  return v;
+}
+
+// One store to a W1TS / W1TC register: every pin in `value` changes at the
+// same instant, for the price of one APB write
+void simRegWrite(uint32_t reg, uint32_t value) {
+  sim::busyNs(13);
+  uint8_t first = 0;
+  bool level;
+  if (reg == GPIO_OUT_W1TS_REG || reg == GPIO_OUT_W1TC_REG) {
+    level = reg == GPIO_OUT_W1TS_REG;
+  } else if (reg == GPIO_OUT1_W1TS_REG || reg == GPIO_OUT1_W1TC_REG) {
+    first = 32;
+    level = reg == GPIO_OUT1_W1TS_REG;
+  } else {
+    return;
+  }
+  for (uint8_t i = 0; i < 32 && first + i < sim::PIN_COUNT; i++)
+    if ((value >> i) & 1) sim::gpioSet(first + i, level);
+}
+
+int8_t digitalPinToAnalogChannel(uint8_t pin) {
+  switch (pin) {
+    case 36: return 0;
+    case 37: return 1;
+    case 38: return 2;
+    case 39: return 3;
+    case 32: return 4;
+    case 33: return 5;
+    case 34: return 6;
+    case 35: return 7;
+    // ADC2 channels numbered from 10, as in the Arduino core
+    case 4: return 10;
+    case 0: return 11;
+    case 2: return 12;
+    case 15: return 13;
+    case 13: return 14;
+    case 12: return 15;
+    case 14: return 16;
+    case 27: return 17;
+    case 25: return 18;
+    case 26: return 19;
+    default: return -1;
+  }
+}
+
+uint16_t analogRead(uint8_t pin) {
+  sim::busyNs(10000);        // one oneshot conversion is ~10 us
+  return sim::analogValue(pin);
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+  if (pin >= sim::PIN_COUNT) return;
+  g_pads[pin].isr = isr;
+  g_pads[pin].isrMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < sim::PIN_COUNT) g_pads[pin].isr = nullptr;
+}
+
+// ---- Hardware timers ----
+
+struct hw_timer_s {
+  uint8_t num;
+  uint16_t divider;
+  bool countUp;
+  bool running;
+  uint64_t base;             // counter value at baseNs
+  uint64_t baseNs;
+  uint64_t alarm;
+  bool autoreload;
+  bool alarmEnabled;
+  void (*isr)();
+  uint32_t event;
+};
+
+static hw_timer_s g_timers[4];
+
+// 80 MHz APB clock: one tick is divider x 12.5 ns
+static uint64_t tickPs(const hw_timer_s *t) { return (uint64_t)t->divider * 12500; }
+
+static uint64_t counterAt(const hw_timer_s *t, uint64_t ns) {
+  if (!t->running) return t->base;
+  uint64_t ticks = (ns - t->baseNs) * 1000 / tickPs(t);
+  return t->countUp ? t->base + ticks : t->base - ticks;
+}
+
+static void rebase(hw_timer_s *t) {
+  t->base = counterAt(t, sim::nowNs());
+  t->baseNs = sim::nowNs();
+}
+
+static void armAlarm(hw_timer_s *t);
+
+static void alarmEvent(void *arg, uint32_t) {
+  hw_timer_s *t = static_cast<hw_timer_s *>(arg);
+  t->event = 0;
+  if (t->autoreload) {
+    t->base = 0;
+    t->baseNs = sim::nowNs();
+  } else {
+    rebase(t);
+    t->alarmEnabled = false;   // the hardware clears the enable on a one-shot alarm
+  }
+  if (t->isr) t->isr();
+  armAlarm(t);
+}
+
+// (Re)schedule the next alarm after any change to the timer
+static void armAlarm(hw_timer_s *t) {
+  sim::cancel(t->event);
+  t->event = 0;
+  if (!t->running || !t->alarmEnabled || !t->isr) return;
+  uint64_t now = sim::nowNs();
+  uint64_t value = counterAt(t, now);
+  uint64_t ticks = t->countUp ? (t->alarm > value ? t->alarm - value : 0) : (value > t->alarm ? value - t->alarm : 0);
+  if (t->autoreload && ticks == 0) ticks = 1;
+  t->event = sim::schedule(now + ticks * tickPs(t) / 1000, alarmEvent, t);
+}
+
+hw_timer_t *timerBegin(uint8_t num, uint16_t divider, bool countUp) {
+  if (num >= 4) return nullptr;
+  hw_timer_s *t = &g_timers[num];
+  sim::cancel(t->event);
+  *t = hw_timer_s();
+  t->num = num;
+  t->divider = divider < 2 ? 2 : divider;
+  t->countUp = countUp;
+  t->running = true;
+  t->baseNs = sim::nowNs();
+  return t;
+}
+
+void timerEnd(hw_timer_t *t) {
+  timerStop(t);
+  timerDetachInterrupt(t);
+}
+
+void timerStart(hw_timer_t *t) {
+  if (t->running) return;
+  t->running = true;
+  t->baseNs = sim::nowNs();
+  armAlarm(t);
+}
+
+void timerStop(hw_timer_t *t) {
+  rebase(t);
+  t->running = false;
+  armAlarm(t);
+}
+
+void timerAttachInterrupt(hw_timer_t *t, void (*fn)(void), bool) {
+  t->isr = fn;
+  armAlarm(t);
+}
+
+void timerDetachInterrupt(hw_timer_t *t) {
+  t->isr = nullptr;
+  armAlarm(t);
+}
+
+void timerAlarmWrite(hw_timer_t *t, uint64_t alarmValue, bool autoreload) {
+  t->alarm = alarmValue;
+  t->autoreload = autoreload;
+  armAlarm(t);
+}
+
+void timerAlarmEnable(hw_timer_t *t) {
+  t->alarmEnabled = true;
+  armAlarm(t);
+}
+
+void timerAlarmDisable(hw_timer_t *t) {
+  t->alarmEnabled = false;
+  armAlarm(t);
+}
+
+bool timerAlarmEnabled(hw_timer_t *t) { return t->alarmEnabled; }
+
+void timerWrite(hw_timer_t *t, uint64_t value) {
+  t->base = value;
+  t->baseNs = sim::nowNs();
+  armAlarm(t);
+}
+
+uint64_t timerRead(hw_timer_t *t) { return counterAt(t, sim::nowNs()); }
+
+// ---- Misc ----
+
+static uint32_t g_seed = 1;
+
+long random(long max) {
+  if (max <= 0) return 0;
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (long)((g_seed >> 1) % (uint32_t)max);
+}
+
+long random(long min, long max) { return min >= max ? min : min + random(max - min); }
+void randomSeed(unsigned long seed) { g_seed = (uint32_t)seed; }
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount() { return (uint32_t)(sim::nowNs() * 240 / 1000); }
+
+void EspClass::restart() {
+  fflush(stdout);
+  fprintf(stderr, "sim: ESP.restart() at %.3f s\n", sim::nowNs() / 1e9);
+  exit(0);
+}
+
+// ---- Serial ----
+//
+// The UART sends 10 bits per byte at the configured baud rate from a
+// 128-byte FIFO; write() only costs CPU time once the FIFO is full, as with
+// the Arduino core's default of no TX ring buffer.
+
+HardwareSerial Serial;
+
+static const uint32_t UART_FIFO = 128;
+static uint64_t g_txFreeNs = 0;   // when the last queued byte leaves the pin
+
+static bool serialQuiet() {
+  static int quiet = -1;
+  if (quiet < 0) {
+    const char *q = getenv("SIM_QUIET");
+    quiet = q && atoi(q);
+  }
+  return quiet;
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t n) {
+  if (!n) return 0;
+  uint64_t byteNs = 10000000000ULL / (_baud ? _baud : 115200);
+  uint64_t now = sim::nowNs();
+  if (g_txFreeNs < now) g_txFreeNs = now;
+  g_txFreeNs += n * byteNs;
+  uint64_t queued = g_txFreeNs - now;
+  if (queued > UART_FIFO * byteNs) sim::busyNs(queued - UART_FIFO * byteNs);
+
+  sim::stats().serialBytes += n;
+  sim::activity();
+  if (!serialQuiet()) fwrite(buf, 1, n, stdout);
+  return n;
+}
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+void HardwareSerial::flush() {
+  uint64_t now = sim::nowNs();
+  if (g_txFreeNs > now) sim::busyNs(g_txFreeNs - now);
+  if (!serialQuiet()) fflush(stdout);
+}
+
+// ---- String ----
+
+std::string String::num(long long v, unsigned char base) {
+  if (base == 10 && v < 0) return "-" + num((unsigned long long)-v, base, true);
+  // Other bases print the 32-bit two's complement, like the ESP32 core
+  if (base != 10 && v < 0 && v >= INT32_MIN) return num((unsigned long long)(uint32_t)v, base, true);
+  return num((unsigned long long)v, base, true);
+}
+
+std::string String::num(unsigned long long v, unsigned char base, bool) {
+  if (base < 2 || base > 36) base = 10;
+  char buf[66];
+  char *p = buf + sizeof(buf) - 1;
+  *p = 0;
+  do {
+    unsigned d = (unsigned)(v % base);
+    *--p = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+    v /= base;
+  } while (v);
+  return p;
+}
+
+std::string String::fixed(double v, unsigned char decimals) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+  return buf;
+}
+
+void String::trim() {
+  size_t a = _s.find_first_not_of(" \t\r\n\f\v");
+  if (a == std::string::npos) {
+    _s.clear();
+    return;
+  }
+  size_t b = _s.find_last_not_of(" \t\r\n\f\v");
+  _s = _s.substr(a, b - a + 1);
+}
+
+void String::toUpperCase() {
+  for (char &c : _s)
+    if (c >= 'a' && c <= 'z') c -= 32;
+}
+
+void String::toLowerCase() {
+  for (char &c : _s)
+    if (c >= 'A' && c <= 'Z') c += 32;
+}
+
+// ---- Print ----
+
+size_t Print::printNumber(unsigned long long v, int base) {
+  if (base == 0) return write((uint8_t)v);
+  return print(String((unsigned long)v, (unsigned char)base));
+}
+
+size_t Print::printSigned(long long v, int base) {
+  if (base == 0) return write((uint8_t)v);
+  return print(String((long)v, (unsigned char)base));
+}
+
+// Same rounding and nan/inf handling as Print::printFloat in the core
+size_t Print::print(double v, int digits) {
+  if (isnan(v)) return print("nan");
+  if (isinf(v)) return print("inf");
+  if (v > 4294967040.0 || v < -4294967040.0) return print("ovf");
+
+  size_t n = 0;
+  if (v < 0.0) {
+    n += print('-');
+    v = -v;
+  }
+  double rounding = 0.5;
+  for (int i = 0; i < digits; i++) rounding /= 10.0;
+  v += rounding;
+
+  unsigned long whole = (unsigned long)v;
+  double rest = v - (double)whole;
+  n += print(whole);
+  if (digits > 0) n += print('.');
+  while (digits-- > 0) {
+    rest *= 10.0;
+    unsigned int d = (unsigned int)rest;
+    n += print(d);
+    rest -= d;
+  }
+  return n;
+}
+
+size_t Print::printf(const char *fmt, ...) {
+  char small[128];
+  va_list ap;
+  va_start(ap, fmt);
+  int len = vsnprintf(small, sizeof(small), fmt, ap);
+  va_end(ap);
+  if (len < 0) return 0;
+  if ((size_t)len < sizeof(small)) return write((const uint8_t *)small, len);
+
+  std::string big(len + 1, '\0');
+  va_start(ap, fmt);
+  vsnprintf(&big[0], big.size(), fmt, ap);
+  va_end(ap);
+  return write((const uint8_t *)big.data(), len);
+}
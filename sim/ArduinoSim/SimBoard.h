@@ -0,0 +1,18 @@
+// Internal interface between the parts of the simulated board (not for sketches)
+
+#pragma once
+
+#include <stdint.h>
+
+namespace sim {
+
+static const uint8_t PIN_COUNT = 40;
+
+// Pad configuration and output latch, as set by pinMode() / gpio_set_*()
+void gpioDirection(uint8_t pin, bool output, bool openDrain);
+void gpioPull(uint8_t pin, bool up, bool down);
+void gpioSet(uint8_t pin, bool level);
+bool gpioLevel(uint8_t pin);            // what the pad reads right now
+uint16_t analogValue(uint8_t pin);      // last setAnalog(), 12 bits
+
+}  // namespace sim
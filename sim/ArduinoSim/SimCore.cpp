@@ -0,0 +1,292 @@
+#include "SimCore.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+
+void setup();
+void loop();
+
+namespace sim {
+
+// An idle loop() (no output, no delay) skips ahead at most this far, so
+// sketches that poll millis() still see every millisecond.
+static const uint64_t IDLE_STEP_NS = 1000000;
+
+struct Event {
+  uint64_t at;
+  uint32_t seq;         // FIFO among events due at the same time
+  uint32_t id;
+  EventFn fn;
+  void *arg;
+  uint32_t tag;
+  bool operator>(const Event &o) const { return at != o.at ? at > o.at : seq > o.seq; }
+};
+
+static uint64_t g_now = 0;
+static uint64_t g_end = UINT64_MAX;
+static std::vector<Event> g_heap;
+static std::unordered_set<uint32_t> g_cancelled;
+static uint32_t g_seq = 0;
+static uint32_t g_nextId = 1;
+static bool g_inEvent = false;
+static uint64_t g_activity = 0;
+static bool g_slept = false;
+static bool g_trace = false;
+static Stats g_stats;
+
+Stats &stats() { return g_stats; }
+bool tracing() { return g_trace; }
+
+void trace(const char *fmt, ...) {
+  if (!g_trace) return;
+  fprintf(stderr, "[%10.3f ms] ", nowNs() / 1e6);
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+  fputc('\n', stderr);
+}
+
+uint64_t nowNs() { return g_now + (inTask() ? taskOffsetNs() : 0); }
+uint64_t endNs() { return g_end; }
+
+void activity() { g_activity++; }
+
+uint32_t schedule(uint64_t atNs, EventFn fn, void *arg, uint32_t tag) {
+  Event e = {atNs, g_seq++, g_nextId++, fn, arg, tag};
+  g_heap.push_back(e);
+  std::push_heap(g_heap.begin(), g_heap.end(), std::greater<Event>());
+  return e.id;
+}
+
+void cancel(uint32_t id) {
+  if (id) g_cancelled.insert(id);
+}
+
+static void dropCancelled() {
+  while (!g_heap.empty() && g_cancelled.count(g_heap.front().id)) {
+    g_cancelled.erase(g_heap.front().id);
+    std::pop_heap(g_heap.begin(), g_heap.end(), std::greater<Event>());
+    g_heap.pop_back();
+  }
+}
+
+uint64_t nextEventNs() {
+  dropCancelled();
+  return g_heap.empty() ? UINT64_MAX : g_heap.front().at;
+}
+
+// Move the main clock to `target`, firing every event on the way
+static void advanceTo(uint64_t target) {
+  for (;;) {
+    uint64_t next = nextEventNs();
+    if (next > target) break;
+    Event e = g_heap.front();
+    std::pop_heap(g_heap.begin(), g_heap.end(), std::greater<Event>());
+    g_heap.pop_back();
+    if (e.at > g_now) g_now = e.at;
+    g_stats.events++;
+    // Interrupts and callbacks take no virtual time themselves
+    g_inEvent = true;
+    e.fn(e.arg, e.tag);
+    g_inEvent = false;
+  }
+  if (target > g_now) g_now = target;
+}
+
+void sleepNs(uint64_t ns) {
+  if (inTask()) {
+    taskSleepNs(ns);
+    return;
+  }
+  if (g_inEvent) return;
+  g_slept = true;
+  g_stats.sleepNs += ns;
+  advanceTo(g_now + ns);
+}
+
+void busyNs(uint64_t ns) {
+  if (inTask()) {
+    taskBusyNs(ns);
+    return;
+  }
+  if (g_inEvent) return;
+  g_stats.busyNs += ns;
+  advanceTo(g_now + ns);
+}
+
+void spinNs(uint64_t ns) {
+  if (!inTask() && !g_inEvent) g_slept = true;
+  busyNs(ns);
+}
+
+// ---- Input script ----
+//
+// One command per line, times in ms since start, '#' starts a comment:
+//   <ms> pin <gpio> <0|1>           drive an input (0 = pressed for buttons)
+//   <ms> release <gpio>             stop driving it
+//   <ms> press <gpio> <hold_ms>     active-low button press
+//   <ms> analog <gpio> <raw>        ADC reading (0-4095)
+//   <ms> dht <gpio> <11|22> <temp> <hum>   DHT sensor reading (deg C, %RH)
+//   <ms> bounce <gpio> <hold_ms> <bounce_ms> [seed]
+//                                   active-low press whose edges chatter for
+//                                   bounce_ms (20-500 us pulses, repeatable)
+//   <ms> expect <gpio|oled>         the press at <ms> should change this output
+//   0 window <ms>                   expect lines below: look this long for
+//                                   the response (default 1000)
+//   0 latency <ms>                  ... and fail slower ones (default: no limit)
+// Times may have fractions (recorded traces are in us: "1000.125 pin 27 0").
+
+struct ScriptStep {
+  uint8_t kind;
+  uint8_t pin;
+  int32_t a, b, c;
+};
+enum { S_PIN, S_RELEASE, S_ANALOG, S_DHT };
+static std::vector<ScriptStep> g_steps;
+
+static void runStep(void *, uint32_t index) {
+  const ScriptStep &s = g_steps[index];
+  switch (s.kind) {
+    case S_PIN: driveInput(s.pin, s.a != 0); break;
+    case S_RELEASE: releaseInput(s.pin); break;
+    case S_ANALOG: setAnalog(s.pin, (uint16_t)s.a); break;
+    case S_DHT: setDht(s.pin, (uint8_t)s.a, (int16_t)s.b, (uint16_t)s.c); break;
+  }
+}
+
+// Rounded, so "2090.421" is 2090421000 ns and not one ns short
+static uint64_t msToNs(double ms) { return (uint64_t)(ms * 1e6 + 0.5); }
+
+static void addStep(double ms, ScriptStep s) {
+  g_steps.push_back(s);
+  schedule(msToNs(ms), runStep, nullptr, (uint32_t)(g_steps.size() - 1));
+}
+
+// Contact chatter on both edges of a press: the line alternates with 20-500
+// us pulses for bounceMs and then settles (low while held, released after)
+static void addBounce(double ms, uint8_t pin, double holdMs, double bounceMs, uint32_t seed) {
+  uint32_t r = seed * 2654435761u + 1;
+  auto pulseMs = [&r]() {
+    r = r * 1103515245u + 12345u;
+    return 0.02 + 0.48 * ((r >> 8) & 0xFFFF) / 65536.0;
+  };
+  for (int edge = 0; edge < 2; edge++) {
+    double start = edge ? ms + holdMs : ms, t = start;
+    bool pressed = !edge;   // the first level of the edge
+    while (t < start + bounceMs) {
+      addStep(t, pressed ? ScriptStep{S_PIN, pin, 0, 0, 0} : ScriptStep{S_RELEASE, pin, 0, 0, 0});
+      pressed = !pressed;
+      t += pulseMs();
+    }
+    addStep(t, edge ? ScriptStep{S_RELEASE, pin, 0, 0, 0} : ScriptStep{S_PIN, pin, 0, 0, 0});
+  }
+}
+
+static bool loadScript(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) return false;
+  char line[256];
+  int lineNo = 0;
+  double windowMs = 1000, limitMs = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNo++;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = 0;
+    double ms, x = 0, y = 0;
+    char cmd[16];
+    int pin, a = 0;
+    int n = sscanf(line, "%lf %15s %d %d %lf %lf", &ms, cmd, &pin, &a, &x, &y);
+    if (n <= 0) continue;
+    char arg[16];
+    if (n >= 2 && sscanf(line, "%*f %*s %15s", arg) == 1) {
+      if (!strcmp(cmd, "expect")) {
+        uint8_t out = !strcmp(arg, "oled") ? OUTPUT_OLED : (uint8_t)atoi(arg);
+        expectOutput(msToNs(ms), out, msToNs(windowMs), msToNs(limitMs));
+        continue;
+      }
+      if (!strcmp(cmd, "window")) {
+        windowMs = atof(arg);
+        continue;
+      }
+      if (!strcmp(cmd, "latency")) {
+        limitMs = atof(arg);
+        continue;
+      }
+    }
+    bool ok = n >= 3;
+    if (ok && !strcmp(cmd, "bounce") && n >= 5) addBounce(ms, (uint8_t)pin, a, x, n >= 6 ? (uint32_t)y : lineNo);
+    else if (ok && !strcmp(cmd, "pin") && n >= 4) addStep(ms, {S_PIN, (uint8_t)pin, a, 0, 0});
+    else if (ok && !strcmp(cmd, "release")) addStep(ms, {S_RELEASE, (uint8_t)pin, 0, 0, 0});
+    else if (ok && !strcmp(cmd, "press") && n >= 4) {
+      addStep(ms, {S_PIN, (uint8_t)pin, 0, 0, 0});
+      addStep(ms + a, {S_RELEASE, (uint8_t)pin, 0, 0, 0});
+    } else if (ok && !strcmp(cmd, "analog") && n >= 4) addStep(ms, {S_ANALOG, (uint8_t)pin, a, 0, 0});
+    else if (ok && !strcmp(cmd, "dht") && n >= 6)
+      addStep(ms, {S_DHT, (uint8_t)pin, a, (int32_t)(x * 10 + (x < 0 ? -0.5 : 0.5)), (int32_t)(y * 10 + 0.5)});
+    else fprintf(stderr, "sim: %s:%d: can't parse '%s'\n", path, lineNo, line);
+  }
+  fclose(f);
+  return true;
+}
+
+static void printStats(uint64_t endNs, double wallS) {
+  const Stats &s = g_stats;
+  double simS = endNs / 1e9;
+  fprintf(stderr, "sim: %.3f s simulated in %.3f s (%.0fx real time)\n", simS, wallS,
+          wallS > 0 ? simS / wallS : 0.0);
+  fprintf(stderr, "sim: loop() ran %llu times, longest %.3f ms\n", (unsigned long long)s.loops,
+          s.maxLoopNs / 1e6);
+  fprintf(stderr, "sim: main core busy %.3f s (%.2f %%), in delay() %.3f s, idle %.3f s\n",
+          s.busyNs / 1e9, endNs ? 100.0 * s.busyNs / endNs : 0.0, s.sleepNs / 1e9, s.idleNs / 1e9);
+  fprintf(stderr, "sim: tasks resumed %llu times, busy %.3f s\n", (unsigned long long)s.taskRuns,
+          s.taskBusyNs / 1e9);
+  fprintf(stderr, "sim: %llu events, %llu GPIO changes, %llu PWM changes, %llu I2C bytes, %llu serial bytes\n",
+          (unsigned long long)s.events, (unsigned long long)s.gpioWrites, (unsigned long long)s.pwmWrites,
+          (unsigned long long)s.i2cBytes, (unsigned long long)s.serialBytes);
+}
+
+}  // namespace sim
+
+int main() {
+  using namespace sim;
+  const char *env = getenv("SIM_SECONDS");
+  double seconds = env ? atof(env) : 3600;
+  g_trace = (env = getenv("SIM_TRACE")) && atoi(env);
+  if ((env = getenv("SIM_SCRIPT")) && !loadScript(env)) {
+    fprintf(stderr, "sim: can't open script %s\n", env);
+    return 1;
+  }
+
+  g_end = (uint64_t)(seconds * 1e9);
+  auto wall0 = std::chrono::steady_clock::now();
+
+  setup();
+  while (g_now < g_end) {
+    uint64_t t0 = g_now;
+    uint64_t act0 = g_activity;
+    g_slept = false;
+    loop();
+    g_stats.loops++;
+    if (g_now - t0 > g_stats.maxLoopNs) g_stats.maxLoopNs = g_now - t0;
+
+    // Nothing happened: skip to the next event (or 1 ms, whichever is first)
+    if (g_activity == act0 && !g_slept) {
+      uint64_t target = std::min(g_now + IDLE_STEP_NS, nextEventNs());
+      if (target < g_now) target = g_now;
+      g_stats.idleNs += target - g_now;
+      advanceTo(target);
+    }
+  }
+
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+  fflush(stdout);
+  printStats(g_now, wallS);
+  return replayReport() ? 0 : 3;
+}
@@ -0,0 +1,96 @@
+// SimCore: virtual clock, event queue and run statistics for the host build
+//
+// Everything in the simulated board happens on one deterministic timeline
+// kept in nanoseconds. Timer alarms, esp_timer callbacks, scripted input
+// changes and task wake-ups are events on that timeline; delay() and bus
+// transfers move the clock forward and fire the events they pass. Nothing
+// waits on the real clock, so an hour of operation takes seconds.
+//
+// main() lives here: it runs setup() and then loop() until SIM_SECONDS of
+// virtual time have passed, and prints the statistics on exit.
+//
+// Environment variables:
+//   SIM_SECONDS  virtual run time (default 3600)
+//   SIM_SCRIPT   input script (format at "Input script" in SimCore.cpp)
+//   SIM_QUIET    1 = don't echo Serial output
+//   SIM_TRACE    1 = log output changes (pins, PWM, tones) to stderr
+//
+// With "expect" lines in the script, the exit code is 3 if any expected
+// response was late, missed, merged or doubled (SimReplay.cpp).
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sim {
+
+typedef void (*EventFn)(void *arg, uint32_t tag);
+
+// ---- Clock ----
+uint64_t nowNs();                 // virtual time of the running context
+inline uint64_t nowUs() { return nowNs() / 1000; }
+uint64_t endNs();                 // SIM_SECONDS: where the run stops
+
+// Time passing without CPU work (delay(), idle loop). In a task this
+// blocks the task instead.
+void sleepNs(uint64_t ns);
+// CPU or bus time spent by the caller (counted as busy)
+void busyNs(uint64_t ns);
+// Busy-waiting on purpose (delayMicroseconds()): busy time, but the loop()
+// iteration is waiting, so it is not treated as idle either
+void spinNs(uint64_t ns);
+
+// ---- Events ----
+// Runs fn(arg, tag) at virtual time `atNs`; returns an id for cancel()
+uint32_t schedule(uint64_t atNs, EventFn fn, void *arg, uint32_t tag = 0);
+void cancel(uint32_t id);
+uint64_t nextEventNs();           // UINT64_MAX when nothing is pending
+
+// Something observable changed (output level, bus transfer, serial text):
+// the current loop() iteration is not idle.
+void activity();
+
+// ---- Tracing ----
+bool tracing();
+void trace(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// ---- Statistics ----
+struct Stats {
+  uint64_t loops = 0;             // loop() iterations
+  uint64_t busyNs = 0;            // CPU / bus time in the main context
+  uint64_t sleepNs = 0;           // delay() in the main context
+  uint64_t idleNs = 0;            // skipped by idle loop() iterations
+  uint64_t maxLoopNs = 0;         // longest single loop() iteration
+  uint64_t events = 0;            // timer / input events fired
+  uint64_t gpioWrites = 0;        // level changes
+  uint64_t pwmWrites = 0;         // duty / tone changes
+  uint64_t i2cBytes = 0;
+  uint64_t serialBytes = 0;
+  uint64_t taskRuns = 0;          // RTOS task resumptions
+  uint64_t taskBusyNs = 0;        // time spent inside tasks
+};
+Stats &stats();
+
+// ---- Board inputs (also used by the input script) ----
+void driveInput(uint8_t pin, bool level);          // external level on a pin
+void releaseInput(uint8_t pin);                    // back to pull-up / floating
+void setAnalog(uint8_t pin, uint16_t raw);         // 12-bit ADC reading
+void setDht(uint8_t pin, uint8_t type, int16_t tempTenths, uint16_t humTenths);
+
+// ---- Replay (SimReplay.cpp) ----
+// Outputs are GPIO numbers (level or PWM changes) or OUTPUT_OLED (GDDRAM
+// contents). The script's "expect" lines register expectations; the board
+// reports every change of an output.
+static const uint8_t OUTPUT_OLED = 0xFF;
+void expectOutput(uint64_t atNs, uint8_t output, uint64_t windowNs, uint64_t limitNs);
+void outputChanged(uint8_t output);
+bool replayReport();              // prints the latency report; false on any failure
+
+// ---- RTOS hooks (SimRtos.cpp) ----
+bool inTask();
+uint64_t taskOffsetNs();          // how far the running task is ahead of the clock
+void taskBusyNs(uint64_t ns);
+void taskSleepNs(uint64_t ns);
+
+}  // namespace sim
@@ -0,0 +1,103 @@
+// SPI flash on the simulated board: a single data partition
+//
+// Behaves like NOR flash: erasing a 4 KB sector sets it to 0xFF, and a
+// write can only clear bits (new = old & data). Writes cost 0.7 ms per
+// 256-byte page and erases 45 ms per sector, the typical figures for the
+// ESP32 module's flash, and the caller is busy for that time. Reads and the
+// mmap view are free.
+//
+// SIM_FLASH=path keeps the partition in a file, so its contents survive
+// from one run to the next (a reset); without it the partition starts
+// erased in RAM. Whatever label is asked for, the same 0x170000-byte
+// partition comes back.
+
+#include "esp_partition.h"
+#include "SimCore.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint32_t PART_SIZE = 0x170000;
+static const uint64_t PAGE_WRITE_NS = 700000;
+static const uint64_t SECTOR_ERASE_NS = 45000000;
+
+static esp_partition_t g_part;
+static uint8_t *g_flash = nullptr;
+
+static bool mapFlash() {
+  if (g_flash) return true;
+  const char *path = getenv("SIM_FLASH");
+  if (path && *path) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    struct stat st;
+    bool fresh = fstat(fd, &st) == 0 && st.st_size == 0;
+    if (ftruncate(fd, PART_SIZE) != 0) {
+      close(fd);
+      return false;
+    }
+    void *p = mmap(nullptr, PART_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    g_flash = (uint8_t *)p;
+    if (fresh) memset(g_flash, 0xFF, PART_SIZE);
+  } else {
+    g_flash = (uint8_t *)malloc(PART_SIZE);
+    memset(g_flash, 0xFF, PART_SIZE);
+  }
+  g_part.type = ESP_PARTITION_TYPE_DATA;
+  g_part.address = 0x290000;
+  g_part.size = PART_SIZE;
+  return true;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+  (void)subtype;
+  if (type != ESP_PARTITION_TYPE_DATA || !mapFlash()) return nullptr;
+  strncpy(g_part.label, label ? label : "data", sizeof(g_part.label) - 1);
+  return &g_part;
+}
+
+static bool inRange(const esp_partition_t *part, size_t offset, size_t size) {
+  return part == &g_part && offset <= PART_SIZE && size <= PART_SIZE - offset;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size) {
+  if (!inRange(part, offset, size)) return ESP_ERR_INVALID_ARG;
+  memcpy(dst, g_flash + offset, size);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size) {
+  if (!inRange(part, offset, size)) return ESP_ERR_INVALID_ARG;
+  const uint8_t *s = (const uint8_t *)src;
+  for (size_t i = 0; i < size; i++) g_flash[offset + i] &= s[i];
+  sim::busyNs((size + 255) / 256 * PAGE_WRITE_NS);
+  sim::activity();
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size) {
+  if (!inRange(part, offset, size) || offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE)
+    return ESP_ERR_INVALID_ARG;
+  memset(g_flash + offset, 0xFF, size);
+  sim::busyNs(size / SPI_FLASH_SEC_SIZE * SECTOR_ERASE_NS);
+  sim::activity();
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t *part, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void **out, spi_flash_mmap_handle_t *handle) {
+  (void)memory;
+  if (!inRange(part, offset, size) || !out) return ESP_ERR_INVALID_ARG;
+  *out = g_flash + offset;
+  if (handle) *handle = 1;
+  return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle) { (void)handle; }
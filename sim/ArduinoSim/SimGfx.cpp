@@ -0,0 +1,743 @@
+// Adafruit_GFX / Adafruit_SSD1306 for the host build, and the SSD1306 panel
+// model that receives their I2C traffic.
+
+#include "Adafruit_SSD1306.h"
+#include "SimCore.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <utility>
+
+// ---- Adafruit_GFX (algorithms as in Adafruit_GFX.cpp) ----
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+  rotation = r & 3;
+  _width = (rotation & 1) ? HEIGHT : WIDTH;
+  _height = (rotation & 1) ? WIDTH : HEIGHT;
+}
+
+void Adafruit_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = y0 < y1 ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep) writePixel(y0, x0, color);
+    else writePixel(x0, y0, color);
+    err -= dy;
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  startWrite();
+  writeLine(x, y, x, y + h - 1, color);
+  endWrite();
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  startWrite();
+  writeLine(x, y, x + w - 1, y, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  startWrite();
+  for (int16_t i = x; i < x + w; i++) writeFastVLine(i, y, h, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  if (x0 == x1) {
+    if (y0 > y1) std::swap(y0, y1);
+    drawFastVLine(x0, y0, y1 - y0 + 1, color);
+  } else if (y0 == y1) {
+    if (x0 > x1) std::swap(x0, x1);
+    drawFastHLine(x0, y0, x1 - x0 + 1, color);
+  } else {
+    startWrite();
+    writeLine(x0, y0, x1, y1, color);
+    endWrite();
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  startWrite();
+  writeFastHLine(x, y, w, color);
+  writeFastHLine(x, y + h - 1, w, color);
+  writeFastVLine(x, y, h, color);
+  writeFastVLine(x + w - 1, y, h, color);
+  endWrite();
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  startWrite();
+  writePixel(x0, y0 + r, color);
+  writePixel(x0, y0 - r, color);
+  writePixel(x0 + r, y0, color);
+  writePixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    writePixel(x0 + x, y0 + y, color);
+    writePixel(x0 - x, y0 + y, color);
+    writePixel(x0 + x, y0 - y, color);
+    writePixel(x0 - x, y0 - y, color);
+    writePixel(x0 + y, y0 + x, color);
+    writePixel(x0 - y, y0 + x, color);
+    writePixel(x0 + y, y0 - x, color);
+    writePixel(x0 - y, y0 - x, color);
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (cornername & 0x4) {
+      writePixel(x0 + x, y0 + y, color);
+      writePixel(x0 + y, y0 + x, color);
+    }
+    if (cornername & 0x2) {
+      writePixel(x0 + x, y0 - y, color);
+      writePixel(x0 + y, y0 - x, color);
+    }
+    if (cornername & 0x8) {
+      writePixel(x0 - y, y0 + x, color);
+      writePixel(x0 - x, y0 + y, color);
+    }
+    if (cornername & 0x1) {
+      writePixel(x0 - y, y0 - x, color);
+      writePixel(x0 - x, y0 - y, color);
+    }
+  }
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  startWrite();
+  writeFastVLine(x0, y0 - r, 2 * r + 1, color);
+  fillCircleHelper(x0, y0, r, 3, 0, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta,
+                                    uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+  int16_t px = x;
+  int16_t py = y;
+
+  delta++;   // avoid some +1's in the loop
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    // These checks avoid double-drawing certain lines, important for INVERSE
+    if (x < (y + 1)) {
+      if (corners & 1) writeFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
+      if (corners & 2) writeFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
+    }
+    if (y != py) {
+      if (corners & 1) writeFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
+      if (corners & 2) writeFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
+      py = y;
+    }
+    px = x;
+  }
+}
+
+void Adafruit_GFX::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2,
+                                uint16_t color) {
+  drawLine(x0, y0, x1, y1, color);
+  drawLine(x1, y1, x2, y2, color);
+  drawLine(x2, y2, x0, y0, color);
+}
+
+void Adafruit_GFX::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) {
+  int16_t maxRadius = ((w < h) ? w : h) / 2;
+  if (r > maxRadius) r = maxRadius;
+  startWrite();
+  writeFastHLine(x + r, y, w - 2 * r, color);
+  writeFastHLine(x + r, y + h - 1, w - 2 * r, color);
+  writeFastVLine(x, y + r, h - 2 * r, color);
+  writeFastVLine(x + w - 1, y + r, h - 2 * r, color);
+  drawCircleHelper(x + r, y + r, r, 1, color);
+  drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+  drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+  drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) {
+  int16_t maxRadius = ((w < h) ? w : h) / 2;
+  if (r > maxRadius) r = maxRadius;
+  startWrite();
+  writeFillRect(x + r, y, w - 2 * r, h, color);
+  fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+  fillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);
+  endWrite();
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
+  int16_t byteWidth = (w + 7) / 8;
+  uint8_t b = 0;
+  startWrite();
+  for (int16_t j = 0; j < h; j++, y++) {
+    for (int16_t i = 0; i < w; i++) {
+      if (i & 7) b <<= 1;
+      else b = bitmap[j * byteWidth + i / 8];
+      if (b & 0x80) writePixel(x + i, y, color);
+    }
+  }
+  endWrite();
+}
+
+// Stand-in glyphs: a 5x7 outline with a per-character pattern inside
+// (bit 7, the descender row, stays clear like most glcdfont glyphs)
+static uint8_t glyphColumn(unsigned char c, int8_t i) {
+  if (c == ' ' || c == 0) return 0;
+  if (i == 0 || i == 4) return 0x7F;
+  return 0x41 | (((c * (2 * i + 3)) >> i & 0x1F) << 1);
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  drawChar(x, y, c, color, bg, size, size);
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t sizeX,
+                            uint8_t sizeY) {
+  if (x >= _width || y >= _height || (x + 6 * sizeX - 1) < 0 || (y + 8 * sizeY - 1) < 0) return;
+  if (!_cp437 && c >= 176) c++;   // the classic font's missing-glyph quirk
+
+  startWrite();
+  for (int8_t i = 0; i < 5; i++) {
+    uint8_t line = glyphColumn(c, i);
+    for (int8_t j = 0; j < 8; j++, line >>= 1) {
+      if (line & 1) {
+        if (sizeX == 1 && sizeY == 1) writePixel(x + i, y + j, color);
+        else writeFillRect(x + i * sizeX, y + j * sizeY, sizeX, sizeY, color);
+      } else if (bg != color) {
+        if (sizeX == 1 && sizeY == 1) writePixel(x + i, y + j, bg);
+        else writeFillRect(x + i * sizeX, y + j * sizeY, sizeX, sizeY, bg);
+      }
+    }
+  }
+  if (bg != color) {   // the sixth, spacing column
+    if (sizeX == 1 && sizeY == 1) writeFastVLine(x + 5, y, 8, bg);
+    else writeFillRect(x + 5 * sizeX, y, sizeX, 8 * sizeY, bg);
+  }
+  endWrite();
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += (int16_t)textsize_y * 8;
+  } else if (c != '\r') {
+    if (wrap && (cursor_x + textsize_x * 6) > _width) {
+      cursor_x = 0;
+      cursor_y += (int16_t)textsize_y * 8;
+    }
+    drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+    cursor_x += textsize_x * 6;
+  }
+  return 1;
+}
+
+void Adafruit_GFX::getTextBounds(const char *s, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w,
+                                 uint16_t *h) {
+  int16_t minx = _width, miny = _height, maxx = -1, maxy = -1;
+  for (; *s; s++) {
+    if (*s == '\n') {
+      x = 0;
+      y += textsize_y * 8;
+      continue;
+    }
+    if (*s == '\r') continue;
+    if (wrap && (x + textsize_x * 6) > _width) {
+      x = 0;
+      y += textsize_y * 8;
+    }
+    int16_t x2 = x + textsize_x * 6 - 1, y2 = y + textsize_y * 8 - 1;
+    if (x < minx) minx = x;
+    if (y < miny) miny = y;
+    if (x2 > maxx) maxx = x2;
+    if (y2 > maxy) maxy = y2;
+    x += textsize_x * 6;
+  }
+  *x1 = maxx >= minx ? minx : x;
+  *y1 = maxy >= miny ? miny : y;
+  *w = maxx >= minx ? maxx - minx + 1 : 0;
+  *h = maxy >= miny ? maxy - miny + 1 : 0;
+}
+
+// ---- SSD1306 panel model ----
+//
+// Decodes the command stream (with arguments that may span transactions)
+// and writes data bytes into GDDRAM using the addressing mode and window
+// the commands set up.
+
+namespace {
+
+class Ssd1306Panel : public sim::I2cDevice {
+public:
+  explicit Ssd1306Panel(uint8_t pages) : _pages(pages), _pageEnd(pages - 1) { memset(_ram, 0, sizeof(_ram)); }
+
+  void receive(const uint8_t *d, size_t n) override {
+    if (!n) return;
+    uint8_t ctrl = d[0];
+    if (ctrl & 0x80) {   // Co = 1: control byte before every byte
+      for (size_t i = 0; i + 1 < n; i += 2) byte(d[i] & 0x40, d[i + 1]);
+      return;
+    }
+    for (size_t i = 1; i < n; i++) byte(ctrl & 0x40, d[i]);
+  }
+
+  const uint8_t *ram() const { return _ram; }
+
+private:
+  void byte(bool data, uint8_t b) {
+    if (data) writeData(b);
+    else command(b);
+  }
+
+  static uint8_t argCount(uint8_t c) {
+    switch (c) {
+      case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+      case 0x21: case 0x22: case 0xA3:
+        return 2;
+      case 0x29: case 0x2A:
+        return 5;
+      case 0x26: case 0x27:
+        return 6;
+      default:
+        return 0;
+    }
+  }
+
+  void command(uint8_t b) {
+    if (_need) {
+      _args[_have++] = b;
+      if (_have == _need) execute(_cmd);
+      return;
+    }
+    _cmd = b;
+    _have = 0;
+    _need = argCount(b);
+    if (!_need) execute(b);
+  }
+
+  void execute(uint8_t c) {
+    _need = 0;
+    switch (c) {
+      case 0x20: _mode = _args[0] & 3; break;
+      case 0x21:
+        _colStart = _col = _args[0] & 0x7F;
+        _colEnd = _args[1] & 0x7F;
+        break;
+      case 0x22:
+        _pageStart = _page = _args[0] & 7;
+        _pageEnd = (_args[1] & 7) < _pages ? (_args[1] & 7) : _pages - 1;
+        break;
+      case 0x81: _contrast = _args[0]; break;
+      case 0xA6: case 0xA7: _inverted = c & 1; break;
+      case 0xAE: case 0xAF: _on = c & 1; break;
+      case 0x2E: _scrolling = false; break;
+      case 0x2F: _scrolling = true; break;
+      default:
+        if (c >= 0x40 && c <= 0x7F) _startLine = c & 0x3F;
+        else if (c >= 0xB0 && c <= 0xB7) _page = c & 7;                       // page mode addressing
+        else if (c <= 0x0F) _col = (_col & 0xF0) | c;
+        else if (c >= 0x10 && c <= 0x17) _col = (_col & 0x0F) | ((c & 7) << 4);
+        break;
+    }
+    sim::trace("oled cmd 0x%02X", c);
+  }
+
+  void writeData(uint8_t b) {
+    if (_page < _pages && _ram[_page * 128 + _col] != b) {
+      _ram[_page * 128 + _col] = b;
+      sim::outputChanged(sim::OUTPUT_OLED);   // only what the panel shows differently
+    }
+    if (_mode == 2) {   // page addressing: column wraps inside the page
+      _col = (_col + 1) & 0x7F;
+      return;
+    }
+    if (_col < _colEnd) {
+      _col++;
+      return;
+    }
+    _col = _colStart;
+    _page = _page < _pageEnd ? _page + 1 : _pageStart;
+  }
+
+  uint8_t _ram[128 * 8];
+  uint8_t _pages;
+  uint8_t _mode = 2;   // page addressing after reset
+  uint8_t _col = 0, _colStart = 0, _colEnd = 127;
+  uint8_t _page = 0, _pageStart = 0, _pageEnd;
+  uint8_t _cmd = 0, _need = 0, _have = 0, _args[6];
+  uint8_t _contrast = 0x7F, _startLine = 0;
+  bool _inverted = false, _on = false, _scrolling = false;
+};
+
+std::map<uint8_t, Ssd1306Panel *> g_panels;
+
+}  // namespace
+
+const uint8_t *sim::ssd1306Ram(uint8_t addr) {
+  auto it = g_panels.find(addr);
+  return it == g_panels.end() ? nullptr : it->second->ram();
+}
+
+// ---- Adafruit_SSD1306 (transfers as in Adafruit_SSD1306.cpp) ----
+
+static const size_t WIRE_MAX = I2C_BUFFER_LENGTH;
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi, int8_t, uint32_t clkDuring,
+                                   uint32_t clkAfter)
+    : Adafruit_GFX(w, h), wire(twi ? twi : &Wire), wireClk(clkDuring), restoreClk(clkAfter) {}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() { free(buffer); }
+
+void Adafruit_SSD1306::command1(uint8_t c) {
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x00);
+  wire->write(c);
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::commandList(const uint8_t *c, uint8_t n) {
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x00);
+  size_t bytesOut = 1;
+  while (n--) {
+    if (bytesOut >= WIRE_MAX) {
+      wire->endTransmission();
+      wire->beginTransmission(i2caddr);
+      wire->write((uint8_t)0x00);
+      bytesOut = 1;
+    }
+    wire->write(*c++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+  wire->setClock(wireClk);
+  command1(c);
+  wire->setClock(restoreClk);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, bool, bool periphBegin) {
+  if (!buffer && !(buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8)))) return false;
+  clearDisplay();
+  vccstate = vcs;
+  i2caddr = addr ? addr : (HEIGHT == 32 ? 0x3C : 0x3D);
+  if (periphBegin) wire->begin();
+
+  if (!g_panels.count(i2caddr)) {
+    g_panels[i2caddr] = new Ssd1306Panel((HEIGHT + 7) / 8);
+    sim::attachI2c(i2caddr, g_panels[i2caddr]);
+  }
+
+  wire->setClock(wireClk);
+  static const uint8_t init1[] = {SSD1306_DISPLAYOFF, SSD1306_SETDISPLAYCLOCKDIV, 0x80, SSD1306_SETMULTIPLEX};
+  commandList(init1, sizeof(init1));
+  command1(HEIGHT - 1);
+  static const uint8_t init2[] = {SSD1306_SETDISPLAYOFFSET, 0x0, SSD1306_SETSTARTLINE | 0x0, SSD1306_CHARGEPUMP};
+  commandList(init2, sizeof(init2));
+  command1(vccstate == SSD1306_EXTERNALVCC ? 0x10 : 0x14);
+  static const uint8_t init3[] = {SSD1306_MEMORYMODE, 0x00, SSD1306_SEGREMAP | 0x1, SSD1306_COMSCANDEC};
+  commandList(init3, sizeof(init3));
+
+  uint8_t comPins = 0x02;
+  contrast = 0x8F;
+  if (WIDTH == 128 && HEIGHT == 64) {
+    comPins = 0x12;
+    contrast = vccstate == SSD1306_EXTERNALVCC ? 0x9F : 0xCF;
+  } else if (WIDTH == 96 && HEIGHT == 16) {
+    comPins = 0x2;
+    contrast = vccstate == SSD1306_EXTERNALVCC ? 0x10 : 0xAF;
+  }
+  command1(SSD1306_SETCOMPINS);
+  command1(comPins);
+  command1(SSD1306_SETCONTRAST);
+  command1(contrast);
+  command1(SSD1306_SETPRECHARGE);
+  command1(vccstate == SSD1306_EXTERNALVCC ? 0x22 : 0xF1);
+  static const uint8_t init5[] = {SSD1306_SETVCOMDETECT, 0x40, SSD1306_DISPLAYALLON_RESUME,
+                                  SSD1306_NORMALDISPLAY, SSD1306_DEACTIVATE_SCROLL, SSD1306_DISPLAYON};
+  commandList(init5, sizeof(init5));
+  wire->setClock(restoreClk);
+  return true;
+}
+
+void Adafruit_SSD1306::display() {
+  wire->setClock(wireClk);
+  static const uint8_t dlist1[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0};
+  commandList(dlist1, sizeof(dlist1));
+  command1(WIDTH - 1);
+
+  uint16_t count = WIDTH * ((HEIGHT + 7) / 8);
+  const uint8_t *ptr = buffer;
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x40);
+  size_t bytesOut = 1;
+  while (count--) {
+    if (bytesOut >= WIRE_MAX) {
+      wire->endTransmission();
+      wire->beginTransmission(i2caddr);
+      wire->write((uint8_t)0x40);
+      bytesOut = 1;
+    }
+    wire->write(*ptr++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  if (buffer) memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+}
+
+void Adafruit_SSD1306::invertDisplay(bool i) { ssd1306_command(i ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY); }
+
+void Adafruit_SSD1306::dim(bool d) {
+  wire->setClock(wireClk);
+  command1(SSD1306_SETCONTRAST);
+  command1(d ? 0 : contrast);
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || x >= width() || y < 0 || y >= height() || !buffer) return;
+  switch (getRotation()) {
+    case 1:
+      std::swap(x, y);
+      x = WIDTH - x - 1;
+      break;
+    case 2:
+      x = WIDTH - x - 1;
+      y = HEIGHT - y - 1;
+      break;
+    case 3:
+      std::swap(x, y);
+      y = HEIGHT - y - 1;
+      break;
+  }
+  uint8_t &b = buffer[x + (y / 8) * WIDTH];
+  switch (color) {
+    case SSD1306_WHITE: b |= (1 << (y & 7)); break;
+    case SSD1306_BLACK: b &= ~(1 << (y & 7)); break;
+    case SSD1306_INVERSE: b ^= (1 << (y & 7)); break;
+  }
+}
+
+// The library's byte-wise line fills (fillRect, fillCircle and text
+// backgrounds all end up here), same clipping and masks
+void Adafruit_SSD1306::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  bool swap = false;
+  switch (getRotation()) {
+    case 1:
+      swap = true;
+      std::swap(x, y);
+      x = WIDTH - x - 1;
+      break;
+    case 2:
+      x = WIDTH - x - 1;
+      y = HEIGHT - y - 1;
+      x -= (w - 1);
+      break;
+    case 3:
+      swap = true;
+      std::swap(x, y);
+      y = HEIGHT - y - 1;
+      y -= (w - 1);
+      break;
+  }
+  if (swap) drawFastVLineInternal(x, y, w, color);
+  else drawFastHLineInternal(x, y, w, color);
+}
+
+void Adafruit_SSD1306::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  bool swap = false;
+  switch (getRotation()) {
+    case 1:
+      swap = true;
+      std::swap(x, y);
+      x = WIDTH - x - 1;
+      x -= (h - 1);
+      break;
+    case 2:
+      x = WIDTH - x - 1;
+      y = HEIGHT - y - 1;
+      y -= (h - 1);
+      break;
+    case 3:
+      swap = true;
+      std::swap(x, y);
+      y = HEIGHT - y - 1;
+      break;
+  }
+  if (swap) drawFastHLineInternal(x, y, h, color);
+  else drawFastVLineInternal(x, y, h, color);
+}
+
+void Adafruit_SSD1306::drawFastHLineInternal(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (y < 0 || y >= HEIGHT || !buffer) return;
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (x + w > WIDTH) w = WIDTH - x;
+  if (w <= 0) return;
+  uint8_t *p = &buffer[(y / 8) * WIDTH + x], mask = 1 << (y & 7);
+  switch (color) {
+    case SSD1306_WHITE: while (w--) *p++ |= mask; break;
+    case SSD1306_BLACK: mask = ~mask; while (w--) *p++ &= mask; break;
+    case SSD1306_INVERSE: while (w--) *p++ ^= mask; break;
+  }
+}
+
+static void applyMask(uint8_t *p, uint8_t mask, uint16_t color) {
+  switch (color) {
+    case SSD1306_WHITE: *p |= mask; break;
+    case SSD1306_BLACK: *p &= ~mask; break;
+    case SSD1306_INVERSE: *p ^= mask; break;
+  }
+}
+
+void Adafruit_SSD1306::drawFastVLineInternal(int16_t x, int16_t y0, int16_t h0, uint16_t color) {
+  if (x < 0 || x >= WIDTH || !buffer) return;
+  if (y0 < 0) {
+    h0 += y0;
+    y0 = 0;
+  }
+  if (y0 + h0 > HEIGHT) h0 = HEIGHT - y0;
+  if (h0 <= 0) return;
+  uint8_t y = y0, h = h0;
+  uint8_t *p = &buffer[(y / 8) * WIDTH + x];
+  uint8_t mod = y & 7;
+  if (mod) {
+    static const uint8_t premask[8] = {0x00, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE};
+    mod = 8 - mod;
+    uint8_t mask = premask[mod];
+    if (h < mod) mask &= (0xFF >> (mod - h));
+    applyMask(p, mask, color);
+    p += WIDTH;
+  }
+  if (h >= mod) {
+    h -= mod;
+    if (h >= 8) {
+      if (color == SSD1306_INVERSE) {
+        do {
+          *p ^= 0xFF;
+          p += WIDTH;
+          h -= 8;
+        } while (h >= 8);
+      } else {
+        uint8_t val = color != SSD1306_BLACK ? 0xFF : 0x00;
+        do {
+          *p = val;
+          p += WIDTH;
+          h -= 8;
+        } while (h >= 8);
+      }
+    }
+    if (h) {
+      static const uint8_t postmask[8] = {0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F};
+      applyMask(p, postmask[h & 7], color);
+    }
+  }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
+  if (x < 0 || x >= width() || y < 0 || y >= height() || !buffer) return false;
+  switch (getRotation()) {
+    case 1:
+      std::swap(x, y);
+      x = WIDTH - x - 1;
+      break;
+    case 2:
+      x = WIDTH - x - 1;
+      y = HEIGHT - y - 1;
+      break;
+    case 3:
+      std::swap(x, y);
+      y = HEIGHT - y - 1;
+      break;
+  }
+  return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+}
+
+void Adafruit_SSD1306::startscrollright(uint8_t start, uint8_t stop) {
+  wire->setClock(wireClk);
+  const uint8_t list[] = {SSD1306_RIGHT_HORIZONTAL_SCROLL, 0x00, start, 0x00, stop, 0x00, 0xFF,
+                          SSD1306_ACTIVATE_SCROLL};
+  commandList(list, sizeof(list));
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::startscrollleft(uint8_t start, uint8_t stop) {
+  wire->setClock(wireClk);
+  const uint8_t list[] = {SSD1306_LEFT_HORIZONTAL_SCROLL, 0x00, start, 0x00, stop, 0x00, 0xFF,
+                          SSD1306_ACTIVATE_SCROLL};
+  commandList(list, sizeof(list));
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::stopscroll() { ssd1306_command(SSD1306_DEACTIVATE_SCROLL); }
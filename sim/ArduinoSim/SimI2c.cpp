@@ -0,0 +1,68 @@
+// The simulated I2C bus and the devices that can sit on it
+
+#include "Wire.h"
+#include "SimCore.h"
+
+#include <map>
+
+static std::map<uint8_t, sim::I2cDevice *> g_devices;
+
+void sim::attachI2c(uint8_t addr, I2cDevice *dev) {
+  if (dev) g_devices[addr] = dev;
+  else g_devices.erase(addr);
+}
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+bool TwoWire::begin(int, int, uint32_t frequency) {
+  if (frequency) _clock = frequency;
+  return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+  if (!frequency) return false;
+  _clock = frequency;
+  return true;
+}
+
+void TwoWire::beginTransmission(uint16_t addr) {
+  _addr = addr;
+  _len = 0;
+  _inTx = true;
+}
+
+size_t TwoWire::write(uint8_t c) {
+  if (!_inTx || _len >= I2C_BUFFER_LENGTH) return 0;
+  _buf[_len++] = c;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buf, size_t n) {
+  size_t k = 0;
+  while (k < n && write(buf[k])) k++;
+  return k;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  if (!_inTx) return 4;
+  _inTx = false;
+
+  auto it = g_devices.find((uint8_t)_addr);
+  // Start + address byte always go out; data only after an ACK
+  size_t bytes = it == g_devices.end() ? 1 : _len + 1;
+  uint64_t bitNs = 1000000000ULL / _clock;
+  sim::busyNs((bytes * 9 + 2) * bitNs);
+  sim::activity();
+  if (it == g_devices.end()) return 2;
+
+  sim::stats().i2cBytes += bytes;
+  it->second->receive(_buf, _len);
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint16_t addr, uint8_t, bool) {
+  sim::busyNs(11 * 1000000000ULL / _clock);
+  (void)addr;
+  return 0;
+}
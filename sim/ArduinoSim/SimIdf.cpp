@@ -0,0 +1,593 @@
+// ESP-IDF drivers on the simulated board: esp_timer, LEDC (driver and
+// Arduino API), RMT receive with a DHT sensor model, GPIO, I2S ADC sampling
+// and ADC calibration.
+
+#include "Arduino.h"
+#include "SimBoard.h"
+#include "esp_timer.h"
+#include "esp_adc_cal.h"
+#include "driver/adc.h"
+#include "driver/gpio.h"
+#include "driver/i2s.h"
+#include "driver/ledc.h"
+#include "driver/rmt.h"
+#include "freertos/ringbuf.h"
+
+#include <vector>
+
+// ---- esp_timer ----
+//
+// Callbacks run as events: they take no virtual time and see the clock at
+// their deadline. Periodic timers keep their phase (next = due + period).
+
+struct SimEspTimer {
+  esp_timer_cb_t callback;
+  void *arg;
+  const char *name;
+  uint64_t periodNs;
+  uint64_t dueNs;
+  uint32_t event;
+};
+
+static void espTimerEvent(void *arg, uint32_t) {
+  SimEspTimer *t = static_cast<SimEspTimer *>(arg);
+  t->event = 0;
+  if (t->periodNs) {
+    t->dueNs += t->periodNs;
+    t->event = sim::schedule(t->dueNs, espTimerEvent, t);
+  }
+  t->callback(t->arg);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+  if (!args || !args->callback || !out) return ESP_ERR_INVALID_ARG;
+  SimEspTimer *t = new SimEspTimer();
+  t->callback = args->callback;
+  t->arg = args->arg;
+  t->name = args->name;
+  *out = t;
+  return ESP_OK;
+}
+
+static esp_err_t startTimer(SimEspTimer *t, uint64_t us, bool periodic) {
+  if (!t) return ESP_ERR_INVALID_ARG;
+  if (t->event) return ESP_ERR_INVALID_STATE;
+  t->periodNs = periodic ? us * 1000 : 0;
+  t->dueNs = sim::nowNs() + us * 1000;
+  t->event = sim::schedule(t->dueNs, espTimerEvent, t);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs) { return startTimer(t, timeoutUs, false); }
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t periodUs) { return startTimer(t, periodUs, true); }
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+  if (!t) return ESP_ERR_INVALID_ARG;
+  if (!t->event) return ESP_ERR_INVALID_STATE;
+  sim::cancel(t->event);
+  t->event = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t t) {
+  if (!t) return ESP_ERR_INVALID_ARG;
+  if (t->event) return ESP_ERR_INVALID_STATE;
+  delete t;
+  return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t t) { return t && t->event; }
+
+int64_t esp_timer_get_time() {
+  sim::busyNs(100);
+  return (int64_t)sim::nowUs();
+}
+
+// ---- LEDC ----
+
+namespace {
+
+const uint32_t APB_HZ = 80000000;
+
+struct LedcTimer {
+  uint32_t bits = 8;
+  uint32_t freqHz = 0;
+};
+
+struct LedcChannel {
+  int pin = -1;
+  uint8_t timer = 0;
+  uint32_t duty = 0;         // written by ledc_set_duty(), applied on update
+  uint32_t from = 0;         // output duty; while fading, ramps from -> to
+  uint32_t to = 0;
+  uint64_t fadeStartNs = 0;
+  uint64_t fadeNs = 0;
+  uint32_t fadeTarget = 0;   // set by ledc_set_fade_with_time()
+  uint32_t fadeMs = 0;
+};
+
+LedcTimer g_ledcTimers[LEDC_SPEED_MODE_MAX][LEDC_TIMER_MAX];
+LedcChannel g_ledc[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+
+bool validChannel(ledc_mode_t mode, ledc_channel_t ch) {
+  return mode >= 0 && mode < LEDC_SPEED_MODE_MAX && ch >= 0 && ch < LEDC_CHANNEL_MAX;
+}
+
+uint32_t outputDuty(const LedcChannel &c) {
+  uint64_t now = sim::nowNs();
+  if (!c.fadeNs || now >= c.fadeStartNs + c.fadeNs) return c.to;
+  int64_t span = (int64_t)c.to - (int64_t)c.from;
+  return (uint32_t)((int64_t)c.from + span * (int64_t)(now - c.fadeStartNs) / (int64_t)c.fadeNs);
+}
+
+void traceChannel(int mode, int ch, const char *what) {
+  const LedcChannel &c = g_ledc[mode][ch];
+  const LedcTimer &t = g_ledcTimers[mode][c.timer];
+  sim::stats().pwmWrites++;
+  sim::activity();
+  if (c.pin >= 0) sim::outputChanged((uint8_t)c.pin);
+  sim::trace("ledc %d.%d pin %d: %s duty %u/%u at %u Hz", mode, ch, c.pin, what, c.to, 1u << t.bits, t.freqHz);
+}
+
+void setOutput(int mode, int ch, uint32_t duty) {
+  LedcChannel &c = g_ledc[mode][ch];
+  c.from = c.to = duty;
+  c.fadeNs = 0;
+  traceChannel(mode, ch, "set");
+}
+
+}  // namespace
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *cfg) {
+  if (!cfg || cfg->speed_mode >= LEDC_SPEED_MODE_MAX || cfg->timer_num >= LEDC_TIMER_MAX) return ESP_ERR_INVALID_ARG;
+  if (cfg->duty_resolution < 1 || cfg->duty_resolution > 20) return ESP_ERR_INVALID_ARG;
+  // Same limit as the driver: the 10.8 divider must fit
+  if ((uint64_t)cfg->freq_hz << cfg->duty_resolution > APB_HZ) return ESP_FAIL;
+  LedcTimer &t = g_ledcTimers[cfg->speed_mode][cfg->timer_num];
+  t.bits = cfg->duty_resolution;
+  t.freqHz = cfg->freq_hz;
+  return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *cfg) {
+  if (!cfg || !validChannel(cfg->speed_mode, cfg->channel)) return ESP_ERR_INVALID_ARG;
+  LedcChannel &c = g_ledc[cfg->speed_mode][cfg->channel];
+  c.pin = cfg->gpio_num;
+  c.timer = cfg->timer_sel;
+  c.duty = cfg->duty;
+  setOutput(cfg->speed_mode, cfg->channel, cfg->duty);
+  return ESP_OK;
+}
+
+esp_err_t ledc_timer_set(ledc_mode_t mode, ledc_timer_t timer, uint32_t clockDivider, uint32_t dutyResolution,
+                         ledc_clk_src_t) {
+  if (mode >= LEDC_SPEED_MODE_MAX || timer >= LEDC_TIMER_MAX) return ESP_ERR_INVALID_ARG;
+  LedcTimer &t = g_ledcTimers[mode][timer];
+  t.bits = dutyResolution;
+  // 8 fractional bits in the divider
+  t.freqHz = clockDivider ? (uint32_t)(((uint64_t)APB_HZ << 8) / ((uint64_t)clockDivider << dutyResolution)) : 0;
+  sim::trace("ledc timer %d.%d: %u Hz", mode, timer, t.freqHz);
+  sim::stats().pwmWrites++;
+  sim::activity();
+  // A new tone is an output change on every pin the timer drives
+  for (const LedcChannel &c : g_ledc[mode])
+    if (c.timer == timer && c.pin >= 0 && c.to) sim::outputChanged((uint8_t)c.pin);
+  return ESP_OK;
+}
+
+esp_err_t ledc_set_freq(ledc_mode_t mode, ledc_timer_t timer, uint32_t freqHz) {
+  if (mode >= LEDC_SPEED_MODE_MAX || timer >= LEDC_TIMER_MAX) return ESP_ERR_INVALID_ARG;
+  g_ledcTimers[mode][timer].freqHz = freqHz;
+  return ESP_OK;
+}
+
+uint32_t ledc_get_freq(ledc_mode_t mode, ledc_timer_t timer) {
+  if (mode >= LEDC_SPEED_MODE_MAX || timer >= LEDC_TIMER_MAX) return 0;
+  return g_ledcTimers[mode][timer].freqHz;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t ch, uint32_t duty) {
+  if (!validChannel(mode, ch)) return ESP_ERR_INVALID_ARG;
+  g_ledc[mode][ch].duty = duty;
+  return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t ch) {
+  if (!validChannel(mode, ch)) return ESP_ERR_INVALID_ARG;
+  setOutput(mode, ch, g_ledc[mode][ch].duty);
+  return ESP_OK;
+}
+
+esp_err_t ledc_set_duty_and_update(ledc_mode_t mode, ledc_channel_t ch, uint32_t duty, uint32_t) {
+  if (!validChannel(mode, ch)) return ESP_ERR_INVALID_ARG;
+  g_ledc[mode][ch].duty = duty;
+  setOutput(mode, ch, duty);
+  return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t mode, ledc_channel_t ch) {
+  return validChannel(mode, ch) ? outputDuty(g_ledc[mode][ch]) : 0;
+}
+
+esp_err_t ledc_stop(ledc_mode_t mode, ledc_channel_t ch, uint32_t) {
+  if (!validChannel(mode, ch)) return ESP_ERR_INVALID_ARG;
+  setOutput(mode, ch, 0);
+  return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int) { return ESP_OK; }
+void ledc_fade_func_uninstall() {}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t ch, uint32_t targetDuty, int maxFadeTimeMs) {
+  if (!validChannel(mode, ch)) return ESP_ERR_INVALID_ARG;
+  g_ledc[mode][ch].fadeTarget = targetDuty;
+  g_ledc[mode][ch].fadeMs = maxFadeTimeMs > 0 ? maxFadeTimeMs : 0;
+  return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t ch, ledc_fade_mode_t fadeMode) {
+  if (!validChannel(mode, ch)) return ESP_ERR_INVALID_ARG;
+  LedcChannel &c = g_ledc[mode][ch];
+  c.from = outputDuty(c);
+  c.to = c.duty = c.fadeTarget;
+  c.fadeStartNs = sim::nowNs();
+  c.fadeNs = (uint64_t)c.fadeMs * 1000000;
+  traceChannel(mode, ch, "fade to");
+  if (fadeMode == LEDC_FADE_WAIT_DONE) sim::sleepNs(c.fadeNs);
+  return ESP_OK;
+}
+
+// Arduino channels 0-7 are the high-speed group, 8-15 the low-speed group;
+// channels 2n and 2n+1 share timer n, as in esp32-hal-ledc.c.
+
+static ledc_mode_t arduinoMode(uint8_t ch) { return ch < 8 ? LEDC_HIGH_SPEED_MODE : LEDC_LOW_SPEED_MODE; }
+static ledc_channel_t arduinoChannel(uint8_t ch) { return (ledc_channel_t)(ch % 8); }
+static ledc_timer_t arduinoTimer(uint8_t ch) { return (ledc_timer_t)((ch / 2) % 4); }
+
+uint32_t ledcSetup(uint8_t ch, uint32_t freq, uint8_t bits) {
+  if (ch >= 16) return 0;
+  ledc_timer_config_t tc = {};
+  tc.speed_mode = arduinoMode(ch);
+  tc.duty_resolution = (ledc_timer_bit_t)bits;
+  tc.timer_num = arduinoTimer(ch);
+  tc.freq_hz = freq;
+  if (ledc_timer_config(&tc) != ESP_OK) return 0;
+  g_ledc[tc.speed_mode][arduinoChannel(ch)].timer = tc.timer_num;
+  return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t ch) {
+  if (ch >= 16) return;
+  g_ledc[arduinoMode(ch)][arduinoChannel(ch)].pin = pin;
+  g_ledc[arduinoMode(ch)][arduinoChannel(ch)].timer = arduinoTimer(ch);
+}
+
+void ledcDetachPin(uint8_t pin) {
+  for (auto &group : g_ledc)
+    for (auto &c : group)
+      if (c.pin == pin) c.pin = -1;
+}
+
+void ledcWrite(uint8_t ch, uint32_t duty) {
+  if (ch >= 16) return;
+  ledc_set_duty_and_update(arduinoMode(ch), arduinoChannel(ch), duty, 0);
+}
+
+uint32_t ledcRead(uint8_t ch) { return ch < 16 ? ledc_get_duty(arduinoMode(ch), arduinoChannel(ch)) : 0; }
+
+uint32_t ledcWriteTone(uint8_t ch, uint32_t freq) {
+  if (!freq) {
+    ledcWrite(ch, 0);
+    return 0;
+  }
+  uint32_t f = ledcSetup(ch, freq, 10);
+  ledcWrite(ch, 0x1FF);
+  return f;
+}
+
+uint32_t ledcReadFreq(uint8_t ch) {
+  if (ch >= 16 || !ledcRead(ch)) return 0;
+  return ledc_get_freq(arduinoMode(ch), arduinoTimer(ch));
+}
+
+// tone() uses LEDC channel 0, like the core's tone task
+static uint32_t g_toneEvent = 0;
+
+static void toneEnd(void *, uint32_t pin) {
+  g_toneEvent = 0;
+  noTone((uint8_t)pin);
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+  sim::cancel(g_toneEvent);
+  g_toneEvent = 0;
+  ledcAttachPin(pin, 0);
+  ledcWriteTone(0, frequency);
+  if (duration) g_toneEvent = sim::schedule(sim::nowNs() + duration * 1000000ULL, toneEnd, nullptr, pin);
+}
+
+void noTone(uint8_t pin) {
+  ledcWriteTone(0, 0);
+  ledcDetachPin(pin);
+}
+
+// ---- GPIO driver ----
+
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode) {
+  if (pin < 0 || pin >= sim::PIN_COUNT) return ESP_ERR_INVALID_ARG;
+  sim::gpioDirection(pin, mode & GPIO_MODE_OUTPUT, mode == GPIO_MODE_OUTPUT_OD || mode == GPIO_MODE_INPUT_OUTPUT_OD);
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t pin, gpio_pull_mode_t pull) {
+  if (pin < 0 || pin >= sim::PIN_COUNT) return ESP_ERR_INVALID_ARG;
+  sim::gpioPull(pin, pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLUP_PULLDOWN,
+                pull == GPIO_PULLDOWN_ONLY || pull == GPIO_PULLUP_PULLDOWN);
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+  if (pin < 0 || pin >= sim::PIN_COUNT) return ESP_ERR_INVALID_ARG;
+  sim::gpioSet(pin, level != 0);
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin) { return pin >= 0 && sim::gpioLevel(pin); }
+
+// ---- RMT receive + DHT sensor model ----
+
+struct SimRingbuf {
+  std::vector<rmt_item32_t> item;
+  bool full = false;
+  bool held = false;         // handed out, not yet returned
+};
+
+namespace {
+
+struct DhtSensor {
+  uint8_t type = 0;          // 0 = no sensor on this pin
+  int16_t tempTenths = 0;
+  uint16_t humTenths = 0;
+};
+
+struct RmtChannel {
+  int pin = -1;
+  bool installed = false;
+  uint32_t event = 0;
+  SimRingbuf rb;
+};
+
+DhtSensor g_dht[sim::PIN_COUNT];
+RmtChannel g_rmt[RMT_CHANNEL_MAX];
+
+// Datasheet timings in us: 80/80 handshake, 50 us low before every bit,
+// 26-28 us high for a 0 and 70 us for a 1
+void dhtFrame(const DhtSensor &s, std::vector<rmt_item32_t> &items) {
+  uint8_t b[5];
+  uint16_t t = (uint16_t)(s.tempTenths < 0 ? -s.tempTenths : s.tempTenths);
+  if (s.type == 11) {           // DHT11: integer and decimal bytes
+    b[0] = s.humTenths / 10;
+    b[1] = s.humTenths % 10;
+    b[2] = t / 10;
+    b[3] = (t % 10) | (s.tempTenths < 0 ? 0x80 : 0);
+  } else {
+    b[0] = s.humTenths >> 8;
+    b[1] = s.humTenths & 0xFF;
+    b[2] = (t >> 8) | (s.tempTenths < 0 ? 0x80 : 0);
+    b[3] = t & 0xFF;
+  }
+  b[4] = b[0] + b[1] + b[2] + b[3];
+
+  std::vector<std::pair<uint8_t, uint16_t>> pulses = {{1, 30}, {0, 80}, {1, 80}};
+  for (int i = 0; i < 40; i++) {
+    bool one = b[i / 8] & (0x80 >> (i % 8));
+    pulses.push_back({0, 50});
+    pulses.push_back({1, (uint16_t)(one ? 70 : 27)});
+  }
+  pulses.push_back({0, 50});
+
+  items.clear();
+  for (size_t i = 0; i < pulses.size(); i += 2) {
+    rmt_item32_t it = {};
+    it.level0 = pulses[i].first;
+    it.duration0 = pulses[i].second;
+    if (i + 1 < pulses.size()) {
+      it.level1 = pulses[i + 1].first;
+      it.duration1 = pulses[i + 1].second;
+    }
+    items.push_back(it);
+  }
+  items.push_back(rmt_item32_t());   // idle threshold reached: end of frame
+}
+
+void rmtFrameDone(void *arg, uint32_t) {
+  RmtChannel *c = static_cast<RmtChannel *>(arg);
+  c->event = 0;
+  if (!c->rb.held) c->rb.full = true;
+}
+
+}  // namespace
+
+void sim::setDht(uint8_t pin, uint8_t type, int16_t tempTenths, uint16_t humTenths) {
+  if (pin >= PIN_COUNT) return;
+  g_dht[pin].type = type;
+  g_dht[pin].tempTenths = tempTenths;
+  g_dht[pin].humTenths = humTenths;
+}
+
+esp_err_t rmt_config(const rmt_config_t *cfg) {
+  if (!cfg || cfg->channel >= RMT_CHANNEL_MAX || cfg->rmt_mode != RMT_MODE_RX) return ESP_ERR_INVALID_ARG;
+  g_rmt[cfg->channel].pin = cfg->gpio_num;
+  return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t ch, size_t, int) {
+  if (ch >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  if (g_rmt[ch].installed) return ESP_ERR_INVALID_STATE;
+  g_rmt[ch].installed = true;
+  return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t ch) {
+  if (ch >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  rmt_rx_stop(ch);
+  g_rmt[ch].installed = false;
+  return ESP_OK;
+}
+
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t ch, RingbufHandle_t *rb) {
+  if (ch >= RMT_CHANNEL_MAX || !g_rmt[ch].installed || !rb) return ESP_ERR_INVALID_ARG;
+  *rb = &g_rmt[ch].rb;
+  return ESP_OK;
+}
+
+esp_err_t rmt_rx_start(rmt_channel_t ch, bool) {
+  if (ch >= RMT_CHANNEL_MAX || !g_rmt[ch].installed) return ESP_ERR_INVALID_STATE;
+  RmtChannel &c = g_rmt[ch];
+  sim::cancel(c.event);
+  c.event = 0;
+  if (c.pin < 0 || c.pin >= sim::PIN_COUNT || !g_dht[c.pin].type) return ESP_OK;   // nobody answers
+
+  dhtFrame(g_dht[c.pin], c.rb.item);
+  uint64_t us = 0;
+  for (const rmt_item32_t &it : c.rb.item) us += it.duration0 + it.duration1;
+  c.event = sim::schedule(sim::nowNs() + (us + 200) * 1000, rmtFrameDone, &c);
+  return ESP_OK;
+}
+
+esp_err_t rmt_rx_stop(rmt_channel_t ch) {
+  if (ch >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  sim::cancel(g_rmt[ch].event);
+  g_rmt[ch].event = 0;
+  return ESP_OK;
+}
+
+void *xRingbufferReceive(RingbufHandle_t rb, size_t *itemSize, TickType_t ticksToWait) {
+  if (!rb->full && ticksToWait) sim::sleepNs((uint64_t)ticksToWait * portTICK_PERIOD_MS * 1000000);
+  if (!rb->full || rb->held) return nullptr;
+  rb->held = true;
+  *itemSize = rb->item.size() * sizeof(rmt_item32_t);
+  return rb->item.data();
+}
+
+void vRingbufferReturnItem(RingbufHandle_t rb, void *) {
+  rb->held = false;
+  rb->full = false;
+}
+
+// ---- ADC ----
+
+esp_err_t adc1_config_width(adc_bits_width_t) { return ESP_OK; }
+esp_err_t adc1_config_channel_atten(adc1_channel_t ch, adc_atten_t) {
+  return ch < ADC1_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+static const uint8_t ADC1_PINS[ADC1_CHANNEL_MAX] = {36, 37, 38, 39, 32, 33, 34, 35};
+
+int adc1_get_raw(adc1_channel_t ch) {
+  if (ch >= ADC1_CHANNEL_MAX) return -1;
+  sim::busyNs(10000);
+  return sim::analogValue(ADC1_PINS[ch]);
+}
+
+esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t unit, adc_atten_t atten, adc_bits_width_t width,
+                                             uint32_t defaultVref, esp_adc_cal_characteristics_t *chars) {
+  chars->adc_num = unit;
+  chars->atten = atten;
+  chars->bit_width = width;
+  chars->coeff_a = 3300;
+  chars->coeff_b = 0;
+  chars->vref = defaultVref;
+  return ESP_ADC_CAL_VAL_DEFAULT_VREF;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t *chars) {
+  return raw * chars->coeff_a / 4095 + chars->coeff_b;
+}
+
+// ---- I2S ADC sampling ----
+//
+// Samples accumulate at the configured rate while the ADC is enabled, up to
+// what the DMA buffers hold (older ones are lost, as on the chip). Each is
+// tagged with the channel in the top 4 bits like the real DMA output.
+
+namespace {
+
+struct I2sAdc {
+  bool installed = false;
+  bool enabled = false;
+  uint32_t rate = 0;
+  size_t capacity = 0;       // samples in all DMA buffers
+  adc1_channel_t channel = ADC1_CHANNEL_0;
+  uint64_t takenNs = 0;      // time up to which samples were handed out
+  uint64_t dropped = 0;
+};
+
+I2sAdc g_i2s[I2S_NUM_MAX];
+
+}  // namespace
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t *cfg, int, void *) {
+  if (port >= I2S_NUM_MAX || !cfg || !cfg->sample_rate) return ESP_ERR_INVALID_ARG;
+  if (!(cfg->mode & I2S_MODE_ADC_BUILT_IN) || port != I2S_NUM_0) return ESP_ERR_INVALID_ARG;
+  I2sAdc &a = g_i2s[port];
+  a.installed = true;
+  a.rate = cfg->sample_rate;
+  a.capacity = (size_t)cfg->dma_buf_count * cfg->dma_buf_len;
+  return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port) {
+  if (port >= I2S_NUM_MAX) return ESP_ERR_INVALID_ARG;
+  g_i2s[port] = I2sAdc();
+  return ESP_OK;
+}
+
+esp_err_t i2s_set_adc_mode(adc_unit_t unit, adc1_channel_t ch) {
+  if (unit != ADC_UNIT_1 || ch >= ADC1_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  g_i2s[I2S_NUM_0].channel = ch;
+  return ESP_OK;
+}
+
+esp_err_t i2s_adc_enable(i2s_port_t port) {
+  if (port >= I2S_NUM_MAX || !g_i2s[port].installed) return ESP_ERR_INVALID_STATE;
+  g_i2s[port].enabled = true;
+  g_i2s[port].takenNs = sim::nowNs();
+  return ESP_OK;
+}
+
+esp_err_t i2s_adc_disable(i2s_port_t port) {
+  if (port >= I2S_NUM_MAX || !g_i2s[port].installed) return ESP_ERR_INVALID_STATE;
+  g_i2s[port].enabled = false;
+  return ESP_OK;
+}
+
+esp_err_t i2s_read(i2s_port_t port, void *dest, size_t size, size_t *bytesRead, TickType_t ticksToWait) {
+  *bytesRead = 0;
+  if (port >= I2S_NUM_MAX || !g_i2s[port].enabled) return ESP_ERR_INVALID_STATE;
+  I2sAdc &a = g_i2s[port];
+  uint64_t sampleNs = 1000000000ULL / a.rate;
+  size_t want = size / sizeof(uint16_t);
+
+  uint64_t ready = (sim::nowNs() - a.takenNs) / sampleNs;
+  if (ready < want && ticksToWait) {
+    uint64_t needNs = (want - ready) * sampleNs;
+    uint64_t maxNs = (uint64_t)ticksToWait * portTICK_PERIOD_MS * 1000000;
+    sim::sleepNs(needNs < maxNs ? needNs : maxNs);
+    ready = (sim::nowNs() - a.takenNs) / sampleNs;
+  }
+  if (ready > a.capacity) {
+    a.dropped += ready - a.capacity;
+    a.takenNs += (ready - a.capacity) * sampleNs;
+    ready = a.capacity;
+  }
+  size_t n = ready < want ? (size_t)ready : want;
+
+  uint16_t *out = static_cast<uint16_t *>(dest);
+  uint16_t raw = sim::analogValue(ADC1_PINS[a.channel]);
+  for (size_t i = 0; i < n; i++) out[i] = (uint16_t)((a.channel << 12) | raw);
+  a.takenNs += n * sampleNs;
+  *bytesRead = n * sizeof(uint16_t);
+  sim::busyNs(n * 5);        // copying out of the DMA buffers
+  return ESP_OK;
+}
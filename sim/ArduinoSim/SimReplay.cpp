@@ -0,0 +1,135 @@
+// Input-to-output latency for replayed input traces
+//
+// The script's "expect" lines say which output a press should change: a
+// GPIO / PWM pin or the OLED. Every change of a watched output is logged
+// (changes less than BURST_NS apart are one response, e.g. a whole frame
+// flush). At exit every response goes to the latest expectation of its
+// output at or before it (the press it reacts to), if inside that window:
+//
+//   answered   latency = response - expectation time
+//   late       answered, but slower than the script's "latency" limit
+//   missed     no response of that output in the window at all
+//   merged     no response of its own, but one inside its window went to a
+//              later expectation (two presses, one reaction)
+//   extra      a further response for an expectation that already has one
+//              (a bounce taken as a second press)
+//
+// Responses outside every window (blinking effects, periodic redraws) are
+// ignored, so an expectation should name an output only the press changes.
+
+#include "SimCore.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+namespace sim {
+
+static const uint64_t BURST_NS = 20000000;   // 20 ms
+
+struct Expectation {
+  uint64_t at;
+  uint8_t output;
+  uint64_t windowNs;
+  uint64_t limitNs;     // 0: no latency limit
+  int response = -1;    // index into g_responses
+  int extra = 0;
+  bool merged = false;
+};
+
+struct Response {
+  uint64_t at;
+  uint8_t output;
+  bool claimed = false;
+};
+
+static std::vector<Expectation> g_expect;
+static std::vector<Response> g_responses;
+static bool g_watched[256];
+static bool g_changed[256];
+static uint64_t g_lastChange[256];   // latest change, continues a burst
+
+void expectOutput(uint64_t atNs, uint8_t output, uint64_t windowNs, uint64_t limitNs) {
+  Expectation e;
+  e.at = atNs;
+  e.output = output;
+  e.windowNs = windowNs;
+  e.limitNs = limitNs;
+  g_expect.push_back(e);
+  g_watched[output] = true;
+}
+
+void outputChanged(uint8_t output) {
+  if (!g_watched[output]) return;
+  uint64_t now = nowNs();
+  bool sameBurst = g_changed[output] && now - g_lastChange[output] < BURST_NS;
+  g_changed[output] = true;
+  g_lastChange[output] = now;
+  if (sameBurst) return;
+  Response r;
+  r.at = now;
+  r.output = output;
+  g_responses.push_back(r);
+}
+
+static void describe(char *buf, size_t n, uint8_t output) {
+  if (output == OUTPUT_OLED) snprintf(buf, n, "oled");
+  else snprintf(buf, n, "gpio %u", output);
+}
+
+bool replayReport() {
+  if (g_expect.empty()) return true;
+  std::stable_sort(g_expect.begin(), g_expect.end(),
+                   [](const Expectation &a, const Expectation &b) { return a.at < b.at; });
+
+  for (size_t r = 0; r < g_responses.size(); r++) {
+    Response &resp = g_responses[r];
+    Expectation *owner = nullptr;
+    for (Expectation &e : g_expect)
+      if (e.output == resp.output && e.at <= resp.at) owner = &e;
+    if (!owner || resp.at >= owner->at + owner->windowNs) continue;
+    resp.claimed = true;
+    if (owner->response < 0) owner->response = (int)r;
+    else owner->extra++;
+  }
+  for (Expectation &e : g_expect) {
+    if (e.response >= 0) continue;
+    for (const Response &resp : g_responses)
+      if (resp.claimed && resp.output == e.output && resp.at >= e.at && resp.at < e.at + e.windowNs)
+        e.merged = true;
+  }
+
+  int answered = 0, missed = 0, merged = 0, extra = 0, late = 0;
+  std::vector<uint64_t> lat;
+  for (const Expectation &e : g_expect) {
+    char what[16];
+    describe(what, sizeof(what), e.output);
+    fprintf(stderr, "sim: expect %10.3f ms %-8s ", e.at / 1e6, what);
+    if (e.response >= 0) {
+      uint64_t l = g_responses[e.response].at - e.at;
+      bool isLate = e.limitNs && l > e.limitNs;
+      answered++;
+      late += isLate;
+      lat.push_back(l);
+      fprintf(stderr, "%9.3f ms%s", l / 1e6, isLate ? "  LATE" : "");
+    } else if (e.merged) {
+      merged++;
+      fprintf(stderr, "%12s", "MERGED");
+    } else {
+      missed++;
+      fprintf(stderr, "%12s", "MISSED");
+    }
+    if (e.extra) fprintf(stderr, "  +%d EXTRA", e.extra);
+    extra += e.extra;
+    fputc('\n', stderr);
+  }
+
+  std::sort(lat.begin(), lat.end());
+  fprintf(stderr, "sim: replay: %zu expected, %d answered", g_expect.size(), answered);
+  if (!lat.empty())
+    fprintf(stderr, " (latency p50 %.3f ms, max %.3f ms)", lat[lat.size() / 2] / 1e6, lat.back() / 1e6);
+  fprintf(stderr, ", %d late, %d missed, %d merged, %d extra\n", late, missed, merged, extra);
+  return !late && !missed && !merged && !extra;
+}
+
+}  // namespace sim
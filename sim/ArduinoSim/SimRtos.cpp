@@ -0,0 +1,216 @@
+// FreeRTOS tasks as coroutines on the virtual clock
+//
+// A task runs on its own stack (ucontext) until it blocks in
+// ulTaskNotifyTake() / vTaskDelay(), then control returns to whoever
+// resumed it. Tasks are modelled as running on the other core: time a task
+// spends busy does not hold up loop(), it only delays when that task can
+// run again. Only one context executes at a time, so the run is
+// deterministic and the portMUX critical sections are no-ops.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "SimCore.h"
+
+#include <ucontext.h>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+struct SimTask {
+  TaskFunction_t fn;
+  void *param;
+  const char *name;
+  BaseType_t core;
+  ucontext_t ctx;
+  void *stack;
+  size_t stackSize;
+  uint32_t notify = 0;
+  bool waiting = false;       // blocked in ulTaskNotifyTake()
+  bool ready = false;
+  bool deleted = false;
+  uint32_t timeoutEvent = 0;
+  uint64_t freeAtNs = 0;      // main-clock time its last run finished
+  uint64_t offsetNs = 0;      // busy time of the current run
+};
+
+static ucontext_t g_mainCtx;
+static SimTask *g_current = nullptr;
+// Arduino's loopTask is the main context itself, not a coroutine. It only
+// exists as a handle, so loop() can block in ulTaskNotifyTake() too.
+static SimTask g_loopTask;
+
+namespace sim {
+
+bool inTask() { return g_current != nullptr; }
+uint64_t taskOffsetNs() { return g_current ? g_current->offsetNs : 0; }
+
+void taskBusyNs(uint64_t ns) {
+  g_current->offsetNs += ns;
+  stats().taskBusyNs += ns;
+}
+
+}  // namespace sim
+
+static void resumeEvent(void *arg, uint32_t);
+
+static void makeReady(SimTask *t) {
+  if (t->ready || t->deleted || t == &g_loopTask) return;
+  t->ready = true;
+  uint64_t now = sim::nowNs();
+  sim::schedule(t->freeAtNs > now ? t->freeAtNs : now, resumeEvent, t);
+}
+
+// Give the CPU back to the main context until something resumes this task
+static void block(SimTask *t) {
+  uint64_t now = sim::nowNs();
+  t->freeAtNs = now;
+  t->offsetNs = 0;
+  g_current = nullptr;
+  swapcontext(&t->ctx, &g_mainCtx);
+  // resumed by resumeEvent()
+}
+
+static void resumeEvent(void *arg, uint32_t) {
+  SimTask *t = static_cast<SimTask *>(arg);
+  if (!t->ready || t->deleted) return;
+  t->ready = false;
+  sim::stats().taskRuns++;
+  g_current = t;
+  // Deleted tasks are never freed: pending events may still point at them
+  swapcontext(&g_mainCtx, &t->ctx);
+}
+
+// makecontext() only passes ints: the SimTask pointer comes in two halves
+static void trampoline(int hi, int lo) {
+  SimTask *t = (SimTask *)(((uintptr_t)(uint32_t)hi << 16 << 16) | (uintptr_t)(uint32_t)lo);
+  t->fn(t->param);
+  vTaskDelete(nullptr);     // a task function must not return, but be kind
+}
+
+namespace sim {
+
+void taskSleepNs(uint64_t ns) {
+  SimTask *t = g_current;
+  uint64_t wake = nowNs() + ns;
+  t->ready = true;
+  schedule(wake, resumeEvent, t);
+  block(t);
+}
+
+}  // namespace sim
+
+static void timeoutEvent(void *arg, uint32_t) {
+  SimTask *t = static_cast<SimTask *>(arg);
+  t->timeoutEvent = 0;
+  if (t->waiting) makeReady(t);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+  (void)priority;
+  SimTask *t = new SimTask();
+  t->fn = fn;
+  t->param = param;
+  t->name = name;
+  t->core = core;
+  // Host code needs more stack than the firmware asks for
+  t->stackSize = stackDepth < 65536 ? 65536 : stackDepth * 4;
+  t->stack = malloc(t->stackSize);
+  getcontext(&t->ctx);
+  t->ctx.uc_stack.ss_sp = t->stack;
+  t->ctx.uc_stack.ss_size = t->stackSize;
+  t->ctx.uc_link = nullptr;
+  uintptr_t p = (uintptr_t)t;
+  makecontext(&t->ctx, (void (*)())trampoline, 2, (int)(uint32_t)((uint64_t)p >> 32), (int)(uint32_t)p);
+
+  if (handle) *handle = t;
+  t->freeAtNs = sim::nowNs();
+  makeReady(t);
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+  SimTask *t = handle ? handle : g_current;
+  if (!t) return;
+  t->deleted = true;
+  if (t == g_current) {
+    g_current = nullptr;
+    swapcontext(&t->ctx, &g_mainCtx);   // never returns
+  }
+}
+
+void vTaskDelay(TickType_t ticks) {
+  if (g_current) sim::taskSleepNs((uint64_t)ticks * portTICK_PERIOD_MS * 1000000ULL);
+  else sim::sleepNs((uint64_t)ticks * portTICK_PERIOD_MS * 1000000ULL);
+}
+
+// Wakes at *previousWake + increment (at once if that has passed) and
+// advances *previousWake by exactly one increment, so the period doesn't drift
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t increment) {
+  TickType_t wake = *previousWake + increment;
+  *previousWake = wake;
+  int32_t ahead = (int32_t)(wake - xTaskGetTickCount());
+  if (ahead > 0) vTaskDelay((TickType_t)ahead);
+}
+
+// loop(): the main core idles through the events until one of them notifies
+// it, the timeout passes or the run is over
+static void loopNotifyTake(TickType_t ticksToWait) {
+  uint64_t until = sim::endNs();
+  if (ticksToWait != portMAX_DELAY)
+    until = std::min<uint64_t>(until, sim::nowNs() + (uint64_t)ticksToWait * portTICK_PERIOD_MS * 1000000ULL);
+  while (g_loopTask.notify == 0) {
+    uint64_t now = sim::nowNs(), next = sim::nextEventNs();
+    if (next >= until) {
+      if (until > now) sim::sleepNs(until - now);
+      return;
+    }
+    sim::sleepNs(next > now ? next - now : 0);
+  }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+  SimTask *t = g_current;
+  if (!t) {
+    t = &g_loopTask;
+    if (t->notify == 0 && ticksToWait) loopNotifyTake(ticksToWait);
+  } else if (t->notify == 0 && ticksToWait) {
+    t->waiting = true;
+    if (ticksToWait != portMAX_DELAY)
+      t->timeoutEvent = sim::schedule(sim::nowNs() + (uint64_t)ticksToWait * portTICK_PERIOD_MS * 1000000ULL,
+                                      timeoutEvent, t);
+    block(t);
+    t->waiting = false;
+    sim::cancel(t->timeoutEvent);
+    t->timeoutEvent = 0;
+  }
+  uint32_t n = t->notify;
+  if (n) t->notify = clearOnExit ? 0 : n - 1;
+  return n;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t t) {
+  if (!t) return pdFAIL;
+  t->notify++;
+  if (t->waiting) makeReady(t);
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t *woken) {
+  xTaskNotifyGive(t);
+  if (woken) *woken = pdTRUE;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return g_current ? g_current : &g_loopTask; }
+
+BaseType_t xPortGetCoreID() {
+  if (!g_current) return 1;   // Arduino loop() runs on core 1
+  return g_current->core == tskNO_AFFINITY ? 0 : g_current->core;
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)(sim::nowNs() / (portTICK_PERIOD_MS * 1000000ULL)); }
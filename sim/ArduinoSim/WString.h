@@ -0,0 +1,80 @@
+// Host build: Arduino String on top of std::string (the subset the sketches use)
+
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include <stdlib.h>
+
+class String {
+public:
+  String(const char *s = "") : _s(s ? s : "") {}
+  String(const std::string &s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  explicit String(unsigned char v, unsigned char base = 10) : _s(num(v, base)) {}
+  explicit String(int v, unsigned char base = 10) : _s(num(v, base)) {}
+  explicit String(unsigned int v, unsigned char base = 10) : _s(num(v, base)) {}
+  explicit String(long v, unsigned char base = 10) : _s(num(v, base)) {}
+  explicit String(unsigned long v, unsigned char base = 10) : _s(num(v, base)) {}
+  explicit String(float v, unsigned char decimals = 2) : _s(fixed(v, decimals)) {}
+  explicit String(double v, unsigned char decimals = 2) : _s(fixed(v, decimals)) {}
+
+  const char *c_str() const { return _s.c_str(); }
+  unsigned int length() const { return (unsigned int)_s.size(); }
+  bool isEmpty() const { return _s.empty(); }
+  void reserve(unsigned int n) { _s.reserve(n); }
+
+  char operator[](unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+  int indexOf(char c, unsigned int from = 0) const { return pos(_s.find(c, from)); }
+  int indexOf(const String &s, unsigned int from = 0) const { return pos(_s.find(s._s, from)); }
+  String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    return from < _s.size() ? String(_s.substr(from, to - from)) : String();
+  }
+  bool startsWith(const String &s) const { return _s.compare(0, s._s.size(), s._s) == 0; }
+  bool endsWith(const String &s) const {
+    return _s.size() >= s._s.size() && _s.compare(_s.size() - s._s.size(), s._s.size(), s._s) == 0;
+  }
+  long toInt() const { return strtol(_s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(_s.c_str(), nullptr); }
+  void trim();
+  void toUpperCase();
+  void toLowerCase();
+
+  String &operator+=(const String &o) { _s += o._s; return *this; }
+  String &operator+=(const char *o) { _s += o ? o : ""; return *this; }
+  String &operator+=(char c) { _s += c; return *this; }
+  String &operator+=(int v) { _s += num(v, 10); return *this; }
+  String &operator+=(unsigned int v) { _s += num(v, 10); return *this; }
+  String &operator+=(long v) { _s += num(v, 10); return *this; }
+  String &operator+=(unsigned long v) { _s += num(v, 10); return *this; }
+  String &operator+=(double v) { _s += fixed(v, 2); return *this; }
+  bool concat(const String &o) { _s += o._s; return true; }
+
+  bool operator==(const String &o) const { return _s == o._s; }
+  bool operator==(const char *o) const { return _s == (o ? o : ""); }
+  bool operator!=(const String &o) const { return _s != o._s; }
+  bool operator!=(const char *o) const { return !(*this == o); }
+  bool operator<(const String &o) const { return _s < o._s; }
+  bool equals(const String &o) const { return _s == o._s; }
+
+private:
+  static std::string num(long long v, unsigned char base);
+  static std::string num(unsigned long long v, unsigned char base, bool);
+  static std::string num(int v, unsigned char base) { return num((long long)v, base); }
+  static std::string num(long v, unsigned char base) { return num((long long)v, base); }
+  static std::string num(unsigned int v, unsigned char base) { return num((unsigned long long)v, base, true); }
+  static std::string num(unsigned long v, unsigned char base) { return num((unsigned long long)v, base, true); }
+  static std::string num(unsigned char v, unsigned char base) { return num((unsigned long long)v, base, true); }
+  static std::string fixed(double v, unsigned char decimals);
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+
+  std::string _s;
+};
+
+// Arduino lets you start a concatenation from any side
+template <typename T>
+String operator+(const String &a, const T &b) { String r(a); r += b; return r; }
+inline String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
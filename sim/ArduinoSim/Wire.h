@@ -0,0 +1,65 @@
+// Host build: I2C master. A transmission takes the time its bits need at
+// the current clock (9 bits per byte plus start/stop) and is delivered to
+// the device model registered at that address; with no device there, the
+// address is not acknowledged (endTransmission() returns 2), as on the bus.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Arduino.h"
+
+#define I2C_BUFFER_LENGTH 128
+
+namespace sim {
+
+// A device on the simulated bus receives every complete write transaction
+class I2cDevice {
+public:
+  virtual ~I2cDevice() {}
+  virtual void receive(const uint8_t *data, size_t n) = 0;
+};
+
+// nullptr takes the device off the bus (its address then NACKs)
+void attachI2c(uint8_t addr, I2cDevice *dev);
+
+}  // namespace sim
+
+class TwoWire : public Print {
+public:
+  explicit TwoWire(uint8_t bus) : _bus(bus) {}
+
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  bool end() { return true; }
+  bool setClock(uint32_t frequency);
+  uint32_t getClock() const { return _clock; }
+  void setTimeOut(uint16_t ms) { _timeoutMs = ms; }
+  uint16_t getTimeOut() const { return _timeoutMs; }
+
+  void beginTransmission(uint16_t addr);
+  void beginTransmission(int addr) { beginTransmission((uint16_t)addr); }
+  uint8_t endTransmission(bool sendStop = true);
+
+  // Reads are not modelled: no device ever sends data back
+  uint8_t requestFrom(uint16_t addr, uint8_t quantity, bool sendStop = true);
+  uint8_t requestFrom(int addr, int quantity) { return requestFrom((uint16_t)addr, (uint8_t)quantity); }
+  int available() { return 0; }
+  int read() { return -1; }
+  int peek() { return -1; }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t n) override;
+  using Print::write;
+
+private:
+  uint8_t _bus;
+  uint32_t _clock = 100000;
+  uint16_t _timeoutMs = 50;
+  uint16_t _addr = 0;
+  bool _inTx = false;
+  uint8_t _buf[I2C_BUFFER_LENGTH];
+  size_t _len = 0;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
@@ -0,0 +1,66 @@
+// Host build: RMT receive only. A capture started with rmt_rx_start() on a
+// pin with a simulated DHT sensor (sim::setDht()) produces that sensor's
+// response frame, ready ~5 ms later; other pins never receive anything.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/ringbuf.h"
+
+typedef enum {
+  RMT_CHANNEL_0 = 0, RMT_CHANNEL_1, RMT_CHANNEL_2, RMT_CHANNEL_3,
+  RMT_CHANNEL_4, RMT_CHANNEL_5, RMT_CHANNEL_6, RMT_CHANNEL_7, RMT_CHANNEL_MAX
+} rmt_channel_t;
+typedef enum { RMT_MODE_TX = 0, RMT_MODE_RX } rmt_mode_t;
+
+typedef struct {
+  union {
+    struct {
+      uint32_t duration0 : 15;
+      uint32_t level0 : 1;
+      uint32_t duration1 : 15;
+      uint32_t level1 : 1;
+    };
+    uint32_t val;
+  };
+} rmt_item32_t;
+
+typedef struct {
+  uint16_t idle_threshold;
+  uint8_t filter_ticks_thresh;
+  bool filter_en;
+} rmt_rx_config_t;
+
+typedef struct {
+  rmt_mode_t rmt_mode;
+  rmt_channel_t channel;
+  gpio_num_t gpio_num;
+  uint8_t clk_div;
+  uint8_t mem_block_num;
+  uint32_t flags;
+  rmt_rx_config_t rx_config;
+} rmt_config_t;
+
+inline rmt_config_t simRmtDefaultRx(gpio_num_t gpio, rmt_channel_t channel) {
+  rmt_config_t c = {};
+  c.rmt_mode = RMT_MODE_RX;
+  c.channel = channel;
+  c.gpio_num = gpio;
+  c.clk_div = 80;
+  c.mem_block_num = 1;
+  c.rx_config.idle_threshold = 12000;
+  c.rx_config.filter_ticks_thresh = 100;
+  c.rx_config.filter_en = true;
+  return c;
+}
+#define RMT_DEFAULT_CONFIG_RX(gpio, channel_id) simRmtDefaultRx(gpio, channel_id)
+
+esp_err_t rmt_config(const rmt_config_t *cfg);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rxBufSize, int intrAllocFlags);
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel);
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t *rb);
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool resetMemory);
+esp_err_t rmt_rx_stop(rmt_channel_t channel);
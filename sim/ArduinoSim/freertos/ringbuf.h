@@ -0,0 +1,10 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct SimRingbuf;
+typedef SimRingbuf *RingbufHandle_t;
+
+// Only what the RMT receiver needs: one item at a time, no-split buffers
+void *xRingbufferReceive(RingbufHandle_t rb, size_t *itemSize, TickType_t ticksToWait);
+void vRingbufferReturnItem(RingbufHandle_t rb, void *item);
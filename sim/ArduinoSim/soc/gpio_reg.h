@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+// Input levels of GPIO 0-31 / 32-39, read through REG_READ()
+#define GPIO_IN_REG 0x3FF4403C
+#define GPIO_IN1_REG 0x3FF44040
+
+// Output latches of GPIO 0-31 / 32-39: read them, or set / clear the pins
+// whose bits are 1 with one REG_WRITE() to the W1TS / W1TC registers
+#define GPIO_OUT_REG 0x3FF44004
+#define GPIO_OUT_W1TS_REG 0x3FF44008
+#define GPIO_OUT_W1TC_REG 0x3FF4400C
+#define GPIO_OUT1_REG 0x3FF44010
+#define GPIO_OUT1_W1TS_REG 0x3FF44014
+#define GPIO_OUT1_W1TC_REG 0x3FF44018
+
+uint32_t simRegRead(uint32_t reg);
+void simRegWrite(uint32_t reg, uint32_t value);
+#define REG_READ(reg) simRegRead((uint32_t)(reg))
+#define REG_WRITE(reg, val) simRegWrite((uint32_t)(reg), (uint32_t)(val))
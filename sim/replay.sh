@@ -0,0 +1,31 @@
+#!/bin/sh
+# Replay input traces against a native build and check their expect lines
+#
+#   sim/replay.sh .pio/build/native/program sim/traces/HomeTask2-PartB/*.txt
+#
+# Each trace runs until 2 s after its last step. Prints PASS or FAIL with
+# the replay summary per trace (all expect lines on a failure) and exits 1
+# when any trace failed.
+
+if [ $# -lt 2 ]; then
+  echo "usage: $0 <program> <trace>..." >&2
+  exit 2
+fi
+prog=$1
+shift
+
+failed=0
+for trace in "$@"; do
+  secs=$(awk '!/^[ \t]*(#|$)/ && $1 + 0 > end { end = $1 + 0 } END { printf "%d", end / 1000 + 2 }' "$trace")
+  out=$(SIM_SECONDS=$secs SIM_QUIET=1 SIM_SCRIPT=$trace "$prog" 2>&1 >/dev/null)
+  status=$?
+  summary=$(echo "$out" | grep '^sim: replay:' | sed 's/^sim: replay: //')
+  if [ $status -eq 0 ] && [ -n "$summary" ]; then
+    echo "PASS $trace: $summary"
+  else
+    echo "FAIL $trace: ${summary:-exit status $status}"
+    echo "$out" | grep '^sim: expect' | sed 's/^sim: /  /'
+    failed=1
+  fi
+done
+exit $failed
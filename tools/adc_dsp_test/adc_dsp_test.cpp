@@ -0,0 +1,174 @@
+// adc_dsp_test: AdcStream's Decimator and AdcCalLut against double
+// precision, and samples per second
+//
+//   g++ -std=c++11 -O2 -I../../lib/AdcStream adc_dsp_test.cpp -o adc_dsp_test
+//   ./adc_dsp_test
+//
+// Checks that:
+//   - Decimator<6> (what AdcStream uses) and <4> return the rounded mean of
+//     every block exactly, full-scale blocks included,
+//   - on a slow LDR-like signal with +-24 counts of noise, the decimated
+//     samples are closer to the noise-free signal than the raw ones by
+//     about sqrt(2^SHIFT),
+//   - AdcCalLut::setLinear() is within 1 mV of (raw / 4095.0) * 3300 for
+//     every 12-bit code,
+//   - a table built from a curve shaped like esp_adc_cal's 11 dB
+//     characteristic (a 142 mV offset, linear up to code 2880 and bending
+//     above it) is within 2 mV of the curve for every code, and code
+//     4095 reads back exactly the value the curve gave for it.
+// Then times push(), toMv() and the two together, against the float
+// conversion the sketches did per sample before, best of several runs.
+// Exits 1 on any failed check.
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include "AdcDsp.h"
+#include "../common/Check.h"
+
+static const int N = 1 << 20;
+static const int RUNS = 10;
+
+static uint32_t g_seed = 1;
+static int rnd(int n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (int)((g_seed >> 16) % (uint32_t)n);
+}
+
+template <uint8_t SHIFT>
+static void checkDecimatorExact() {
+  Decimator<SHIFT> d;
+  const uint32_t F = 1u << SHIFT;
+  uint32_t blocks = 0, wrong = 0;
+  uint32_t sum = 0, n = 0;
+  for (int i = 0; i < N; i++) {
+    // Mostly random codes, with runs of 0 and 4095 to hit both ends
+    int kind = (i >> 12) % 4;
+    uint16_t v = kind == 1 ? 4095 : kind == 2 ? 0 : (uint16_t)rnd(4096);
+    uint16_t out;
+    sum += v;
+    n++;
+    if (d.push(v, out)) {
+      uint16_t want = (uint16_t)floor((double)sum / F + 0.5);
+      if (out != want) wrong++;
+      blocks++;
+      sum = n = 0;
+    } else if (n == F) {
+      wrong++;   // a full block produced nothing
+    }
+  }
+  printf("Decimator<%d>: %lu blocks, %lu not the rounded mean\n", SHIFT, (unsigned long)blocks,
+         (unsigned long)wrong);
+  check(wrong == 0 && blocks == N / F, "decimator output is not the rounded block mean");
+}
+
+static double signal(int i) { return 2000 + 1500 * sin(i / 40000.0 * 2 * M_PI); }
+
+template <uint8_t SHIFT>
+static void checkDecimatorNoise() {
+  Decimator<SHIFT> d;
+  const uint32_t F = 1u << SHIFT;
+  double rawSq = 0, outSq = 0, clean = 0;
+  uint32_t outs = 0;
+  for (int i = 0; i < N; i++) {
+    double s = signal(i);
+    int v = (int)floor(s + 0.5) + rnd(49) - 24;
+    uint16_t out;
+    rawSq += (v - s) * (v - s);
+    clean += s;
+    if (d.push((uint16_t)std::min(4095, std::max(0, v)), out)) {
+      double e = out - clean / F;
+      outSq += e * e;
+      outs++;
+      clean = 0;
+    }
+  }
+  double rawRms = sqrt(rawSq / N), outRms = sqrt(outSq / outs);
+  printf("Decimator<%d>: noise rms %.2f -> %.2f counts (%.1fx, sqrt(%lu) = %.1f)\n", SHIFT, rawRms, outRms,
+         rawRms / outRms, (unsigned long)F, sqrt((double)F));
+  check(rawRms / outRms > 0.7 * sqrt((double)F), "decimator doesn't reduce noise by ~sqrt(factor)");
+}
+
+// Shaped like esp_adc_cal's 11 dB characteristic at the default 1100 mV
+// reference: linear with an offset, flattening towards the top codes
+static double curveMv(uint32_t raw) {
+  double mv = 142 + 0.8 * raw;
+  if (raw > 2880) mv -= 1.883e-4 * (raw - 2880.0) * (raw - 2880.0);
+  return mv;
+}
+
+static void checkLut(const AdcCalLut &lut, double (*ref)(uint32_t), const char *name, double tol) {
+  double worst = 0, sq = 0;
+  uint16_t at = 0;
+  for (uint32_t raw = 0; raw < 4096; raw++) {
+    double e = fabs(lut.toMv((uint16_t)raw) - ref(raw));
+    if (e > worst) worst = e, at = (uint16_t)raw;
+    sq += e * e;
+  }
+  printf("AdcCalLut %-24s max %.2f mV (code %u), rms %.2f mV  %s\n", name, worst, at, sqrt(sq / 4096),
+         worst <= tol ? "ok" : "FAIL");
+  check(worst <= tol, "calibration table strays from its curve");
+}
+
+static double linearMv(uint32_t raw) { return raw / 4095.0 * 3300; }
+
+template <typename F>
+static void bench(const char *name, F f) {
+  double best = 1e30;
+  for (int run = 0; run < RUNS; run++) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+  }
+  printf("%-40s %8.1f Msamples/s (%.2f ns/sample)\n", name, N / best / 1e6, best * 1e9 / N);
+}
+
+int main() {
+  checkDecimatorExact<4>();
+  checkDecimatorExact<6>();
+  checkDecimatorNoise<4>();
+  checkDecimatorNoise<6>();
+
+  AdcCalLut linear, curve;
+  linear.setLinear(3300);
+  curve.build([](uint32_t raw) { return (uint16_t)floor(curveMv(raw) + 0.5); });
+  checkLut(linear, linearMv, "setLinear(3300)", 1.0);
+  checkLut(curve, curveMv, "11 dB-like curve", 2.0);
+  check(curve.toMv(4095) == (uint16_t)floor(curveMv(4095) + 0.5), "full-scale code isn't the table's own value");
+
+  std::vector<uint16_t> raw(N);
+  for (int i = 0; i < N; i++) raw[i] = (uint16_t)std::min(4095, std::max(0, (int)signal(i) + rnd(49) - 24));
+  volatile uint32_t sink = 0;
+  volatile float fsink = 0;
+  printf("\n");
+  bench("Decimator<6>::push", [&] {
+    Decimator<6> d;
+    uint32_t acc = 0;
+    uint16_t out;
+    for (int i = 0; i < N; i++)
+      if (d.push(raw[i], out)) acc += out;
+    sink += acc;
+  });
+  bench("AdcCalLut::toMv", [&] {
+    uint32_t acc = 0;
+    for (int i = 0; i < N; i++) acc += curve.toMv(raw[i]);
+    sink += acc;
+  });
+  bench("push + toMv per output (AdcStream::poll)", [&] {
+    Decimator<6> d;
+    uint32_t acc = 0;
+    uint16_t out;
+    for (int i = 0; i < N; i++)
+      if (d.push(raw[i], out)) acc += curve.toMv(out);
+    sink += acc;
+  });
+  bench("float (raw / 4095.0) * 3.3 per sample", [&] {
+    float acc = 0;
+    for (int i = 0; i < N; i++) acc += (raw[i] / 4095.0f) * 3.3f;
+    fsink += acc;
+  });
+
+  return checkResult();
+}
@@ -0,0 +1,106 @@
+// bench_compare: flag micro-benchmark regressions against a stored baseline
+//
+//   g++ -std=c++11 -O2 bench_compare.cpp -o bench_compare
+//   ./bench_compare baseline.txt current.txt [tolerance% = 10] [floor = 2]
+//
+// Both files are whatever captured the "bench,..." lines (a serial log from
+// the bench project, micro_bench output); every other line is skipped. The
+// cases are matched by name and compared on p50:
+//
+//   SLOWER   p50 above baseline by more than tolerance% and by more than
+//            `floor` units (so a 3 -> 4 cycle blip on a tiny case isn't one)
+//   faster   the same margins the other way (worth a new baseline)
+//   MISSING  in the baseline but not in the current run
+//   new      in the current run only
+//
+// Exits 1 on any SLOWER or MISSING case, or when the units differ (a host
+// run against a device baseline). To take a new baseline, keep the current
+// file in its place.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct Case {
+  std::string name, unit;
+  double min, p50, max;
+};
+
+static bool load(const char *path, std::vector<Case> &cases) {
+  FILE *f = fopen(path, "r");
+  if (!f) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    const char *p = strstr(line, "bench,");   // serial logs may prefix the line
+    if (!p) continue;
+    char name[96], unit[16];
+    Case c;
+    if (sscanf(p, "bench,%95[^,],%15[^,],%lf,%lf,%lf", name, unit, &c.min, &c.p50, &c.max) != 5) continue;
+    c.name = name;
+    c.unit = unit;
+    cases.push_back(c);
+  }
+  fclose(f);
+  return true;
+}
+
+static const Case *find(const std::vector<Case> &cases, const std::string &name) {
+  for (const Case &c : cases)
+    if (c.name == name) return &c;
+  return nullptr;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s baseline.txt current.txt [tolerance%% = 10] [floor = 2]\n", argv[0]);
+    return 2;
+  }
+  double tolerance = argc > 3 ? atof(argv[3]) / 100 : 0.10;
+  double floor = argc > 4 ? atof(argv[4]) : 2;
+  std::vector<Case> base, cur;
+  if (!load(argv[1], base) || !load(argv[2], cur)) {
+    fprintf(stderr, "can't read %s\n", base.empty() ? argv[1] : argv[2]);
+    return 2;
+  }
+
+  int slower = 0, faster = 0, missing = 0, added = 0, bad = 0;
+  printf("%-30s %-7s %10s %10s %8s\n", "case", "unit", "baseline", "current", "change");
+  for (const Case &b : base) {
+    const Case *c = find(cur, b.name);
+    if (!c) {
+      printf("%-30s %-7s %10.1f %10s %8s  MISSING\n", b.name.c_str(), b.unit.c_str(), b.p50, "-", "");
+      missing++;
+      continue;
+    }
+    if (c->unit != b.unit) {
+      printf("%-30s %-7s %10.1f %10.1f %8s  UNIT %s\n", b.name.c_str(), b.unit.c_str(), b.p50, c->p50, "",
+             c->unit.c_str());
+      bad++;
+      continue;
+    }
+    double d = c->p50 - b.p50;
+    const char *flag = "";
+    if (d > b.p50 * tolerance && d > floor) {
+      flag = "  SLOWER";
+      slower++;
+    } else if (-d > b.p50 * tolerance && -d > floor) {
+      flag = "  faster";
+      faster++;
+    }
+    char change[16] = "";
+    if (b.p50 > 0) snprintf(change, sizeof(change), "%+.0f%%", 100 * d / b.p50);
+    printf("%-30s %-7s %10.1f %10.1f %8s%s\n", b.name.c_str(), b.unit.c_str(), b.p50, c->p50, change, flag);
+  }
+  for (const Case &c : cur)
+    if (!find(base, c.name)) {
+      printf("%-30s %-7s %10s %10.1f %8s  new\n", c.name.c_str(), c.unit.c_str(), "-", c.p50, "");
+      added++;
+    }
+
+  printf("%zu cases: %d slower, %d faster, %d missing, %d new%s (tolerance %.0f%%, floor %g)\n", base.size(),
+         slower, faster, missing, added, bad ? ", unit mismatch" : "", tolerance * 100, floor);
+  return slower || missing || bad ? 1 : 0;
+}
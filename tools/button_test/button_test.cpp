@@ -0,0 +1,235 @@
+// button_test: VerticalDebounce + PressClassifier on bouncing contact traces
+//
+//   g++ -std=c++11 -O2 -I../../lib/ButtonScan button_test.cpp -o button_test
+//   ./button_test
+//
+// Drives all 32 lanes at once, the way ButtonScan's timer ISR does: every
+// lane gets its own random press sequence with contact chatter on both
+// edges (20-500 us pulses for up to 30 ms, like the simulator's "bounce"
+// script step), and the line is sampled every 10 ms at a random phase.
+// Holds are either clearly short or clearly long and gaps clearly inside or
+// outside the double-press window, so a reference classifier working on
+// the clean press times knows the exact events each lane must produce.
+// Checks that:
+//   - every lane produces exactly the reference event sequence (PRESS /
+//     RELEASE / SHORT / LONG / DOUBLE), half the lanes with double-press
+//     detection on,
+//   - debounced edges come no later than the chatter plus four samples,
+//     and RELEASE's heldMs is the hold time within that,
+//   - glitches of 1-3 samples never toggle a lane and 4 samples always do,
+//   - a 70 s hold reports heldMs 70000 (no 16-bit wrap),
+//   - a long second press on a double-press pin reports the first press
+//     as SHORT with its own held time, then LONG.
+// Exits 1 on any failed check.
+
+#include <stdio.h>
+#include <vector>
+#include "ButtonLogic.h"
+#include "../common/Check.h"
+
+static const uint32_t PERIOD_MS = 10;
+static const uint32_t LONG_MS = 1000, GAP_MS = 300;
+static const uint32_t MAX_BOUNCE_US = 30000;
+static const uint32_t LATENCY_MS = MAX_BOUNCE_US / 1000 + 4 * PERIOD_MS + PERIOD_MS;
+
+static uint32_t g_seed = 1;
+static uint32_t rnd(uint32_t n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (g_seed >> 8) % n;
+}
+
+struct Press {
+  uint32_t downUs, upUs;
+  uint32_t bounceUs;
+};
+
+// Level changes of one lane, in us
+struct Lane {
+  std::vector<Press> presses;
+  std::vector<uint32_t> edgeUs;   // the line toggles at each, starting released
+  size_t next = 0;
+  bool level = false;
+
+  void chatter(uint32_t at, uint32_t bounceUs, bool settle) {
+    uint32_t t = at;
+    bool l = settle;
+    while (t < at + bounceUs) {
+      if (level != l) edgeUs.push_back(t), level = l;
+      l = !l;
+      t += 20 + rnd(481);
+    }
+    if (level != settle) edgeUs.push_back(t), level = settle;
+  }
+};
+
+// Clean-time classification, the same rules as PressClassifier
+static std::vector<uint8_t> reference(const std::vector<Press> &p, bool dbl) {
+  std::vector<uint8_t> ev;
+  auto isLong = [](const Press &x) { return x.upUs - x.downUs >= LONG_MS * 1000; };
+  for (size_t i = 0; i < p.size(); i++) {
+    ev.push_back(BTN_PRESS);
+    if (isLong(p[i])) {
+      ev.push_back(BTN_LONG);
+      ev.push_back(BTN_RELEASE);
+      continue;
+    }
+    ev.push_back(BTN_RELEASE);
+    if (dbl && i + 1 < p.size() && p[i + 1].downUs - p[i].upUs < GAP_MS * 1000) {
+      ev.push_back(BTN_PRESS);
+      i++;
+      if (isLong(p[i])) {
+        ev.push_back(BTN_SHORT);
+        ev.push_back(BTN_LONG);
+        ev.push_back(BTN_RELEASE);
+      } else {
+        ev.push_back(BTN_RELEASE);
+        ev.push_back(BTN_DOUBLE);
+      }
+      continue;
+    }
+    ev.push_back(BTN_SHORT);
+  }
+  return ev;
+}
+
+struct Log {
+  std::vector<ButtonEvent> ev[32];
+  void operator()(const ButtonEvent &e) { ev[e.pin].push_back(e); }
+};
+
+static void checkTraces() {
+  static const uint32_t RUN_US = 600u * 1000 * 1000;   // 10 min per lane
+  Lane lanes[32];
+  for (int l = 0; l < 32; l++) {
+    Lane &ln = lanes[l];
+    uint32_t t = 100000 + rnd(1000000);
+    for (;;) {
+      // Short 80-700 ms or long 1300-3000 ms; the gap after it well inside
+      // or well outside the double-press window
+      uint32_t hold = rnd(3) ? 80000 + rnd(620000) : 1300000 + rnd(1700000);
+      uint32_t gap = rnd(2) ? 90000 + rnd(110000) : 450000 + rnd(1500000);
+      if (t + hold + gap + MAX_BOUNCE_US > RUN_US - 3000000) break;
+      Press p = {t, t + hold, rnd(MAX_BOUNCE_US + 1)};
+      ln.chatter(p.downUs, p.bounceUs, true);
+      ln.chatter(p.upUs, p.bounceUs, false);
+      ln.presses.push_back(p);
+      t += hold + gap;
+    }
+    ln.level = false;
+  }
+
+  VerticalDebounce deb;
+  PressClassifier cls;
+  cls.longMs = LONG_MS;
+  cls.doubleGapMs = GAP_MS;
+  cls.doubleMask = 0xAAAAAAAA;
+  Log log;
+  uint32_t phaseUs = rnd(PERIOD_MS * 1000);
+  for (uint32_t now = PERIOD_MS; now * 1000 + phaseUs < RUN_US; now += PERIOD_MS) {
+    uint32_t at = now * 1000 + phaseUs, word = 0;
+    for (int l = 0; l < 32; l++) {
+      Lane &ln = lanes[l];
+      while (ln.next < ln.edgeUs.size() && ln.edgeUs[ln.next] <= at) ln.level = !ln.level, ln.next++;
+      if (ln.level) word |= 1u << l;
+    }
+    uint32_t toggled = deb.update(word);
+    cls.update(deb.state(), toggled, now, log);
+  }
+
+  size_t presses = 0, events = 0;
+  for (int l = 0; l < 32; l++) {
+    const Lane &ln = lanes[l];
+    std::vector<uint8_t> want = reference(ln.presses, (cls.doubleMask >> l) & 1);
+    const std::vector<ButtonEvent> &got = log.ev[l];
+    bool same = want.size() == got.size();
+    for (size_t k = 0; same && k < want.size(); k++) same = got[k].type == want[k];
+    checkf(same, "lane %d: event sequence differs from the reference", l);
+    presses += ln.presses.size();
+    events += got.size();
+
+    // Edge latency and held time, press by press
+    size_t pi = 0;
+    for (const ButtonEvent &e : got) {
+      if (pi >= ln.presses.size()) break;
+      const Press &p = ln.presses[pi];
+      uint32_t t = e.timeMs * 1000 + phaseUs;
+      if (e.type == BTN_PRESS) {
+        checkf(t >= p.downUs && t <= p.downUs + LATENCY_MS * 1000, "lane %d: press edge late", l);
+      } else if (e.type == BTN_RELEASE) {
+        checkf(t >= p.upUs && t <= p.upUs + LATENCY_MS * 1000, "lane %d: release edge late", l);
+        int32_t err = (int32_t)(e.heldMs * 1000) - (int32_t)(p.upUs - p.downUs);
+        checkf(err > -(int32_t)(LATENCY_MS * 1000) && err < (int32_t)(LATENCY_MS * 1000), "lane %d: heldMs off", l);
+        pi++;
+      }
+    }
+  }
+  printf("32 lanes, %lu bouncing presses over 10 min: %lu events, %s\n", (unsigned long)presses,
+         (unsigned long)events, g_failed ? "FAIL" : "all as the reference");
+}
+
+static void checkGlitches() {
+  for (int start = 0; start < 2; start++) {
+    for (uint32_t len = 1; len <= 4; len++) {
+      VerticalDebounce d;
+      uint32_t base = start ? 0xFFFFFFFF : 0;
+      for (int i = 0; i < 8; i++) d.update(base);   // settle
+      uint32_t toggles = 0;
+      for (uint32_t i = 0; i < len; i++) toggles |= d.update(~base);
+      for (int i = 0; i < 8; i++) toggles |= d.update(d.state());
+      bool flipped = d.state() != base;
+      printf("%s glitch of %lu sample%s: %s\n", start ? "release" : "press  ", (unsigned long)len,
+             len > 1 ? "s" : " ", flipped ? "taken" : "ignored");
+      check(flipped == (len >= 4) && (toggles == 0xFFFFFFFF) == (len >= 4), "glitch length rule");
+    }
+  }
+}
+
+// Feeds already clean levels for one pin; returns the events
+static std::vector<ButtonEvent> play(PressClassifier &cls, const uint32_t *edgesMs, int n, uint32_t untilMs) {
+  VerticalDebounce d;
+  Log log;
+  uint32_t level = 0;
+  int k = 0;
+  for (uint32_t now = PERIOD_MS; now <= untilMs; now += PERIOD_MS) {
+    while (k < n && edgesMs[k] <= now) level ^= 1, k++;
+    uint32_t toggled = d.update(level);
+    cls.update(d.state(), toggled, now, log);
+  }
+  return log.ev[0];
+}
+
+static void checkLongHold() {
+  PressClassifier cls;
+  static const uint32_t E[] = {1000, 71000};
+  std::vector<ButtonEvent> ev = play(cls, E, 2, 73000);
+  bool ok = ev.size() == 3 && ev[0].type == BTN_PRESS && ev[1].type == BTN_LONG && ev[2].type == BTN_RELEASE;
+  printf("70 s hold: %u events, RELEASE heldMs %lu\n", (unsigned)ev.size(),
+         ev.size() == 3 ? (unsigned long)ev[2].heldMs : 0UL);
+  check(ok && ev[2].heldMs == 70000, "70 s hold not reported as 70000 ms");
+}
+
+static void checkLongSecondPress() {
+  PressClassifier cls;
+  cls.doubleMask = 1;
+  static const uint32_t E[] = {1000, 1150, 1300, 3000};   // 150 ms, 150 ms gap, 1.7 s
+  std::vector<ButtonEvent> ev = play(cls, E, 4, 4000);
+  static const uint8_t WANT[] = {BTN_PRESS, BTN_RELEASE, BTN_PRESS, BTN_SHORT, BTN_LONG, BTN_RELEASE};
+  bool ok = ev.size() == 6;
+  for (size_t k = 0; ok && k < 6; k++) ok = ev[k].type == WANT[k];
+  printf("short then long press: %s", ok ? "" : "wrong sequence");
+  if (ok)
+    printf("SHORT heldMs %lu, LONG at +%lu ms from the second press\n", (unsigned long)ev[3].heldMs,
+           (unsigned long)(ev[4].timeMs - ev[2].timeMs));
+  else
+    printf("\n");
+  check(ok && ev[3].heldMs == 150 && ev[4].timeMs - ev[2].timeMs == LONG_MS,
+        "long second press lost the first SHORT or timed LONG from the first press");
+}
+
+int main() {
+  checkTraces();
+  checkGlitches();
+  checkLongHold();
+  checkLongSecondPress();
+  return checkResult();
+}
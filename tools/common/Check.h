@@ -0,0 +1,55 @@
+// Check: pass / fail bookkeeping shared by the host tests in tools/
+//
+//   #include "../common/Check.h"
+//
+//   check(got == want, "decodes the frame", "DHT22");   // FAIL DHT22      decodes the frame
+//   checkf(ok, "lane %d: %u events", lane, n);          // FAIL lane 3: 2 events
+//   ...
+//   return checkResult();                               // 1 if anything failed
+//
+// Every failure is counted in g_failed; only the first CHECK_PRINT are
+// printed, so a broken loop doesn't bury the first (most useful) message.
+// Header only: each tool is one translation unit.
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifndef CHECK_PRINT
+#define CHECK_PRINT 20
+#endif
+
+static int g_failed = 0;
+
+// `name` is the case the check belongs to (frame, effect, melody ...)
+static inline bool check(bool ok, const char *what, const char *name = nullptr) {
+  if (ok) return true;
+  if (g_failed++ >= CHECK_PRINT) return false;
+  if (name) printf("FAIL %-10s %s\n", name, what);
+  else printf("FAIL %s\n", what);
+  return false;
+}
+
+// The message is formatted only when the check fails
+__attribute__((format(printf, 2, 3))) static inline bool checkf(bool ok, const char *fmt, ...) {
+  if (ok) return true;
+  if (g_failed++ >= CHECK_PRINT) return false;
+  va_list ap;
+  va_start(ap, fmt);
+  printf("FAIL ");
+  vprintf(fmt, ap);
+  printf("\n");
+  va_end(ap);
+  return false;
+}
+
+// Final line and exit status
+static inline int checkResult() {
+  if (g_failed) {
+    printf("%d checks failed\n", g_failed);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,220 @@
+// dht_decode_test: dhtDecode / dhtConvert against DHT11 / DHT22 waveforms
+//
+//   g++ -std=c++11 -O2 -I../../lib/DhtRmt dht_decode_test.cpp ../../lib/DhtRmt/DhtDecode.cpp -o dht_decode_test
+//   ./dht_decode_test
+//
+// Builds pulse trains the way the RMT receiver hands them to DhtRmt (level +
+// duration in us, the line floating high before the handshake) and checks
+// that:
+//   - DHT11 and DHT22 frames decode and convert to the right tenths,
+//     including negative temperatures, at datasheet timing and with every
+//     pulse jittered by up to +-8 us (the 1 us RMT resolution included),
+//   - each corrupted capture gets the status that describes it: empty,
+//     no handshake, cut short anywhere, a noise spike inside a bit (in
+//     the last bit only the first half is read, so it must not change the
+//     bytes), a stretched cell, and every single data-bit flip,
+//   - random single-pulse damage (duration changed, pulse dropped or
+//     doubled) is never accepted as a reading with different bytes.
+// Also prints which high-cell widths decode as 0, as 1 and as bad timing.
+// Exits 1 on any failed check.
+
+#include <stdio.h>
+#include <string.h>
+#include "DhtDecode.h"
+#include "../common/Check.h"
+
+static const size_t MAX_PULSES = 96;
+
+struct Capture {
+  DhtPulse p[MAX_PULSES];
+  size_t n = 0;
+  void add(uint8_t level, int us) { p[n++] = {level, (uint16_t)(us < 1 ? 1 : us)}; }
+};
+
+static uint32_t g_seed = 1;
+static int rnd(int n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (int)((g_seed >> 16) % (uint32_t)n);
+}
+
+// Datasheet waveform; jitter moves every pulse by up to +-jitter us
+static Capture frame(const uint8_t b[5], int jitter = 0) {
+  Capture c;
+  auto j = [&] { return jitter ? rnd(2 * jitter + 1) - jitter : 0; };
+  c.add(1, 30 + j());   // line released by the host
+  c.add(0, 80 + j());   // handshake
+  c.add(1, 80 + j());
+  for (int i = 0; i < 40; i++) {
+    c.add(0, 50 + j());
+    c.add(1, ((b[i / 8] >> (7 - i % 8)) & 1 ? 70 : 27) + j());
+  }
+  c.add(0, 50 + j());   // sensor releases the line, the RMT idles out
+  return c;
+}
+
+static void withSum(uint8_t b[5]) { b[4] = (uint8_t)(b[0] + b[1] + b[2] + b[3]); }
+
+static DhtStatus decode(const Capture &c, uint8_t out[5]) { return dhtDecode(c.p, c.n, out); }
+
+struct Known {
+  const char *name;
+  uint8_t type;
+  uint8_t b[4];
+  int16_t tempTenths;
+  uint16_t humTenths;
+};
+
+static const Known KNOWN[] = {
+  {"dht11", DHT11, {45, 0, 23, 4}, 234, 450},
+  {"dht11-neg", DHT11, {80, 0, 2, 0x85}, -25, 800},
+  {"dht22", DHT22, {0x02, 0x8C, 0x01, 0x5F}, 351, 652},
+  {"dht22-neg", DHT22, {0x03, 0xE8, 0x80, 0x65}, -101, 1000},
+  {"dht22-zero", DHT22, {0x00, 0x00, 0x00, 0x00}, 0, 0},
+};
+
+static void checkKnown() {
+  for (const Known &k : KNOWN) {
+    uint8_t b[5] = {k.b[0], k.b[1], k.b[2], k.b[3], 0};
+    withSum(b);
+    int bad = 0;
+    for (int run = 0; run < 2000; run++) {
+      Capture c = frame(b, run ? 8 : 0);
+      uint8_t out[5];
+      int16_t t = 0;
+      uint16_t h = 0;
+      DhtStatus s = decode(c, out);
+      if (s == DHT_OK) dhtConvert(k.type, out, t, h);
+      if (s != DHT_OK || memcmp(out, b, 5) || t != k.tempTenths || h != k.humTenths) {
+        if (!bad) printf("  %s run %d: %s, %d / %u tenths\n", k.name, run, dhtStatusName(s), t, h);
+        bad++;
+      }
+    }
+    printf("%-10s %5.1f degC %5.1f %%RH: %d of 2000 captures wrong\n", k.name, k.tempTenths / 10.0,
+           k.humTenths / 10.0, bad);
+    check(bad == 0, "clean or jittered capture not decoded", k.name);
+  }
+}
+
+static void expect(const Capture &c, DhtStatus want, const char *name) {
+  uint8_t out[5];
+  DhtStatus s = decode(c, out);
+  if (s != want) printf("  %s: got %s, want %s\n", name, dhtStatusName(s), dhtStatusName(want));
+  check(s == want, "wrong status", name);
+}
+
+static void checkCorrupted() {
+  uint8_t b[5] = {0x02, 0x8C, 0x01, 0x5F, 0};
+  withSum(b);
+  const Capture good = frame(b);
+
+  expect(Capture(), DHT_TIMEOUT, "empty");
+
+  Capture floating;
+  floating.add(1, 30);
+  floating.add(0, 20);   // host pulse edge only, sensor never answers
+  expect(floating, DHT_NO_RESPONSE, "no-answer");
+
+  // Cut after every pulse: before the handshake pair completes nothing has
+  // answered, after it the frame is short
+  for (size_t n = 1; n < good.n - 1; n++) {
+    Capture c = good;
+    c.n = n;
+    expect(c, n < 3 ? DHT_NO_RESPONSE : DHT_TRUNCATED, "cut");
+  }
+
+  // A noise spike splits a high cell into high / low / high. In the last
+  // cell the decoder stops at the first half, which still holds the bit
+  for (int bit = 0; bit < 40; bit++) {
+    Capture c;
+    for (size_t k = 0; k < good.n; k++) {
+      if (k == 4 + 2 * (size_t)bit) {
+        c.add(1, good.p[k].us / 2);
+        c.add(0, 2);
+        c.add(1, good.p[k].us - good.p[k].us / 2 - 2);
+      } else {
+        c.p[c.n++] = good.p[k];
+      }
+    }
+    if (bit < 39) {
+      expect(c, DHT_BAD_TIMING, "spike");
+    } else {
+      uint8_t out[5];
+      DhtStatus s = decode(c, out);
+      check(s != DHT_OK || !memcmp(out, b, 5), "spike in the last cell accepted with wrong bytes", "spike");
+    }
+  }
+
+  // A cell held far longer than a 1 (sensor stalled mid-frame)
+  for (int bit = 0; bit < 40; bit++) {
+    Capture c = good;
+    c.p[4 + 2 * bit].us = 150;
+    expect(c, DHT_BAD_TIMING, "stretched");
+  }
+
+  // Every single data or checksum bit flipped in the waveform
+  for (int bit = 0; bit < 40; bit++) {
+    Capture c = good;
+    DhtPulse &cell = c.p[4 + 2 * bit];
+    cell.us = cell.us > 48 ? 27 : 70;
+    expect(c, DHT_CHECKSUM, "bit-flip");
+  }
+}
+
+static void checkFuzz() {
+  static const int TRIALS = 200000;
+  int count[DHT_TIMEOUT + 1] = {};
+  int falseAccept = 0;
+  for (int t = 0; t < TRIALS; t++) {
+    uint8_t b[5];
+    for (int k = 0; k < 4; k++) b[k] = (uint8_t)rnd(256);
+    withSum(b);
+    Capture src = frame(b, 5), c;
+    size_t at = (size_t)rnd((int)src.n);
+    int kind = rnd(3);
+    for (size_t k = 0; k < src.n; k++) {
+      if (k != at) c.p[c.n++] = src.p[k];
+      else if (kind == 0) c.add(src.p[k].level, rnd(200));   // duration changed
+      else if (kind == 2) c.p[c.n++] = src.p[k], c.p[c.n++] = src.p[k];   // doubled
+      // kind 1: dropped
+    }
+    uint8_t out[5];
+    DhtStatus s = decode(c, out);
+    count[s]++;
+    if (s == DHT_OK && memcmp(out, b, 5)) falseAccept++;
+  }
+  printf("fuzz %d single-pulse faults:", TRIALS);
+  for (int s = 0; s <= DHT_TIMEOUT; s++)
+    if (count[s]) printf(" %s %d", dhtStatusName((DhtStatus)s), count[s]);
+  printf(", wrong bytes accepted %d\n", falseAccept);
+  check(falseAccept == 0, "damaged capture accepted with wrong bytes", "fuzz");
+}
+
+// Which high-cell widths read as 0, 1 or bad timing
+static void printMargins() {
+  uint8_t b[5] = {0xFF, 0xFF, 0xFF, 0xFF, 0};
+  withSum(b);
+  int lo0 = -1, hi0 = -1, lo1 = -1, hi1 = -1;
+  for (int us = 1; us <= 200; us++) {
+    Capture c = frame(b);
+    c.p[4].us = (uint16_t)us;   // first data bit
+    uint8_t out[5];
+    DhtStatus s = decode(c, out);
+    if (s == DHT_OK) {
+      if (lo1 < 0) lo1 = us;
+      hi1 = us;
+    } else if (s == DHT_CHECKSUM) {
+      if (lo0 < 0) lo0 = us;
+      hi0 = us;
+    }
+  }
+  printf("high cell reads as 0 for %d..%d us, as 1 for %d..%d us, bad timing otherwise\n", lo0, hi0, lo1, hi1);
+  check(lo0 <= 20 && hi0 >= 35 && lo1 <= 60 && hi1 >= 85, "bit margins narrower than +-8 us jitter", "margins");
+}
+
+int main() {
+  checkKnown();
+  checkCorrupted();
+  checkFuzz();
+  printMargins();
+  return checkResult();
+}
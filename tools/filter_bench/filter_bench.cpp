@@ -0,0 +1,165 @@
+// filter_bench: SensorFilter accuracy against double precision, and speed
+//
+//   g++ -std=c++11 -O2 -I../../lib/SensorFilter filter_bench.cpp -o filter_bench
+//   ./filter_bench
+//
+// Feeds two synthetic traces through each stage and through the same filter
+// written in double: an LDR trace (12-bit counts following a slow light
+// curve, a few counts of noise, a spike every ~200 samples) and a DHT11
+// temperature trace (0.1 degC units quantised to whole degrees). Reports
+// the worst and RMS difference from the reference in sample units, how far
+// raw and filtered samples are from the noise-free signal, and samples per
+// second, best of several runs. Exits 1 if a stage strays further from its
+// reference than its tolerance.
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include "SensorFilter.h"
+#include "../common/Check.h"
+
+static const int N = 200000;
+static const int RUNS = 10;
+
+struct Trace {
+  const char *name;
+  std::vector<int32_t> raw;    // what the sensor reports
+  std::vector<double> clean;   // the signal without noise
+};
+
+static uint32_t g_seed = 1;
+static int rnd(int n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (int)((g_seed >> 16) % (uint32_t)n);
+}
+
+static Trace ldrTrace() {
+  Trace tr = {"LDR counts", {}, {}};
+  for (int i = 0; i < N; i++) {
+    double v = 2000 + 1500 * sin(i / 20000.0 * 2 * M_PI);
+    int32_t r = (int32_t)lround(v) + rnd(13) - 6;
+    if (rnd(200) == 0) r += rnd(2) ? 800 : -800;
+    tr.raw.push_back(std::min(4095, std::max(0, r)));
+    tr.clean.push_back(v);
+  }
+  return tr;
+}
+
+static Trace tempTrace() {
+  Trace tr = {"DHT11 0.1 C", {}, {}};
+  for (int i = 0; i < N; i++) {
+    double v = 225 + 30 * sin(i / 5000.0 * 2 * M_PI);
+    tr.raw.push_back(10 * (int32_t)lround((v + rnd(7) - 3) / 10));
+    tr.clean.push_back(v);
+  }
+  return tr;
+}
+
+// ---- Double-precision references ----
+
+struct RefMedian {
+  explicit RefMedian(int n) : n(n) {}
+  double step(double x) {
+    win.push_back(x);
+    if ((int)win.size() > n) win.erase(win.begin());
+    std::vector<double> s = win;
+    std::sort(s.begin(), s.end());
+    return s[(s.size() - 1) / 2];
+  }
+  int n;
+  std::vector<double> win;
+};
+
+struct RefEma {
+  explicit RefEma(double a) : a(a) {}
+  double step(double x) { return y = started ? y + a * (x - y) : (started = true, x); }
+  double a, y = 0;
+  bool started = false;
+};
+
+struct RefKalman {
+  RefKalman(double q, double r) : q(q), r(r) {}
+  double step(double z) {
+    if (!started) {
+      started = true;
+      p = r;
+      return x = z;
+    }
+    double pp = p + q, k = pp / (pp + r);
+    x += k * (z - x);
+    p = (1 - k) * pp;
+    return x;
+  }
+  double q, r, x = 0, p = 0;
+  bool started = false;
+};
+
+// ---- Accuracy and speed ----
+
+template <typename Chain, typename Ref>
+static void accuracy(const char *stage, const Trace &tr, Ref ref, double tolerance) {
+  Chain chain;
+  double worst = 0, sq = 0, rawSq = 0, outSq = 0;
+  for (size_t i = 0; i < tr.raw.size(); i++) {
+    double y = chain.push(tr.raw[i]) / 65536.0;
+    double e = y - ref.step(tr.raw[i]);
+    worst = std::max(worst, fabs(e));
+    sq += e * e;
+    rawSq += (tr.raw[i] - tr.clean[i]) * (tr.raw[i] - tr.clean[i]);
+    outSq += (y - tr.clean[i]) * (y - tr.clean[i]);
+  }
+  size_t n = tr.raw.size();
+  bool ok = worst <= tolerance;
+  printf("%-12s %-26s vs double: max %.4f rms %.4f %s  | noise rms %.2f -> %.2f\n", tr.name, stage, worst,
+         sqrt(sq / n), ok ? "ok  " : "FAIL", sqrt(rawSq / n), sqrt(outSq / n));
+  check(ok, "strays from the double reference", stage);
+}
+
+static volatile int32_t g_sink;
+
+template <typename Chain>
+static void speed(const char *stage, const Trace &tr) {
+  double best = 1e9;
+  for (int r = 0; r < RUNS; r++) {
+    Chain chain;
+    int32_t sum = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < tr.raw.size(); i++) sum += chain.push(tr.raw[i]);
+    auto t1 = std::chrono::steady_clock::now();
+    g_sink = sum;
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  printf("%-38s %8.1f Msamples/s (%.2f ns/sample)\n", stage, tr.raw.size() / best / 1e6, best * 1e9 / tr.raw.size());
+}
+
+typedef Median<5> Med5;
+typedef Ema<q15(0.1)> Ema01;
+typedef Kalman<q16(0.5), q16(8.0)> Kal;
+
+int main() {
+  Trace ldr = ldrTrace(), temp = tempTrace();
+
+  // Median reorders the Q16 inputs exactly; EMA and Kalman round once per
+  // step, so they may drift from the reference by a few 1/65536 units
+  accuracy<FilterChain<Med5>>("Median<5>", ldr, RefMedian(5), 0.0);
+  accuracy<FilterChain<Ema01>>("Ema<0.1>", ldr, RefEma(q15(0.1) / 32768.0), 0.01);
+  accuracy<FilterChain<Kal>>("Kalman<0.5, 8>", ldr, RefKalman(0.5, 8.0), 0.05);
+  accuracy<FilterChain<Ema01>>("Ema<0.1>", temp, RefEma(q15(0.1) / 32768.0), 0.01);
+  accuracy<FilterChain<Kal>>("Kalman<0.5, 8>", temp, RefKalman(0.5, 8.0), 0.05);
+
+  struct RefMedEma {
+    double step(double x) { return ema.step(med.step(x)); }
+    RefMedian med{5};
+    RefEma ema{q15(0.1) / 32768.0};
+  };
+  accuracy<FilterChain<Med5, Ema01>>("Median<5> + Ema<0.1>", ldr, RefMedEma(), 0.01);
+
+  speed<FilterChain<Med5>>("Median<5>", ldr);
+  speed<FilterChain<Ema01>>("Ema<0.1>", ldr);
+  speed<FilterChain<Kal>>("Kalman<0.5, 8>", ldr);
+  speed<FilterChain<Med5, Ema01>>("Median<5> + Ema<0.1>  (HomeTask1 LDR)", ldr);
+  speed<FilterChain<Kal>>("Kalman<0.5, 8>  (HomeTask1 DHT)", temp);
+  return checkResult();
+}
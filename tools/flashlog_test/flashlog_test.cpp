@@ -0,0 +1,243 @@
+// flashlog_test: FlashLog on a FileFlash through random power cuts, and
+// append / query speed
+//
+//   g++ -std=c++11 -O2 -I../../lib/FlashLog -I../../lib/SampleStore -I../../lib/SeriesCodec
+//       -I../../lib/Telemetry flashlog_test.cpp ../../lib/FlashLog/FlashLog.cpp
+//       ../../lib/FlashLog/FlashDev.cpp -o flashlog_test
+//   FLASHLOG_CUTS=2000 ./flashlog_test     (the default count, about 10 s)
+//
+// One small ring (24 segments) is "rebooted" over and over: each round
+// appends DHT-like 1 s samples (with the odd jump and gap, so pages hold
+// different numbers of records) and sometimes flush()es, then the power
+// goes after a random number of programmed / erased bytes, so cuts land in
+// page writes, seals, segment headers and the erase of the oldest segment
+// on wrap. The file is reopened, the power restored and a new FlashLog
+// begin()s on it. Checks that after every reboot:
+//   - the recovered records are one unbroken run of what was appended, in
+//     order, values intact, and records() counts them,
+//   - nothing is lost at the new end that had gone to flash before the
+//     cut (a page write or flush() that completed), so at most the RAM
+//     page goes, and at the old end at most the one segment being erased,
+//   - query() and summary() over random ranges match the reference,
+//   - the log takes new samples after the newest recovered one.
+// Then times append(), a full query(), the last hour and a 24 h summary()
+// on a samplelog-sized (1.44 MB) file. Exits 1 on any failed check.
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include "FlashLog.h"
+#include "../common/Check.h"
+
+static const char *const PATH = "/tmp/flashlog_test.bin";
+static const uint32_t RING_BYTES = 24 * FlashDev::SECTOR_BYTES;
+static const uint32_t BENCH_BYTES = 0x170000;   // the sketches' samplelog partition
+static const uint8_t CH = 2;
+static const int RUNS = 5;
+
+struct Rec {
+  uint64_t t;
+  int16_t v[CH];
+};
+
+static uint32_t g_seed = 1;
+static uint32_t rnd(uint32_t n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (g_seed >> 8) % n;
+}
+
+// Temperature and humidity in 0.1 units, drifting, now and then jumping
+struct Source {
+  uint64_t t = 0;
+  int16_t temp = 230, hum = 450;
+  Rec next() {
+    t += rnd(50) ? 1000 + rnd(40) : 60000 + rnd(3600000);
+    if (rnd(200) == 0) temp = (int16_t)(rnd(600) - 100), hum = (int16_t)rnd(1000);
+    temp = (int16_t)(temp + (int)rnd(3) - 1);
+    hum = (int16_t)(hum + (int)rnd(5) - 2);
+    Rec r = {t, {temp, hum}};
+    return r;
+  }
+};
+
+static std::vector<Rec> readAll(const FlashLog &log) {
+  std::vector<Rec> out;
+  log.forEach(0, UINT64_MAX, [&](uint64_t t, const int16_t *v) {
+    Rec r = {t, {v[0], v[1]}};
+    out.push_back(r);
+  });
+  return out;
+}
+
+static bool sameRec(const Rec &a, const Rec &b) { return a.t == b.t && a.v[0] == b.v[0] && a.v[1] == b.v[1]; }
+
+// Index of the record stamped t in `all` (timestamps are unique), or -1
+static long indexOf(const std::vector<Rec> &all, uint64_t t) {
+  auto it = std::lower_bound(all.begin(), all.end(), t, [](const Rec &r, uint64_t x) { return r.t < x; });
+  return it != all.end() && it->t == t ? (long)(it - all.begin()) : -1;
+}
+
+static void checkQueries(const FlashLog &log, const std::vector<Rec> &ref, int round) {
+  if (ref.empty()) return;
+  uint64_t lo = ref.front().t, hi = ref.back().t;
+  for (int q = 0; q < 20; q++) {
+    uint64_t a = lo + rnd((uint32_t)std::min<uint64_t>(hi - lo + 1, UINT32_MAX));
+    uint64_t b = a + rnd(q < 10 ? 4000000 : 400000000);
+    Rollup want[CH];
+    uint32_t n = 0;
+    bool same = true;
+    size_t k = std::lower_bound(ref.begin(), ref.end(), a, [](const Rec &r, uint64_t x) { return r.t < x; }) -
+               ref.begin();
+    log.forEach(a, b, [&](uint64_t t, const int16_t *v) {
+      Rec r = {t, {v[0], v[1]}};
+      same = same && k + n < ref.size() && sameRec(r, ref[k + n]);
+      n++;
+    });
+    for (size_t i = k; i < ref.size() && ref[i].t <= b; i++)
+      for (uint8_t c = 0; c < CH; c++) want[c].add(ref[i].v[c]);
+    checkf(same && n == want[0].count, "round %d: query() differs from the reference", round);
+    for (uint8_t c = 0; c < CH; c++) {
+      Rollup got = log.summary(a, b, c);
+      checkf(got.count == want[c].count && got.sum == want[c].sum &&
+                 (!got.count || (got.min == want[c].min && got.max == want[c].max)),
+             "round %d: summary() differs from the reference", round);
+    }
+  }
+}
+
+// One boot: recover, check against `ref`, append until the power goes
+struct Ring {
+  FileFlash flash;
+  Source src;
+  std::vector<Rec> ref;    // everything appended, oldest first
+  size_t durable = 0;      // ref[0, durable) had reached flash before the cut
+  uint64_t oldestT = 0;    // first readable record when the power went
+  uint32_t worstLost = 0, torn = 0;
+  uint64_t recovered = 0;
+
+  void boot(int round) {
+    checkf(flash.open(PATH, RING_BYTES), "round %d: can't open the flash file", round);
+    FlashLog log(flash, CH);
+    checkf(log.begin(0), "round %d: begin() failed", round);
+    torn += log.tornPages();
+
+    std::vector<Rec> got = readAll(log);
+    long first = got.empty() ? 0 : indexOf(ref, got.front().t);
+    bool run = first >= 0;
+    for (size_t i = 0; run && i < got.size(); i++) run = first + i < ref.size() && sameRec(got[i], ref[first + i]);
+    checkf(run, "round %d: recovered records aren't an unbroken run of the appended ones", round);
+    checkf(log.records() == got.size(), "round %d: records() doesn't count the recovered records", round);
+    size_t end = got.empty() ? 0 : first + got.size();
+    checkf(end >= durable, "round %d: lost records that had already gone to flash", round);
+    checkf(ref.empty() || (!got.empty() && got.front().t <= oldestT), "round %d: lost records at the old end", round);
+    if (end < ref.size()) worstLost = std::max<uint32_t>(worstLost, (uint32_t)(ref.size() - end));
+    recovered += got.size();
+    ref = got;
+    checkQueries(log, ref, round);
+
+    // Round 0 fills the ring past its wrap first
+    uint32_t appends = round ? 200 + rnd(6000) : 150000 + rnd(6000);
+    uint32_t cutAt = appends - 1 - rnd(std::min<uint32_t>(appends, 6000));
+    uint32_t pages = log.pagesWritten();
+    durable = ref.size();
+    for (uint32_t i = 0; i < appends; i++) {
+      // Mostly within the next few pages, sometimes far enough for an erase
+      if (i == cutAt) flash.cutPowerAfter(rnd(8) ? rnd(FlashDev::PAGE_BYTES * 4) : rnd(FlashDev::SECTOR_BYTES * 2));
+      Rec r = src.next();
+      bool ok = log.append(r.t, r.v);
+      checkf(ok || i >= cutAt, "round %d: append() failed with the power on", round);
+      ref.push_back(r);
+      // A page that went out whole holds everything before this record
+      if (log.pagesWritten() != pages && flash.powered()) durable = ref.size() - 1;
+      pages = log.pagesWritten();
+      if (rnd(400) == 0 && log.flush() && flash.powered()) durable = ref.size();
+      if (!flash.powered()) break;
+    }
+    // Not log.oldest(): that is the segment's t0, whose page may be torn
+    oldestT = UINT64_MAX;
+    log.forEach(0, UINT64_MAX, [&](uint64_t t, const int16_t *) { oldestT = std::min(oldestT, t); });
+    flash.close();
+    flash.restorePower();
+  }
+};
+
+static void checkPowerCuts(int rounds) {
+  unlink(PATH);
+  Ring ring;
+  for (int round = 0; round <= rounds; round++) ring.boot(round);
+  unlink(PATH);
+  printf("%d power cuts on a %u-segment ring: %llu records recovered in all, %u torn pages found, "
+         "at most %u records lost  %s\n",
+         rounds, RING_BYTES / FlashDev::SECTOR_BYTES, (unsigned long long)ring.recovered, ring.torn,
+         ring.worstLost, g_failed ? "FAIL" : "ok");
+}
+
+template <typename F>
+static double bestNs(uint32_t calls, F f) {
+  double best = 1e30;
+  for (int run = 0; run < RUNS; run++) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / calls;
+    best = std::min(best, ns);
+  }
+  return best;
+}
+
+static void bench() {
+  const uint32_t N = 2000000;   // fills the partition and wraps
+  std::vector<Rec> recs(N);
+  Source src;
+  for (Rec &r : recs) r = src.next();
+
+  FileFlash flash;
+  FlashLog *log = nullptr;
+  double best = 1e30;
+  for (int run = 0; run < RUNS; run++) {
+    unlink(PATH);
+    flash.open(PATH, BENCH_BYTES);
+    delete log;
+    log = new FlashLog(flash, CH);
+    log->begin(0);
+    auto t0 = std::chrono::steady_clock::now();
+    for (const Rec &r : recs) log->append(r.t, r.v);
+    best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / N);
+  }
+  printf("\n%u records into %u segments (%u kept, %lu in the log): %.1f flash bytes / record, %lu erases\n", N,
+         log->capacity(), log->segments(), (unsigned long)log->records(),
+         (double)flash.bytesWritten() / N, (unsigned long)log->erases());
+  printf("%-32s %10.1f ns/record\n", "append()", best);
+
+  volatile uint32_t sink = 0;
+  uint32_t all = log->records();
+  double ns = bestNs(all, [&] {
+    sink += log->forEach(0, UINT64_MAX, [&](uint64_t, const int16_t *v) { sink += v[0]; });
+  });
+  printf("%-32s %10.1f ns/record\n", "query() everything", ns);
+
+  uint64_t to = log->newest();
+  ns = bestNs(1, [&] { sink += log->forEach(to - 3600000, to, [&](uint64_t, const int16_t *v) { sink += v[1]; }); });
+  printf("%-32s %10.1f us (%u segments skipped)\n", "query() last hour", ns / 1000, log->lastSkipped());
+  ns = bestNs(1, [&] { sink += log->summary(to - 24 * 3600000ULL, to, 0).count; });
+  printf("%-32s %10.1f us (%u segments by header)\n", "summary() last 24 h", ns / 1000, log->lastSkipped());
+  ns = bestNs(1, [&] {
+    Rollup r;
+    log->forEach(to - 24 * 3600000ULL, to, [&](uint64_t, const int16_t *v) { r.add(v[0]); });
+    sink += r.count;
+  });
+  printf("%-32s %10.1f us\n", "the same by query()", ns / 1000);
+  delete log;
+  flash.close();
+  unlink(PATH);
+}
+
+int main() {
+  int rounds = 2000;
+  if (const char *n = getenv("FLASHLOG_CUTS")) rounds = atoi(n);
+  checkPowerCuts(rounds);
+  bench();
+  return checkResult();
+}
@@ -0,0 +1,161 @@
+// ledfx_test: LedFx keyframe expansion and effect switch latency on the host
+//
+//   g++ -std=c++11 -O2 -I../../lib/LedFx ledfx_test.cpp -o ledfx_test
+//   ./ledfx_test
+//
+// Expands the effects HomeTask2-PartB - Copy plays (and a breathe curve)
+// with KeyframeExpander and checks that:
+//   - every segment is at most LEDFX_SEGMENT_MS long,
+//   - ramps and holds add up to the keyframe times, with no drift over
+//     many loops,
+//   - a ramp's duty moves monotonically along the gamma curve and ends on
+//     ledGamma(target),
+//   - an effect with no time in it finishes instead of looping forever.
+// Then plays each effect on a virtual clock the way LedFx does (next
+// segment at the end of the current one) and switches to another effect at
+// every ms of a 3 s window: the new effect must take over within
+// LEDFX_SEGMENT_MS. Exits 1 on any failed check.
+
+#include <stdio.h>
+#include "LedKeyframes.h"
+#include "../common/Check.h"
+
+static const uint16_t ALT_STEP_MS = 200, FADE_MS = 1000, TOGGLE_MS = 500;
+
+static constexpr Keyframe OFF_FRAMES[] = {{0, 0, {0, 0, 0}}};
+static constexpr Keyframe ALT_FRAMES[] = {
+  {0, ALT_STEP_MS, {255, 0, 0}},
+  {0, ALT_STEP_MS, {0, 255, 0}},
+  {0, ALT_STEP_MS, {0, 0, 255}},
+};
+static constexpr Keyframe FADE_FRAMES[] = {
+  {FADE_MS, 0, {255, 255, 255}},
+  {FADE_MS, 0, {0, 0, 0}},
+};
+static constexpr Keyframe TOGGLE_FRAMES[] = {
+  {0, TOGGLE_MS, {0, 0, 0}},
+  {0, TOGGLE_MS, {255, 255, 255}},
+};
+static constexpr Keyframe BREATHE_FRAMES[] = {
+  {1500, 300, {255, 128, 0}},
+  {1500, 700, {10, 5, 0}},
+};
+
+struct Named {
+  const char *name;
+  Effect fx;
+  uint32_t periodMs;   // one pass over the keyframes
+};
+
+static const Named EFFECTS[] = {
+  {"off", makeEffect(OFF_FRAMES, false), 0},
+  {"alternate", makeEffect(ALT_FRAMES, true), 3 * ALT_STEP_MS},
+  {"fade", makeEffect(FADE_FRAMES, true), 2 * FADE_MS},
+  {"toggle", makeEffect(TOGGLE_FRAMES, true), 2 * TOGGLE_MS},
+  {"breathe", makeEffect(BREATHE_FRAMES, true), 4000},
+};
+static const int EFFECT_COUNT = sizeof(EFFECTS) / sizeof(EFFECTS[0]);
+
+// Segment lengths and ramp end points over `loops` passes
+static void checkExpansion(const Named &e, int loops) {
+  KeyframeExpander x;
+  x.start(e.fx);
+  DutySegment s;
+  uint32_t total = 0, segs = 0;
+  uint16_t longest = 0;
+  bool overlong = false, ramps = true;
+  uint32_t limit = e.periodMs ? e.periodMs * loops : 0;
+  while ((!limit || total < limit) && x.next(s)) {
+    if (s.ms > LEDFX_SEGMENT_MS) overlong = true;
+    if (s.ms > longest) longest = s.ms;
+    // Ramp end points are gamma-corrected levels
+    if (s.ramp)
+      for (uint8_t i = 0; i < LEDFX_MAX_LEDS; i++) {
+        bool onTable = false;
+        for (int l = 0; l < 256 && !onTable; l++) onTable = ledGamma((uint8_t)l) == s.duty[i];
+        if (!onTable) ramps = false;
+      }
+    total += s.ms;
+    segs++;
+    if (segs > 1000000) break;
+  }
+  printf("%-10s %7lu segments, longest %2u ms, %8lu ms expanded\n", e.name, (unsigned long)segs, longest,
+         (unsigned long)total);
+  check(!overlong, "segment longer than LEDFX_SEGMENT_MS", e.name);
+  check(ramps, "ramp duty not on the gamma table", e.name);
+  check(total == limit, limit ? "loops don't add up to the keyframe times" : "one-shot effect took time",
+        e.name);
+  if (!e.fx.loop) check(x.done(), "one-shot effect still running", e.name);
+}
+
+// One 1 s ramp from 0 to 200: monotonic duties ending on ledGamma(200)
+static void checkRamp() {
+  static constexpr Keyframe F[] = {{1000, 0, {200, 0, 255, 0}}};
+  KeyframeExpander x;
+  x.start(makeEffect(F, false));
+  DutySegment s;
+  uint16_t last = 0;
+  uint32_t ms = 0;
+  bool monotonic = true;
+  while (x.next(s)) {
+    if (s.duty[0] < last) monotonic = false;
+    last = s.duty[0];
+    ms += s.ms;
+  }
+  printf("%-10s 0 -> 200 in %lu ms, ends at duty %u (gamma %u)\n", "ramp", (unsigned long)ms, last, ledGamma(200));
+  check(monotonic, "ramp duty not monotonic", "ramp");
+  check(last == ledGamma(200) && s.duty[2] == LEDFX_MAX_DUTY, "ramp doesn't end on the gamma target", "ramp");
+  check(ms == 1000, "ramp time not kept", "ramp");
+}
+
+// A zero-length looping effect must finish (start() turns its loop off)
+static void checkZeroTime() {
+  static constexpr Keyframe F[] = {{0, 0, {255}}, {0, 0, {0}}};
+  KeyframeExpander x;
+  x.start(makeEffect(F, true));
+  DutySegment s;
+  int n = 0;
+  while (x.next(s) && n < 100) n++;
+  check(n == 2 && x.done(), "zero-time looping effect doesn't finish", "zero-time");
+}
+
+// LedFx on a virtual clock: a segment starts when the previous one ends, a
+// play() is taken up at the next segment boundary
+static uint32_t switchLatency(const Effect &from, const Effect &to, uint32_t atMs) {
+  KeyframeExpander x;
+  x.start(from);
+  DutySegment s;
+  uint32_t t = 0;
+  while (x.next(s)) {
+    if (t + s.ms > atMs) break;   // the segment running at atMs
+    t += s.ms;
+    if (s.ms == 0 && x.done()) return 0;
+  }
+  if (x.done() && t <= atMs) return 0;   // idle: play() starts at once
+  uint32_t boundary = t + s.ms;
+  x.start(to);
+  return boundary - atMs;
+}
+
+static void checkLatency() {
+  for (int a = 0; a < EFFECT_COUNT; a++) {
+    uint32_t worst = 0;
+    for (int b = 0; b < EFFECT_COUNT; b++) {
+      if (a == b) continue;
+      for (uint32_t at = 0; at < 3000; at++) {
+        uint32_t l = switchLatency(EFFECTS[a].fx, EFFECTS[b].fx, at);
+        if (l > worst) worst = l;
+      }
+    }
+    printf("%-10s switching away takes at most %2lu ms\n", EFFECTS[a].name, (unsigned long)worst);
+    check(worst <= LEDFX_SEGMENT_MS, "switch latency above LEDFX_SEGMENT_MS", EFFECTS[a].name);
+  }
+}
+
+int main() {
+  for (int i = 0; i < EFFECT_COUNT; i++) checkExpansion(EFFECTS[i], 50);
+  checkRamp();
+  checkZeroTime();
+  checkLatency();
+  return checkResult();
+}
@@ -0,0 +1,193 @@
+// melody_test: MelodyCore stepped on a virtual clock
+//
+//   g++ -std=c++11 -O2 -I../../lib/MelodySeq melody_test.cpp -o melody_test
+//   ./melody_test
+//
+// Steps melodies the way MelodySeq does (next step at the previous
+// deadline plus the returned wait) and records what the buzzer does and
+// when. Checks that:
+//   - the tone / silence timeline matches one worked out from the table:
+//     every note starts at the sum of the earlier (len + gap) sixteenths,
+//     sounds for len, then is silent for gap; rests are silent,
+//   - a looping melody has no drift after 100 loops, at several tempos,
+//   - a one-shot melody ends silent and step() then returns 0,
+//   - setTempo() takes effect from the next step, not in the middle of one,
+//   - every divider in the note table plays its frequency within 0.05 %,
+//   - with the callback running up to 3 ms late at random, absolute
+//     deadlines keep every note start within that 3 ms of its slot.
+// Exits 1 on any failed check.
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include "MelodyCore.h"
+#include "../common/Check.h"
+
+struct Change {
+  uint64_t us;
+  uint32_t div;   // 0 = silent
+};
+
+// Buzzer stand-in: records every change of what is heard
+struct Recorder {
+  uint64_t now = 0;
+  uint32_t div = 0;
+  std::vector<Change> log;
+  void tone(const Note &n) { set(n.div); }
+  void silence() { set(0); }
+  void set(uint32_t d) {
+    if (d == div) return;
+    div = d;
+    log.push_back({now, d});
+  }
+};
+
+// The table's own timeline: the same changes, from sums of sixteenths
+static std::vector<Change> expected(const Note *notes, uint16_t count, uint16_t bpm, int loops, bool loop) {
+  std::vector<Change> out;
+  uint64_t unit = 60000000ULL / 4 / bpm, t = 0;
+  uint32_t div = 0;
+  auto set = [&](uint32_t d) {
+    if (d != div) out.push_back({t, d}), div = d;
+  };
+  for (int l = 0; l < loops; l++) {
+    for (uint16_t i = 0; i < count; i++) {
+      set(notes[i].div);
+      t += notes[i].len * unit;
+      if (notes[i].gap) {
+        set(0);
+        t += notes[i].gap * unit;
+      }
+    }
+    if (!loop) break;
+  }
+  if (!loop) set(0);
+  return out;
+}
+
+// Runs until `untilUs` or the melody ends
+static Recorder run(const Note *notes, uint16_t count, bool loop, uint16_t bpm, uint64_t untilUs) {
+  MelodyCore core;
+  core.setTempo(bpm);
+  core.start(notes, count, loop);
+  Recorder rec;
+  while (rec.now < untilUs) {
+    uint32_t wait = core.step(rec);
+    if (!wait) break;
+    rec.now += wait;
+  }
+  return rec;
+}
+
+static bool sameTimeline(const std::vector<Change> &a, const std::vector<Change> &b, size_t n) {
+  if (a.size() < n || b.size() < n) return false;
+  for (size_t i = 0; i < n; i++)
+    if (a[i].us != b[i].us || a[i].div != b[i].div) return false;
+  return true;
+}
+
+// Notes with rests, gaps and repeated pitches (a repeat with no gap is heard
+// as one longer tone, which both timelines show the same way)
+static constexpr Note TUNE[] = {
+  {NOTE_A4, 4}, {NOTE_A4, 4, 2}, {NOTE_REST, 4}, {NOTE_F4, 3, 1}, {NOTE_C5, 1},
+  {NOTE_A4, 4}, {NOTE_E5, 2, 2}, {NOTE_REST, 2}, {NOTE_GS4, 6, 2},
+};
+static const uint16_t TUNE_N = sizeof(TUNE) / sizeof(TUNE[0]);
+
+static void checkTimeline() {
+  static const uint16_t BPMS[] = {60, 86, 120, 133, 240};
+  for (uint16_t bpm : BPMS) {
+    uint64_t unit = 60000000ULL / 4 / bpm, perLoop = 0;
+    for (const Note &n : TUNE) perLoop += (n.len + n.gap) * unit;
+    std::vector<Change> want = expected(TUNE, TUNE_N, bpm, 101, true);
+    Recorder got = run(TUNE, TUNE_N, true, bpm, 100 * perLoop);
+    // Everything up to the end of loop 100 must match, to the microsecond
+    size_t n = 0;
+    while (n < want.size() && want[n].us < 100 * perLoop) n++;
+    char name[16];
+    snprintf(name, sizeof(name), "%u bpm", bpm);
+    bool ok = sameTimeline(got.log, want, n);
+    printf("%-8s loop %7.3f s, 100 loops: %u changes, last at %.6f s  %s\n", name, perLoop / 1e6, (unsigned)n,
+           n ? got.log[n - 1].us / 1e6 : 0.0, ok ? "ok" : "FAIL");
+    check(ok, "timeline differs from the table (drift or wrong order)", name);
+  }
+
+  std::vector<Change> want = expected(TUNE, TUNE_N, 120, 1, false);
+  MelodyCore core;
+  core.start(TUNE, TUNE_N, false);
+  Recorder rec;
+  uint32_t wait;
+  int steps = 0;
+  while ((wait = core.step(rec)) != 0 && steps < 1000) rec.now += wait, steps++;
+  bool ok = sameTimeline(rec.log, want, want.size()) && rec.log.size() == want.size() && rec.div == 0 &&
+            !core.playing() && core.step(rec) == 0;
+  printf("one-shot: %d steps, ends silent at %.3f s  %s\n", steps, rec.now / 1e6, ok ? "ok" : "FAIL");
+  check(ok, "one-shot melody doesn't end silent and stopped", "one-shot");
+}
+
+static void checkTempoChange() {
+  MelodyCore core;
+  core.setTempo(120);
+  core.start(TUNE, TUNE_N, true);
+  Recorder rec;
+  uint32_t w1 = core.step(rec);   // first note at 120 bpm
+  core.setTempo(60);              // mid-note: this wait is already fixed
+  uint32_t w2 = core.step(rec);   // second note at 60 bpm
+  bool ok = w1 == TUNE[0].len * (60000000UL / 4 / 120) && w2 == TUNE[1].len * (60000000UL / 4 / 60);
+  printf("setTempo mid-note: waits %lu us then %lu us  %s\n", (unsigned long)w1, (unsigned long)w2,
+         ok ? "ok" : "FAIL");
+  check(ok, "tempo change not applied from the next step", "tempo");
+}
+
+static void checkDividers() {
+  static const uint16_t HZ[] = {NOTE_C4, NOTE_D4, NOTE_E4, NOTE_F4, NOTE_G4, NOTE_GS4, NOTE_A4, NOTE_B4, NOTE_C5,
+                                NOTE_D5, NOTE_E5, NOTE_F5, NOTE_FS5, NOTE_G5, NOTE_GS5, NOTE_A5};
+  double worst = 0;
+  for (uint16_t hz : HZ) {
+    // LEDC output: APB / (divider / 256) / 2^bits
+    double f = (double)MELODY_APB_HZ * 256 / melodyDivider(hz) / (1u << MELODY_DUTY_BITS);
+    worst = fmax(worst, fabs(f - hz) / hz);
+  }
+  printf("dividers: worst frequency error %.4f %%\n", worst * 100);
+  check(worst < 0.0005, "divider off by more than 0.05 %", "dividers");
+  check(melodyDivider(0) == 0 && Note(NOTE_REST, 1).div == 0, "rest has a divider", "dividers");
+}
+
+// MelodySeq's scheduling: absolute deadlines, callbacks late at random
+static void checkJitter() {
+  static const uint32_t MAX_LATE_US = 3000;
+  MelodyCore core;
+  core.setTempo(86);
+  core.start(TUNE, TUNE_N, true);
+  uint32_t seed = 1;
+  Recorder rec;
+  std::vector<uint64_t> due;   // when each step should have run
+  uint64_t dueUs = 0, worst = 0;
+  for (int i = 0; i < 20000; i++) {
+    seed = seed * 1103515245u + 12345u;
+    rec.now = dueUs + (seed >> 8) % (MAX_LATE_US + 1);   // callback runs late
+    worst = rec.now - dueUs > worst ? rec.now - dueUs : worst;
+    dueUs += core.step(rec);   // next deadline from the due time, not from now
+  }
+  // Compare with the ideal timeline: every change within MAX_LATE_US of it
+  std::vector<Change> want = expected(TUNE, TUNE_N, 86, 5000, true);
+  uint64_t maxErr = 0;
+  bool order = true;
+  for (size_t k = 0; k < rec.log.size() && k < want.size(); k++) {
+    order &= rec.log[k].div == want[k].div;
+    uint64_t e = rec.log[k].us - want[k].us;
+    if (e > maxErr) maxErr = e;
+  }
+  printf("callbacks up to %lu us late: note starts at most %lu us off after %u changes (%.0f s)  %s\n",
+         (unsigned long)MAX_LATE_US, (unsigned long)maxErr, (unsigned)rec.log.size(), dueUs / 1e6,
+         order && maxErr <= MAX_LATE_US ? "ok" : "FAIL");
+  check(order && maxErr <= MAX_LATE_US, "late callbacks drifted the melody", "jitter");
+}
+
+int main() {
+  checkTimeline();
+  checkTempoChange();
+  checkDividers();
+  checkJitter();
+  return checkResult();
+}
@@ -0,0 +1,34 @@
+// micro_bench: the pure-compute cases of bench/ timed on the host
+//
+//   g++ -std=c++11 -O2 -I../../bench/src $(for d in ../../lib/*/; do echo -I$d; done) micro_bench.cpp
+//       ../../lib/SpanRaster/SpanRaster.cpp ../../lib/DhtRmt/DhtDecode.cpp -o micro_bench
+//   ./micro_bench > host.txt
+//   ../bench_compare/bench_compare ../../bench/baseline/host.txt host.txt
+//
+// Same cases and output format as the device build (bench/src/ComputeCases.h),
+// in ns per call instead of cycles. Host numbers only compare with a
+// baseline taken on the same machine and compiler flags; they catch
+// algorithmic regressions before anything is flashed.
+
+#include <chrono>
+#include <stdio.h>
+#include "ComputeCases.h"
+
+// Anything with write() will do for printfTo()
+struct StdOut {
+  size_t write(const uint8_t *p, size_t n) { return fwrite(p, 1, n, stdout); }
+};
+
+static uint32_t nanos() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int main() {
+  StdOut out;
+  BenchClock clock = benchClock(nanos, "ns");
+  printf("# micro_bench host, clock overhead %u ns\n", (unsigned)clock.overhead);
+  bench::runComputeCases(out, clock);
+  return 0;
+}
@@ -0,0 +1,180 @@
+// oled_diff_test: OledDiff bytes on the bus for typical sensor-screen updates
+//
+//   g++ -std=gnu++11 -O2 -DARDUINO=10819 -DESP32 -DARDUINO_ARCH_ESP32 -I../../sim/ArduinoSim
+//       -I../../lib/OledDiff oled_diff_test.cpp ../../lib/OledDiff/OledDiff.cpp
+//       ../../sim/ArduinoSim/*.cpp -o oled_diff_test
+//   ./oled_diff_test
+//
+// Runs on the simulated board. OledDiff talks to a mock SSD1306 on the sim's
+// Wire at 0x3D that counts every byte it receives and decodes the column /
+// page window commands and the data into its own GDDRAM. For each update
+// (first frame, nothing changed, one reading changed, two readings on
+// different pages, a size-2 reading over two pages, the sketches' old
+// clearDisplay() + redraw of the same text, a NACKed transfer) it checks
+// that:
+//   - flush() returns exactly the bytes the mock received,
+//   - the mock's GDDRAM equals the frame afterwards,
+//   - the byte count is the one the update calls for: worked out from the
+//     frame difference on its own (one addressed window per dirty page, or
+//     one window over adjacent pages when that is cheaper).
+// Exits 1 on any failed check.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "OledDiff.h"
+#include "../common/Check.h"
+
+static const uint8_t MOCK_ADDR = 0x3D;
+static const uint16_t CHUNK = I2C_BUFFER_LENGTH - 1;   // as in OledDiff.cpp
+
+// SSD1306 in horizontal addressing mode, as far as OledDiff drives it
+class MockPanel : public sim::I2cDevice {
+public:
+  uint8_t ram[OledDiff::FRAME_BYTES] = {};
+  uint32_t bytes = 0;
+
+  void receive(const uint8_t *d, size_t n) override {
+    bytes += n;
+    if (!n) return;
+    if (d[0] == 0x40) {
+      for (size_t i = 1; i < n; i++) data(d[i]);
+      return;
+    }
+    for (size_t i = 1; i < n; i++) {
+      if (d[i] == SSD1306_COLUMNADDR && i + 2 < n) {
+        _c0 = _col = d[i + 1];
+        _c1 = d[i + 2];
+        i += 2;
+      } else if (d[i] == SSD1306_PAGEADDR && i + 2 < n) {
+        _p0 = _page = d[i + 1];
+        _p1 = d[i + 2];
+        i += 2;
+      }
+    }
+  }
+
+private:
+  void data(uint8_t b) {
+    ram[_page * OledDiff::WIDTH + _col] = b;
+    if (_col++ < _c1) return;
+    _col = _c0;
+    _page = _page < _p1 ? _page + 1 : _p0;
+  }
+
+  uint8_t _c0 = 0, _c1 = 127, _p0 = 0, _p1 = 7, _col = 0, _page = 0;
+};
+
+static Adafruit_SSD1306 display(128, 64, &Wire, -1);
+static OledDiff oled(display, Wire, MOCK_ADDR, 0, 0);
+static MockPanel panel;
+static uint8_t sent[OledDiff::FRAME_BYTES];   // what the panel should hold
+
+static uint16_t rectCost(int pages, int cols) {
+  int n = pages * cols;
+  return (uint16_t)(7 + n + (n + CHUNK - 1) / CHUNK);
+}
+
+// Bytes the update from `sent` to the current buffer should take, worked
+// out independently: dirty column range per page, adjacent dirty pages
+// merged when one window over both is cheaper
+static uint16_t expectedBytes(bool full) {
+  const uint8_t *f = display.getBuffer();
+  int first[8], last[8];
+  for (int p = 0; p < 8; p++) {
+    first[p] = 128;
+    last[p] = -1;
+    for (int c = 0; c < 128; c++)
+      if (full || f[p * 128 + c] != sent[p * 128 + c]) {
+        if (first[p] == 128) first[p] = c;
+        last[p] = c;
+      }
+  }
+  uint16_t total = 0;
+  for (int p = 0; p < 8;) {
+    if (last[p] < 0) {
+      p++;
+      continue;
+    }
+    int p1 = p, c0 = first[p], c1 = last[p];
+    while (p1 + 1 < 8 && last[p1 + 1] >= 0) {
+      int n0 = c0 < first[p1 + 1] ? c0 : first[p1 + 1], n1 = c1 > last[p1 + 1] ? c1 : last[p1 + 1];
+      if (rectCost(p1 - p + 2, n1 - n0 + 1) > rectCost(p1 - p + 1, c1 - c0 + 1) +
+                                                   rectCost(1, last[p1 + 1] - first[p1 + 1] + 1))
+        break;
+      c0 = n0;
+      c1 = n1;
+      p1++;
+    }
+    total += rectCost(p1 - p + 1, c1 - c0 + 1);
+    p = p1 + 1;
+  }
+  return total;
+}
+
+// Flush and check the three properties; `full` = the shadow is not valid
+static void step(const char *name, bool full = false) {
+  uint16_t want = expectedBytes(full);
+  uint32_t before = panel.bytes;
+  uint16_t got = oled.flush();
+  printf("%-30s %5u bytes, %u window(s)\n", name, got, oled.lastFrameRects());
+  check(got == panel.bytes - before, "flush() count differs from the bytes on the bus", name);
+  check(got == want, "byte count differs from the frame difference", name);
+  check(!memcmp(panel.ram, display.getBuffer(), sizeof(panel.ram)), "panel RAM differs from the frame", name);
+  memcpy(sent, display.getBuffer(), sizeof(sent));
+}
+
+static void screen(const char *temp, const char *hum, const char *big) {
+  display.clearDisplay();
+  display.setTextColor(SSD1306_WHITE, SSD1306_BLACK);
+  display.setTextSize(1);
+  display.setCursor(0, 0);
+  display.print("Hello IoT");
+  display.setCursor(0, 16);
+  display.print("Temp: ");
+  display.print(temp);
+  display.print(" C");
+  display.setCursor(0, 32);
+  display.print("Humidity: ");
+  display.print(hum);
+  display.print(" %");
+  display.setTextSize(2);
+  display.setCursor(0, 48);
+  display.print(big);
+}
+
+void setup() {
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  sim::attachI2c(MOCK_ADDR, &panel);
+  oled.begin();
+  printf("(a full display() is 1040 bytes)\n");
+
+  screen("23.50", "41.00", "2048");
+  step("first frame", true);
+  check(oled.lastFrameBytes() == 1040, "first frame is not 1040 bytes", "first frame");
+  step("nothing changed");
+  check(oled.lastFrameBytes() == 0, "an unchanged frame sent bytes", "nothing changed");
+  screen("23.60", "41.00", "2048");
+  step("temperature 23.50 -> 23.60");
+  screen("23.70", "42.00", "2048");
+  step("temperature and humidity");
+  screen("23.70", "42.00", "2051");
+  step("size-2 reading (two pages)");
+  screen("23.70", "42.00", "2051");
+  step("clearDisplay() + same text");
+
+  // NACK: nothing arrives, so the next flush must resend the whole frame
+  sim::attachI2c(MOCK_ADDR, nullptr);
+  screen("24.00", "42.00", "2051");
+  oled.flush();
+  sim::attachI2c(MOCK_ADDR, &panel);
+  step("after a NACKed transfer", true);
+  check(oled.lastFrameBytes() == 1040, "no full resend after the NACK", "after a NACKed transfer");
+
+  exit(checkResult());
+}
+
+void loop() {}
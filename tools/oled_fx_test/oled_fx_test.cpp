@@ -0,0 +1,219 @@
+// oled_fx_test: OledFx effects on a mock SSD1306, and their I2C byte cost
+//
+//   g++ -std=gnu++11 -O2 -DARDUINO=10819 -DESP32 -DARDUINO_ARCH_ESP32 -I../../sim/ArduinoSim
+//       -I../../lib/OledDiff -I../../lib/OledFx oled_fx_test.cpp ../../lib/OledDiff/OledDiff.cpp
+//       ../../lib/OledFx/OledFx.cpp ../../sim/ArduinoSim/*.cpp -o oled_fx_test
+//   ./oled_fx_test
+//
+// Runs on the simulated board, calling poll() every millisecond of virtual
+// time. The mock panel on the sim's Wire at 0x3D counts every byte it
+// receives and decodes the commands (with their datasheet parameter
+// counts) into its own state: invert, contrast, start line, scroll setup.
+// For each effect it checks that:
+//   - stats(effect) has exactly the transactions and bytes the mock saw,
+//   - the cost is what the commands call for: a control byte plus the
+//     command and its parameters (invert 2, contrast 3, start line 2,
+//     horizontal scroll 10, diagonal 12, stop 2),
+//   - the panel ends up in the state the effect promises: blink(150, 5)
+//     toggles 10 times on a 150 ms grid and ends normal, fade() steps down
+//     monotonically no faster than FADE_STEP_MS and lands on the target,
+//     roll(1, 30) walks the start line through 0-63 once per 30 ms and
+//     stopRoll() puts it back, scroll() sets up the pages / speed /
+//     offset asked for, and the flush after stopScroll() is a full frame.
+// Then prints each effect's bytes per second against pushing one 1040-byte
+// frame per step instead. Exits 1 on any failed check.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "OledFx.h"
+#include "../common/Check.h"
+
+static const uint8_t MOCK_ADDR = 0x3D;
+static const uint32_t FRAME = 1040;   // a full OledDiff frame
+static const uint32_t BUS_MS = 2;     // the mock stamps a command when its transfer ends
+
+struct Cmd {
+  uint32_t ms;
+  uint8_t op;
+  uint8_t arg[6];
+};
+
+// SSD1306 command decoder: every command with its parameters, as sent
+class MockPanel : public sim::I2cDevice {
+public:
+  uint32_t bytes = 0, transactions = 0;
+  std::vector<Cmd> log;
+  bool inverted = false, scrolling = false;
+  uint8_t contrast = 0x7F, startLine = 0;
+  Cmd scrollSetup = {};
+
+  void receive(const uint8_t *d, size_t n) override {
+    bytes += n;
+    transactions++;
+    if (!n || d[0] != 0x00) return;   // data, not commands
+    for (size_t i = 1; i < n;) {
+      Cmd c = {(uint32_t)millis(), d[i++], {}};
+      uint8_t params = paramCount(c.op);
+      for (uint8_t k = 0; k < params && i < n; k++) c.arg[k] = d[i++];
+      apply(c);
+      log.push_back(c);
+    }
+  }
+
+  void clear() {
+    bytes = transactions = 0;
+    log.clear();
+  }
+
+private:
+  static uint8_t paramCount(uint8_t op) {
+    switch (op) {
+      case SSD1306_RIGHT_HORIZONTAL_SCROLL:
+      case SSD1306_LEFT_HORIZONTAL_SCROLL: return 6;
+      case SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL:
+      case SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL: return 5;
+      case SSD1306_SET_VERTICAL_SCROLL_AREA:
+      case SSD1306_COLUMNADDR:
+      case SSD1306_PAGEADDR: return 2;
+      case SSD1306_SETCONTRAST:
+      case SSD1306_MEMORYMODE: return 1;
+      default: return 0;
+    }
+  }
+
+  void apply(const Cmd &c) {
+    if (c.op == SSD1306_INVERTDISPLAY) inverted = true;
+    else if (c.op == SSD1306_NORMALDISPLAY) inverted = false;
+    else if (c.op == SSD1306_SETCONTRAST) contrast = c.arg[0];
+    else if (c.op >= 0x40 && c.op <= 0x7F) startLine = c.op & 0x3F;
+    else if (c.op == SSD1306_DEACTIVATE_SCROLL) scrolling = false;
+    else if (c.op == SSD1306_ACTIVATE_SCROLL) scrolling = true;
+    else if (c.op >= SSD1306_RIGHT_HORIZONTAL_SCROLL && c.op <= SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL)
+      scrollSetup = c;
+  }
+};
+
+static Adafruit_SSD1306 display(128, 64, &Wire, -1);
+static OledDiff oled(display, Wire, MOCK_ADDR, 0, 0);
+static OledFx fx(oled);
+static MockPanel panel;
+static void run(uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    delay(1);
+    fx.poll();
+  }
+}
+
+// The counts OledFx kept for `e` against what the mock received, and the
+// cost line for the table
+static void cost(OledFx::Effect e, const char *name, uint32_t ms, uint32_t bytesEach) {
+  const OledFx::Stats &s = fx.stats(e);
+  printf("%-8s %4lu commands %5lu bytes in %5lu ms: %7.1f B/s, as frame pushes %8.0f B/s (%.0fx)\n", name,
+         (unsigned long)s.commands, (unsigned long)s.bytes, (unsigned long)ms, s.bytes * 1000.0 / ms,
+         s.commands * FRAME * 1000.0 / ms, s.bytes ? (double)s.commands * FRAME / s.bytes : 0.0);
+  check(s.bytes == panel.bytes && s.commands == panel.transactions, "stats() differ from the bytes on the bus",
+        name);
+  if (bytesEach) check(s.bytes == s.commands * bytesEach, "a step costs more than its command bytes", name);
+}
+
+static void start() {
+  fx.resetStats();
+  panel.clear();
+}
+
+static void checkBlink() {
+  start();
+  fx.blink(150, 5);
+  run(2000);
+  bool spaced = panel.log.size() == 10;
+  for (size_t i = 0; spaced && i < panel.log.size(); i++) {
+    spaced = panel.log[i].op == (i % 2 ? SSD1306_NORMALDISPLAY : SSD1306_INVERTDISPLAY);
+    // Against the first toggle, not the previous one: no drift allowed
+    int32_t off = (int32_t)(panel.log[i].ms - panel.log[0].ms) - 150 * (int32_t)i;
+    spaced &= off >= -(int32_t)BUS_MS && off <= (int32_t)BUS_MS;
+  }
+  check(spaced && !panel.inverted && !fx.busy(), "not 10 toggles 150 ms apart ending normal", "blink");
+  cost(OledFx::BLINK, "blink", 2000, 2);
+}
+
+static void checkFade() {
+  start();
+  fx.fade(0xCF, 0x00, 1000);
+  run(1100);
+  bool ok = !panel.log.empty() && panel.log[0].arg[0] == 0xCF && panel.contrast == 0x00 && !fx.busy();
+  for (size_t i = 1; ok && i < panel.log.size(); i++)
+    ok = panel.log[i].arg[0] < panel.log[i - 1].arg[0] &&
+         panel.log[i].ms - panel.log[i - 1].ms + BUS_MS >= OledFx::FADE_STEP_MS;
+  check(ok, "fade not monotonic, too fast, or off its target", "fade");
+  cost(OledFx::FADE, "fade", 1100, 3);
+}
+
+static void checkRoll() {
+  start();
+  fx.roll(1, 30);
+  bool ok = true;
+  for (int k = 1; k <= 64; k++) {
+    run(30);
+    ok &= panel.startLine == (k & 0x3F);
+  }
+  run(15);
+  fx.stopRoll();
+  check(ok, "start line not one row further every 30 ms", "roll");
+  uint32_t rollMs = 64 * 30 + 15;
+  cost(OledFx::ROLL, "roll", rollMs, 2);
+
+  // Down, then stopped off line 0: the stop puts the picture back
+  start();
+  fx.roll(-3, 30);
+  run(95);
+  fx.stopRoll();
+  check(panel.log.size() == 4 && panel.log[2].op == (SSD1306_SETSTARTLINE | (64 - 9)) && panel.startLine == 0,
+        "roll down / stopRoll() didn't return to line 0", "roll");
+}
+
+static void checkScroll() {
+  start();
+  fx.scroll(OledFx::LEFT, 2, 5, OledFx::FRAMES_25);
+  const Cmd &h = panel.scrollSetup;
+  check(panel.scrolling && h.op == SSD1306_LEFT_HORIZONTAL_SCROLL && h.arg[1] == 2 &&
+            h.arg[2] == OledFx::FRAMES_25 && h.arg[3] == 5,
+        "horizontal scroll set up wrong", "scroll");
+  check(fx.stats(OledFx::SCROLL).bytes == 10, "horizontal scroll not 10 bytes", "scroll");
+  run(1000);
+  fx.scroll(OledFx::DIAG_RIGHT, 0, 7, OledFx::FRAMES_2, 3);
+  const Cmd &d = panel.scrollSetup;
+  check(panel.scrolling && d.op == SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL && d.arg[1] == 0 &&
+            d.arg[2] == OledFx::FRAMES_2 && d.arg[3] == 7 && d.arg[4] == 3,
+        "diagonal scroll set up wrong", "scroll");
+  check(fx.stats(OledFx::SCROLL).bytes == 10 + 12, "diagonal scroll not 12 bytes", "scroll");
+  run(1000);
+  fx.stopScroll();
+  check(!panel.scrolling && !fx.busy(), "stopScroll() left the panel scrolling", "scroll");
+  cost(OledFx::SCROLL, "scroll", 2000, 0);
+  check(fx.stats(OledFx::SCROLL).bytes == 10 + 12 + 2, "scroll + stop not 24 bytes", "scroll");
+
+  // GDDRAM was moved: the next flush must be the whole frame
+  panel.clear();
+  uint16_t n = oled.flush();
+  check(n == FRAME && panel.bytes == FRAME, "flush after stopScroll() not a full frame", "scroll");
+}
+
+void setup() {
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  sim::attachI2c(MOCK_ADDR, &panel);
+  oled.begin();
+  oled.flush();
+  printf("(one frame through OledDiff is %lu bytes)\n", (unsigned long)FRAME);
+  checkBlink();
+  checkFade();
+  checkRoll();
+  checkScroll();
+  exit(checkResult());
+}
+
+void loop() {}
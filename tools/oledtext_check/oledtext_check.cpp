@@ -0,0 +1,254 @@
+// oledtext_check: OledText against Adafruit_GFX text, byte for byte, and
+// per-line speed
+//
+//   g++ -std=gnu++11 -O2 -DARDUINO=10819 -DESP32 -DARDUINO_ARCH_ESP32 -I../../sim/ArduinoSim
+//       -I../../lib/OledText -I../../lib/FixedText oledtext_check.cpp ../../lib/OledText/OledText.cpp
+//       ../../sim/ArduinoSim/*.cpp -o oledtext_check
+//   TEXT_CALLS=100000 ./oledtext_check     (the default count)
+//
+// Runs on the simulated board, so the reference is the simulator's
+// Adafruit_SSD1306 printing at text size 1, white on a transparent
+// background, with the cursor at (x, 8 * page) and wrapping off (OledText
+// clips instead of wrapping). Every check starts both from the same random
+// frame buffer and must leave it byte-identical, with the cursor where
+// OledText's return value says:
+//   - every printable character at every column from -6 to 128, on every
+//     page,
+//   - random printable strings of 0-24 characters at random columns, many
+//     across the left or right edge,
+//   - print(x, page, value, 2) against print(value / 100.0), the class-1
+//     readings, for every temperature and humidity the DHT can report,
+//     and print(x, page, value) against print(long) for random values,
+//   - characters outside 0x20-0x7E leave their cell untouched and still
+//     advance the column.
+//
+// Then times the class-1 screen, line by line, both ways. Exits 1 on any
+// mismatch.
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "OledText.h"
+#include "../common/Check.h"
+
+static const int W = 128, H = 64, BYTES = W * H / 8;
+
+static Adafruit_SSD1306 display(W, H, &Wire, -1);
+static OledText text(display);
+static uint8_t start[BYTES], want[BYTES];
+
+static uint32_t g_seed = 1;
+static int rnd(int lo, int hi) {   // lo..hi inclusive
+  g_seed = g_seed * 1103515245u + 12345u;
+  return lo + (int)((g_seed >> 8) % (uint32_t)(hi - lo + 1));
+}
+
+// Draws with `gfx` then `fast` from the same random frame; compares frames
+// and end columns
+template <typename G, typename F>
+static bool same(const char *what, int16_t x, uint8_t page, G gfx, F fast) {
+  uint8_t *buf = display.getBuffer();
+  for (int i = 0; i < BYTES; i++) start[i] = (uint8_t)rnd(0, 255);
+  memcpy(buf, start, BYTES);
+  display.setCursor(x, page * 8);
+  gfx();
+  int16_t gfxEnd = display.getCursorX();
+  memcpy(want, buf, BYTES);
+  memcpy(buf, start, BYTES);
+  int16_t end = fast();
+  if (!memcmp(buf, want, BYTES) && end == gfxEnd) return true;
+  int i = 0;
+  while (i < BYTES && buf[i] == want[i]) i++;
+  if (i < BYTES)
+    return checkf(false, "%s at x %d page %u: page %d column %d gfx %02X text %02X", what, x, page, i / W, i % W,
+                  want[i], buf[i]);
+  return checkf(false, "%s at x %d page %u: ends at %d, gfx at %d", what, x, page, end, gfxEnd);
+}
+
+static void checkChars() {
+  long calls = 0, bad = 0;
+  for (uint8_t page = 0; page < H / 8; page++)
+    for (int16_t x = -6; x <= W; x++)
+      for (char c = OledText::FIRST; c <= (char)OledText::LAST; c++) {
+        char s[2] = {c, 0};
+        calls++;
+        bad += !same(s, x, page, [&] { display.print(s); }, [&] { return text.print(x, page, s); });
+      }
+  printf("every character at columns -6..%d on every page: %ld prints, %ld mismatches\n", W, calls, bad);
+}
+
+static void checkStrings(long calls) {
+  long bad = 0;
+  for (long n = 0; n < calls; n++) {
+    char s[25];
+    int len = rnd(0, 24);
+    for (int i = 0; i < len; i++) s[i] = (char)rnd(OledText::FIRST, OledText::LAST);
+    s[len] = 0;
+    int16_t x = (int16_t)(rnd(0, 3) ? rnd(-30, W) : rnd(-200, W + 40));
+    uint8_t page = (uint8_t)rnd(0, H / 8 - 1);
+    bad += !same(s, x, page, [&] { display.print(s); }, [&] { return text.print(x, page, s); });
+  }
+  printf("random strings: %ld prints, %ld mismatches\n", calls, bad);
+}
+
+static void checkNumbers() {
+  long calls = 0, bad = 0;
+  // DHT11 / DHT22 range in 0.1 units, drawn as class-1 does: tenths * 10, 2 decimals
+  for (int32_t tenths = -400; tenths <= 1250; tenths++) {
+    int16_t x = (int16_t)rnd(-10, W);
+    uint8_t page = (uint8_t)rnd(0, H / 8 - 1);
+    char what[24];
+    snprintf(what, sizeof(what), "%ld / 10.0", (long)tenths);
+    calls++;
+    bad += !same(what, x, page, [&] { display.print(tenths * 10 / 100.0); },
+                 [&] { return text.print(x, page, tenths * 10, 2); });
+  }
+  for (int n = 0; n < 20000; n++) {
+    int32_t v = (int32_t)(((uint32_t)rnd(0, 0xFFFF) << 16) | (uint32_t)rnd(0, 0xFFFF)) >> rnd(0, 31);
+    int16_t x = (int16_t)rnd(-10, W);
+    uint8_t page = (uint8_t)rnd(0, H / 8 - 1);
+    char what[24];
+    snprintf(what, sizeof(what), "%ld", (long)v);
+    calls++;
+    bad += !same(what, x, page, [&] { display.print((long)v); }, [&] { return text.print(x, page, v); });
+  }
+  printf("numbers (readings with 2 decimals, random integers): %ld prints, %ld mismatches\n", calls, bad);
+}
+
+static void checkUnprintable() {
+  long bad = 0;
+  uint8_t *buf = display.getBuffer();
+  for (int c = 1; c < 256; c++) {
+    if (c >= OledText::FIRST && c <= OledText::LAST) continue;
+    char s[4] = {'A', (char)c, 'B', 0};
+    uint8_t page = (uint8_t)rnd(0, H / 8 - 1);
+    int16_t x = (int16_t)rnd(0, W - 18);
+    // Reference: "A", an untouched cell, "B"
+    for (int i = 0; i < BYTES; i++) start[i] = (uint8_t)rnd(0, 255);
+    memcpy(buf, start, BYTES);
+    display.setCursor(x, page * 8);
+    display.print("A");
+    display.setCursor(x + 2 * OledText::CELL, page * 8);
+    display.print("B");
+    memcpy(want, buf, BYTES);
+    memcpy(buf, start, BYTES);
+    int16_t end = text.print(x, page, s);
+    bad += !checkf(!memcmp(buf, want, BYTES) && end == x + 3 * OledText::CELL,
+                   "character 0x%02X drew into its cell or didn't advance", c);
+  }
+  printf("characters outside 0x20-0x7E: %ld not skipped cleanly\n", bad);
+}
+
+// ---- speed ----
+typedef void (*Draw)(int);
+
+static double nsPerCall(Draw draw) {
+  const int N = 20000;
+  double best = 1e30;
+  for (int run = 0; run < 5; run++) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) draw(i);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / N;
+    if (ns < best) best = ns;
+  }
+  return best;
+}
+
+struct Case {
+  const char *name;
+  Draw gfx, text;
+};
+
+// `i` varies the reading so nothing is folded away between calls
+static const Case CASES[] = {
+  {"\"Hello IoT\"",
+   [](int) {
+     display.setCursor(0, 0);
+     display.print("Hello IoT");
+   },
+   [](int) { text.print(0, 0, "Hello IoT"); }},
+  {"\"Temp: 23.50 C\"",
+   [](int i) {
+     display.setCursor(0, 16);
+     display.print("Temp: ");
+     display.print((230 + i % 50) / 10.0);
+     display.print(" C");
+   },
+   [](int i) {
+     int16_t x = text.print(0, 2, "Temp: ");
+     x = text.print(x, 2, (230 + i % 50) * 10, 2);
+     text.print(x, 2, " C");
+   }},
+  {"\"Humidity: 55.00 %\"",
+   [](int i) {
+     display.setCursor(0, 32);
+     display.print("Humidity: ");
+     display.print((550 + i % 50) / 10.0);
+     display.print(" %");
+   },
+   [](int i) {
+     int16_t x = text.print(0, 4, "Humidity: ");
+     x = text.print(x, 4, (550 + i % 50) * 10, 2);
+     text.print(x, 4, " %");
+   }},
+  {"class-1 screen",
+   [](int i) {
+     display.clearDisplay();
+     display.setCursor(0, 0);
+     display.print("Hello IoT");
+     display.setCursor(0, 16);
+     display.print("Temp: ");
+     display.print((230 + i % 50) / 10.0);
+     display.print(" C");
+     display.setCursor(0, 32);
+     display.print("Humidity: ");
+     display.print((550 + i % 50) / 10.0);
+     display.print(" %");
+   },
+   [](int i) {
+     display.clearDisplay();
+     text.print(0, 0, "Hello IoT");
+     int16_t x = text.print(0, 2, "Temp: ");
+     x = text.print(x, 2, (230 + i % 50) * 10, 2);
+     text.print(x, 2, " C");
+     x = text.print(0, 4, "Humidity: ");
+     x = text.print(x, 4, (550 + i % 50) * 10, 2);
+     text.print(x, 4, " %");
+   }},
+  {"21 characters, full line",
+   [](int) {
+     display.setCursor(0, 56);
+     display.print("0123456789ABCDEFGHIJK");
+   },
+   [](int) { text.print(0, 7, "0123456789ABCDEFGHIJK"); }},
+};
+
+static void speed() {
+  printf("%-26s %10s %10s %8s\n", "case", "GFX ns", "text ns", "speedup");
+  for (const Case &c : CASES) {
+    double g = nsPerCall(c.gfx), t = nsPerCall(c.text);
+    printf("%-26s %10.1f %10.1f %7.1fx\n", c.name, g, t, g / t);
+  }
+}
+
+static long g_calls = 100000;
+
+void setup() {
+  if (const char *n = getenv("TEXT_CALLS")) g_calls = atol(n);
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);   // one colour: transparent background
+  display.setTextWrap(false);
+  text.begin();
+  checkChars();
+  checkStrings(g_calls);
+  checkNumbers();
+  checkUnprintable();
+  speed();
+  exit(checkResult());
+}
+
+void loop() {}
@@ -0,0 +1,209 @@
+// queue_stress: SpscQueue / MpscQueue under real threads, and throughput
+//
+//   g++ -std=c++11 -O2 -pthread -I../../lib/EventQueue queue_stress.cpp -o queue_stress
+//   ./queue_stress
+//   (add -fsanitize=thread to have ThreadSanitizer check the memory orders)
+//
+// Producers and the consumer run on their own threads, as the ISRs and
+// loop() do on the two cores; a side that finds the queue full or empty
+// yields, so the test also runs (slowly) on a single CPU. Every Event
+// carries its sequence number spread over all four fields, so a torn or
+// stale slot shows up as a mismatch.
+// Checks that:
+//   - SPSC with a retrying producer delivers every event once, in order,
+//     and overflows() equals the rejected pushes,
+//   - SPSC with an ISR-style producer (a full queue drops the event)
+//     delivers an increasing subsequence and received + overflows() is
+//     what was pushed,
+//   - MPSC with 4 producer threads keeps every lane complete and in order,
+//   - MpscQueue::pop() merges filled lanes oldest-first by timeUs, also
+//     across the 32-bit micros() wrap.
+// Then reports events per second for each case and single-thread push +
+// pop time. Exits 1 on any failed check.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include "EventQueue.h"
+#include "../common/Check.h"
+
+static const uint32_t ITEMS = 4000000;
+static const uint8_t LANES = 4;
+
+static Event make(uint32_t seq, uint8_t lane) {
+  return Event{(uint8_t)seq, lane, (uint16_t)(seq >> 8), seq};
+}
+
+static bool consistent(const Event &e, uint8_t lane) {
+  return e.type == (uint8_t)e.timeUs && e.source == lane && e.arg == (uint16_t)(e.timeUs >> 8);
+}
+
+static double seconds(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+template <uint16_t N>
+static void spscRetry() {
+  static SpscQueue<Event, N> q;
+  uint32_t rejected = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  std::thread producer([&] {
+    for (uint32_t s = 0; s < ITEMS; s++)
+      while (!q.push(make(s, 0))) rejected++, std::this_thread::yield();
+  });
+  uint32_t expect = 0, bad = 0;
+  Event e;
+  while (expect < ITEMS) {
+    if (!q.pop(e)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (e.timeUs != expect || !consistent(e, 0)) bad++;
+    expect = e.timeUs + 1;
+  }
+  producer.join();
+  double s = seconds(t0);
+  printf("SPSC N=%-5u retrying producer: %u events, %u out of order or torn, %u full, overflows() %u, %6.1f M/s\n",
+         N, ITEMS, bad, rejected, q.overflows(), ITEMS / s / 1e6);
+  check(bad == 0 && q.empty(), "SPSC lost, reordered or tore an event");
+  check(q.overflows() == rejected, "SPSC overflows() doesn't match the rejected pushes");
+}
+
+template <uint16_t N>
+static void spscLossy() {
+  static SpscQueue<Event, N> q;
+  std::atomic<bool> done{false};
+  auto t0 = std::chrono::steady_clock::now();
+  std::thread producer([&] {
+    for (uint32_t s = 0; s < ITEMS; s++) q.push(make(s, 0));
+    done.store(true, std::memory_order_release);
+  });
+  uint32_t got = 0, bad = 0;
+  int64_t last = -1;
+  Event e;
+  for (;;) {
+    if (q.pop(e)) {
+      if ((int64_t)e.timeUs <= last || !consistent(e, 0)) bad++;
+      last = e.timeUs;
+      got++;
+    } else if (done.load(std::memory_order_acquire) && q.empty()) {
+      break;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  double s = seconds(t0);
+  printf("SPSC N=%-5u dropping producer: %u received + %u overflows = %u, %u out of order or torn, %6.1f M/s pushed\n",
+         N, got, q.overflows(), got + q.overflows(), bad, ITEMS / s / 1e6);
+  check(bad == 0 && got + q.overflows() == ITEMS, "SPSC dropping producer lost track of events");
+}
+
+template <uint16_t N>
+static void mpsc() {
+  static MpscQueue<Event, N, LANES> q;
+  std::atomic<uint32_t> clock{0};   // shared micros(): every push gets a fresh time
+  std::atomic<uint8_t> finished{0};
+  const uint32_t perLane = ITEMS / LANES;
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (uint8_t l = 0; l < LANES; l++)
+    producers.emplace_back([&, l] {
+      for (uint32_t s = 0; s < perLane; s++) {
+        // Time and sequence in one: the lane's own order must survive
+        Event e = make(clock.fetch_add(1, std::memory_order_relaxed), l);
+        while (!q.push(l, e)) std::this_thread::yield();
+      }
+      finished.fetch_add(1, std::memory_order_release);
+    });
+  uint32_t got[LANES] = {}, bad = 0;
+  int64_t last[LANES] = {-1, -1, -1, -1};
+  Event e;
+  for (;;) {
+    if (q.pop(e)) {
+      if (e.source >= LANES || !consistent(e, e.source) || (int64_t)e.timeUs <= last[e.source]) {
+        bad++;
+        continue;
+      }
+      last[e.source] = e.timeUs;
+      got[e.source]++;
+    } else if (finished.load(std::memory_order_acquire) == LANES && q.empty()) {
+      break;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  for (std::thread &t : producers) t.join();
+  double s = seconds(t0);
+  uint32_t total = 0;
+  bool complete = true;
+  for (uint8_t l = 0; l < LANES; l++) total += got[l], complete &= got[l] == perLane;
+  printf("MPSC N=%-5u %u producers: %u events, %u out of lane order or torn, %6.1f M/s\n", N, LANES, total, bad,
+         total / s / 1e6);
+  check(bad == 0 && complete, "MPSC lane lost, reordered or tore an event");
+}
+
+// Lanes filled first, then drained: pop() must return global time order
+static void mpscMerge() {
+  static MpscQueue<Event, 64, LANES> q;
+  int wrong = 0;
+  for (int round = 0; round < 2; round++) {
+    uint32_t base = round ? 0xFFFFFF00u : 1000;   // the second round crosses the micros() wrap
+    std::vector<uint32_t> times;
+    uint32_t seed = 7;
+    for (uint32_t t = 0; t < 200; t++) {
+      seed = seed * 1103515245u + 12345u;
+      uint8_t lane = (seed >> 16) % LANES;
+      q.push(lane, make(base + t * 3, lane));
+      times.push_back(base + t * 3);
+    }
+    Event e;
+    size_t k = 0;
+    while (q.pop(e)) wrong += k >= times.size() || e.timeUs != times[k++];
+    wrong += k != times.size();
+  }
+  printf("MPSC merge of 4 filled lanes (twice, once across the wrap): %d out of time order\n", wrong);
+  check(wrong == 0, "MpscQueue::pop() didn't merge oldest-first");
+}
+
+static void singleThread() {
+  static SpscQueue<Event, 16> spsc;
+  static MpscQueue<Event, 16, LANES> mp;
+  const uint32_t CALLS = 50000000;
+  volatile uint32_t sink = 0;
+  double best = 1e30, bestM = 1e30;
+  for (int run = 0; run < 5; run++) {
+    auto t0 = std::chrono::steady_clock::now();
+    Event e{};
+    for (uint32_t i = 0; i < CALLS; i++) {
+      spsc.push(make(i, 0));
+      spsc.pop(e);
+      sink += e.arg;
+    }
+    best = std::min(best, seconds(t0));
+    t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < CALLS; i++) {
+      mp.push((uint8_t)(i & (LANES - 1)), make(i, 0));
+      mp.pop(e);
+      sink += e.arg;
+    }
+    bestM = std::min(bestM, seconds(t0));
+  }
+  printf("one thread, push + pop: SPSC %.2f ns, MPSC (%u lanes) %.2f ns\n", best * 1e9 / CALLS, LANES,
+         bestM * 1e9 / CALLS);
+}
+
+int main() {
+  spscRetry<16>();
+  spscRetry<1024>();
+  spscLossy<16>();
+  spscLossy<1024>();
+  mpsc<16>();
+  mpsc<1024>();
+  mpscMerge();
+  singleThread();
+  return checkResult();
+}
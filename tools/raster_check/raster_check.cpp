@@ -0,0 +1,221 @@
+// raster_check: SpanRaster against Adafruit_GFX, pixel for pixel, and per
+// primitive speed
+//
+//   g++ -std=gnu++11 -O2 -DARDUINO=10819 -DESP32 -DARDUINO_ARCH_ESP32 -I../../sim/ArduinoSim
+//       -I../../lib/SpanRaster raster_check.cpp ../../lib/SpanRaster/SpanRaster.cpp
+//       ../../sim/ArduinoSim/*.cpp -o raster_check
+//   RASTER_CALLS=200000 ./raster_check     (the default count)
+//
+// Runs on the simulated board, so the reference is the simulator's
+// Adafruit_SSD1306 (GFX algorithms plus the driver's byte-wise
+// drawFastHLine / drawFastVLine, as on the device). Both frame buffers
+// start from the same random contents. Every fillCircle radius up to just
+// past MAX_FILL_RADIUS is drawn in each colour at five places; then every
+// random call (all primitives, all three colours, coordinates and radii
+// well off screen, radii past MAX_FILL_RADIUS) goes to both. The buffers
+// must be byte-identical after each call. The first mismatches are
+// printed with the call.
+//
+// Then each primitive is timed on the host, GFX vs SpanRaster, with the
+// calls the sketches make (the Hometask-BONUS logo, the class-3
+// diagonals) and a few harder ones. Exits 1 on any mismatch.
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SpanRaster.h"
+#include "../common/Check.h"
+
+static const int W = 128, H = 64, BYTES = W * H / 8;
+
+static Adafruit_SSD1306 display(W, H, &Wire, -1);
+static uint8_t frame[BYTES];
+static SpanRaster raster;
+
+static uint32_t g_seed = 1;
+static int rnd(int lo, int hi) {   // lo..hi inclusive
+  g_seed = g_seed * 1103515245u + 12345u;
+  return lo + (int)((g_seed >> 8) % (uint32_t)(hi - lo + 1));
+}
+
+enum Prim { PIXEL, HLINE, VLINE, RECT, SCREEN, LINE, CIRCLE, FILL_CIRCLE, PRIMS };
+static const char *const NAMES[PRIMS] = {"drawPixel", "drawFastHLine", "drawFastVLine", "fillRect",
+                                         "fillScreen", "drawLine", "drawCircle", "fillCircle"};
+
+struct Call {
+  Prim prim;
+  int16_t a, b, c, d;
+  uint8_t color;
+};
+
+static void onGfx(const Call &k) {
+  switch (k.prim) {
+    case PIXEL: display.drawPixel(k.a, k.b, k.color); break;
+    case HLINE: display.drawFastHLine(k.a, k.b, k.c, k.color); break;
+    case VLINE: display.drawFastVLine(k.a, k.b, k.c, k.color); break;
+    case RECT: display.fillRect(k.a, k.b, k.c, k.d, k.color); break;
+    case SCREEN: display.fillScreen(k.color); break;
+    case LINE: display.drawLine(k.a, k.b, k.c, k.d, k.color); break;
+    case CIRCLE: display.drawCircle(k.a, k.b, k.c, k.color); break;
+    case FILL_CIRCLE: display.fillCircle(k.a, k.b, k.c, k.color); break;
+    default: break;
+  }
+}
+
+static void onRaster(const Call &k) {
+  switch (k.prim) {
+    case PIXEL: raster.drawPixel(k.a, k.b, k.color); break;
+    case HLINE: raster.drawFastHLine(k.a, k.b, k.c, k.color); break;
+    case VLINE: raster.drawFastVLine(k.a, k.b, k.c, k.color); break;
+    case RECT: raster.fillRect(k.a, k.b, k.c, k.d, k.color); break;
+    case SCREEN: raster.fillScreen(k.color); break;
+    case LINE: raster.drawLine(k.a, k.b, k.c, k.d, k.color); break;
+    case CIRCLE: raster.drawCircle(k.a, k.b, k.c, k.color); break;
+    case FILL_CIRCLE: raster.fillCircle(k.a, k.b, k.c, k.color); break;
+    default: break;
+  }
+}
+
+static Call randomCall() {
+  Call k;
+  k.prim = (Prim)rnd(0, PRIMS - 1);
+  if (k.prim == SCREEN && rnd(0, 9)) k.prim = RECT;   // keep full-screen fills rare
+  k.color = (uint8_t)rnd(0, 2);
+  // Mostly on screen, often across an edge, sometimes far off it
+  k.a = (int16_t)rnd(-80, W + 80);
+  k.b = (int16_t)rnd(-60, H + 60);
+  k.c = (int16_t)rnd(-150, 150);
+  k.d = (int16_t)rnd(-100, 100);
+  if (k.prim == LINE) {
+    k.c = (int16_t)rnd(-80, W + 80);
+    k.d = (int16_t)rnd(-60, H + 60);
+  }
+  if (k.prim == CIRCLE || k.prim == FILL_CIRCLE) k.c = (int16_t)(rnd(0, 9) ? rnd(0, 70) : rnd(0, 200));
+  return k;
+}
+
+// Draw k on both; on a mismatch report it and go on from the reference
+static bool same(const Call &k, long n) {
+  uint8_t *gfx = display.getBuffer();
+  onGfx(k);
+  onRaster(k);
+  if (!memcmp(gfx, frame, BYTES)) return true;
+  int i = 0;
+  while (gfx[i] == frame[i]) i++;
+  checkf(false, "call %ld: %s(%d, %d, %d, %d) color %u: page %d column %d gfx %02X raster %02X", n, NAMES[k.prim],
+         k.a, k.b, k.c, k.d, k.color, i / W, i % W, gfx[i], frame[i]);
+  memcpy(frame, gfx, BYTES);
+  return false;
+}
+
+static void golden(long calls) {
+  uint8_t *gfx = display.getBuffer();
+  for (int i = 0; i < BYTES; i++) gfx[i] = frame[i] = (uint8_t)rnd(0, 255);
+  long bad = 0;
+
+  // fillCircle's tables rely on GFX emitting each column once for every
+  // radius they cover: all of those (and the first ones past), in every
+  // colour, centred and pushed into each corner so every edge shows
+  long sweep = 0;
+  for (int16_t r = 0; r <= SpanRaster::MAX_FILL_RADIUS + 2; r++)
+    for (uint8_t color = 0; color < 3; color++) {
+      const int16_t at[5][2] = {{W / 2, H / 2}, {r, r}, {(int16_t)(W - 1 - r), r},
+                                {r, (int16_t)(H - 1 - r)}, {(int16_t)(W - 1 - r), (int16_t)(H - 1 - r)}};
+      for (const auto &c : at) {
+        Call k = {FILL_CIRCLE, c[0], c[1], r, 0, color};
+        bad += !same(k, sweep++);
+      }
+    }
+  printf("fillCircle sweep: %ld calls (r 0..%d, every colour), %ld mismatches\n", sweep,
+         SpanRaster::MAX_FILL_RADIUS + 2, bad);
+
+  long perPrim[PRIMS] = {};
+  bad = 0;
+  for (long n = 0; n < calls; n++) {
+    Call k = randomCall();
+    perPrim[k.prim]++;
+    bad += !same(k, n);
+  }
+  printf("golden: %ld random calls (", calls);
+  for (int p = 0; p < PRIMS; p++) printf("%s%s %ld", p ? ", " : "", NAMES[p], perPrim[p]);
+  printf("), %ld mismatches\n", bad);
+}
+
+// ---- speed ----
+typedef void (*Draw)(int);
+
+static double nsPerCall(Draw draw) {
+  const int N = 20000;
+  double best = 1e30;
+  for (int run = 0; run < 5; run++) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) draw(i);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / N;
+    if (ns < best) best = ns;
+  }
+  return best;
+}
+
+struct Case {
+  const char *name;
+  Draw gfx, span;
+};
+
+// `i` varies the colour so nothing is folded away between calls
+static const Case CASES[] = {
+  {"logo fillCircle x3",
+   [](int i) {
+     display.fillCircle(64, 32, 24, 1);
+     display.fillCircle(64, 32, 18, i & 1);
+     display.fillCircle(64, 32, 10, 1);
+   },
+   [](int i) {
+     raster.fillCircle(64, 32, 24, 1);
+     raster.fillCircle(64, 32, 18, i & 1);
+     raster.fillCircle(64, 32, 10, 1);
+   }},
+  {"diagonals x2",
+   [](int i) {
+     display.drawLine(0, 0, 127, 63, i & 1);
+     display.drawLine(0, 63, 127, 0, i & 1);
+   },
+   [](int i) {
+     raster.drawLine(0, 0, 127, 63, i & 1);
+     raster.drawLine(0, 63, 127, 0, i & 1);
+   }},
+  {"steep line", [](int i) { display.drawLine(60, 0, 70, 63, i & 1); },
+   [](int i) { raster.drawLine(60, 0, 70, 63, i & 1); }},
+  {"clipped line", [](int i) { display.drawLine(-500, -200, 600, 260, i & 1); },
+   [](int i) { raster.drawLine(-500, -200, 600, 260, i & 1); }},
+  {"drawCircle r30", [](int i) { display.drawCircle(64, 32, 30, i & 1); },
+   [](int i) { raster.drawCircle(64, 32, 30, i & 1); }},
+  {"fillCircle r20 inverse", [](int) { display.fillCircle(64, 32, 20, 2); },
+   [](int) { raster.fillCircle(64, 32, 20, 2); }},
+  {"fillRect 100x40", [](int i) { display.fillRect(10, 10, 100, 40, i & 1); },
+   [](int i) { raster.fillRect(10, 10, 100, 40, i & 1); }},
+  {"fillScreen", [](int i) { display.fillScreen(i & 1); }, [](int i) { raster.fillScreen(i & 1); }},
+};
+
+static void speed() {
+  printf("%-24s %10s %10s %8s\n", "case", "GFX ns", "span ns", "speedup");
+  for (const Case &c : CASES) {
+    double g = nsPerCall(c.gfx), s = nsPerCall(c.span);
+    printf("%-24s %10.1f %10.1f %7.1fx\n", c.name, g, s, g / s);
+  }
+}
+
+static long g_calls = 200000;
+
+void setup() {
+  if (const char *n = getenv("RASTER_CALLS")) g_calls = atol(n);
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  raster.begin(frame);
+  golden(g_calls);
+  speed();
+  exit(checkResult());
+}
+
+void loop() {}
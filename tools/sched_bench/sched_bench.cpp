@@ -0,0 +1,166 @@
+// sched_bench: CoopSched deadline jitter on a virtual clock, and dispatch cost
+//
+//   g++ -std=c++11 -O2 -I../../lib/CoopSched -I../../lib/FixedText sched_bench.cpp
+//       ../../lib/CoopSched/CoopSched.cpp -o sched_bench
+//   ./sched_bench
+//
+// Runs the task set of HomeTask2-PartB - Copy and week-5/class-2 (buttons,
+// serial, LED steps, melody notes, a one-shot buzzer chain and the slow
+// report) for 10 virtual minutes. Each task burns a varying, made-up CPU
+// time. The same schedule runs with three ways of sleeping until the next
+// deadline:
+//
+//   exact      the virtual clock jumps to the deadline
+//   tick       blocked to the next 1 ms FreeRTOS tick (vTaskDelay() alone)
+//   esp_timer  SchedClock::arduino(): an esp_timer wakes the task WAKE_US
+//              early with 5-40 us of dispatch latency, the rest is spun
+//
+// and prints, per task, how late it started (p50 / p99 / max in us) plus
+// the share of time spent spinning. Then times runDue() itself on the host.
+// Exits 1 if a task in the exact or esp_timer runs starts later than one
+// run of every other task plus the wake-up latency: a cooperative
+// scheduler can't do better than that, but must not do worse.
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+#include "CoopSched.h"
+
+static const uint32_t RUN_US = 600u * 1000000u;
+static const uint32_t WAKE_US = 20;     // as in CoopSched.cpp
+static const uint32_t TICK_US = 1000;
+static const uint32_t TICK_PHASE_US = 347;   // ticks don't line up with micros()
+
+static uint32_t g_seed = 1;
+static uint32_t rnd(uint32_t n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (g_seed >> 16) % n;
+}
+
+// ---- sleep models ----
+static uint64_t g_spunUs = 0;
+
+static void sleepTick(uint32_t us) {
+  uint32_t end = VirtualClock::now + us;
+  uint32_t ticks = (end - TICK_PHASE_US + TICK_US - 1) / TICK_US;
+  VirtualClock::now = ticks * TICK_US + TICK_PHASE_US;
+}
+
+static void sleepEspTimer(uint32_t us) {
+  uint32_t end = VirtualClock::now + us;
+  if (us > WAKE_US) VirtualClock::now += us - WAKE_US + 5 + rnd(36);
+  int32_t left = (int32_t)(end - VirtualClock::now);
+  if (left > 0) {
+    VirtualClock::now += left;
+    g_spunUs += left;
+  }
+}
+
+// ---- task set ----
+struct Spec {
+  const char *name;
+  uint32_t periodUs;   // 0: the one-shot buzzer chain
+  uint32_t costUs;     // CPU time per run, +-50 %
+};
+
+static const Spec SPECS[] = {
+  {"buttons", 5000, 15},    {"serial", 50000, 5},     {"leds", 20000, 30},
+  {"melody", 300000, 40},   {"buzzer", 0, 25},        {"report", 5000000, 18000},
+};
+static const int TASKS = sizeof(SPECS) / sizeof(SPECS[0]);
+static const uint32_t BUZZER_STEPS_US[] = {150000, 250000, 150000, 450000};
+
+static CoopSched *g_sched;
+static std::vector<uint32_t> g_late[TASKS];
+static uint32_t g_next[TASKS];   // deadlines, kept the way CoopSched keeps them
+static uint32_t g_buzzerDeadline = 0;
+static uint8_t g_buzzerStep = 0;
+
+static void work(int i) {
+  uint32_t c = SPECS[i].costUs;
+  VirtualClock::now += c / 2 + rnd(c + 1);
+}
+
+template <int I>
+static void periodic() {
+  uint32_t now = VirtualClock::now, p = SPECS[I].periodUs;
+  g_late[I].push_back(now - g_next[I]);
+  g_next[I] += p;
+  // Missed slots are skipped, the phase is kept
+  if ((int32_t)(g_next[I] - now) < 0) g_next[I] += ((now - g_next[I]) / p + 1) * p;
+  work(I);
+}
+
+static void buzzer() {
+  const int I = 4;
+  g_late[I].push_back(VirtualClock::now - g_buzzerDeadline);
+  work(I);
+  uint32_t d = BUZZER_STEPS_US[g_buzzerStep++ & 3];
+  g_buzzerDeadline += d;
+  g_sched->again(d);
+}
+
+static uint32_t pct(std::vector<uint32_t> &v, int p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, v.size() * p / 100)];
+}
+
+static bool runModel(const char *name, void (*sleepUs)(uint32_t)) {
+  VirtualClock::now = 0;
+  g_spunUs = 0;
+  g_seed = 1;
+  g_buzzerDeadline = 0;
+  g_buzzerStep = 0;
+  for (auto &v : g_late) v.clear();
+  for (auto &n : g_next) n = 0;
+
+  CoopSched sched(SchedClock{&VirtualClock::nowUs, sleepUs});
+  g_sched = &sched;
+  sched.every(SPECS[0].periodUs, periodic<0>, SPECS[0].name);
+  sched.every(SPECS[1].periodUs, periodic<1>, SPECS[1].name);
+  sched.every(SPECS[2].periodUs, periodic<2>, SPECS[2].name);
+  sched.every(SPECS[3].periodUs, periodic<3>, SPECS[3].name);
+  sched.after(0, buzzer, SPECS[4].name);
+  sched.every(SPECS[5].periodUs, periodic<5>, SPECS[5].name);
+  while (VirtualClock::now < RUN_US) sched.run();
+
+  printf("%s: spinning %.3f %% of the time\n", name, 100.0 * g_spunUs / VirtualClock::now);
+  printf("  %-8s %8s %8s %8s %8s\n", "task", "runs", "p50 us", "p99 us", "max us");
+  bool ok = true;
+  for (int i = 0; i < TASKS; i++) {
+    uint32_t others = 0;   // every other task running once, as long as it can
+    for (int j = 0; j < TASKS; j++)
+      if (j != i) others += SPECS[j].costUs * 3 / 2;
+    size_t runs = g_late[i].size();
+    uint32_t p50 = pct(g_late[i], 50), p99 = pct(g_late[i], 99), mx = pct(g_late[i], 100);
+    bool bad = sleepUs != sleepTick && mx > others + 40;
+    printf("  %-8s %8zu %8u %8u %8u%s\n", SPECS[i].name, runs, p50, p99, mx, bad ? "  TOO LATE" : "");
+    ok = ok && !bad;
+  }
+  return ok;
+}
+
+// Host cost of one runDue() that finds a task due among 16
+static void dispatchCost() {
+  VirtualClock::now = 0;
+  CoopSched sched(VirtualClock::clock());
+  for (int i = 0; i < CoopSched::MAX_TASKS; i++) sched.every(1000 + 37 * i, [] {}, "t");
+  const int N = 2000000;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; i++) {
+    uint32_t wait = sched.runDue();
+    VirtualClock::now += wait == UINT32_MAX ? 1000 : wait;
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  printf("dispatch: %.1f ns per runDue() with %d tasks (host)\n", ns / N, (int)CoopSched::MAX_TASKS);
+}
+
+int main() {
+  bool ok = runModel("exact", &VirtualClock::sleepUs);
+  runModel("tick", &sleepTick);
+  ok = runModel("esp_timer", &sleepEspTimer) && ok;
+  dispatchCost();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+// store_bench: SampleStore rollups against a brute-force reference, and
+// insert / query speed
+//
+//   g++ -std=gnu++11 -O2 -I../../sim/ArduinoSim -I../../lib/SampleStore store_bench.cpp -o store_bench
+//   ./store_bench
+//
+// Feeds the HomeTask1 layout (3 channels, 240 raw samples, 60 x 1 min,
+// 96 x 15 min, 168 x 1 h) eight days of 1 s samples: one channel near
+// +full scale, one near -full scale (a week of either is far past 2^31 in
+// the sum) and a DHT-like 0.1 degC trace, with a 20 min gap on day 3 and
+// a few late samples. At every simulated hour it compares last() for
+// several spans on every tier, and the raw ring, with min / max / mean /
+// count computed from the full sample list. Then times add() and last()
+// per tier at its full depth, best of several runs. Exits 1 on any
+// mismatch.
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+#include "SampleStore.h"
+#include "../common/Check.h"
+
+// Only the header is used; millis64() belongs to the board build
+uint64_t millis64() { return 0; }
+
+enum { CH_HIGH, CH_LOW, CH_TEMP, CH_COUNT };
+typedef SampleStore<CH_COUNT, 240> Store;
+
+static const uint64_t SAMPLE_MS = 1000;
+static const uint64_t RUN_MS = 8ULL * 24 * 3600 * 1000;
+static const uint64_t GAP_FROM = 2ULL * 24 * 3600 * 1000 + 5 * 3600 * 1000, GAP_MS = 20 * 60 * 1000;
+static const uint64_t LATE_MS = 120000;   // how far back a late sample is stamped
+static const int RUNS = 5;
+
+struct Rec {
+  uint64_t t;
+  int16_t v[CH_COUNT];
+};
+
+static uint32_t g_seed = 1;
+static int rnd(int n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (int)((g_seed >> 16) % (uint32_t)n);
+}
+
+static void sample(uint64_t t, int16_t (&v)[CH_COUNT]) {
+  v[CH_HIGH] = (int16_t)(32000 + rnd(768) - (t / 60000) % 500);
+  v[CH_LOW] = (int16_t)(-32000 - rnd(768) + (t / 60000) % 500);
+  v[CH_TEMP] = (int16_t)(230 + (int)((t / 600000) % 40) - 20 + rnd(3));
+}
+
+static int g_compared = 0;
+
+// Computed independently of Rollup, sums in 64 bits
+struct Ref {
+  int16_t min = INT16_MAX, max = INT16_MIN;
+  int64_t sum = 0;
+  uint32_t count = 0;
+  void add(int16_t v) {
+    min = std::min(min, v);
+    max = std::max(max, v);
+    sum += v;
+    count++;
+  }
+  int16_t mean() const { return count ? (int16_t)(sum / count) : 0; }
+};
+
+// Same covering rule as last(): the current bucket and n-1 older ones
+static Ref reference(const std::vector<Rec> &recs, const std::vector<uint8_t> &inTier, StoreTier tier,
+                        uint8_t ch, uint32_t spanMs, uint64_t now) {
+  Ref r;
+  uint32_t period = Store::PERIOD_MS[tier];
+  uint32_t n = std::min<uint32_t>((spanMs + period - 1) / period, Store::tierDepth(tier));
+  uint64_t cur = now / period;
+  for (size_t i = recs.size(); i-- > 0;) {
+    uint64_t idx = recs[i].t / period;
+    if ((recs[i].t + LATE_MS) / period + n <= cur) break;   // nothing older can be in range
+    if (idx + n > cur && (inTier[i] & (1 << tier))) r.add(recs[i].v[ch]);
+  }
+  return r;
+}
+
+static void compare(const Store &s, const std::vector<Rec> &recs, const std::vector<uint8_t> &inTier,
+                    uint64_t now) {
+  static const uint32_t SPANS[] = {60000, 15 * 60000UL, 3600000UL, 24 * 3600000UL, 7 * 24 * 3600000UL};
+  for (int tier = 0; tier < TIER_COUNT; tier++) {
+    for (uint32_t span : SPANS) {
+      for (uint8_t c = 0; c < CH_COUNT; c++) {
+        Rollup got = s.last((StoreTier)tier, c, span);
+        Ref want = reference(recs, inTier, (StoreTier)tier, c, span, now);
+        g_compared++;
+        checkf(got.count == want.count && got.sum == want.sum && got.mean() == want.mean() &&
+                   (!got.count || (got.min == want.min && got.max == want.max)),
+               "at %llu s tier %d span %lu ch %d: got %d/%d/%d n=%lu, want %d/%d/%d n=%lu",
+               (unsigned long long)(now / 1000), tier, (unsigned long)span, c, got.min, got.mean(), got.max,
+               (unsigned long)got.count, want.min, want.mean(), want.max, (unsigned long)want.count);
+      }
+    }
+  }
+  for (uint16_t ago = 0; ago < s.rawCount(); ago++) {
+    const Store::Sample &r = s.raw(ago);
+    const Rec &w = recs[recs.size() - 1 - ago];
+    if (!checkf(r.t == w.t && !memcmp(r.v, w.v, sizeof(r.v)), "raw sample %u at %llu s", ago,
+                (unsigned long long)(now / 1000)))
+      break;
+  }
+}
+
+static void checkAgainstReference() {
+  static Store s;
+  std::vector<Rec> recs;
+  std::vector<uint8_t> inTier;   // bit per tier: the sample is in that tier's rollups
+  uint64_t newest[TIER_COUNT] = {};
+  recs.reserve(RUN_MS / SAMPLE_MS + 16);
+  uint32_t late = 0;
+  for (uint64_t t = 0; t < RUN_MS; t += SAMPLE_MS) {
+    if (t >= GAP_FROM && t < GAP_FROM + GAP_MS) continue;
+    Rec r;
+    r.t = t;
+    sample(t, r.v);
+    // Now and then a sample arrives stamped 2 min in the past: it belongs in
+    // the raw ring, and in a tier only if its bucket is still the newest
+    if (t > 300000 && t % 4000000 == 0) r.t = t - LATE_MS;
+    uint8_t mask = 0;
+    for (int tier = 0; tier < TIER_COUNT; tier++) {
+      uint64_t idx = r.t / Store::PERIOD_MS[tier];
+      if (recs.empty() || idx >= newest[tier]) mask |= 1 << tier, newest[tier] = idx;
+    }
+    if (mask != (1 << TIER_COUNT) - 1) late++;
+    s.add(r.t, r.v);
+    recs.push_back(r);
+    inTier.push_back(mask);
+    if (t % 3600000 == 3599000) compare(s, recs, inTier, t);
+  }
+  int64_t full = 0;
+  for (const Rec &r : recs) full += r.v[CH_HIGH];
+  printf("%lu samples over %llu days, %lu late (store counted %lu), %d rollups compared: %s\n",
+         (unsigned long)recs.size(), (unsigned long long)(RUN_MS / 86400000), (unsigned long)late,
+         (unsigned long)s.late(), g_compared, g_failed ? "FAIL" : "ok");
+  printf("  high channel sum over the run %lld (2^31 = 2147483648), 7 d mean %d\n", (long long)full,
+         s.last(TIER_1H, CH_HIGH, 7 * 24 * 3600000UL).mean());
+  check(s.late() == late, "late() differs from the samples sent late");
+}
+
+template <typename F>
+static double bestNs(int calls, F f) {
+  double best = 1e30;
+  for (int run = 0; run < RUNS; run++) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / calls;
+    best = std::min(best, ns);
+  }
+  return best;
+}
+
+static void bench() {
+  static Store s;
+  const int ADDS = 500000;
+  std::vector<Rec> recs(ADDS);
+  for (int i = 0; i < ADDS; i++) {
+    recs[i].t = (uint64_t)i * SAMPLE_MS;
+    sample(recs[i].t, recs[i].v);
+  }
+  printf("\nsizeof(SampleStore<%d, 240>) = %u bytes\n", CH_COUNT, (unsigned)sizeof(Store));
+  double ns = bestNs(ADDS, [&] {
+    s = Store();
+    for (const Rec &r : recs) s.add(r.t, r.v);
+  });
+  printf("%-34s %8.1f ns/call\n", "add() 1 s samples", ns);
+
+  volatile int32_t sink = 0;
+  for (int tier = 0; tier < TIER_COUNT; tier++) {
+    uint32_t span = Store::PERIOD_MS[tier] * Store::tierDepth((StoreTier)tier);
+    const int CALLS = 200000;
+    ns = bestNs(CALLS, [&] {
+      for (int i = 0; i < CALLS; i++) sink += s.last((StoreTier)tier, (uint8_t)(i % CH_COUNT), span).mean();
+    });
+    char name[48];
+    snprintf(name, sizeof(name), "last() tier %d, %u buckets", tier, Store::tierDepth((StoreTier)tier));
+    printf("%-34s %8.1f ns/call (%.2f ns/bucket)\n", name, ns, ns / Store::tierDepth((StoreTier)tier));
+  }
+  const int CALLS = 1000000;
+  ns = bestNs(CALLS, [&] {
+    for (int i = 0; i < CALLS; i++) sink += s.raw((uint16_t)(i % s.rawCount())).v[0];
+  });
+  printf("%-34s %8.1f ns/call\n", "raw(ago)", ns);
+}
+
+int main() {
+  checkAgainstReference();
+  bench();
+  return checkResult();
+}
@@ -0,0 +1,135 @@
+// telemetry_decode: binary telemetry stream (lib/Telemetry) -> CSV
+//
+//   g++ -std=c++11 -O2 -I../../lib/Telemetry telemetry_decode.cpp -o telemetry_decode
+//   stty -F /dev/ttyUSB0 115200 raw && ./telemetry_decode < /dev/ttyUSB0 > log.csv
+//   ./telemetry_decode capture.bin > log.csv
+//
+// Writes "t_ms,channel,value" rows to stdout, values scaled by the channel
+// table the device sends. Text the sketch printed between frames goes to
+// stderr unchanged, followed by a summary (frames, lost frames by sequence
+// gap, CRC failures, wire bytes per record).
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "TelemetryCodec.h"
+
+using namespace TelemetryCodec;
+
+struct ChannelInfo {
+  bool known = false;
+  uint8_t decimals = 0;
+  std::string name;
+};
+
+static ChannelInfo channels[256];
+static unsigned long frames, records, badFrames, lostFrames, wireBytes, textBytes;
+static int lastSeq = -1;
+
+static void printValue(int32_t v, uint8_t decimals) {
+  if (!decimals) {
+    printf("%ld", (long)v);
+    return;
+  }
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < decimals && i < 9; i++) scale *= 10;
+  uint32_t mag = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+  printf("%s%lu.%0*lu", v < 0 ? "-" : "", (unsigned long)(mag / scale), (int)decimals,
+         (unsigned long)(mag % scale));
+}
+
+static bool decodeChannels(const uint8_t *p, const uint8_t *end) {
+  uint8_t count = *p++;
+  for (uint8_t i = 0; i < count; i++) {
+    if (end - p < 3 || end - p < 3 + p[2]) return false;
+    ChannelInfo &c = channels[p[0]];
+    c.known = true;
+    c.decimals = p[1];
+    c.name.assign((const char *)p + 3, p[2]);
+    p += 3 + p[2];
+  }
+  return true;
+}
+
+static bool decodeData(const uint8_t *p, const uint8_t *end) {
+  uint8_t seq = p[0];
+  uint32_t t = p[1] | (uint32_t)p[2] << 8 | (uint32_t)p[3] << 16 | (uint32_t)p[4] << 24;
+  p += 5;
+  if (lastSeq >= 0) lostFrames += (uint8_t)(seq - lastSeq - 1);
+  lastSeq = seq;
+  while (p < end) {
+    uint8_t ch = *p++;
+    uint32_t dt, zz;
+    uint8_t n = getVarint(p, end, dt);
+    if (!n) return false;
+    p += n;
+    n = getVarint(p, end, zz);
+    if (!n) return false;
+    p += n;
+    t += dt;
+    const ChannelInfo &c = channels[ch];
+    printf("%lu,", (unsigned long)t);
+    if (c.known) printf("%s,", c.name.c_str());
+    else printf("ch%u,", ch);
+    printValue(unzigzag(zz), c.decimals);
+    printf("\n");
+    records++;
+  }
+  return true;
+}
+
+static bool looksLikeText(const std::vector<uint8_t> &chunk) {
+  for (uint8_t b : chunk)
+    if ((b < 0x20 && b != '\r' && b != '\n' && b != '\t') || b == 0x7F) return false;
+  return true;
+}
+
+static void handleChunk(const std::vector<uint8_t> &chunk) {
+  if (chunk.empty()) return;
+  std::vector<uint8_t> raw(chunk.size());
+  size_t n = cobsDecode(chunk.data(), chunk.size(), raw.data());
+  bool ok = n > CRC_BYTES && crc16(raw.data(), n - CRC_BYTES) == (raw[n - 2] | raw[n - 1] << 8);
+  if (ok) {
+    const uint8_t *p = raw.data(), *end = p + n - CRC_BYTES;
+    if (p[0] == FRAME_DATA && n - CRC_BYTES >= DATA_HEADER) ok = decodeData(p + 1, end);
+    else if (p[0] == FRAME_CHANNELS && n - CRC_BYTES >= 2) ok = decodeChannels(p + 1, end);
+    else ok = false;
+  }
+  if (ok) {
+    frames++;
+    wireBytes += chunk.size() + 2;   // both delimiters
+  } else if (looksLikeText(chunk)) {
+    fwrite(chunk.data(), 1, chunk.size(), stderr);
+    textBytes += chunk.size();
+  } else {
+    badFrames++;
+  }
+}
+
+int main(int argc, char **argv) {
+  FILE *in = stdin;
+  if (argc > 1 && !(in = fopen(argv[1], "rb"))) {
+    perror(argv[1]);
+    return 1;
+  }
+  printf("t_ms,channel,value\n");
+  std::vector<uint8_t> chunk;
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (c) {
+      chunk.push_back((uint8_t)c);
+      continue;
+    }
+    handleChunk(chunk);
+    chunk.clear();
+    fflush(stdout);
+  }
+  handleChunk(chunk);
+
+  fprintf(stderr, "\ntelemetry: %lu frames, %lu records, %lu lost frames, %lu bad frames, %lu text bytes\n",
+          frames, records, lostFrames, badFrames, textBytes);
+  if (records)
+    fprintf(stderr, "telemetry: %.2f wire bytes per record\n", (double)wireBytes / records);
+  return 0;
+}
@@ -0,0 +1,80 @@
+// text_bench: OLED label building, Arduino String vs FixedString
+//
+//   g++ -std=c++11 -O2 -I../../lib/FixedText -I../../sim/ArduinoSim text_bench.cpp -o text_bench
+//   ./text_bench
+//
+// Builds the two redraw labels the sketches used to concatenate with
+// String ("State:\n" + label in HomeTask 2-Part A, "Mode: " + name in
+// HomeTask2-PartB - Copy) both ways, and reports ns per label and heap
+// allocations per label (operator new is counted here).
+//
+// The String side is the simulator's String (sim/ArduinoSim/WString.h),
+// which sits on std::string and keeps up to 15 chars without the heap. The
+// ESP32 core's String allocates with realloc and has a smaller inline
+// buffer, so on the device it allocates at least as often as shown here.
+
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include "WString.h"
+#include "FixedString.h"
+
+static unsigned long g_allocs = 0;
+
+void *operator new(size_t n) {
+  g_allocs++;
+  void *p = malloc(n ? n : 1);
+  if (!p) abort();
+  return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static constexpr const char *const PART_A[] = {"ALL OFF", "ALTERNATE", "ALL ON", "PWM FADE"};
+static constexpr const char *const PART_B[] = {"All Off", "Alternate Blink", "All On", "PWM Fade"};
+
+static const int N = 1000000;
+
+// Keeps the result alive without printing it
+static unsigned g_sink = 0;
+
+template <typename F>
+static void run(const char *name, F build) {
+  for (int i = 0; i < 1000; i++) build(i);   // warm up
+  unsigned long a0 = g_allocs;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; i++) build(i);
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+  printf("%-28s %7.1f ns/label  %5.2f allocations/label\n", name, ns, (double)(g_allocs - a0) / N);
+}
+
+int main() {
+  run("Part A: String", [](int i) {
+    String s = "State:\n" + String(PART_A[i & 3]);
+    g_sink += s.length();
+  });
+  run("Part A: FixedString<24>", [](int i) {
+    FixedString<24> s("State:\n");
+    s += label(PART_A, i & 3);
+    g_sink += s.length();
+  });
+  run("PartB-Copy: String", [](int i) {
+    String s = String("Mode: ") + PART_B[i & 3];
+    g_sink += s.length();
+  });
+  run("PartB-Copy: FixedString<24>", [](int i) {
+    FixedString<24> s("Mode: ");
+    s += label(PART_B, i & 3);
+    g_sink += s.length();
+  });
+  run("printf line: FixedString<127>", [](int i) {
+    FixedString<PRINTF_CHARS> s;
+    s.printf("%s 15min: min %d mean %d max %d (%lu samples)\n", PART_B[i & 3], i & 255, 220 + (i & 7), 240,
+             (unsigned long)i);
+    g_sink += s.length();
+  });
+  printf("checksum %u\n", g_sink);
+  return 0;
+}
@@ -1,27 +1,25 @@
 #include <Arduino.h>
+#include <LedFx.h>
 
 #define LED_PIN 2            
-#define Freq 5000
-#define res 8
-#define chn 0
+#define FADE_MS 5100         // 0 -> full, as the old 255 steps of 20 ms
 
-void setup(){
-  ledcSetup(chn,Freq,res);
-  ledcAttachPin(LED_PIN,chn);
+// Up and back down, forever. The LEDC fade hardware does the ramps.
+static constexpr Keyframe FADE_FRAMES[] = {
+  {FADE_MS, 0, {255}},
+  {FADE_MS, 0, {0}},
+};
+static constexpr Effect FADE = makeEffect(FADE_FRAMES, true);
+
+LedFx leds;
 
+void setup(){
+  leds.add(LED_PIN);
+  leds.begin();
+  leds.play(FADE);
 }
 
 void loop()
 {
-  for (int i = 0; i <= 255; i++)
-  {
-    ledcWrite(chn,i);
-    delay(20);
-  }
-  
-  for (int i = 255; i >= 0; i--)
-  {
-    ledcWrite(chn,i);
-    delay(20);
-  }
-}
\ No newline at end of file
+  // nothing to do: the fade runs without the CPU
+}
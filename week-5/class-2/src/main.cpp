@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include <CoopSched.h>
 
 #define BUZZER_PIN  27     // GPIO connected to buzzer
 #define BUZ_CH      0      // PWM channel (0–15)
@@ -15,6 +16,77 @@
 
 #define LED_RES 8
 
+CoopSched sched(SchedClock::arduino());
+
+// ---- Buzzer: beeps -> sweep -> pause -> melody, then again ----
+// Each call plays one step and tells the scheduler when the next one is due,
+// so the LEDs (and anything else) keep running in between.
+enum BuzPhase { BEEP_ON, BEEP_OFF, SWEEP, MELODY };
+const int melody[] = {262, 294, 330, 349, 392, 440, 494, 523};
+BuzPhase buzPhase = BEEP_ON;
+int buzStep = 0;
+
+void buzzerStep() {
+  uint32_t nextMs = 0;
+  switch (buzPhase) {
+    // --- 1. Simple beep pattern ---
+    case BEEP_ON:
+      ledcWriteTone(BUZ_CH, 2000 + buzStep * 400); // change tone
+      buzPhase = BEEP_OFF;
+      nextMs = 150;
+      break;
+    case BEEP_OFF:
+      ledcWrite(BUZ_CH, 0);                        // stop tone
+      if (++buzStep < 3) buzPhase = BEEP_ON;
+      else { buzPhase = SWEEP; buzStep = 400; }
+      nextMs = 150;
+      break;
+
+    // --- 2. Frequency sweep (400Hz → 3kHz) ---
+    case SWEEP:
+      if (buzStep <= 3000) {
+        ledcWriteTone(BUZ_CH, buzStep);
+        buzStep += 100;
+        nextMs = 20;
+      } else {
+        ledcWrite(BUZ_CH, 0);
+        buzPhase = MELODY;
+        buzStep = 0;
+        nextMs = 500;
+      }
+      break;
+
+    // --- 3. Short melody ---
+    case MELODY:
+      if (buzStep < 8) {
+        ledcWriteTone(BUZ_CH, melody[buzStep++]);
+        nextMs = 250;
+      } else {
+        ledcWrite(BUZ_CH, 0); // stop buzzer
+        buzPhase = BEEP_ON;
+        buzStep = 0;
+      }
+      break;
+  }
+  sched.again(nextMs * 1000UL);
+}
+
+// ---- LEDs: fade up in steps of 10, down in steps of 20, every 20 ms ----
+int ledLevel = 0;
+bool ledUp = true;
+
+void ledFadeStep() {
+  ledcWrite(LED1_CH, ledLevel);
+  ledcWrite(LED2_CH, ledLevel);
+  if (ledUp) {
+    ledLevel += 10;
+    if (ledLevel >= 255) { ledLevel = 255; ledUp = false; }
+  } else {
+    ledLevel -= 20;
+    if (ledLevel <= 0) { ledLevel = 0; ledUp = true; }
+  }
+}
+
 void setup() {
   //LED1
    ledcSetup(LED1_CH, LED1_FREQ, LED_RES);
@@ -26,63 +98,11 @@ void setup() {
   ledcSetup(BUZ_CH, BUZ_FREQ, BUZ_RESOLUTION);
   ledcAttachPin(BUZZER_PIN, BUZ_CH);
 
-  // --- 1. Simple beep pattern ---
-  for (int i = 0; i < 3; i++) {
-    ledcWriteTone(BUZ_CH, 2000 + i * 400); // change tone
-    delay(150);
-    ledcWrite(BUZ_CH, 0);                  // stop tone
-    delay(150);
-  }
-
-  // --- 2. Frequency sweep (400Hz → 3kHz) ---
-  for (int f = 400; f <= 3000; f += 100) {
-    ledcWriteTone(BUZ_CH, f);
-    delay(20);
-  }
-  ledcWrite(BUZ_CH, 0);
-  delay(500);
-
-  // --- 3. Short melody ---
-  int melody[] = {262, 294, 330, 349, 392, 440, 494, 523};
-  for (int i = 0; i < 8; i++) {
-    ledcWriteTone(BUZ_CH, melody[i]);
-    delay(250);
-  }
-  ledcWrite(BUZ_CH, 0); // stop buzzer
+  // Buzzer sequence and LED fade now run side by side
+  sched.after(0, buzzerStep, "buzzer");
+  sched.every(20000, ledFadeStep, "leds");
 }
 
 void loop() {
-  for (int i = 0; i < 3; i++) {
-    ledcWriteTone(BUZ_CH, 2000 + i * 400); // change tone
-    delay(150);
-    ledcWrite(BUZ_CH, 0);                  // stop tone
-    delay(150);
-  }
-
-  // --- 2. Frequency sweep (400Hz → 3kHz) ---
-  for (int f = 400; f <= 3000; f += 100) {
-    ledcWriteTone(BUZ_CH, f);
-    delay(20);
-  }
-  ledcWrite(BUZ_CH, 0);
-  delay(500);
-
-  // --- 3. Short melody ---
-  int melody[] = {262, 294, 330, 349, 392, 440, 494, 523};
-  for (int i = 0; i < 8; i++) {
-    ledcWriteTone(BUZ_CH, melody[i]);
-    delay(250);
-  }
-  //LED1
-  for (int d=0; d<=255; d=d+10) { 
-ledcWrite(LED1_CH, d); delay(10);
-ledcWrite(LED2_CH, d); delay(10);
-  //LED2
- }
-  for (int d=255; d>=0; d=d-20) { 
-ledcWrite(LED1_CH, d); delay(10);
-ledcWrite(LED2_CH, d); delay(10);
-
- }
-  ledcWrite(BUZ_CH, 0); // stop buzzer
+  sched.run();
 }
\ No newline at end of file
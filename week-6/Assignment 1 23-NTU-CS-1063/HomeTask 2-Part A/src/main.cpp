@@ -7,6 +7,10 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <EventQueue.h>
+#include <LedFx.h>
+#include <FixedString.h>
+#include <HeapCount.h>
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
@@ -18,28 +22,49 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
 #define LED3 19
 #define MODE_BTN 25
 #define RESET_BTN 26
-#define PWM_LED3 0                      //channel 0
 #define DEBOUNCE_US 50000                // 50ms
 
 hw_timer_t *debounceTimerM = nullptr;
 hw_timer_t *debounceTimerR = nullptr;
 volatile bool debounceM_Active = false;
 volatile bool debounceR_Active = false;
-volatile bool m_Event = false;
-volatile bool r_Event = false;
+
+enum { SRC_MODE = 0, SRC_RESET = 1 };            //event source = queue lane (one per ISR)
+enum { EV_PRESS = 0 };
+MpscQueue<Event, 8, 2> btnEvents;                //every confirmed press, with its time in us
 
 int mode = 0;
-unsigned long lastAltStep = 0;          //previous alternate
-int altState = 0;                       //current alternate
+
+LedFx leds;                             //all 3 LEDs, faded/blinked by the LEDC hardware
+static constexpr Keyframe OFF_FRAMES[] = {{0, 0, {0, 0, 0}}};
+static constexpr Keyframe ON_FRAMES[] = {{0, 0, {255, 255, 255}}};
+static constexpr Keyframe ALT_FRAMES[] = {          //LED1 and LED2 swap every 200ms, LED3 off
+  {0, 200, {0, 255, 0}},
+  {0, 200, {255, 0, 0}},
+};
+static constexpr Keyframe FADE_FRAMES[] = {         //LED3 up and down in ~0.5s each (was 256 x 2ms)
+  {512, 0, {0, 0, 255}},
+  {512, 0, {0, 0, 0}},
+};
+static constexpr Effect modeFx[] = {                //effect for each mode
+  makeEffect(OFF_FRAMES, false),
+  makeEffect(ALT_FRAMES, true),
+  makeEffect(ON_FRAMES, false),
+  makeEffect(FADE_FRAMES, true),
+};
+static constexpr const char *const MODE_LABELS[] = {  //shown on the OLED, same order
+  "ALL OFF", "ALTERNATE", "ALL ON", "PWM FADE",
+};
+static_assert(labelCount(MODE_LABELS) == sizeof(modeFx) / sizeof(modeFx[0]), "one label per mode");
 
 void IRAM_ATTR onM_Debounce()                       // when Mode btn(btn 1) is pressed  
 {                                                   // for longer than debounce time
-  if (digitalRead(MODE_BTN) == LOW) m_Event = true;
+  if (digitalRead(MODE_BTN) == LOW) btnEvents.push(SRC_MODE, Event{EV_PRESS, SRC_MODE, 0, (uint32_t)micros()});
   debounceM_Active = false;
 }
 void IRAM_ATTR onR_Debounce()                       // when Reset btn(btn 2) is pressed 
 {                                                   // for longer than debounce time
-  if (digitalRead(RESET_BTN) == LOW) r_Event = true;
+  if (digitalRead(RESET_BTN) == LOW) btnEvents.push(SRC_RESET, Event{EV_PRESS, SRC_RESET, 0, (uint32_t)micros()});
   debounceR_Active = false;
 }
 void IRAM_ATTR modeISR()                            //Interrupt called when btn1 is pressed
@@ -63,43 +88,15 @@ void IRAM_ATTR resetISR()
     }
 }
 
-void setAllOff() 
-{                                    //All leds become OFF
-    digitalWrite(LED1, LOW);
-    digitalWrite(LED2, LOW);
-    ledcWrite(PWM_LED3, 0);             //PWM is attached to led3 that is why this syntax used
-}
-void setAllOn() 
-{
-    digitalWrite(LED1, HIGH);
-    digitalWrite(LED2, HIGH);           //All led ON
-    ledcWrite(PWM_LED3, 255);
-}
-void alternateStep() 
-{
-    digitalWrite(LED1, altState ? HIGH : LOW);
-    digitalWrite(LED2, altState ? LOW : HIGH);      //ALternate the LED1 and LED2
-    ledcWrite(PWM_LED3, 0);
-altState = !altState;
-}
-String currentLabel() 
-{
-    switch (mode) 
-    {
-        case 0: return "ALL OFF";
-        case 1: return "ALTERNATE";             //Cases to retun msg to show msg on OLED
-        case 2: return "ALL ON";
-        case 3: return "PWM FADE";
-        default: return "UNKNOWN";
-    }
-}
 void drawOLED() 
 {
+    FixedString<24> msg("State:\n");               //built on the stack, no String
+    msg += label(MODE_LABELS, mode);
     display.clearDisplay();
     display.setTextSize(2);
     display.setTextColor(SSD1306_WHITE);            //Displays msg on OLED
     display.setCursor(0, 0);
-    display.print("State:\n" + currentLabel());
+    display.print(msg.c_str());
     display.display();
 }
 
@@ -109,14 +106,13 @@ void setup()
     Serial.begin(115200);
     display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR);
 
-    pinMode(LED1, OUTPUT);
-    pinMode(LED2, OUTPUT);
-    pinMode(LED3, OUTPUT);
     pinMode(MODE_BTN, INPUT_PULLUP);                //modes of pins
     pinMode(RESET_BTN, INPUT_PULLUP);
 
-    ledcSetup(PWM_LED3, 5000, 8);                   //attaching channel, frequency and resolution
-    ledcAttachPin(LED3, PWM_LED3);                  //attaching led3 pin and pwm channel
+    leds.add(LED1);                                 //LED index 0, 1, 2 in the keyframes
+    leds.add(LED2);
+    leds.add(LED3);
+    leds.begin();
 
     debounceTimerM = timerBegin(0, 80, true);       //timer start for debouncing for each btn
     debounceTimerR = timerBegin(1, 80, true);
@@ -126,56 +122,25 @@ void setup()
     attachInterrupt(digitalPinToInterrupt(MODE_BTN), modeISR, FALLING);   //when Interrupt occurs and where
     attachInterrupt(digitalPinToInterrupt(RESET_BTN), resetISR, FALLING);
 
-    setAllOff();        //ALL LEDs are OFF state
+    leds.play(modeFx[mode]);    //ALL LEDs are OFF state
     drawOLED();         //draws on oled OFF state
+    HEAP_MARK();        //-DHEAPCOUNT=1: count allocations from here on
 }
 
 void loop() 
 {
-    unsigned long now = millis();
-
-    if (m_Event) 
+    Event ev;
+    while (btnEvents.pop(ev))               //handle every press, oldest first
     {
-        m_Event = false;
-        mode = (mode + 1) % 4;              //change of Modes when btn1 pressed
+        if (ev.source == SRC_MODE)
+            mode = (mode + 1) % 4;          //change of Modes when btn1 pressed
+        else if (ev.source == SRC_RESET)
+            mode = 0;                       //GO to OFF mode when btn2 pressed
+        leds.play(modeFx[mode]);            //the effect runs on its own until the next press
         drawOLED();
-    }
-
-    if (r_Event) 
-    {
-        r_Event = false;                    //GO to OFF mode when btn2 pressed
-        mode = 0;
-        setAllOff();
-        drawOLED();
-    }
-
-    switch (mode) 
-    {
-        case 0: setAllOff(); break;
-        case 1:
-            if (now - lastAltStep >= 200)       //time in ms for alternating.(alternates after 200ms)
-            {
-                alternateStep();
-                lastAltStep = now;
-            }
-            break;
-        case 2: setAllOn(); break;              //calls func for all on 
-        case 3:
-            digitalWrite(LED1, LOW);
-            digitalWrite(LED2, LOW);
-            for (int v = 0; v <= 255; ++v)          //PWM for LED3,oter leds are off
-            {
-                if (m_Event || r_Event) break;
-                ledcWrite(PWM_LED3, v);
-                delay(2);
-            }
-            for (int v = 255; v >= 0; --v) 
-            {
-                if (m_Event || r_Event) break;
-                ledcWrite(PWM_LED3, v);
-                delay(2);
-             }
-    break;
+#if HEAPCOUNT
+        HEAP_REPORT(Serial);                //should stay at 0 however often the mode changes
+#endif
     }
 
     delay(5);
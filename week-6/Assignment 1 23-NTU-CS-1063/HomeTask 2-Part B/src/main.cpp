@@ -7,25 +7,42 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <ButtonScan.h>
+#include <MelodySeq.h>
+#include <FastPin.h>
+#include <FixedString.h>
 
-#define LED_1 17
-#define LED_2 18
-#define LED_3 19
+#ifndef INPUTREC
+#define INPUTREC 0      // 1: record button edges, 't' over serial prints them as a sim script
+#endif
+
+#if INPUTREC
+#include <InputTrace.h>
+InputRecorder inputRec;
+#endif
+
+typedef PinGroup<17, 18, 19> Leds;   // LED_1..LED_3, switched together by one register store
 #define BTN 27
 #define BZR 14
 #define LONG_PRESS 1500 // in ms
+#define MELODY_BPM 86   // one note per beat, ~700 ms like before
 
 #define SCREEN_WIDTH 128
 #define SCREEN_LENGTH 64
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_LENGTH, &Wire, -1);
 
-int melody[] = {
-  440, 440, 440, 349, 523, 440, 349, 523, 440,            //STAR WARS intro melody 
-  659, 659, 659, 698, 523, 415, 349, 523, 440,
-  880, 440, 440, 880, 830, 784, 740, 698, 740
+// STAR WARS intro melody, one beat (4 sixteenths) per note. constexpr keeps
+// the table and its LEDC dividers in flash.
+static constexpr Note melody[] = {
+  {NOTE_A4, 4}, {NOTE_A4, 4}, {NOTE_A4, 4}, {NOTE_F4, 4}, {NOTE_C5, 4}, {NOTE_A4, 4}, {NOTE_F4, 4}, {NOTE_C5, 4}, {NOTE_A4, 4},
+  {NOTE_E5, 4}, {NOTE_E5, 4}, {NOTE_E5, 4}, {NOTE_F5, 4}, {NOTE_C5, 4}, {NOTE_GS4, 4}, {NOTE_F4, 4}, {NOTE_C5, 4}, {NOTE_A4, 4},
+  {NOTE_A5, 4}, {NOTE_A4, 4}, {NOTE_A4, 4}, {NOTE_A5, 4}, {NOTE_GS5, 4}, {NOTE_G5, 4}, {NOTE_FS5, 4}, {NOTE_F5, 4}, {NOTE_FS5, 4}
 };
 
-bool Playing = false;         // is melody Playing?
+static_assert(pinsDisjoint<Leds, Pin<BZR>>(), "LED and buzzer pins overlap");
+
+MelodySeq player(BZR);          // plays in the background (esp_timer + LEDC)
+ButtonScan buttons(0, 10);      // debounce + short/long press on a 10 ms timer
 
 void updateDisplay(const char *msg) {   // Method for Writing on Screen 
 display.clearDisplay();
@@ -36,69 +53,75 @@ display.print(msg);                     //msg is either "Ready","Melody","LED"
 display.display();
 }
 
-void play() {                 //Play the Melody
-  static int i = 0;           //Only runs when this function runs the first time
-  ledcWriteTone(0, melody[i]);
-  delay(700);                   //delay of 700ms between each tone
-  i = (i + 1) % (sizeof(melody) / sizeof(melody[0]));       //Size of array containing all the melody tones 
+void stop() {               //Stops the melody (buzzer is silent when this returns)
+  player.stop();
 }
 
-void stop() {               //Stops the melody 
-  ledcWriteTone(0, 0);
-  Playing = false;
+#if FASTPIN_BENCH
+// Cycles per update of all three LEDs: three digitalWrite()s vs one store
+void benchLeds() {
+  const uint16_t N = 1000;
+  uint32_t t0 = ESP.getCycleCount();
+  for (uint16_t i = 0; i < N; i++) {
+    digitalWrite(17, i & 1);
+    digitalWrite(18, i & 1);
+    digitalWrite(19, i & 1);
+  }
+  uint32_t t1 = ESP.getCycleCount();
+  for (uint16_t i = 0; i < N; i++) Leds::write(i & 1);
+  uint32_t t2 = ESP.getCycleCount();
+  printfTo(Serial, "LED update: digitalWrite x3 %lu cycles, Leds::write %lu cycles\n", (unsigned long)((t1 - t0) / N),
+                   (unsigned long)((t2 - t1) / N));
+  Leds::clear();
 }
+#endif
 
 void setup() {
-  pinMode(LED_1, OUTPUT);
-  pinMode(LED_2, OUTPUT);
-  pinMode(LED_3, OUTPUT);
-  pinMode(BTN, INPUT_PULLUP);
+  Leds::begin();                  // outputs, all off
+
+  player.begin();
+  player.setTempo(MELODY_BPM);
+  buttons.add(BTN);
+  buttons.setLongPressMs(LONG_PRESS);
+  buttons.begin();
 
-  ledcAttachPin(BZR, 0);
   Wire.begin(21, 22);
   display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
   updateDisplay("Ready");
 
-  digitalWrite(LED_1, LOW);
-  digitalWrite(LED_2, LOW);
-  digitalWrite(LED_3, LOW);
+#if FASTPIN_BENCH || INPUTREC
+  Serial.begin(115200);
+#endif
+#if FASTPIN_BENCH
+  benchLeds();
+#endif
+#if INPUTREC
+  inputRec.add(BTN);
+  inputRec.begin();
+#endif
 }
 
 void loop() {
-  if (digitalRead(BTN) == LOW) {                  //This part checks for time wether <1.5s or not
-  unsigned long startTime = millis();
-  while (digitalRead(BTN) == LOW)
-  delay(10);
-  unsigned long pressTime = millis() - startTime;
-
-  if (pressTime >= LONG_PRESS) {              //Time of press >= 1.5s
-    Playing = true;
-    updateDisplay("\nMelody");
-    while (Playing) {
-      play();                                        
-      if (digitalRead(BTN) == LOW) {                    // Check for short press to stop 
-        unsigned long shortStart = millis();
-        while (digitalRead(BTN) == LOW) delay(10);            //Hold of Button is <1.5s or not
-        unsigned long shortPressTime = millis() - shortStart;
-        if (shortPressTime < LONG_PRESS) {
-          stop();
-          updateDisplay("Melody\nStopped");
-          break;
-        }
+#if INPUTREC
+  if (Serial.available() && Serial.read() == 't') inputRec.dump(Serial);
+#endif
+  ButtonEvent ev;
+  while (buttons.next(ev)) {
+    if (ev.type == BTN_LONG) {                    //Held >= 1.5s
+      if (!player.playing()) {
+        player.play(melody);                      //Loops until a short press
+        updateDisplay("\nMelody");
+      }
+    } else if (ev.type == BTN_SHORT) {            //Released before 1.5s
+      if (player.playing()) {   // Short press toggles LEDs or stops melody if playing
+        stop();
+        updateDisplay("Melody\nStopped");
+      } else {
+        static bool ledState = false;             //only runs 1st time this part of code runs
+        ledState = !ledState;
+        Leds::write(ledState);                    //all three in the same instant
+        updateDisplay("\nLED");
       }
-    }
-  } else {
-    if (Playing) {            // Short press toggles LEDs or stops melody if playing
-      stop();
-      updateDisplay("Melody\nStopped");
-    } else {
-      static bool ledState = false;             //only runs 1st time this part of code runs
-      ledState = !ledState;
-      digitalWrite(LED_1, ledState);
-      digitalWrite(LED_2, ledState);
-      digitalWrite(LED_3, ledState);
-      updateDisplay("\nLED");
     }
   }
-  }
-}
\ No newline at end of file
+}
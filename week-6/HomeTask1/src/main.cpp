@@ -2,7 +2,17 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
-#include <DHT.h>
+#include <OledDiff.h>
+#include <DhtRmt.h>
+#include <SampleStore.h>
+#include <AdcStream.h>
+#include <Telemetry.h>
+#include <Seqlock.h>
+#include <CoreLoad.h>
+#include <ProfHistogram.h>
+#include <FlashLog.h>
+#include <FixedString.h>
+#include <SensorFilter.h>
 
 #define LDR_PIN 34
 #define SDA_PIN 21
@@ -12,51 +22,250 @@
 #define DHTPIN 14
 #define DHTTYPE DHT11
 
+// --- Task layout ---
+// core 0  acq   prio 3  every 20 ms: drain the ADC DMA and step the DHT engine;
+//                       every 500 ms publish a Sample and wake ui
+// core 1  ui    prio 2  sleeps until woken, draws the Sample, flushes the OLED
+// core 1  loop  prio 1  (Arduino loop task) history, telemetry, serial
+//                       commands, stats
+// acq has core 0 to itself apart from the esp_timer task (prio 22), which
+// only ends the DHT start pulse. ui outranks loop so a redraw is never held
+// up by serial output. Only ui touches the I2C bus once it has started.
+const uint32_t ACQ_PERIOD_MS = 20;    // the DMA ring holds 64 ms of samples
+const uint32_t DRAW_PERIOD_MS = 500;
+
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+OledDiff oled(display);   // sends only the changed part of the frame
+
+AdcStream ldr(LDR_PIN);              // 16 kHz DMA sampling, 64x averaged
+DhtRmt dht(DHTPIN, DHTTYPE, 2000);   // cached reading, refreshed every 2 s
+
+// Display filters, run by acq in Q16.16 fixed point (lib/SensorFilter). The
+// LDR is filtered on every acq pass that has a new ADC output (50 Hz): a
+// median of 5 drops single spikes, the EMA (time constant ~0.2 s) the
+// noise. DHT11 readings are whole degrees / percent 2 s apart; the Kalman
+// filter (variances in 0.1-unit^2: R ~ the 1-unit quantisation, Q a slow
+// drift) smooths the steps between them.
+typedef FilterChain<Median<5>, Ema<q15(0.1)>> LdrFilter;
+typedef FilterChain<Kalman<q16(0.5), q16(8.0)>> DhtFilter;
+LdrFilter ldrFilter, mvFilter;
+DhtFilter tempFilter, humFilter;
+
+// What acq hands to ui and loop: the newest values, never a backlog. The
+// raw values go to history, flash and telemetry, the filtered ones to the OLED.
+struct Sample {
+  uint32_t sampleUs;       // micros() when acq took the values
+  uint32_t timeMs;         // millis() of the same moment
+  uint16_t ldrRaw;
+  uint16_t ldrMv;
+  int16_t tempTenths;
+  uint16_t humTenths;
+  // Filtered, for the display: counts, mV, 0.01 degC, 0.01 %RH
+  uint16_t ldrShown;
+  uint16_t mvShown;
+  int16_t tempShown;
+  uint16_t humShown;
+  uint32_t dhtFailures;
+};
+Seqlock<Sample> latest;
+
+TaskHandle_t uiTask = nullptr;
+TaskLoad acqLoad("acq");
+TaskLoad uiLoad("ui");
+TaskLoad loopLoad("loop");
+ProfHistogram pixelLatency;   // us from acquisition to the end of the flush (written by ui)
+
+uint32_t lastVersion = 0;
+uint32_t lastFailures = 0;
+
+// History: 2 min of raw samples + 1 min / 15 min / 1 h min-max-mean rollups
+enum { CH_LDR, CH_TEMP, CH_HUM, CH_COUNT };   // ADC counts, 0.1 C, 0.1 %
+SampleStore<CH_COUNT, 240> history;
+static_assert(sizeof(history) < 24 * 1024, "sample history should stay under 24 KB");
+unsigned long lastSummary = 0;
+
+// Every sample also goes to the "samplelog" flash partition (partitions.csv),
+// so the history survives a reset. Written from loop(); compressed, a page
+// holds ~280 samples of a slowly changing room (~2.5 min), so a 4 KB sector
+// is erased about every 35 min (every 3 min uncompressed).
+PartitionFlash flash("samplelog");
+FlashLog flashLog(flash, CH_COUNT);
+
+// Readings go out as binary frames (decode with tools/telemetry_decode);
+// the 1-minute summaries stay text and show up on the decoder's stderr
+enum { TM_LDR, TM_MV, TM_TEMP, TM_HUM };   // ADC counts, mV, 0.1 C, 0.1 %
+Telemetry telemetry(Serial, 2000);         // one frame per 4 draws
+
+void acqTaskFn(void *) {
+  // Installed from here so the I2S and RMT interrupts land on core 0 too
+  if (!ldr.begin()) Serial.println("LDR ADC stream failed to start!");
+  dht.begin();
+
+  TickType_t wake = xTaskGetTickCount();
+  uint32_t lastPublish = millis();
+  uint32_t lastAdcOutput = 0;
+  uint32_t lastDhtSeq = 0;
+  for (;;) {
+    {
+      LoadScope busy(acqLoad);
+      ldr.poll();
+      dht.poll();
+
+      if (ldr.outputs() != lastAdcOutput) {
+        lastAdcOutput = ldr.outputs();
+        ldrFilter.push(ldr.raw());
+        mvFilter.push(ldr.millivolts());
+      }
+      const DhtReading &reading = dht.latest();
+      if (reading.valid && reading.seq != lastDhtSeq) {
+        lastDhtSeq = reading.seq;
+        tempFilter.push(reading.tempTenths);
+        humFilter.push(reading.humTenths);
+      }
+
+      uint32_t now = millis();
+      if (now - lastPublish >= DRAW_PERIOD_MS && reading.valid) {
+        lastPublish = now;
+        Sample s = {(uint32_t)micros(), now, ldr.raw(), ldr.millivolts(),
+                    reading.tempTenths, reading.humTenths,
+                    (uint16_t)fromQ16(ldrFilter.value()), (uint16_t)fromQ16(mvFilter.value()),
+                    (int16_t)fromQ16(tempFilter.value(), 1), (uint16_t)fromQ16(humFilter.value(), 1),
+                    dht.failures()};
+        latest.publish(s);
+        xTaskNotifyGive(uiTask);
+      }
+    }
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(ACQ_PERIOD_MS));
+  }
+}
+
+void uiTaskFn(void *) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    LoadScope busy(uiLoad);
+    Sample s{};
+    if (!latest.read(s)) continue;
+
+    display.clearDisplay();
+    display.setTextSize(1);
+    display.setCursor(0,0);
+    // Filtered values, formatted from integers: no floats on this path
+    FixedString<24> line("LDR ADC: ");
+    line.appendFixed(s.ldrShown);
+    display.println(line.c_str());
+    line.clear();
+    line.append("Voltage: ").appendFixed((s.mvShown + 5) / 10, 2).append(" V");
+    display.println(line.c_str());
+    line.clear();
+    line.append("Temp: ").appendFixed(s.tempShown, 2).append(" C");
+    display.println(line.c_str());
+    line.clear();
+    line.append("Humidity: ").appendFixed(s.humShown, 2).append(" %");
+    display.println(line.c_str());
+    oled.flush();
+    pixelLatency.add(micros() - s.sampleUs);
+  }
+}
+
+void printSummary() {
+  static const char *names[CH_COUNT] = {"LDR", "Temp", "Hum"};
+  for (uint8_t c = 0; c < CH_COUNT; c++) {
+    Rollup r = history.last(TIER_1MIN, c, 15 * 60000UL);   // last 15 min
+    printfTo(Serial, "%s 15min: min %d mean %d max %d (%lu samples)\n",
+                     names[c], r.min, r.mean(), r.max, (unsigned long)r.count);
+  }
+}
+
+// Last 24 h of log time from flash, across resets
+void printFlashSummary() {
+  static const char *names[CH_COUNT] = {"LDR", "Temp", "Hum"};
+  if (flashLog.empty()) return;
+  uint64_t to = flashLog.newest();
+  uint64_t from = to > 86400000ULL ? to - 86400000ULL : 0;
+  for (uint8_t c = 0; c < CH_COUNT; c++) {
+    Rollup r = flashLog.summary(from, to, c);
+    printfTo(Serial, "%s 24h (flash): min %d mean %d max %d (%lu samples)\n",
+                     names[c], r.min, r.mean(), r.max, (unsigned long)r.count);
+  }
+  printfTo(Serial, "flash log: %lu samples in %u/%u segments, %lu min, max wear %lu\n",
+                   (unsigned long)flashLog.records(), flashLog.segments(), flashLog.capacity(),
+                   (unsigned long)((flashLog.newest() - flashLog.oldest()) / 60000), (unsigned long)flashLog.maxWear());
+}
 
-DHT dht(DHTPIN, DHTTYPE);
+// ui may add a sample while this runs; the figures are still within one draw
+void printStats() {
+  printfTo(Serial, "sample->pixel us: p50 %lu p99 %lu max %lu (%lu draws)\n",
+                   (unsigned long)pixelLatency.percentile(500), (unsigned long)pixelLatency.percentile(990),
+                   (unsigned long)pixelLatency.max(), (unsigned long)pixelLatency.count());
+  CoreLoad::report(Serial);
+}
 
 void setup() {
   Serial.begin(115200);
   Wire.begin(SDA_PIN, SCL_PIN);
   display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  oled.begin();
 
   display.clearDisplay();
   display.setTextColor(SSD1306_WHITE);
   display.setTextSize(1);
   display.setCursor(0, 0);
   display.println("Initializing...");
-  display.display();
+  oled.flush();
 
-  // Initialize DHT sensor
-  dht.begin();
+  telemetry.channel(TM_LDR, "ldr_adc", 0);
+  telemetry.channel(TM_MV, "ldr_mv", 0);
+  telemetry.channel(TM_TEMP, "temp_c", 1);
+  telemetry.channel(TM_HUM, "hum_pct", 1);
+  telemetry.begin();
+
+  if (flash.begin() && flashLog.begin(millis64())) printFlashSummary();
+  else Serial.println("No samplelog partition, samples are not kept");
+
+  xTaskCreatePinnedToCore(uiTaskFn, "ui", 4096, nullptr, 2, &uiTask, 1);
+  xTaskCreatePinnedToCore(acqTaskFn, "acq", 4096, nullptr, 3, nullptr, 0);
   delay(1000);
 }
 
 void loop() {
-  int adcValue = analogRead(LDR_PIN);
-  float voltage = (adcValue / 4095.0) * 3.3;
-  float temperature = dht.readTemperature();
-  float humidity = dht.readHumidity();
-
-  // Check if read failed
-  if (isnan(temperature) || isnan(humidity)) {
-    Serial.println("Error reading DHT22 sensor!");
-    return;
-  }
+  {
+    LoadScope busy(loopLoad);
+    telemetry.poll();
 
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setCursor(0,0);
-  display.print("LDR ADC: "); display.println(adcValue);
-  display.print("Voltage: "); display.print(voltage, 2); display.println(" V");
-  display.print("Temp: ");
-  display.print(temperature);
-  display.println(" C");
-  display.print("Humidity: ");
-  display.print(humidity);
-  display.println(" %");
-  display.display();
-
-  delay(500);
-}
\ No newline at end of file
+    // 's' prints latency and per-core load now, 'r' restarts the latency
+    // histogram, 'l' summarises the flash log, 'f' writes its RAM page out
+    // (before a planned power-off)
+    while (Serial.available()) {
+      char c = Serial.read();
+      if (c == 's') printStats();
+      else if (c == 'r') pixelLatency.reset();
+      else if (c == 'l') printFlashSummary();
+      else if (c == 'f') flashLog.flush();
+    }
+
+    Sample s{};
+    if (latest.version() != lastVersion) {
+      lastVersion = latest.read(s);
+
+      // Check if read failed
+      if (s.dhtFailures != lastFailures) {
+        lastFailures = s.dhtFailures;
+        Serial.println("Error reading DHT22 sensor!");
+      }
+
+      const int16_t sample[CH_COUNT] = {(int16_t)s.ldrRaw, s.tempTenths, (int16_t)s.humTenths};
+      history.add(millis64(), sample);
+      flashLog.append(flashLog.logTime(millis64()), sample);
+      telemetry.add(TM_LDR, s.ldrRaw, s.timeMs);
+      telemetry.add(TM_MV, s.ldrMv, s.timeMs);
+      telemetry.add(TM_TEMP, s.tempTenths, s.timeMs);
+      telemetry.add(TM_HUM, s.humTenths, s.timeMs);
+      if (s.timeMs - lastSummary >= 60000UL) {
+        lastSummary = s.timeMs;
+        printSummary();
+        printStats();
+      }
+    }
+  }
+  delay(10);   // input and bookkeeping only; lets core 1 idle between checks
+}
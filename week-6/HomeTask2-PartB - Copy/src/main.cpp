@@ -5,12 +5,41 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <OledDiff.h>
+#include <OledService.h>
+#include <ButtonScan.h>
+#include <CoopSched.h>
+#include <LedFx.h>
+#include <LoopProfiler.h>
+#include <FixedString.h>
+#include <HeapCount.h>
+#include <StateChart.h>
+
+// 1: record the button edges; 't' over serial prints them as a sim script
+#ifndef INPUTREC
+#define INPUTREC 0
+#endif
+
+#if INPUTREC
+#include <InputTrace.h>
+InputRecorder inputRec;
+#endif
 
 // ---------------- OLED ----------------
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define OLED_ADDR 0x3C
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+OledDiff oled(display);
+OledService oledService(display, oled); // flushes frames from its own task (core 0)
+
+// 1: don't start the flush task; submit() then flushes inline from the
+// buttons task (the old synchronous path, kept to measure against).
+// Native build, rapid.txt trace, LOOPPROF: the buttons task's run max is
+// 13.4 ms with OLED_SYNC 1 and 1 us with the flush task.
+#ifndef OLED_SYNC
+#define OLED_SYNC 0
+#endif
 
 // ---------------- Pins ----------------
 #define LED1 17
@@ -22,97 +51,197 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
 #define BUZZER_PIN 14
 
 // ---------------- PWM channels ----------------
-const uint8_t PWM1 = 0;
-const uint8_t PWM2 = 1;
-const uint8_t PWM3 = 2;
+// The LEDs are on LedFx (low-speed LEDC group, Arduino channels 8-10)
 const uint8_t PWM_BUZ = 3; // buzzer channel for ledcWriteTone
 
 // ---------------- Constants ----------------
-const uint32_t DEBOUNCE_US  = 50000; // 50 ms
+const uint8_t SCAN_MS = 10;          // button scan period (4 equal samples = debounced)
 const uint32_t LONGPRESS_MS = 1500;  // 1.5 s
-const uint32_t LED_TOGGLE_MS = 500;  // LED toggle interval when BTN3 short pressed
+const uint16_t LED_TOGGLE_MS = 500;  // LED toggle interval when BTN3 short pressed
 const uint32_t MELODY_NOTE_MS = 300; // per-note time
 
-// ---------------- Debounce timers ----------------
-hw_timer_t *debounceTimer1 = nullptr;
-hw_timer_t *debounceTimer2 = nullptr;
-hw_timer_t *debounceTimer3 = nullptr;
-
-// ---------------- Volatile flags (ISR-safe) ----------------
-volatile bool debounceActive1 = false;
-volatile bool debounceActive2 = false;
-volatile bool debounceActive3 = false;
-
-volatile bool modeButtonEvent = false;
-volatile bool resetButtonEvent = false;
-volatile bool btn3DebouncedEvent = false; // set when BTN3 confirmed pressed (after debounce)
-
-// ---------------- Application state ----------------
-int mode = 0; // 0: All Off, 1: Alternate Blink, 2: All On, 3: PWM Fade
-const char *modeNames[] = {"All Off", "Alternate Blink", "All On", "PWM Fade"};
+// ---------------- Buttons ----------------
+// One timer (timer 0) scans all three buttons; timers 1-3 stay free.
+ButtonScan buttons(0, SCAN_MS);
+
+// ---------------- Scheduler ----------------
+// Buttons, melody and the report are tasks; loop() only runs the scheduler,
+// which sleeps until the next deadline. The LEDs need no task (see LedFx).
+const uint32_t INPUT_MS = 5;           // button event handling
+const uint32_t REPORT_MS = 5000;       // print per-task timing this often (LOOPPROF / HEAPCOUNT)
+const uint32_t SERIAL_MS = 50;         // serial command polling
+CoopSched sched(SchedClock::arduino());
+int8_t taskMelody;
+
+// ---------------- Profiling ----------------
+// Cycle-count histograms per section (LOOPPROF=1 in the esp32dev-prof and
+// native environments).
+// Send 'p' over serial for the dump, 'r' to clear it.
+PROF_SECTION(profEvents, "events");    // whole button task: drain + handle
+PROF_SECTION(profMode, "mode");        // one event through both charts
+PROF_SECTION(profMelody, "melody");    // one melody step
+PROF_SECTION(profOled, "oled");        // compose + hand off (or flush) a frame
+PROF_SECTION(profTick, "btn tick");    // time between button task runs
+
+// ---------------- LED effects ----------------
+// Run by the LEDC fade hardware; levels are perceived brightness (gamma
+// corrected to 13-bit duty by LedFx).
+LedFx leds;
+const uint16_t ALT_STEP_MS = 200;      // alternate blink step
+const uint16_t FADE_MS = 960;          // 0 -> full (was 64 steps of 15 ms)
+
+static constexpr Keyframe OFF_FRAMES[] = {{0, 0, {0, 0, 0}}};
+static constexpr Keyframe ON_FRAMES[] = {{0, 0, {255, 255, 255}}};
+static constexpr Keyframe ALT_FRAMES[] = {
+  {0, ALT_STEP_MS, {255, 0, 0}},
+  {0, ALT_STEP_MS, {0, 255, 0}},
+  {0, ALT_STEP_MS, {0, 0, 255}},
+};
+static constexpr Keyframe FADE_FRAMES[] = {
+  {FADE_MS, 0, {255, 255, 255}},
+  {FADE_MS, 0, {0, 0, 0}},
+};
+static constexpr Keyframe TOGGLE_FRAMES[] = {
+  {0, LED_TOGGLE_MS, {0, 0, 0}},
+  {0, LED_TOGGLE_MS, {255, 255, 255}},
+};
+static constexpr Effect FX_OFF = makeEffect(OFF_FRAMES, false);
+static constexpr Effect FX_ON = makeEffect(ON_FRAMES, false);
+static constexpr Effect FX_ALT = makeEffect(ALT_FRAMES, true);
+static constexpr Effect FX_FADE = makeEffect(FADE_FRAMES, true);
+static constexpr Effect FX_TOGGLE = makeEffect(TOGGLE_FRAMES, true);
+const Effect *const modeEffects[] = {&FX_OFF, &FX_ALT, &FX_ON, &FX_FADE};
+const Effect *ledEffect = nullptr;     // what leds is playing
+
+// ---------------- Controller ----------------
+// Two state charts (lib/StateChart) fed the same button events: the melody
+// chart (idle / playing) and the LED chart (mode k, showing its effect or
+// toggling). A press is one table lookup per chart; the charts are checked
+// at compile time for unreachable states and unhandled events.
+enum ChartEvent : uint8_t { EV_MODE, EV_RESET, EV_LONG, EV_SHORT, EV_COUNT };
+
+static constexpr const char *const MODE_LABELS[] = {"All Off", "Alternate Blink", "All On", "PWM Fade"};
+static_assert(labelCount(MODE_LABELS) == sizeof(modeEffects) / sizeof(modeEffects[0]), "one label per mode");
 
 // Melody
 int melody[] = {262, 294, 330, 349, 392, 440, 494, 523};
 const size_t melodyLen = sizeof(melody) / sizeof(melody[0]);
-bool melodyPlaying = false;
 size_t melodyIndex = 0;
-unsigned long lastNoteMillis = 0;
-
-// BTN3 press tracking (non-ISR)
-bool waitingForBtn3Release = false;
-unsigned long btn3PressStart = 0;
 
-// LED toggle mode (activated by BTN3 short press)
-bool ledToggleActive = false;
-bool ledsStateOn = false;
-unsigned long lastLedToggleMillis = 0;
+bool melodyOn();
+void showModeOnOLED(const char *msg);
 
-// ---------------- ISR: debounce timers ----------------
-void IRAM_ATTR onDebounceTimer1() {
-  if (digitalRead(MODE_BTN) == LOW) modeButtonEvent = true;
-  debounceActive1 = false;
+// Start fx unless it is already running (restarting would reset its phase)
+void playEffect(const Effect *fx) {
+  if (fx != ledEffect) {
+    leds.play(*fx);
+    ledEffect = fx;
+  }
 }
 
-void IRAM_ATTR onDebounceTimer2() {
-  if (digitalRead(RESET_BTN) == LOW) resetButtonEvent = true;
-  debounceActive2 = false;
-}
+// ---- Melody chart: a long BTN3 press starts it, a short one stops it ----
+enum MelodyState : uint8_t { M_ROOT, M_IDLE, M_PLAYING };
 
-void IRAM_ATTR onDebounceTimer3() {
-  if (digitalRead(BTN3) == LOW) btn3DebouncedEvent = true;
-  debounceActive3 = false;
+void enterPlaying() {
+  melodyIndex = 0;
+  sched.enable(taskMelody, true);
+  showModeOnOLED("Melody started");
+  Serial.println("Melody started (long press)");
 }
-
-// ---------------- ISR: button falling-edge handlers (start debounce) ----------------
-void IRAM_ATTR onModeButtonISR() {
-  if (!debounceActive1) {
-    debounceActive1 = true;
-    timerWrite(debounceTimer1, 0);
-    timerAlarmWrite(debounceTimer1, DEBOUNCE_US, false);
-    timerAlarmEnable(debounceTimer1);
-  }
+void leavePlaying() {
+  sched.enable(taskMelody, false);
+  ledcWriteTone(PWM_BUZ, 0); // ensure buzzer is off
 }
-
-void IRAM_ATTR onResetButtonISR() {
-  if (!debounceActive2) {
-    debounceActive2 = true;
-    timerWrite(debounceTimer2, 0);
-    timerAlarmWrite(debounceTimer2, DEBOUNCE_US, false);
-    timerAlarmEnable(debounceTimer2);
-  }
+void melodyAgain() { Serial.println("Melody already playing"); }
+void melodyStopped() { Serial.println("Melody stopped by short press"); }
+
+static constexpr SmState MELODY_STATES[] = {
+  {SM_NONE, M_IDLE, nullptr, nullptr},           // M_ROOT
+  {M_ROOT, SM_NONE, nullptr, nullptr},           // M_IDLE
+  {M_ROOT, SM_NONE, enterPlaying, leavePlaying}, // M_PLAYING: melody task runs
+};
+static constexpr SmTransition MELODY_TRANSITIONS[] = {
+  {M_IDLE, EV_LONG, M_PLAYING, nullptr},
+  {M_PLAYING, EV_LONG, SM_INTERNAL, melodyAgain},  // keeps playing
+  {M_PLAYING, EV_SHORT, M_IDLE, melodyStopped},
+  {M_ROOT, EV_SHORT, SM_IGNORE, nullptr},          // idle: only the LEDs react
+  {M_ROOT, EV_MODE, SM_IGNORE, nullptr},           // mode / reset leave the melody alone
+  {M_ROOT, EV_RESET, SM_IGNORE, nullptr},
+};
+static constexpr StateChart MELODY_CHART = makeChart(MELODY_STATES, MELODY_TRANSITIONS, EV_COUNT);
+static_assert(smWellFormed(MELODY_CHART), "melody chart: bad table");
+static_assert(smComplete(MELODY_CHART), "melody chart: a state ignores an event without SM_IGNORE");
+static_assert(smReachable(MELODY_CHART), "melody chart: unreachable state");
+StateMachine<MELODY_CHART> melodyChart;
+
+bool melodyOn() { return melodyChart.in(M_PLAYING); }
+
+// ---- LED chart: mode k shows its effect until a short BTN3 press toggles ----
+enum LedState : uint8_t {
+  L_ROOT,
+  L_MODE0, L_MODE1, L_MODE2, L_MODE3,            // 0: All Off, 1: Alternate Blink, 2: All On, 3: PWM Fade
+  L_SHOW0, L_SHOW1, L_SHOW2, L_SHOW3,            // the mode's effect
+  L_TOGGLE0, L_TOGGLE1, L_TOGGLE2, L_TOGGLE3,    // LED toggle, until MODE or RESET
+};
+
+// While the melody plays the LEDs are left alone
+template <uint8_t M>
+void enterShow() {
+  if (!melodyOn()) playEffect(modeEffects[M]);
 }
+void enterToggle() { playEffect(&FX_TOGGLE); }
 
-void IRAM_ATTR onBtn3ISR() {
-  if (!debounceActive3) {
-    debounceActive3 = true;
-    timerWrite(debounceTimer3, 0);
-    timerAlarmWrite(debounceTimer3, DEBOUNCE_US, false);
-    timerAlarmEnable(debounceTimer3);
-  }
+template <uint8_t M>
+void announceMode() {
+  FixedString<24> msg("Mode: ");
+  msg += label(MODE_LABELS, M);
+  showModeOnOLED(msg.c_str());
+}
+void announceReset() { showModeOnOLED("Reset → Off"); }
+void announceToggle() {
+  showModeOnOLED("LED Toggle Mode");
+  Serial.println("LED Toggle Mode started (short press)");
 }
 
+static constexpr SmState LED_STATES[] = {
+  {SM_NONE, L_MODE0, nullptr, nullptr},          // L_ROOT
+  {L_ROOT, L_SHOW0, nullptr, nullptr},           // L_MODE0..3
+  {L_ROOT, L_SHOW1, nullptr, nullptr},
+  {L_ROOT, L_SHOW2, nullptr, nullptr},
+  {L_ROOT, L_SHOW3, nullptr, nullptr},
+  {L_MODE0, SM_NONE, enterShow<0>, nullptr},     // L_SHOW0..3
+  {L_MODE1, SM_NONE, enterShow<1>, nullptr},
+  {L_MODE2, SM_NONE, enterShow<2>, nullptr},
+  {L_MODE3, SM_NONE, enterShow<3>, nullptr},
+  {L_MODE0, SM_NONE, enterToggle, nullptr},      // L_TOGGLE0..3
+  {L_MODE1, SM_NONE, enterToggle, nullptr},
+  {L_MODE2, SM_NONE, enterToggle, nullptr},
+  {L_MODE3, SM_NONE, enterToggle, nullptr},
+};
+// MODE and RESET leave toggling; a short press while toggling re-enters
+// TOGGLE, which keeps its phase (playEffect() skips the running effect)
+static constexpr SmTransition LED_TRANSITIONS[] = {
+  {L_ROOT, EV_RESET, L_MODE0, announceReset},
+  {L_ROOT, EV_LONG, SM_IGNORE, nullptr},         // the melody chart's
+  {L_MODE0, EV_MODE, L_MODE1, announceMode<1>},
+  {L_MODE1, EV_MODE, L_MODE2, announceMode<2>},
+  {L_MODE2, EV_MODE, L_MODE3, announceMode<3>},
+  {L_MODE3, EV_MODE, L_MODE0, announceMode<0>},
+  {L_MODE0, EV_SHORT, L_TOGGLE0, announceToggle},
+  {L_MODE1, EV_SHORT, L_TOGGLE1, announceToggle},
+  {L_MODE2, EV_SHORT, L_TOGGLE2, announceToggle},
+  {L_MODE3, EV_SHORT, L_TOGGLE3, announceToggle},
+};
+static constexpr StateChart LED_CHART = makeChart(LED_STATES, LED_TRANSITIONS, EV_COUNT);
+static_assert(smWellFormed(LED_CHART), "LED chart: bad table");
+static_assert(smComplete(LED_CHART), "LED chart: a state ignores an event without SM_IGNORE");
+static_assert(smReachable(LED_CHART), "LED chart: unreachable state");
+StateMachine<LED_CHART> ledChart;
+
 // ---------------- Helper: OLED ----------------
-void showModeOnOLED(const String &msg) {
+// Messages are literals or FixedStrings: nothing here touches the heap
+void showModeOnOLED(const char *msg) {
+  PROF_SCOPE(profOled);
   display.clearDisplay();
   display.setTextSize(2);
   display.setTextColor(SSD1306_WHITE);
@@ -120,220 +249,128 @@ void showModeOnOLED(const String &msg) {
   display.print(msg);
   display.setTextSize(1);
   display.setCursor(5, 50);
-  display.print(melodyPlaying ? "Melody: ON" : "Melody: OFF");
-  display.display();
+  display.print(melodyOn() ? "Melody: ON" : "Melody: OFF");
+  oledService.submit();
   Serial.println(msg);
 }
 
-// ---------------- Helper: set all leds ----------------
-void setAllLEDs(uint8_t v) {
-  ledcWrite(PWM1, v);
-  ledcWrite(PWM2, v);
-  ledcWrite(PWM3, v);
+// ---------------- Tasks ----------------
+// Chart event for a button event, EV_COUNT if the controller has none
+uint8_t chartEvent(const ButtonEvent &ev) {
+  if (ev.pin == MODE_BTN && ev.type == BTN_PRESS) return EV_MODE;
+  if (ev.pin == RESET_BTN && ev.type == BTN_PRESS) return EV_RESET;
+  if (ev.pin == BTN3 && ev.type == BTN_LONG) return EV_LONG;   // held LONGPRESS_MS
+  if (ev.pin == BTN3 && ev.type == BTN_SHORT) return EV_SHORT;
+  return EV_COUNT;
+}
+
+// Button events (debounced and classified by the scanner)
+void buttonsTask() {
+  PROF_INTERVAL(profTick);
+  PROF_SCOPE(profEvents);
+  ButtonEvent ev;
+  while (buttons.next(ev)) {
+    uint8_t e = chartEvent(ev);
+    if (e == EV_COUNT) continue;
+    PROF_SCOPE(profMode);
+    // Melody first: a short press stops it before the LEDs start toggling
+    melodyChart.dispatch(e);
+    ledChart.dispatch(e);
+  }
+}
+
+// Melody playback: one note per run
+void melodyTask() {
+  PROF_SCOPE(profMelody);
+  ledcWriteTone(PWM_BUZ, melody[melodyIndex]); // start tone at specified frequency
+  melodyIndex = (melodyIndex + 1) % melodyLen;
 }
 
-// perform one quick alternate cycle (used previously; not used for continuous toggle)
-void performAlternateOnce() {
-  ledcWrite(PWM1, 255);
-  ledcWrite(PWM2, 0);
-  ledcWrite(PWM3, 0);
-  delay(180);
-  ledcWrite(PWM1, 0);
-  ledcWrite(PWM2, 255);
-  ledcWrite(PWM3, 0);
-  delay(180);
-  ledcWrite(PWM1, 0);
-  ledcWrite(PWM2, 0);
-  ledcWrite(PWM3, 255);
-  delay(180);
+// Lateness, worst run time and CPU share per task since the last report.
+// Diagnostics only: scheduled when profiling or heap counting is built in.
+// Compare the buttons task's run max with OLED_SYNC 0 and 1.
+void reportTask() {
+#if LOOPPROF
+  sched.report(Serial);
+  sched.resetStats();
+#endif
+#if HEAPCOUNT
+  HEAP_REPORT(Serial);
+#endif
+}
+
+// Serial commands: 'p' prints the section histograms, 'r' clears them,
+// 't' prints the recorded button edges (-DINPUTREC=1)
+void serialTask() {
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == 'p') PROF_DUMP(Serial);
+    else if (c == 'r') PROF_RESET();
+#if INPUTREC
+    else if (c == 't') inputRec.dump(Serial);
+#endif
+  }
 }
 
 // ---------------- Setup ----------------
 void setup() {
   Serial.begin(115200);
+  PROF_BEGIN();
 
   // OLED init
   if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
     Serial.println("OLED not found!");
     while (true) delay(10);
   }
+  oled.begin();
   display.clearDisplay();
-  display.display();
+  oled.flush();
+#if !OLED_SYNC
+  oledService.begin();
+#endif
 
-  // Pins
-  pinMode(MODE_BTN, INPUT_PULLUP);
-  pinMode(RESET_BTN, INPUT_PULLUP);
-  pinMode(BTN3, INPUT_PULLUP);
+  // Pins (buttons are set up by the scanner)
   pinMode(BUZZER_PIN, OUTPUT);
 
-  // PWM (LEDs) - channels for LEDs
-  ledcSetup(PWM1, 5000, 8);
-  ledcSetup(PWM2, 5000, 8);
-  ledcSetup(PWM3, 5000, 8);
-  ledcAttachPin(LED1, PWM1);
-  ledcAttachPin(LED2, PWM2);
-  ledcAttachPin(LED3, PWM3);
+  // LEDs (13-bit PWM, faded in hardware)
+  leds.add(LED1);
+  leds.add(LED2);
+  leds.add(LED3);
+  leds.begin();
 
   // Buzzer channel for ledcWriteTone
   ledcSetup(PWM_BUZ, 2000, 8); // initial freq ignored by ledcWriteTone
   ledcAttachPin(BUZZER_PIN, PWM_BUZ);
 
-  // Debounce timers (prescaler 80 → 1 µs tick)
-  debounceTimer1 = timerBegin(0, 80, true);
-  debounceTimer2 = timerBegin(1, 80, true);
-  debounceTimer3 = timerBegin(2, 80, true);
-
-  timerAttachInterrupt(debounceTimer1, &onDebounceTimer1, true);
-  timerAttachInterrupt(debounceTimer2, &onDebounceTimer2, true);
-  timerAttachInterrupt(debounceTimer3, &onDebounceTimer3, true);
-
-  timerAlarmDisable(debounceTimer1);
-  timerAlarmDisable(debounceTimer2);
-  timerAlarmDisable(debounceTimer3);
-
-  // Attach falling-edge ISRs to start debounce
-  attachInterrupt(digitalPinToInterrupt(MODE_BTN), onModeButtonISR, FALLING);
-  attachInterrupt(digitalPinToInterrupt(RESET_BTN), onResetButtonISR, FALLING);
-  attachInterrupt(digitalPinToInterrupt(BTN3), onBtn3ISR, FALLING);
-
-  // Initial state
-  setAllLEDs(0);
+  // Button scanner: debounce + short/long press classification
+  buttons.add(MODE_BTN);
+  buttons.add(RESET_BTN);
+  buttons.add(BTN3);
+  buttons.setLongPressMs(LONGPRESS_MS);
+  buttons.begin();
+#if INPUTREC
+  inputRec.add(MODE_BTN);
+  inputRec.add(RESET_BTN);
+  inputRec.add(BTN3);
+  inputRec.begin();
+#endif
+
+  // Tasks (the melody starts disabled)
+  sched.every(INPUT_MS * 1000, buttonsTask, "buttons");
+  taskMelody = sched.every(MELODY_NOTE_MS * 1000, melodyTask, "melody", false);
+#if LOOPPROF || HEAPCOUNT
+  sched.every(REPORT_MS * 1000, reportTask, "report");
+#endif
+  sched.every(SERIAL_MS * 1000, serialTask, "serial");
+
+  // Initial state: melody idle, mode 0
+  melodyChart.begin();
+  ledChart.begin();
   showModeOnOLED("Ready");
+  HEAP_MARK();   // -DHEAPCOUNT=1: the report then shows allocations since here
 }
 
 // ---------------- Main loop ----------------
 void loop() {
-  unsigned long now = millis();
-
-  // --- Handle mode button event (confirmed by debounce timer) ---
-  if (modeButtonEvent) {
-    modeButtonEvent = false;
-    // pressing mode or reset cancels LED-toggle-mode
-    ledToggleActive = false;
-    melodyPlaying = melodyPlaying; // leave melody intact per your spec (only BTN3 short stops melody)
-    mode = (mode + 1) % 4;
-    showModeOnOLED(String("Mode: ") + modeNames[mode]);
-  }
-
-  // --- Handle reset button event ---
-  if (resetButtonEvent) {
-    resetButtonEvent = false;
-    ledToggleActive = false; // stop LED toggle mode
-    mode = 0;
-    showModeOnOLED("Reset → Off");
-  }
-
-  // --- Handle BTN3 debounced event: start tracking press duration (non-blocking) ---
-  if (btn3DebouncedEvent && !waitingForBtn3Release) {
-    // confirmed falling edge after debounce: start measuring until release
-    btn3DebouncedEvent = false;
-    waitingForBtn3Release = true;
-    btn3PressStart = millis();
-    // do not decide yet; wait for release
-  }
-
-  // --- If waiting for BTN3 release, check release and take action ---
-  if (waitingForBtn3Release) {
-    if (digitalRead(BTN3) == HIGH) {
-      // released: determine press length
-      unsigned long pressDuration = millis() - btn3PressStart;
-      waitingForBtn3Release = false;
-
-      if (pressDuration >= LONGPRESS_MS) {
-        // Long press -> start melody loop (plays forever until short press on BTN3)
-        if (!melodyPlaying) {
-          melodyPlaying = true;
-          melodyIndex = 0;
-          lastNoteMillis = 0;
-          showModeOnOLED("Melody started");
-          Serial.println("Melody started (long press)");
-        } else {
-          // if already playing (edge-case), keep playing
-          Serial.println("Melody already playing");
-        }
-      } else {
-        // Short press -> stop melody (if playing) and start LED toggling forever
-        if (melodyPlaying) {
-          melodyPlaying = false;
-          ledcWriteTone(PWM_BUZ, 0); // stop buzzer
-          Serial.println("Melody stopped by short press");
-        }
-        // Start LED toggle mode (continues until MODE or RESET pressed)
-        ledToggleActive = true;
-        ledsStateOn = false; // will toggle soon
-        lastLedToggleMillis = millis();
-        showModeOnOLED("LED Toggle Mode");
-        Serial.println("LED Toggle Mode started (short press)");
-      }
-    }
-    // else still pressed -> wait for release
-  }
-
-  // --- If ledToggleActive then perform toggling (overrides normal mode behavior) ---
-  if (ledToggleActive) {
-    if (now - lastLedToggleMillis >= LED_TOGGLE_MS) {
-      ledsStateOn = !ledsStateOn;
-      setAllLEDs(ledsStateOn ? 255 : 0);
-      lastLedToggleMillis = now;
-    }
-    // while in LED toggle mode we skip the normal "mode" behavior
-  } else if (!melodyPlaying) {
-    // --- Normal mode behavior (only when not playing melody and not in led-toggle) ---
-    static unsigned long lastAltStep = 0;
-    static int altState = 0;
-
-    switch (mode) {
-      case 0: // All Off
-        setAllLEDs(0);
-        break;
-
-      case 1: // Alternate Blink (continuous)
-        if (now - lastAltStep >= 200) {
-          altState = (altState + 1) % 3;
-          ledcWrite(PWM1, (altState == 0) ? 255 : 0);
-          ledcWrite(PWM2, (altState == 1) ? 255 : 0);
-          ledcWrite(PWM3, (altState == 2) ? 255 : 0);
-          lastAltStep = now;
-        }
-        break;
-
-      case 2: // All On
-        setAllLEDs(255);
-        break;
-
-      case 3: // PWM Fade
-        static int brightness = 0;
-        static int dir = 4;
-        // step every 15 ms approximately
-        static unsigned long lastFadeStep = 0;
-        if (now - lastFadeStep >= 15) {
-          brightness += dir;
-          if (brightness <= 0) { brightness = 0; dir = -dir; }
-          if (brightness >= 255) { brightness = 255; dir = -dir; }
-          ledcWrite(PWM1, brightness);
-          ledcWrite(PWM2, brightness);
-          ledcWrite(PWM3, brightness);
-          lastFadeStep = now;
-        }
-        break;
-    }
-  }
-  // if melodyPlaying is true, we skip the normal mode behavior above
-
-  // --- Melody playback when melodyPlaying is true ---
-  if (melodyPlaying) {
-    if (now - lastNoteMillis >= MELODY_NOTE_MS) {
-      // play the next note
-      int freq = melody[melodyIndex];
-      ledcWriteTone(PWM_BUZ, freq); // start tone at specified frequency
-      melodyIndex = (melodyIndex + 1) % melodyLen;
-      lastNoteMillis = now;
-    }
-  } else {
-    // ensure buzzer is off
-    ledcWriteTone(PWM_BUZ, 0);
-  }
-
-  // Small yield
-  delay(5);
+  sched.run();
 }
@@ -2,7 +2,16 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
-#include <DHT.h>
+#include <OledDiff.h>
+#include <OledText.h>
+#include <DhtRmt.h>
+#include <Telemetry.h>
+#include <Seqlock.h>
+#include <CoreLoad.h>
+#include <ProfHistogram.h>
+#include <SampleStore.h>
+#include <FlashLog.h>
+#include <FixedString.h>
 
 // --- Pin configuration ---
 #define DHTPIN 14        // DHT22 data pin
@@ -11,13 +20,130 @@
 #define SDA_PIN 21       // I2C SDA
 #define SCL_PIN 22       // I2C SCL
 
+// --- Task layout ---
+// core 0  acq   prio 3  every 10 ms: step the DHT engine, publish each new
+//                       reading and wake ui
+// core 1  ui    prio 2  sleeps until woken, draws the reading, flushes the OLED
+// core 1  loop  prio 1  (Arduino loop task) serial output, commands, stats
+// ui outranks loop so a redraw is never held up by serial output. Only ui
+// touches the I2C bus once it has started.
+const uint32_t ACQ_PERIOD_MS = 10;
+
 // --- OLED setup ---
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+OledDiff oled(display);   // sends only the changed part of the frame
+OledText text(display);   // page-aligned text without per-pixel drawing
 
 // --- DHT sensor setup ---
-DHT dht(DHTPIN, DHTTYPE);
+DhtRmt dht(DHTPIN, DHTTYPE, 2000);   // one read every 2 s, decoded by the RMT
+
+// --- Shared between the tasks ---
+// Newest reading as published by acq; ui and loop each keep their own copy
+struct Sample {
+  uint32_t sampleUs;       // micros() when acq published it
+  uint32_t timestampMs;    // millis() when the DHT frame was captured
+  int16_t tempTenths;
+  uint16_t humTenths;
+  uint32_t failures;
+  DhtStatus status;        // of the last attempt
+};
+Seqlock<Sample> latest;
+
+TaskHandle_t uiTask = nullptr;
+TaskLoad acqLoad("acq");
+TaskLoad uiLoad("ui");
+TaskLoad loopLoad("loop");
+ProfHistogram pixelLatency;   // us from publish to the end of the flush (written by ui)
+
+uint32_t lastVersion = 0;     // last reading handled by loop()
+uint32_t lastFailures = 0;    // last failure count reported
+uint32_t lastStats = 0;
+
+// --- Serial output ---
+// Binary frames (decode with tools/telemetry_decode) or the old text lines
+const bool BINARY_TELEMETRY = true;
+enum { CH_TEMP, CH_HUM };              // 0.1 C, 0.1 %
+Telemetry telemetry(Serial, 10000);    // one frame per 5 readings
+
+// --- Flash sample log ---
+// Every reading also goes to the "samplelog" partition (partitions.csv), so
+// it survives a reset. Compressed, a page holds ~240 readings (~8 min), a
+// sector ~3600 (~2 h); uncompressed it was 31 and 465 (~15 min).
+PartitionFlash flash("samplelog");
+FlashLog flashLog(flash, 2);           // CH_TEMP, CH_HUM
+
+// --- Acquisition task (core 0) ---
+void acqTaskFn(void *) {
+  dht.begin();   // from here, so the RMT interrupt is on core 0 as well
+
+  TickType_t wake = xTaskGetTickCount();
+  uint32_t seq = 0, failures = 0;
+  for (;;) {
+    {
+      LoadScope busy(acqLoad);
+      dht.poll();
+      const DhtReading &reading = dht.latest();
+      // A failure is published too (with the old values), so loop can report it
+      bool fresh = reading.valid && reading.seq != seq;
+      if (fresh || dht.failures() != failures) {
+        seq = reading.seq;
+        failures = dht.failures();
+        Sample s = {(uint32_t)micros(), reading.timestampMs, reading.tempTenths, reading.humTenths,
+                    failures, dht.lastStatus()};
+        latest.publish(s);
+        if (fresh) xTaskNotifyGive(uiTask);
+      }
+    }
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(ACQ_PERIOD_MS));
+  }
+}
+
+// --- UI task (core 1) ---
+void uiTaskFn(void *) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    LoadScope busy(uiLoad);
+    Sample s{};
+    if (!latest.read(s)) continue;
+
+    // Display on OLED: rows 0, 16 and 32 are pages 0, 2 and 4
+    display.clearDisplay();
+    text.print(0, 0, "Hello IoT");
+    int16_t x = text.print(0, 2, "Temp: ");
+    x = text.print(x, 2, s.tempTenths * 10, 2);   // "23.50", as print(float)
+    text.print(x, 2, " C");
+    x = text.print(0, 4, "Humidity: ");
+    x = text.print(x, 4, s.humTenths * 10, 2);
+    text.print(x, 4, " %");
+    oled.flush();
+    pixelLatency.add(micros() - s.sampleUs);
+  }
+}
+
+// ui may add a sample while this runs; the figures are still within one draw
+void printStats() {
+  printfTo(Serial, "sample->pixel us: p50 %lu p99 %lu max %lu (%lu draws)\n",
+                   (unsigned long)pixelLatency.percentile(500), (unsigned long)pixelLatency.percentile(990),
+                   (unsigned long)pixelLatency.max(), (unsigned long)pixelLatency.count());
+  printfTo(Serial, "OLED: last frame %u bytes, %lu bytes in %lu frames\n", oled.lastFrameBytes(),
+                   (unsigned long)oled.totalBytes(), (unsigned long)oled.frames());
+  CoreLoad::report(Serial);
+}
+
+// Last 24 h of log time from flash, across resets
+void printFlashSummary() {
+  if (flashLog.empty()) return;
+  uint64_t to = flashLog.newest();
+  uint64_t from = to > 86400000ULL ? to - 86400000ULL : 0;
+  Rollup t = flashLog.summary(from, to, CH_TEMP);
+  Rollup h = flashLog.summary(from, to, CH_HUM);
+  printfTo(Serial, "24h (flash): temp %d..%d mean %d, hum %d..%d mean %d (0.1 units, %lu readings)\n",
+                   t.min, t.max, t.mean(), h.min, h.max, h.mean(), (unsigned long)t.count);
+  printfTo(Serial, "flash log: %lu readings in %u/%u segments, max wear %lu\n", (unsigned long)flashLog.records(),
+                   flashLog.segments(), flashLog.capacity(), (unsigned long)flashLog.maxWear());
+}
 
 // --- Setup function ---
 void setup() {
@@ -32,50 +158,78 @@ void setup() {
     Serial.println("SSD1306 allocation failed");
     for (;;);
   }
+  oled.begin();
+  text.begin();
   display.clearDisplay();
   display.setTextColor(SSD1306_WHITE);
   display.setTextSize(1);
   display.setCursor(0, 0);
   display.println("Initializing...");
-  display.display();
+  oled.flush();
+
+  if (BINARY_TELEMETRY) {
+    telemetry.channel(CH_TEMP, "temp_c", 1);
+    telemetry.channel(CH_HUM, "hum_pct", 1);
+    telemetry.begin();
+  }
+
+  if (flash.begin() && flashLog.begin(millis64())) printFlashSummary();
+  else Serial.println("No samplelog partition, readings are not kept");
 
-  // Initialize DHT sensor
-  dht.begin();
+  // Start the tasks; from here on only ui draws
+  xTaskCreatePinnedToCore(uiTaskFn, "ui", 4096, nullptr, 2, &uiTask, 1);
+  xTaskCreatePinnedToCore(acqTaskFn, "acq", 4096, nullptr, 3, nullptr, 0);
   delay(1000);
 }
 
-// --- Main loop ---
+// --- Main loop (input and serial output) ---
 void loop() {
-  float temperature = dht.readTemperature();
-  float humidity = dht.readHumidity();
+  {
+    LoadScope busy(loopLoad);
+    if (BINARY_TELEMETRY) telemetry.poll();
 
-  // Check if read failed
-  if (isnan(temperature) || isnan(humidity)) {
-    Serial.println("Error reading DHT22 sensor!");
-    return;
-  }
+    // 's' prints latency, OLED traffic and per-core load, 'r' restarts the latency
+    // histogram, 'l' summarises the flash log, 'f' writes its RAM page out
+    while (Serial.available()) {
+      char c = Serial.read();
+      if (c == 's') printStats();
+      else if (c == 'r') pixelLatency.reset();
+      else if (c == 'l') printFlashSummary();
+      else if (c == 'f') flashLog.flush();
+    }
+    if (millis() - lastStats >= 60000UL) {
+      lastStats = millis();
+      printStats();
+    }
 
-  // Print values on Serial Monitor
-  Serial.print("Temperature: ");
-  Serial.print(temperature);
-  Serial.print(" °C  |  Humidity: ");
-  Serial.print(humidity);
-  Serial.println(" %");
+    // Nothing new until acq publishes the next reading
+    Sample s{};
+    if (latest.version() != lastVersion) {
+      lastVersion = latest.read(s);
 
-  // Display on OLED
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setCursor(0, 0);
-  display.println("Hello IoT");
-  display.setCursor(0, 16);
-  display.print("Temp: ");
-  display.print(temperature);
-  display.println(" C");
-  display.setCursor(0, 32);
-  display.print("Humidity: ");
-  display.print(humidity);
-  display.println(" %");
-  display.display();
-
-  delay(2000); // update every 2 seconds
-}
\ No newline at end of file
+      // Check if read failed (the engine backs off on its own, just report it)
+      if (s.failures != lastFailures) {
+        lastFailures = s.failures;
+        Serial.print("Error reading DHT22 sensor! (");
+        Serial.print(dhtStatusName(s.status));
+        Serial.println(")");
+      } else {
+        const int16_t values[2] = {s.tempTenths, (int16_t)s.humTenths};
+        flashLog.append(flashLog.logTime(millis64()), values);
+
+        // Send the values, or print them on the Serial Monitor
+        if (BINARY_TELEMETRY) {
+          telemetry.add(CH_TEMP, s.tempTenths, s.timestampMs);
+          telemetry.add(CH_HUM, s.humTenths, s.timestampMs);
+        } else {
+          Serial.print("Temperature: ");
+          Serial.print(s.tempTenths / 10.0f);
+          Serial.print(" °C  |  Humidity: ");
+          Serial.print(s.humTenths / 10.0f);
+          Serial.println(" %");
+        }
+      }
+    }
+  }
+  delay(10);   // input and serial only; lets core 1 idle between checks
+}
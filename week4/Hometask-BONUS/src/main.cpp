@@ -2,38 +2,56 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <SpanRaster.h>
+#include <OledDiff.h>
+#include <OledFx.h>
+#include <FixedString.h>
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define OLED_ADDR 0x3C
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+SpanRaster raster;   // fills straight into the display buffer, same pixels as GFX
+OledDiff oled(display);
+OledFx fx(oled);     // blinking is done by the controller's invert command
+
+const uint32_t REPORT_MS = 10000;   // print the effect's bus cost this often
+uint32_t lastReport = 0;
 
 void drawLogo() {
 
   display.clearDisplay();
 
-  display.fillCircle(64, 32, 24, SSD1306_WHITE);
-  display.fillCircle(64, 32, 18, SSD1306_BLACK);
-  display.fillCircle(64, 32, 10, SSD1306_WHITE);
-  display.display();
+  raster.fillCircle(64, 32, 24, SSD1306_WHITE);
+  raster.fillCircle(64, 32, 18, SSD1306_BLACK);
+  raster.fillCircle(64, 32, 10, SSD1306_WHITE);
+  oled.flush();
 }
 
 void setup() {
+  Serial.begin(115200);
   Wire.begin(21, 22); 
 
   if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
     // If OLED not detected, stop program
     for (;;);
   }
+  raster.begin(display.getBuffer());
+  oled.begin();
 
   drawLogo();  
+  fx.blink(150);   // invert on / off every 150 ms
 }
 
 void loop() {
   // blinking effect 
-  display.invertDisplay(true);
-  delay(150);
-  display.invertDisplay(false);
-  delay(150);
+  fx.poll();
+
+  if (millis() - lastReport >= REPORT_MS) {
+    lastReport = millis();
+    const OledFx::Stats &s = fx.stats(OledFx::BLINK);
+    printfTo(Serial, "blink: %lu commands, %lu I2C bytes (one logo frame was %u)\n",
+                     (unsigned long)s.commands, (unsigned long)s.bytes, oled.lastFrameBytes());
+  }
 }
@@ -1,16 +1,17 @@
 #include <Arduino.h>
+#include <FastPin.h>
 
-#define LED_PIN 2            // GPIO4 for LED
+typedef Pin<2> Led;          // GPIO2, the on-board LED
 hw_timer_t *My_timer = nullptr;
 
 // ---- Timer ISR ----
 void IRAM_ATTR onTimer() {
-  digitalWrite(LED_PIN, !digitalRead(LED_PIN));  // toggle LED
+  Led::toggle();             // one register read + one store, inlined into the ISR
 }
 
 // ---- Setup ----
 void setup() {
-  pinMode(LED_PIN, OUTPUT);
+  Led::begin();
 
   // timerBegin(timer number 0-3, prescaler, countUp)
   // 80 MHz / 80 = 1 MHz → tick = 1 µs
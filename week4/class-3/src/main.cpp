@@ -1,6 +1,18 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <SpanRaster.h>
+#include <OledDiff.h>
+
+// 1: fade each new scene in with the contrast register (about 40 bytes more
+// per switch); 0 shows it at once, as the original sketch did
+#ifndef SCENE_FADE
+#define SCENE_FADE 0
+#endif
+
+#if SCENE_FADE
+#include <OledFx.h>
+#endif
 
 // ---- OLED setup ----
 #define SCREEN_WIDTH 128
@@ -9,6 +21,41 @@
 
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+SpanRaster raster;   // lines straight into the display buffer, same pixels as GFX
+OledDiff oled(display);   // only the bytes that differ from the last scene go out
+#if SCENE_FADE
+OledFx fx(oled);          // fade-in done by the controller's contrast register
+#endif
+
+// ---- Scenes ----
+const uint32_t SCENE_MS = 2000;    // each picture stays this long
+#if SCENE_FADE
+const uint16_t FADE_MS = 200;      // contrast ramp after a switch
+const uint8_t FULL_CONTRAST = 0xCF;
+#endif
+uint8_t scene = 1;
+uint32_t sceneStart = 0;
+
+void drawScene(uint8_t s) {
+  display.clearDisplay();
+  if (s == 0) {
+    raster.drawLine(0, 0, 127, 63, SSD1306_WHITE);
+    raster.drawLine(0, 63, 127, 0, SSD1306_WHITE);
+  } else {
+    display.setTextSize(1);
+    display.setTextColor(SSD1306_WHITE);
+    display.setCursor(1, 5);
+    display.println("Hello");
+
+    display.setTextSize(2);
+    display.setCursor(20, 26);
+    display.println("CS-B");
+  }
+  oled.flush();   // the one push per switch
+#if SCENE_FADE
+  fx.fade(0, FULL_CONTRAST, FADE_MS);
+#endif
+}
 
 
 
@@ -20,31 +67,19 @@ void setup() {
     for (;;);
   }
 
-  display.clearDisplay();
-  
+  raster.begin(display.getBuffer());
+  oled.begin();
+  sceneStart = millis() - SCENE_MS;   // first scene right away
 }
 
 void loop() {
- 
-
-  display.clearDisplay();
-  display.drawLine(0, 0, 127, 63, SSD1306_WHITE);
-  display.drawLine(0, 63, 127, 0, SSD1306_WHITE);
-  display.display();
-  delay(2000);
-  display.clearDisplay();
+#if SCENE_FADE
+  fx.poll();
+#endif
 
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-  display.setCursor(1, 5);
-  display.println("Hello");
-  display.display();
-
-
-  display.setTextSize(2);
-  display.setTextColor(SSD1306_WHITE);
-  display.setCursor(20, 26);
-  display.println("CS-B");
-  display.display();
-  delay(2000);
-}
\ No newline at end of file
+  // Switch pictures every SCENE_MS without blocking
+  if (millis() - sceneStart < SCENE_MS) return;
+  sceneStart += SCENE_MS;
+  scene ^= 1;
+  drawScene(scene);
+}